@@ -0,0 +1,84 @@
+#include "../cil-system.h"
+#include "../Utils/Benchmarking/PhaseBenchmark.h"
+#include <filesystem>
+
+//Times every phase of the pipeline over the benchmark corpus in this directory,
+//or over the programs given on the command line, and prints median and p95.
+#ifndef CIL_BENCHMARK_DIR
+#define CIL_BENCHMARK_DIR "Benchmarks"
+#endif
+
+void print_usage(const char* program)
+{
+	std::cerr << "Usage: " << program << " [options] [file...]\n"
+		<< "  --runs=N          Run every program N times (default 10)\n"
+		<< "  --engine=ast|vm   Execute with the tree-walking interpreter (default) or the bytecode VM\n"
+		<< "  --no-optimize     Run the programs exactly as they were parsed\n"
+		<< "Without files every .cil file in " << CIL_BENCHMARK_DIR << " is run.\n";
+}
+
+int main(int argc, char** argv)
+{
+	size_t runs = 10;
+	bool vm = false;
+	bool optimize = true;
+	std::vector<std::string> paths{};
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg.starts_with("--runs="))
+		{ runs = std::stoul(arg.substr(std::strlen("--runs="))); }
+		else if (arg == "--engine=ast")
+		{ vm = false; }
+		else if (arg == "--engine=vm" || arg == "--vm")
+		{ vm = true; }
+		else if (arg == "--no-optimize")
+		{ optimize = false; }
+		else if (arg == "--help" || arg == "-h")
+		{
+			print_usage(argv[0]);
+			return EXIT_SUCCESS;
+		}
+		else if (arg.starts_with("-"))
+		{
+			std::cerr << "Unknown option '" << arg << "'\n";
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		else
+		{ paths.push_back(arg); }
+	}
+
+	if (paths.empty())
+	{
+		std::error_code error{};
+		for (const auto& entry : std::filesystem::directory_iterator(CIL_BENCHMARK_DIR, error))
+		{
+			if (entry.path().extension() == ".cil")
+			{ paths.push_back(entry.path().string()); }
+		}
+		if (error)
+		{
+			std::cerr << "Could not read '" << CIL_BENCHMARK_DIR << "': " << error.message() << "\n";
+			return EXIT_FAILURE;
+		}
+		std::sort(paths.begin(), paths.end());
+	}
+
+	bool failed = false;
+	std::vector<PhaseBenchmark::Result> results{};
+	for (const std::string& path : paths)
+	{
+		if (!std::filesystem::exists(path))
+		{
+			std::cerr << "Could not open '" << path << "'\n";
+			return EXIT_FAILURE;
+		}
+		PhaseBenchmark benchmark{ path, vm, optimize };
+		results.push_back(benchmark.run(runs));
+		failed |= !results.back().error.empty();
+	}
+
+	PhaseBenchmark::report(results, std::cout);
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include "../cil-system.h"
+#include "../Interpreting/CompiledProgram.h"
+#include "../Interpreting/ProgramCache.h"
+#include "../Utils/Benchmarking/Timing.h"
+#include <filesystem>
+
+//Runs every program of the benchmark corpus several times the way an embedding
+//host would, once compiling it for every run and once through a ProgramCache,
+//and prints the median time per run of both next to what the cache saved.
+#ifndef CIL_BENCHMARK_DIR
+#define CIL_BENCHMARK_DIR "Benchmarks"
+#endif
+
+void print_usage(const char* program)
+{
+	std::cerr << "Usage: " << program << " [options] [file...]\n"
+		<< "  --runs=N          Run every program N times each way (default 10)\n"
+		<< "  --capacity=N      Programs the cache holds (default 64)\n"
+		<< "Without files every .cil file in " << CIL_BENCHMARK_DIR << " is run.\n";
+}
+
+int main(int argc, char** argv)
+{
+	size_t runs = 10;
+	size_t capacity = 64;
+	std::vector<std::string> paths{};
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg.starts_with("--runs="))
+		{ runs = std::max<size_t>(std::stoul(arg.substr(std::strlen("--runs="))), 1); }
+		else if (arg.starts_with("--capacity="))
+		{ capacity = std::stoul(arg.substr(std::strlen("--capacity="))); }
+		else if (arg == "--help" || arg == "-h")
+		{
+			print_usage(argv[0]);
+			return EXIT_SUCCESS;
+		}
+		else if (arg.starts_with("-"))
+		{
+			std::cerr << "Unknown option '" << arg << "'\n";
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		else
+		{ paths.push_back(arg); }
+	}
+
+	if (paths.empty())
+	{
+		std::error_code error{};
+		for (const auto& entry : std::filesystem::directory_iterator(CIL_BENCHMARK_DIR, error))
+		{
+			if (entry.path().extension() == ".cil")
+			{ paths.push_back(entry.path().string()); }
+		}
+		if (error)
+		{
+			std::cerr << "Could not read '" << CIL_BENCHMARK_DIR << "': " << error.message() << "\n";
+			return EXIT_FAILURE;
+		}
+		std::sort(paths.begin(), paths.end());
+	}
+
+	ProgramCache cache{ capacity };
+	bool failed = false;
+	std::cout << std::left << std::setw(24) << "program" << std::right << std::setw(8) << "runs"
+	          << std::setw(14) << "compile ms" << std::setw(14) << "uncached ms" << std::setw(14) << "cached ms" << "\n";
+	std::cout << std::fixed << std::setprecision(3);
+	for (const std::string& path : paths)
+	{
+		std::ifstream file{ path, std::ios::binary };
+		if (!file)
+		{
+			std::cerr << "Could not open '" << path << "'\n";
+			return EXIT_FAILURE;
+		}
+		std::stringstream source{};
+		source << file.rdbuf();
+
+		std::vector<double> compile_ms{}, uncached_ms{}, cached_ms{};
+		std::string error{};
+		for (size_t i = 0; i < runs && error.empty(); i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			std::shared_ptr<const CompiledProgram> program = CompiledProgram::compile(source.str());
+			CompiledProgram::Run run = program->run();
+			uncached_ms.push_back(elapsed_ms(start));
+			compile_ms.push_back(program->compile_ms());
+			if (!run.ok())
+			{ error = run.errors.front().what(); }
+		}
+		for (size_t i = 0; i < runs && error.empty(); i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			CompiledProgram::Run run = cache.get(source.str())->run();
+			cached_ms.push_back(elapsed_ms(start));
+			if (!run.ok())
+			{ error = run.errors.front().what(); }
+		}
+
+		std::string name = path.substr(path.find_last_of("/\\") + 1);
+		std::cout << std::left << std::setw(24) << name << std::right << std::setw(8) << runs
+		          << std::setw(14) << median(compile_ms) << std::setw(14) << median(uncached_ms)
+		          << std::setw(14) << median(cached_ms) << "\n";
+		if (!error.empty())
+		{
+			std::cout << "  failed: " << error << "\n";
+			failed = true;
+		}
+	}
+
+	std::cout << "\n";
+	cache.dump_stats(std::cout);
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+#include "../cil-system.h"
+#include "../Diagnostics/CILError.h"
+#include "../Utils/Benchmarking/FrontendBenchmark.h"
+
+//Lexes, scans and parses generated programs of growing size and prints the
+//throughput of every phase, one row per size and phase.
+
+void print_usage(const char* program)
+{
+	std::cerr << "Usage: " << program << " [options]\n"
+		<< "  --sizes=N,N,...        Function counts of the generated programs (default 250,1000,4000,16000)\n"
+		<< "  --runs=N               Parse every program N times and report the median (default 3)\n"
+		<< "  --statement-depth=N    Nesting of statements inside a function (default 3)\n"
+		<< "  --expression-depth=N   Nesting of operators inside an expression (default 3)\n"
+		<< "  --statements=N         Statements per function body, at most (default 6)\n";
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<size_t> sizes{ 250, 1000, 4000, 16000 };
+	size_t runs = 3;
+	ProgramGenerator::Shape shape{};
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg.starts_with("--sizes="))
+		{
+			sizes.clear();
+			std::stringstream list{ arg.substr(std::strlen("--sizes=")) };
+			std::string size{};
+			while (std::getline(list, size, ','))
+			{ sizes.push_back(std::stoul(size)); }
+		}
+		else if (arg.starts_with("--runs="))
+		{ runs = std::stoul(arg.substr(std::strlen("--runs="))); }
+		else if (arg.starts_with("--statement-depth="))
+		{ shape.statement_depth = std::stoi(arg.substr(std::strlen("--statement-depth="))); }
+		else if (arg.starts_with("--expression-depth="))
+		{ shape.expression_depth = std::stoi(arg.substr(std::strlen("--expression-depth="))); }
+		else if (arg.starts_with("--statements="))
+		{ shape.max_statements = (uint32_t)std::stoul(arg.substr(std::strlen("--statements="))); }
+		else if (arg == "--help" || arg == "-h")
+		{
+			print_usage(argv[0]);
+			return EXIT_SUCCESS;
+		}
+		else
+		{
+			std::cerr << "Unknown option '" << arg << "'\n";
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	shape.min_statements = std::min(shape.min_statements, shape.max_statements);
+
+	FrontendBenchmark benchmark{ shape, runs };
+	std::vector<FrontendBenchmark::Sample> samples{};
+	try
+	{
+		for (size_t size : sizes)
+		{ samples.push_back(benchmark.run(size)); }
+	}
+	catch (CILError& err)
+	{
+		std::cerr << err.what() << "\n";
+		return EXIT_FAILURE;
+	}
+
+	FrontendBenchmark::report(samples, std::cout);
+	return EXIT_SUCCESS;
+}
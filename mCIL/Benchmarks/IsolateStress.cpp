@@ -0,0 +1,185 @@
+#include "../cil-system.h"
+#include "../Lexing/Lexer.h"
+#include "../Scanning/Scanner.h"
+#include "../Parsing/Parser.h"
+#include "../Parsing/Optimizer.h"
+#include "../Parsing/Resolver.h"
+#include "../Interpreting/Interpreter.h"
+#include "../Interpreting/Isolate.h"
+#include "../Diagnostics/SourceFileManager.h"
+#include "../Diagnostics/Diagnostics.h"
+#include "../Utils/Threading/ThreadManager.h"
+#include <filesystem>
+
+//Runs the programs of the benchmark corpus in many isolates at the same time and
+//checks that every run prints exactly what the program prints when it runs alone.
+//Configure with -DCIL_TSAN=ON to have ThreadSanitizer watch the isolates for races.
+#ifndef CIL_BENCHMARK_DIR
+#define CIL_BENCHMARK_DIR "Benchmarks"
+#endif
+
+struct Outcome
+{
+	std::string out;
+	std::string error;
+
+	bool operator==(const Outcome& other) const
+	{ return out == other.out && error == other.error; }
+};
+
+//Runs 'path' from source to output in an isolate of its own
+static Outcome run_program(const std::string& path, size_t loop_threads)
+{
+	Isolate isolate{};
+	Isolate::Scope scope{ isolate };
+
+	Outcome outcome{};
+	auto failed = [&outcome]()
+	{
+		if (!ErrorManager::error_ocurred())
+		{ return false; }
+		outcome.error = ErrorManager::errors().front().what();
+		return true;
+	};
+
+	SourceFileManager source{ path };
+	Lexer lexer{ isolate, source };
+	token_list tokens = lexer.scan_file();
+	if (failed())
+	{ return outcome; }
+
+	Scanner scanner{ isolate, tokens };
+	token_list top_level_tokens = scanner.scan();
+	if (failed())
+	{ return outcome; }
+
+	Parser parser{ isolate, top_level_tokens };
+	stmt_list& stmts = parser.parse();
+	if (failed())
+	{ return outcome; }
+
+	ConstantPool constants{};
+	Optimizer optimizer{ stmts, constants };
+	optimizer.optimize();
+	Resolver resolver{ stmts, constants };
+	resolver.resolve();
+	if (failed())
+	{ return outcome; }
+
+	std::stringstream out{};
+	Interpreter interpreter{ isolate, stmts };
+	interpreter.set_output(&out);
+	interpreter.set_threads(loop_threads);
+	interpreter.define_global_symbols();
+	interpreter.run();
+	outcome.out = out.str();
+	failed();
+	return outcome;
+}
+
+void print_usage(const char* program)
+{
+	std::cerr << "Usage: " << program << " [options] [file...]\n"
+		<< "  --isolates=N      Run every program in N isolates at once (default 8)\n"
+		<< "  --threads=N       Run the isolates on N threads (default one per hardware thread, at least 4)\n"
+		<< "  --loop-threads=N  Threads of each isolate's parallel loops (default 2)\n"
+		<< "Without files every .cil file in " << CIL_BENCHMARK_DIR << " is run.\n";
+}
+
+int main(int argc, char** argv)
+{
+	size_t isolates = 8;
+	size_t threads = std::max<size_t>(std::thread::hardware_concurrency(), 4);
+	size_t loop_threads = 2;
+	std::vector<std::string> paths{};
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg.starts_with("--isolates="))
+		{ isolates = std::max<size_t>(std::stoul(arg.substr(std::strlen("--isolates="))), 1); }
+		else if (arg.starts_with("--threads="))
+		{ threads = std::max<size_t>(std::stoul(arg.substr(std::strlen("--threads="))), 1); }
+		else if (arg.starts_with("--loop-threads="))
+		{ loop_threads = std::max<size_t>(std::stoul(arg.substr(std::strlen("--loop-threads="))), 1); }
+		else if (arg == "--help" || arg == "-h")
+		{
+			print_usage(argv[0]);
+			return EXIT_SUCCESS;
+		}
+		else if (arg.starts_with("-"))
+		{
+			std::cerr << "Unknown option '" << arg << "'\n";
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+		else
+		{ paths.push_back(arg); }
+	}
+
+	if (paths.empty())
+	{
+		std::error_code error{};
+		for (const auto& entry : std::filesystem::directory_iterator(CIL_BENCHMARK_DIR, error))
+		{
+			if (entry.path().extension() == ".cil")
+			{ paths.push_back(entry.path().string()); }
+		}
+		if (error)
+		{
+			std::cerr << "Could not read '" << CIL_BENCHMARK_DIR << "': " << error.message() << "\n";
+			return EXIT_FAILURE;
+		}
+		std::sort(paths.begin(), paths.end());
+	}
+
+	std::vector<Outcome> expected{};
+	for (const std::string& path : paths)
+	{
+		if (!std::filesystem::exists(path))
+		{
+			std::cerr << "Could not open '" << path << "'\n";
+			return EXIT_FAILURE;
+		}
+		expected.push_back(run_program(path, loop_threads));
+	}
+
+	//Every program 'isolates' times, interleaved so different programs run side by side
+	std::vector<Outcome> outcomes(paths.size() * isolates);
+	auto start = std::chrono::steady_clock::now();
+	{
+		ThreadManager manager{ threads };
+		std::vector<const JobResult<bool>*> results{};
+		for (size_t i = 0; i < outcomes.size(); i++)
+		{
+			const std::string* path = &paths[i % paths.size()];
+			Outcome* outcome = &outcomes[i];
+			std::function<bool()> job = [path, outcome, loop_threads]()
+			{
+				*outcome = run_program(*path, loop_threads);
+				return true;
+			};
+			results.push_back(manager.schedule_func(job));
+		}
+		manager.wait_all();
+		for (const JobResult<bool>* result : results)
+		{ delete result; }
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	size_t mismatches = 0;
+	for (size_t i = 0; i < outcomes.size(); i++)
+	{
+		const Outcome& want = expected[i % paths.size()];
+		if (outcomes[i] == want)
+		{ continue; }
+		mismatches++;
+		std::cerr << "Isolate " << i / paths.size() << " of '" << paths[i % paths.size()] << "' differs from the run on its own";
+		if (outcomes[i].error != want.error)
+		{ std::cerr << ": '" << outcomes[i].error << "' instead of '" << want.error << "'"; }
+		std::cerr << "\n";
+	}
+
+	std::cout << "Ran " << paths.size() << " programs in " << isolates << " isolates each on " << threads << " threads in "
+	          << std::fixed << std::setprecision(3) << elapsed.count() << "ms, " << mismatches << " differed\n";
+	return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
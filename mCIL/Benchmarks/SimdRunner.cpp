@@ -0,0 +1,224 @@
+#include "../cil-system.h"
+#include "../Interpreting/CompiledProgram.h"
+#include "../Utils/Simd/ArrayKernels.h"
+#include "../Utils/Benchmarking/Timing.h"
+
+//Times the array intrinsics against the CIL loops they replace, then the kernels
+//behind them on every instruction set the CPU supports. Each workload is run as
+//two generated programs over the same arrays, one looping over the elements and
+//one calling intrinsics, which have to print the same result. Times are per
+//round over the arrays, without what declaring them and looping takes.
+
+//How many more rounds the programs calling intrinsics run
+static constexpr size_t INTRINSIC_ROUND_FACTOR = 100;
+
+struct Workload
+{
+	const char* name;
+	//Statements run every round, 'total' accumulates a checksum, 'n' is the size of the arrays
+	const char* loop;
+	const char* intrinsic;
+};
+
+static const Workload WORKLOADS[] = {
+	{ "sum",
+	  "for (num i = 0; i < n; i++) { total = total + a[i]; }",
+	  "total = total + sum(a);" },
+	{ "dot",
+	  "for (num i = 0; i < n; i++) { total = total + a[i] * b[i]; }",
+	  "total = total + dot(a, b);" },
+	{ "max",
+	  "num m = a[0]; for (num i = 1; i < n; i++) { if (a[i] > m) { m = a[i]; } } total = total + m;",
+	  "total = total + max(a);" },
+	{ "c = a * 3 + b",
+	  "for (num i = 0; i < n; i++) { c[i] = a[i] * 3 + b[i]; } total = total + c[n - 1];",
+	  "multiply(c, a, 3); add(c, c, b); total = total + c[n - 1];" },
+	{ "mask = a < b",
+	  "for (num i = 0; i < n; i++) { mask[i] = a[i] < b[i]; } if (mask[n - 1]) { total++; }",
+	  "less(mask, a, b); if (mask[n - 1]) { total++; }" },
+};
+
+static std::string array_decl(const char* type, const char* name, size_t size, const std::function<std::string(size_t)>& element)
+{
+	std::string decl = std::string(type) + "[" + std::to_string(size) + "] " + name + " = {";
+	for (size_t i = 0; i < size; i++)
+	{
+		decl += i % 16 == 0 ? "\n\t" : " ";
+		decl += element(i) + (i + 1 < size ? "," : "");
+	}
+	return decl + "\n};\n";
+}
+
+static std::string program(size_t size, size_t rounds, const char* body)
+{
+	std::string source = "num n = " + std::to_string(size) + ";\n";
+	source += array_decl("num", "a", size, [](size_t i) { return std::to_string(i % 97); });
+	source += array_decl("num", "b", size, [](size_t i) { return std::to_string(i * 7 % 13 + 1); });
+	source += array_decl("num", "c", size, [](size_t) { return std::string("0"); });
+	source += array_decl("bool", "mask", size, [](size_t) { return std::string("false"); });
+	source += "num total = 0;\n";
+	source += "for (num round = 0; round < " + std::to_string(rounds) + "; round++) {\n\t" + body + "\n}\n";
+	return source + "print total;\n";
+}
+
+//Median run time and the output of the last run, empty with the first error printed if the program failed
+static std::optional<std::pair<double, std::string>> time_program(const std::string& source, size_t runs)
+{
+	std::shared_ptr<const CompiledProgram> compiled = CompiledProgram::compile(source);
+	std::vector<double> times{};
+	std::string out{};
+	for (size_t i = 0; i < runs; i++)
+	{
+		CompiledProgram::Run run = compiled->run();
+		if (!run.ok())
+		{
+			std::cerr << "  failed: " << run.errors.front().what() << "\n";
+			return std::nullopt;
+		}
+		times.push_back(run.run_ms);
+		out = run.out;
+	}
+	return std::make_pair(median(times), out);
+}
+
+//What one kernel computes, as a number so the instruction sets can be compared
+struct Kernel
+{
+	const char* name;
+	std::function<double()> run;
+};
+
+void print_usage(const char* program)
+{
+	std::cerr << "Usage: " << program << " [options]\n"
+		<< "  --size=N          Elements of the arrays of the programs (default 4096)\n"
+		<< "  --rounds=N        Times the loops go over their arrays (default 50)\n"
+		<< "  --kernel-size=N   Elements the kernels are timed on (default 16384)\n"
+		<< "  --runs=N          Runs of everything, the median is printed (default 5)\n";
+}
+
+int main(int argc, char** argv)
+{
+	size_t size = 4096;
+	size_t rounds = 50;
+	size_t kernel_size = 16384;
+	size_t runs = 5;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg.starts_with("--size="))
+		{ size = std::max<size_t>(std::stoul(arg.substr(std::strlen("--size="))), 1); }
+		else if (arg.starts_with("--rounds="))
+		{ rounds = std::max<size_t>(std::stoul(arg.substr(std::strlen("--rounds="))), 1); }
+		else if (arg.starts_with("--kernel-size="))
+		{ kernel_size = std::max<size_t>(std::stoul(arg.substr(std::strlen("--kernel-size="))), 1); }
+		else if (arg.starts_with("--runs="))
+		{ runs = std::max<size_t>(std::stoul(arg.substr(std::strlen("--runs="))), 1); }
+		else if (arg == "--help" || arg == "-h")
+		{
+			print_usage(argv[0]);
+			return EXIT_SUCCESS;
+		}
+		else
+		{
+			std::cerr << "Unknown option '" << arg << "'\n";
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	bool failed = false;
+	std::cout << "Programs over " << size << " elements, kernels use " << ArrayKernels::isa_name(ArrayKernels::isa()) << "\n";
+	//The intrinsics go over the arrays more often, so their rounds take long enough to be measured
+	size_t intrinsic_rounds = rounds * INTRINSIC_ROUND_FACTOR;
+	std::optional<std::pair<double, std::string>> loop_setup = time_program(program(size, rounds, "total++;"), runs);
+	std::optional<std::pair<double, std::string>> intrinsic_setup = time_program(program(size, intrinsic_rounds, "total++;"), runs);
+	if (!loop_setup || !intrinsic_setup)
+	{ return EXIT_FAILURE; }
+
+	std::cout << std::left << std::setw(20) << "workload" << std::right << std::setw(16) << "loop us/round"
+	          << std::setw(20) << "intrinsic us/round" << std::setw(10) << "speedup" << "\n";
+	std::cout << std::fixed;
+	for (const Workload& workload : WORKLOADS)
+	{
+		std::optional<std::pair<double, std::string>> loop = time_program(program(size, rounds, workload.loop), runs);
+		std::optional<std::pair<double, std::string>> check = time_program(program(size, rounds, workload.intrinsic), 1);
+		std::optional<std::pair<double, std::string>> intrinsic = time_program(program(size, intrinsic_rounds, workload.intrinsic), runs);
+		if (!loop || !check || !intrinsic)
+		{
+			failed = true;
+			continue;
+		}
+		double loop_us = std::max(loop->first - loop_setup->first, 0.0) * 1000 / rounds;
+		double intrinsic_us = std::max(intrinsic->first - intrinsic_setup->first, 0.001) * 1000 / intrinsic_rounds;
+		std::cout << std::left << std::setw(20) << workload.name << std::right << std::setprecision(3)
+		          << std::setw(16) << loop_us << std::setw(20) << intrinsic_us
+		          << std::setw(9) << std::setprecision(1) << loop_us / intrinsic_us << "x\n";
+		if (loop->second != check->second)
+		{
+			std::cout << "  results differ: " << loop->second << " from the loop, " << check->second << " from the intrinsics\n";
+			failed = true;
+		}
+	}
+
+	//Kernels straight on buffers, once per instruction set
+	std::vector<double> left(kernel_size), right(kernel_size), dst(kernel_size);
+	std::vector<uint8_t> mask(kernel_size);
+	for (size_t i = 0; i < kernel_size; i++)
+	{
+		left[i] = (double)(i % 1000) / 7;
+		right[i] = (double)(i * 31 % 997) / 3;
+	}
+	ArrayKernels::Operand left_operand{ left.data() }, right_operand{ right.data() };
+	std::vector<Kernel> kernels{
+		{ "sum", [&]() { return ArrayKernels::sum(left.data(), kernel_size); } },
+		{ "dot", [&]() { return ArrayKernels::dot(left.data(), right.data(), kernel_size); } },
+		{ "min", [&]() { return ArrayKernels::min(left.data(), kernel_size); } },
+		{ "add", [&]() {
+			ArrayKernels::arith(ArrayKernels::Arith::ARITH_ADD, dst.data(), left_operand, right_operand, kernel_size);
+			return dst[kernel_size / 2] + dst[kernel_size - 1]; } },
+		{ "multiply scalar", [&]() {
+			ArrayKernels::arith(ArrayKernels::Arith::ARITH_MULTIPLY, dst.data(), left_operand, { nullptr, 1.5 }, kernel_size);
+			return dst[kernel_size / 2] + dst[kernel_size - 1]; } },
+		{ "less", [&]() {
+			ArrayKernels::compare(ArrayKernels::Compare::COMPARE_LESS, mask.data(), left_operand, right_operand, kernel_size);
+			return (double)std::count(mask.begin(), mask.end(), 1); } },
+	};
+
+	//Enough calls per timing that small buffers, which stay in the cache, can be measured
+	size_t calls = std::max<size_t>((1 << 24) / kernel_size, 1);
+	ArrayKernels::Isa detected = ArrayKernels::detected_isa();
+	std::cout << "\nKernels over " << kernel_size << " elements, us per call\n" << std::left << std::setw(20) << "kernel" << std::right;
+	for (int isa = 0; isa <= (int)detected; isa++)
+	{ std::cout << std::setw(12) << ArrayKernels::isa_name((ArrayKernels::Isa)isa); }
+	std::cout << "\n";
+	for (const Kernel& kernel : kernels)
+	{
+		std::cout << std::left << std::setw(20) << kernel.name << std::right;
+		std::optional<double> expected{};
+		for (int isa = 0; isa <= (int)detected; isa++)
+		{
+			ArrayKernels::set_isa((ArrayKernels::Isa)isa);
+			std::vector<double> times{};
+			double result = 0;
+			for (size_t i = 0; i < runs; i++)
+			{
+				auto start = std::chrono::steady_clock::now();
+				for (size_t call = 0; call < calls; call++)
+				{ result = kernel.run(); }
+				times.push_back(elapsed_ms(start) * 1000 / calls);
+			}
+			std::cout << std::setw(12) << std::setprecision(3) << median(times);
+			//Every instruction set has to compute exactly what the scalar kernel does
+			if (expected && *expected != result)
+			{
+				std::cout << " (differs)";
+				failed = true;
+			}
+			expected = result;
+		}
+		std::cout << "\n";
+	}
+	ArrayKernels::set_isa(detected);
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,139 @@
+#include "../cil-system.h"
+#include "../Interpreting/CompiledProgram.h"
+#include "../Utils/Benchmarking/Timing.h"
+
+//Times building strings piece by piece, for a number of pieces doubling up to
+//the largest. One string is appended to and one prepended to, then both are
+//compared, which flattens them. With concatenation taking constant time, the
+//time per piece stays the same as the number of pieces grows.
+//A second table compares two strings after every piece appended to them, which
+//flattens both every time. Comparing takes time linear in the length, so the
+//time grows with the square of the pieces, but the strings have to stay within
+//a heap limit of a few times their final size.
+
+//Heap the strings compared after every piece may take, in multiples of their final size
+static constexpr size_t READ_HEAP_FACTOR = 8;
+//Heap left for everything besides the strings
+static constexpr size_t READ_HEAP_BASE = 64 * 1024;
+
+static std::string program(size_t pieces, const std::string& piece)
+{
+	std::string count = std::to_string(pieces);
+	std::string literal = "\"" + piece + "\"";
+	return "str text = \"\";\nstr copy = \"\";\n"
+		"for (num i = 0; i < " + count + "; i++) { text = text + " + literal + "; }\n"
+		"for (num j = 0; j < " + count + "; j++) { copy = " + literal + " + copy; }\n"
+		"print text == copy;\n";
+}
+
+static std::string read_program(size_t pieces, const std::string& piece)
+{
+	std::string count = std::to_string(pieces);
+	std::string literal = "\"" + piece + "\"";
+	return "str text = \"\";\nstr copy = \"\";\nbool same = true;\n"
+		"for (num i = 0; i < " + count + "; i++) { text = text + " + literal + "; copy = copy + " + literal + "; same = same && text == copy; }\n"
+		"print same;\n";
+}
+
+//Runs the programs for 'pieces' halved 'steps' times up to 'pieces', returns false if one failed
+static bool run_table(const std::function<std::string(size_t, const std::string&)>& generate, size_t pieces, size_t steps,
+	const std::string& piece, size_t runs, size_t heap_factor)
+{
+	std::cout << std::right << std::setw(10) << "pieces" << std::setw(12) << "bytes" << std::setw(12) << "ms"
+	          << std::setw(14) << "ns/piece" << std::setw(10) << "growth" << "\n";
+	bool failed = false;
+	std::optional<double> previous{};
+	for (size_t step = steps + 1; step-- > 0;)
+	{
+		size_t count = std::max<size_t>(pieces >> step, 1);
+		std::shared_ptr<const CompiledProgram> compiled = CompiledProgram::compile(generate(count, piece));
+		if (heap_factor)
+		{
+			Heap::Limits limits{};
+			//Two strings of 'count' pieces are built
+			limits.max_bytes = READ_HEAP_BASE + heap_factor * 2 * count * piece.size();
+			compiled->set_heap_limits(limits);
+		}
+		std::vector<double> times{};
+		for (size_t i = 0; i < runs; i++)
+		{
+			CompiledProgram::Run run = compiled->run();
+			if (!run.ok() || run.out != "true")
+			{
+				std::cerr << "  failed: " << (run.ok() ? "the strings differ" : run.errors.front().what()) << "\n";
+				failed = true;
+				break;
+			}
+			times.push_back(run.run_ms);
+		}
+		if (times.empty())
+		{ continue; }
+
+		double ms = median(times);
+		//Two strings of 'count' pieces are built
+		double ns_per_piece = ms * 1e6 / (count * 2);
+		std::cout << std::setw(10) << count << std::setw(12) << count * piece.size() << std::setw(12) << std::setprecision(1) << ms
+		          << std::setw(14) << std::setprecision(1) << ns_per_piece;
+		//Time taken over the half as many pieces before, 2.0 is linear
+		if (previous)
+		{ std::cout << std::setw(9) << std::setprecision(2) << ms / *previous << "x"; }
+		std::cout << "\n";
+		previous = ms;
+	}
+	return !failed;
+}
+
+void print_usage(const char* program)
+{
+	std::cerr << "Usage: " << program << " [options]\n"
+		<< "  --pieces=N       Pieces of the longest strings (default 1000000)\n"
+		<< "  --steps=N        Times the number of pieces is doubled up to that (default 4)\n"
+		<< "  --piece=S        The piece added every time (default 'ab')\n"
+		<< "  --read-pieces=N  Pieces of the longest strings compared after every piece (default 8000)\n"
+		<< "  --runs=N         Runs of every program, the median is printed (default 3)\n";
+}
+
+int main(int argc, char** argv)
+{
+	size_t pieces = 1000000;
+	size_t steps = 4;
+	std::string piece = "ab";
+	size_t read_pieces = 8000;
+	size_t runs = 3;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg.starts_with("--pieces="))
+		{ pieces = std::max<size_t>(std::stoul(arg.substr(std::strlen("--pieces="))), 1); }
+		else if (arg.starts_with("--steps="))
+		{ steps = std::stoul(arg.substr(std::strlen("--steps="))); }
+		else if (arg.starts_with("--piece="))
+		{ piece = arg.substr(std::strlen("--piece=")); }
+		else if (arg.starts_with("--read-pieces="))
+		{ read_pieces = std::max<size_t>(std::stoul(arg.substr(std::strlen("--read-pieces="))), 1); }
+		else if (arg.starts_with("--runs="))
+		{ runs = std::max<size_t>(std::stoul(arg.substr(std::strlen("--runs="))), 1); }
+		else if (arg == "--help" || arg == "-h")
+		{
+			print_usage(argv[0]);
+			return EXIT_SUCCESS;
+		}
+		else
+		{
+			std::cerr << "Unknown option '" << arg << "'\n";
+			print_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (piece.empty() || piece.find_first_of("\"\\") != std::string::npos)
+	{
+		std::cerr << "The piece must not be empty or contain quotes or backslashes\n";
+		return EXIT_FAILURE;
+	}
+
+	std::cout << std::fixed;
+	bool ok = run_table(program, pieces, steps, piece, runs, 0);
+	std::cout << "\nCompared after every piece, within " << READ_HEAP_FACTOR << " times their size:\n";
+	ok = run_table(read_program, read_pieces, steps, piece, runs, READ_HEAP_FACTOR) && ok;
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,509 @@
+#include "BytecodeBackend.h"
+
+BytecodeBackend::BytecodeBackend()
+	: chunk_(nullptr), scope_depth_(0), loops_(), call_sites_(0)
+{
+}
+
+void BytecodeBackend::init()
+{
+	chunk_ = std::make_shared<Chunk>();
+	scope_depth_ = 0;
+	loops_.clear();
+}
+
+void BytecodeBackend::gen_statement(stmt_ptr stmt)
+{
+	visit_stmt(stmt);
+}
+
+void BytecodeBackend::dump()
+{
+	chunk_->disassemble(std::cout, "<program>");
+}
+
+chunk_ptr BytecodeBackend::compile_statement(stmt_ptr stmt)
+{
+	init();
+	visit_stmt(stmt);
+	emit(OpCode::OP_END, stmt->pos());
+	return chunk_;
+}
+
+chunk_ptr BytecodeBackend::compile_expression(expr_ptr expr)
+{
+	init();
+	visit_expr(expr);
+	emit(OpCode::OP_END, expr->pos());
+	return chunk_;
+}
+
+chunk_ptr BytecodeBackend::compile_function(stmt_ptr body)
+{
+	init();
+	visit_stmt(body);
+	emit(OpCode::OP_RETURN_DEFAULT, body->pos());
+	return chunk_;
+}
+
+void BytecodeBackend::visit_error_expr(ErrorExpression* expr)
+{
+	emit(OpCode::OP_ERROR, expr->pos());
+}
+
+void BytecodeBackend::visit_grouping_expr(GroupingExpression* expr)
+{
+	visit_expr(expr->expr());
+}
+
+void BytecodeBackend::visit_primary_expr(PrimaryExpression* expr)
+{
+	switch (expr->primary_type())
+	{
+	case PrimaryType::PRIMARY_NONE:
+		emit(OpCode::OP_NONE, expr->pos());
+		break;
+	case PrimaryType::PRIMARY_BOOL:
+		emit(expr->val().bool_val ? OpCode::OP_TRUE : OpCode::OP_FALSE, expr->pos());
+		break;
+	case PrimaryType::PRIMARY_NUM:
+		emit_short(OpCode::OP_NUMBER, chunk_->add_number(expr->val().num_val), expr->pos());
+		break;
+	case PrimaryType::PRIMARY_STR:
+		emit_short(OpCode::OP_STRING, chunk_->add_string(*expr->val().str_val), expr->pos());
+		break;
+	case PrimaryType::PRIMARY_IDENTIFIER:
+		if (expr->slot().resolved())
+		{
+			emit_short(OpCode::OP_GET_LOCAL, chunk_->add_name(*expr->val().identifier_val), expr->pos());
+			emit_slot(expr->slot(), expr->pos());
+		}
+		else
+		{
+			emit_short(OpCode::OP_GET_VAR, chunk_->add_name(*expr->val().identifier_val), expr->pos());
+		}
+		break;
+	default:
+		throw CILError::error(expr->pos(), "Incomplete handling of primary expressions");
+	}
+}
+
+void BytecodeBackend::visit_call_expr(CallExpression* expr)
+{
+	if (expr->intrinsic() != Intrinsic::INTRINSIC_NONE)
+	{
+		emit_intrinsic(expr);
+		return;
+	}
+	emit_short(OpCode::OP_BEGIN_CALL, chunk_->add_name(expr->identifier()), expr->pos());
+	chunk_->write_short((uint16_t)expr->args().size());
+	if (expr->slot().resolved())
+	{ emit_slot(expr->slot(), expr->pos()); }
+	else
+	{
+		chunk_->write_short(UINT16_MAX);
+		chunk_->write_short(UINT16_MAX);
+	}
+	//Sites past the range of an operand are not cached
+	chunk_->write_short(call_sites_ < UINT16_MAX ? (uint16_t)call_sites_++ : UINT16_MAX);
+	size_t resume = chunk_->size();
+	chunk_->write_short(0);
+
+	for (const expr_ptr& arg : expr->args())
+	{
+		visit_expr(arg);
+	}
+	emit(expr->tail() ? OpCode::OP_TAIL_CALL : OpCode::OP_CALL, expr->pos());
+	patch_jump(resume, expr->pos());
+}
+
+//Plain names are passed by name, the VM decides whether they refer to an array.
+//Every other argument is evaluated onto the stack first
+void BytecodeBackend::emit_intrinsic(CallExpression* expr)
+{
+	std::vector<uint16_t> names{};
+	for (const expr_ptr& arg : expr->args())
+	{
+		PrimaryExpression* primary = arg->is_primary_expr() ? static_cast<PrimaryExpression*>(arg.get()) : nullptr;
+		if (primary && primary->primary_type() == PrimaryType::PRIMARY_IDENTIFIER)
+		{ names.push_back(chunk_->add_name(*primary->val().identifier_val)); }
+		else
+		{
+			visit_expr(arg);
+			names.push_back(UINT16_MAX);
+		}
+	}
+	emit_short(OpCode::OP_INTRINSIC, chunk_->add_name(expr->identifier()), expr->pos());
+	chunk_->write_short((uint16_t)expr->intrinsic());
+	chunk_->write_short((uint16_t)names.size());
+	for (uint16_t name : names)
+	{ chunk_->write_short(name); }
+}
+
+void BytecodeBackend::visit_access_expr(AccessExpression* expr)
+{
+	emit_short(OpCode::OP_ENTER_OBJECT, chunk_->add_name(expr->identifier()), expr->pos());
+	visit_expr(expr->inner());
+	emit(OpCode::OP_LEAVE_OBJECT, expr->pos());
+}
+
+void BytecodeBackend::visit_new_expr(NewExpression* expr)
+{
+	emit_short(OpCode::OP_NEW, chunk_->add_name(expr->identifier()), expr->pos());
+}
+
+void BytecodeBackend::visit_array_access_expr(ArrayAccessExpression* expr)
+{
+	visit_expr(expr->index());
+	emit_short(OpCode::OP_GET_ELEMENT, chunk_->add_name(expr->identifier()), expr->pos());
+}
+
+void BytecodeBackend::visit_unary_expr(UnaryExpression* expr)
+{
+	visit_expr(expr->expr());
+	switch (expr->op())
+	{
+	case Operator::OPERATOR_BANG:
+	case Operator::OPERATOR_SUBTRACT:
+		emit(OpCode::OP_INVERT, expr->pos());
+		break;
+	case Operator::OPERATOR_INCREMENT:
+		emit(OpCode::OP_INCREMENT, expr->pos());
+		break;
+	case Operator::OPERATOR_DECREMENT:
+		emit(OpCode::OP_DECREMENT, expr->pos());
+		break;
+	case Operator::OPERATOR_BITWISE_NOT:
+		emit(OpCode::OP_BITWISE_NOT, expr->pos());
+		break;
+	default:
+		throw CILError::error(expr->pos(), "Incomplete handling of unary expressions");
+	}
+
+	//Numbers are immediate values, so '++' and '--' have to write their result back
+	bool is_step = expr->op() == Operator::OPERATOR_INCREMENT || expr->op() == Operator::OPERATOR_DECREMENT;
+	if (is_step && expr->expr()->is_primary_expr())
+	{
+		PrimaryExpression* primary = static_cast<PrimaryExpression*>(expr->expr().get());
+		if (primary->primary_type() == PrimaryType::PRIMARY_IDENTIFIER)
+		{ emit_store(primary, expr->pos()); }
+	}
+}
+
+void BytecodeBackend::visit_binary_expr(BinaryExpression* expr)
+{
+	OpCode op;
+	switch (expr->op())
+	{
+	case Operator::OPERATOR_ADD:
+		op = OpCode::OP_ADD;
+		break;
+	case Operator::OPERATOR_SUBTRACT:
+		op = OpCode::OP_SUBTRACT;
+		break;
+	case Operator::OPERATOR_MULTIPLY:
+		op = OpCode::OP_MULTIPLY;
+		break;
+	case Operator::OPERATOR_DIVIDE:
+		op = OpCode::OP_DIVIDE;
+		break;
+	case Operator::OPERATOR_LEFT_BITSHIFT:
+		op = OpCode::OP_LEFT_BITSHIFT;
+		break;
+	case Operator::OPERATOR_RIGHT_BITSHIFT:
+		op = OpCode::OP_RIGHT_BITSHIFT;
+		break;
+	case Operator::OPERATOR_GREATER:
+		op = OpCode::OP_GREATER;
+		break;
+	case Operator::OPERATOR_LESS:
+		op = OpCode::OP_LESS;
+		break;
+	case Operator::OPERATOR_GREATER_EQUAL:
+		op = OpCode::OP_GREATER_EQUAL;
+		break;
+	case Operator::OPERATOR_LESS_EQUAL:
+		op = OpCode::OP_LESS_EQUAL;
+		break;
+	case Operator::OPERATOR_EQUAL_EQUAL:
+		op = OpCode::OP_EQUAL;
+		break;
+	case Operator::OPERATOR_NOT_EQUAL:
+		op = OpCode::OP_NOT_EQUAL;
+		break;
+	case Operator::OPERATOR_AND:
+		op = OpCode::OP_AND;
+		break;
+	case Operator::OPERATOR_OR:
+		op = OpCode::OP_OR;
+		break;
+	case Operator::OPERATOR_BITWISE_AND:
+		op = OpCode::OP_BITWISE_AND;
+		break;
+	case Operator::OPERATOR_BITWISE_OR:
+		op = OpCode::OP_BITWISE_OR;
+		break;
+	case Operator::OPERATOR_BITWISE_XOR:
+		op = OpCode::OP_BITWISE_XOR;
+		break;
+	default:
+		throw CILError::error(expr->pos(), "Incomplete handling of binary expressions");
+	}
+
+	//An erroneous left operand short-circuits, the right one is never evaluated
+	visit_expr(expr->left());
+	size_t left_error = emit_jump(OpCode::OP_JUMP_IF_ERROR, expr->pos());
+	visit_expr(expr->right());
+	emit(op, expr->pos());
+	patch_jump(left_error, expr->pos());
+}
+
+void BytecodeBackend::visit_ternary_expr(TernaryExpression* expr)
+{
+	visit_expr(expr->cond());
+	size_t cond_error = emit_jump(OpCode::OP_JUMP_IF_ERROR, expr->pos());
+	size_t else_jump = emit_jump(OpCode::OP_JUMP_IF_FALSE, expr->pos());
+	visit_expr(expr->left());
+	size_t end_jump = emit_jump(OpCode::OP_JUMP, expr->pos());
+	patch_jump(else_jump, expr->pos());
+	visit_expr(expr->right());
+	patch_jump(end_jump, expr->pos());
+	patch_jump(cond_error, expr->pos());
+}
+
+void BytecodeBackend::visit_assignment_expr(AssignmentExpression* expr)
+{
+	if (expr->target()->is_array_access_expr())
+	{
+		ArrayAccessExpression* access = static_cast<ArrayAccessExpression*>(expr->target().get());
+		visit_expr(expr->expr());
+		visit_expr(access->index());
+		emit_short(OpCode::OP_SET_ELEMENT, chunk_->add_name(access->identifier()), expr->pos());
+		return;
+	}
+	if (!expr->target()->is_primary_expr())
+	{ throw CILError::error(expr->pos(), "Cannot only assign to primary values"); }
+
+	PrimaryExpression* primary = static_cast<PrimaryExpression*>(expr->target().get());
+	if (primary->primary_type() != PrimaryType::PRIMARY_IDENTIFIER)
+	{ throw CILError::error(expr->pos(), "Cannot assign to '$'", primary->primary_type()); }
+
+	visit_expr(expr->expr());
+	emit_store(primary, expr->pos());
+}
+
+void BytecodeBackend::visit_block_stmt(BlockStatement* stmt)
+{
+	emit(OpCode::OP_PUSH_SCOPE, stmt->pos());
+	scope_depth_++;
+	for (const stmt_ptr& inner : stmt->inner())
+	{
+		visit_stmt(inner);
+	}
+	scope_depth_--;
+	emit(OpCode::OP_POP_SCOPE, stmt->pos());
+}
+
+void BytecodeBackend::visit_break_stmt(BreakStatement* stmt)
+{
+	if (loops_.empty())
+	{ throw CILError::error(stmt->pos(), "'break' can only be used inside a loop body"); }
+
+	Loop& loop = loops_.back();
+	for (int depth = scope_depth_; depth > loop.scope_depth; depth--)
+	{
+		emit(OpCode::OP_POP_SCOPE, stmt->pos());
+	}
+	loop.breaks.push_back(emit_jump(OpCode::OP_JUMP, stmt->pos()));
+}
+
+void BytecodeBackend::visit_return_stmt(ReturnStatement* stmt)
+{
+	visit_expr(stmt->expr());
+	emit(OpCode::OP_RETURN, stmt->pos());
+}
+
+void BytecodeBackend::visit_print_stmt(PrintStatement* stmt)
+{
+	visit_expr(stmt->expr());
+	emit(OpCode::OP_PRINT, stmt->pos());
+}
+
+void BytecodeBackend::visit_elif_stmt(ElifStatement* stmt)
+{
+	if (stmt->cond() == nullptr)
+	{
+		visit_stmt(stmt->inner());
+		return;
+	}
+
+	visit_expr(stmt->cond());
+	size_t next_jump = emit_jump(OpCode::OP_JUMP_IF_FALSE, stmt->pos());
+	visit_stmt(stmt->inner());
+	size_t end_jump = emit_jump(OpCode::OP_JUMP, stmt->pos());
+	patch_jump(next_jump, stmt->pos());
+	if (stmt->next_elif() != nullptr)
+	{
+		visit_elif_stmt(static_cast<ElifStatement*>(stmt->next_elif().get()));
+	}
+	patch_jump(end_jump, stmt->pos());
+}
+
+void BytecodeBackend::visit_if_stmt(IfStatement* stmt)
+{
+	visit_expr(stmt->cond());
+	size_t else_jump = emit_jump(OpCode::OP_JUMP_IF_FALSE, stmt->pos());
+	visit_stmt(stmt->if_branch());
+	size_t end_jump = emit_jump(OpCode::OP_JUMP, stmt->pos());
+	patch_jump(else_jump, stmt->pos());
+	if (stmt->top_elif() != nullptr)
+	{
+		visit_stmt(stmt->top_elif());
+	}
+	patch_jump(end_jump, stmt->pos());
+}
+
+void BytecodeBackend::visit_while_stmt(WhileStatement* stmt)
+{
+	size_t loop_start = chunk_->size();
+	visit_expr(stmt->cond());
+	size_t exit_jump = emit_jump(OpCode::OP_JUMP_IF_FALSE, stmt->pos());
+
+	loops_.push_back({ scope_depth_, {} });
+	visit_stmt(stmt->inner());
+	emit_loop(loop_start, stmt->pos());
+
+	patch_jump(exit_jump, stmt->pos());
+	for (size_t jump : loops_.back().breaks)
+	{
+		patch_jump(jump, stmt->pos());
+	}
+	loops_.pop_back();
+}
+
+void BytecodeBackend::visit_for_stmt(ForStatement* stmt)
+{
+	//The VM runs parallel loops one iteration after the other, but in a scope of
+	//their own since that is where the resolver put the loop variable, and with
+	//the checks that keep iterations independent when the interpreter runs them
+	if (stmt->parallel())
+	{
+		emit(OpCode::OP_BEGIN_PARALLEL, stmt->pos());
+		scope_depth_++;
+	}
+	visit_stmt(stmt->init());
+
+	size_t loop_start = chunk_->size();
+	visit_expr(stmt->cond());
+	size_t exit_jump = emit_jump(OpCode::OP_JUMP_IF_FALSE, stmt->pos());
+
+	loops_.push_back({ scope_depth_, {} });
+	visit_stmt(stmt->inner());
+	visit_expr(stmt->exec());
+	emit(OpCode::OP_POP, stmt->pos());
+	emit_loop(loop_start, stmt->pos());
+
+	patch_jump(exit_jump, stmt->pos());
+	for (size_t jump : loops_.back().breaks)
+	{
+		patch_jump(jump, stmt->pos());
+	}
+	loops_.pop_back();
+
+	if (stmt->parallel())
+	{
+		scope_depth_--;
+		emit(OpCode::OP_END_PARALLEL, stmt->pos());
+	}
+}
+
+void BytecodeBackend::visit_var_decl_stmt(VarDeclStatement* stmt)
+{
+	visit_expr(stmt->val());
+	emit_short(OpCode::OP_DEFINE_VAR, chunk_->add_decl(stmt), stmt->pos());
+}
+
+void BytecodeBackend::visit_arr_decl_stmt(ArrDeclStatement* stmt)
+{
+	for (const expr_ptr& val : stmt->vals())
+	{
+		visit_expr(val);
+	}
+	emit_short(OpCode::OP_DEFINE_ARR, chunk_->add_decl(stmt), stmt->pos());
+}
+
+void BytecodeBackend::visit_func_decl_stmt(FuncDeclStatement* stmt)
+{
+	emit_short(OpCode::OP_DEFINE_FUNC, chunk_->add_decl(stmt), stmt->pos());
+}
+
+void BytecodeBackend::visit_class_decl_stmt(ClassDeclStatement* stmt)
+{
+	for (const stmt_ptr& s : stmt->members())
+	{
+		visit_expr(static_cast<VarDeclStatement*>(s.get())->val());
+	}
+	emit_short(OpCode::OP_DEFINE_CLASS, chunk_->add_decl(stmt), stmt->pos());
+}
+
+void BytecodeBackend::visit_expr_stmt(ExprStatement* stmt)
+{
+	visit_expr(stmt->expr());
+	emit(OpCode::OP_POP, stmt->pos());
+}
+
+void BytecodeBackend::emit(OpCode op, Position pos)
+{
+	chunk_->write_op(op, pos);
+}
+
+void BytecodeBackend::emit_short(OpCode op, uint16_t operand, Position pos)
+{
+	chunk_->write_op(op, pos);
+	chunk_->write_short(operand);
+}
+
+void BytecodeBackend::emit_slot(ScopeSlot slot, Position pos)
+{
+	if (slot.depth >= UINT16_MAX || slot.slot >= UINT16_MAX)
+	{ throw CILError::error(pos, "Too many nested scopes or locals"); }
+	chunk_->write_short((uint16_t)slot.depth);
+	chunk_->write_short((uint16_t)slot.slot);
+}
+
+void BytecodeBackend::emit_store(PrimaryExpression* target, Position pos)
+{
+	if (target->slot().resolved())
+	{
+		emit_short(OpCode::OP_SET_LOCAL, chunk_->add_name(*target->val().identifier_val), pos);
+		emit_slot(target->slot(), pos);
+	}
+	else
+	{
+		emit_short(OpCode::OP_SET_VAR, chunk_->add_name(*target->val().identifier_val), pos);
+	}
+}
+
+size_t BytecodeBackend::emit_jump(OpCode op, Position pos)
+{
+	chunk_->write_op(op, pos);
+	chunk_->write_short(0);
+	return chunk_->size() - 2;
+}
+
+void BytecodeBackend::patch_jump(size_t operand_offset, Position pos)
+{
+	size_t distance = chunk_->size() - operand_offset - 2;
+	if (distance > UINT16_MAX)
+	{ throw CILError::error(pos, "Too much code to jump over"); }
+	chunk_->patch_short(operand_offset, (uint16_t)distance);
+}
+
+void BytecodeBackend::emit_loop(size_t loop_start, Position pos)
+{
+	chunk_->write_op(OpCode::OP_LOOP, pos);
+	size_t distance = chunk_->size() - loop_start + 2;
+	if (distance > UINT16_MAX)
+	{ throw CILError::error(pos, "Loop body too large"); }
+	chunk_->write_short((uint16_t)distance);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "../cil-system.h"
+#include "Backend.h"
+#include "Chunk.h"
+#include "../Parsing/Expression.h"
+#include "../Parsing/Statement.h"
+#include "../Parsing/ASTVisitor.h"
+#include "../Diagnostics/CILError.h"
+#include "../Diagnostics/Diagnostics.h"
+
+class BytecodeBackend : public Backend, public ASTVisitor<BytecodeBackend>
+{
+	friend ASTVisitor<BytecodeBackend>;
+public:
+	BytecodeBackend();
+	virtual void init() override;
+	virtual void gen_statement(stmt_ptr stmt) override;
+	virtual void dump() override;
+
+	chunk_ptr chunk() const
+	{ return chunk_; }
+
+	chunk_ptr compile_statement(stmt_ptr stmt);
+	chunk_ptr compile_expression(expr_ptr expr);
+	chunk_ptr compile_function(stmt_ptr body);
+private:
+	struct Loop
+	{
+		int scope_depth;
+		std::vector<size_t> breaks;
+	};
+
+	void visit_error_expr(ErrorExpression* expr);
+	void visit_grouping_expr(GroupingExpression* expr);
+	void visit_primary_expr(PrimaryExpression* expr);
+	void visit_call_expr(CallExpression* expr);
+	void visit_access_expr(AccessExpression* expr);
+	void visit_new_expr(NewExpression* expr);
+	void visit_array_access_expr(ArrayAccessExpression* expr);
+	void visit_unary_expr(UnaryExpression* expr);
+	void visit_binary_expr(BinaryExpression* expr);
+	void visit_ternary_expr(TernaryExpression* expr);
+	void visit_assignment_expr(AssignmentExpression* expr);
+
+	void visit_block_stmt(BlockStatement* stmt);
+	void visit_break_stmt(BreakStatement* stmt);
+	void visit_return_stmt(ReturnStatement* stmt);
+	void visit_print_stmt(PrintStatement* stmt);
+	void visit_elif_stmt(ElifStatement* stmt);
+	void visit_if_stmt(IfStatement* stmt);
+	void visit_while_stmt(WhileStatement* stmt);
+	void visit_for_stmt(ForStatement* stmt);
+	void visit_var_decl_stmt(VarDeclStatement* stmt);
+	void visit_arr_decl_stmt(ArrDeclStatement* stmt);
+	void visit_func_decl_stmt(FuncDeclStatement* stmt);
+	void visit_class_decl_stmt(ClassDeclStatement* stmt);
+	void visit_expr_stmt(ExprStatement* stmt);
+
+	void emit(OpCode op, Position pos);
+	void emit_short(OpCode op, uint16_t operand, Position pos);
+	void emit_slot(ScopeSlot slot, Position pos);
+	void emit_store(PrimaryExpression* target, Position pos);
+	void emit_intrinsic(CallExpression* expr);
+	size_t emit_jump(OpCode op, Position pos);
+	void patch_jump(size_t operand_offset, Position pos);
+	void emit_loop(size_t loop_start, Position pos);
+
+	chunk_ptr chunk_;
+
+	int scope_depth_;
+	std::vector<Loop> loops_;
+	//Every call compiled gets a site of its own, for the VM to cache its callee
+	size_t call_sites_;
+};
@@ -0,0 +1,175 @@
+#include "Chunk.h"
+#include "../Types/String.h"
+
+Chunk::Chunk()
+	: code_(), numbers_(), strings_(), names_(), decls_(), pos_offsets_(), positions_()
+{
+}
+
+void Chunk::write_op(OpCode op, Position pos)
+{
+	pos_offsets_.push_back(code_.size());
+	positions_.push_back(pos);
+	code_.push_back((uint8_t)op);
+}
+
+void Chunk::write_short(uint16_t value)
+{
+	code_.push_back((uint8_t)(value & 0xff));
+	code_.push_back((uint8_t)((value >> 8) & 0xff));
+}
+
+void Chunk::patch_short(size_t offset, uint16_t value)
+{
+	code_[offset] = (uint8_t)(value & 0xff);
+	code_[offset + 1] = (uint8_t)((value >> 8) & 0xff);
+}
+
+uint16_t Chunk::add_number(double value)
+{
+	for (size_t i = 0; i < numbers_.size(); i++)
+	{
+		if (numbers_[i] == value)
+		{ return (uint16_t)i; }
+	}
+	if (numbers_.size() > UINT16_MAX)
+	{ throw CILError::error("Too many constants in one chunk"); }
+	numbers_.push_back(value);
+	return (uint16_t)(numbers_.size() - 1);
+}
+
+uint16_t Chunk::add_string(const std::string& value)
+{
+	for (size_t i = 0; i < strings_.size(); i++)
+	{
+		if (strings_[i].as<CIL::String>()->value() == value)
+		{ return (uint16_t)i; }
+	}
+	if (strings_.size() > UINT16_MAX)
+	{ throw CILError::error("Too many constants in one chunk"); }
+	strings_.push_back(CIL::String::create(value));
+	return (uint16_t)(strings_.size() - 1);
+}
+
+uint16_t Chunk::add_name(const std::string& name)
+{
+	for (size_t i = 0; i < names_.size(); i++)
+	{
+		if (names_[i] == name)
+		{ return (uint16_t)i; }
+	}
+	if (names_.size() > UINT16_MAX)
+	{ throw CILError::error("Too many identifiers in one chunk"); }
+	names_.push_back(name);
+	return (uint16_t)(names_.size() - 1);
+}
+
+uint16_t Chunk::add_decl(Statement* decl)
+{
+	if (decls_.size() > UINT16_MAX)
+	{ throw CILError::error("Too many declarations in one chunk"); }
+	decls_.push_back(decl);
+	return (uint16_t)(decls_.size() - 1);
+}
+
+Position Chunk::pos_at(size_t offset) const
+{
+	auto it = std::upper_bound(pos_offsets_.begin(), pos_offsets_.end(), offset);
+	if (it == pos_offsets_.begin())
+	{ return Position(0, 0); }
+	return positions_[(it - pos_offsets_.begin()) - 1];
+}
+
+void Chunk::disassemble(std::ostream& os, const std::string& title) const
+{
+	os << "== " << title << " ==\n";
+	for (size_t offset = 0; offset < code_.size();)
+	{
+		offset = disassemble_instruction(os, offset);
+	}
+}
+
+size_t Chunk::disassemble_instruction(std::ostream& os, size_t offset) const
+{
+	static const char* op_names[] =
+	{
+		"NONE", "TRUE", "FALSE", "NUMBER", "STRING", "ERROR",
+		"GET_VAR", "SET_VAR", "GET_LOCAL", "SET_LOCAL", "GET_ELEMENT", "SET_ELEMENT", "NEW", "ENTER_OBJECT", "LEAVE_OBJECT",
+		"BEGIN_CALL", "CALL", "TAIL_CALL", "INTRINSIC", "RETURN", "RETURN_DEFAULT",
+		"INVERT", "INCREMENT", "DECREMENT", "BITWISE_NOT",
+		"ADD", "SUBTRACT", "MULTIPLY", "DIVIDE", "LEFT_BITSHIFT", "RIGHT_BITSHIFT",
+		"GREATER", "LESS", "GREATER_EQUAL", "LESS_EQUAL", "EQUAL", "NOT_EQUAL",
+		"AND", "OR", "BITWISE_AND", "BITWISE_OR", "BITWISE_XOR",
+		"JUMP", "JUMP_IF_FALSE", "JUMP_IF_ERROR", "LOOP",
+		"POP", "PRINT", "PUSH_SCOPE", "POP_SCOPE", "BEGIN_PARALLEL", "END_PARALLEL",
+		"DEFINE_VAR", "DEFINE_ARR", "DEFINE_FUNC", "DEFINE_CLASS",
+		"END"
+	};
+
+	OpCode op = (OpCode)code_[offset];
+	os << std::setw(5) << std::setfill('0') << offset << std::setfill(' ')
+	   << " " << std::setw(4) << (pos_at(offset).start_pos().line_off + 1)
+	   << " " << std::left << std::setw(16) << op_names[(size_t)op] << std::right;
+
+	switch (op)
+	{
+	case OpCode::OP_NUMBER:
+		os << " " << numbers_[read_short(offset + 1)] << "\n";
+		return offset + 3;
+	case OpCode::OP_STRING:
+		os << " \"" << strings_[read_short(offset + 1)].to_string() << "\"\n";
+		return offset + 3;
+	case OpCode::OP_GET_VAR:
+	case OpCode::OP_SET_VAR:
+	case OpCode::OP_GET_ELEMENT:
+	case OpCode::OP_SET_ELEMENT:
+	case OpCode::OP_NEW:
+	case OpCode::OP_ENTER_OBJECT:
+		os << " " << names_[read_short(offset + 1)] << "\n";
+		return offset + 3;
+	case OpCode::OP_GET_LOCAL:
+	case OpCode::OP_SET_LOCAL:
+		os << " " << names_[read_short(offset + 1)] << " @" << read_short(offset + 3)
+		   << ":" << read_short(offset + 5) << "\n";
+		return offset + 7;
+	case OpCode::OP_BEGIN_CALL:
+		os << " " << names_[read_short(offset + 1)] << " argc=" << read_short(offset + 3)
+		   << " -> " << (offset + 13 + read_short(offset + 11));
+		if (read_short(offset + 5) != UINT16_MAX)
+		{ os << " @" << read_short(offset + 5) << ":" << read_short(offset + 7); }
+		if (read_short(offset + 9) != UINT16_MAX)
+		{ os << " site=" << read_short(offset + 9); }
+		os << "\n";
+		return offset + 13;
+	case OpCode::OP_INTRINSIC:
+	{
+		uint16_t argc = read_short(offset + 5);
+		os << " " << names_[read_short(offset + 1)] << " argc=" << argc;
+		//Arguments that name an array or variable, the others come from the stack
+		for (uint16_t i = 0; i < argc; i++)
+		{
+			uint16_t name = read_short(offset + 7 + i * 2);
+			os << " " << (name == UINT16_MAX ? "<stack>" : names_[name]);
+		}
+		os << "\n";
+		return offset + 7 + argc * 2;
+	}
+	case OpCode::OP_JUMP:
+	case OpCode::OP_JUMP_IF_FALSE:
+	case OpCode::OP_JUMP_IF_ERROR:
+		os << " -> " << (offset + 3 + read_short(offset + 1)) << "\n";
+		return offset + 3;
+	case OpCode::OP_LOOP:
+		os << " -> " << (offset + 3 - read_short(offset + 1)) << "\n";
+		return offset + 3;
+	case OpCode::OP_DEFINE_VAR:
+	case OpCode::OP_DEFINE_ARR:
+	case OpCode::OP_DEFINE_FUNC:
+	case OpCode::OP_DEFINE_CLASS:
+		os << " #" << read_short(offset + 1) << "\n";
+		return offset + 3;
+	default:
+		os << "\n";
+		return offset + 1;
+	}
+}
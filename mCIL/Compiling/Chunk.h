@@ -0,0 +1,134 @@
+#pragma once
+#include "../cil-system.h"
+#include "../Diagnostics/Position.h"
+#include "../Diagnostics/CILError.h"
+#include "../Parsing/Expression.h"
+#include "../Parsing/Statement.h"
+#include "../Types/Value.h"
+
+enum class OpCode : uint8_t
+{
+	OP_NONE,
+	OP_TRUE,
+	OP_FALSE,
+	OP_NUMBER,
+	OP_STRING,
+	OP_ERROR,
+
+	OP_GET_VAR,
+	OP_SET_VAR,
+	OP_GET_LOCAL,
+	OP_SET_LOCAL,
+	OP_GET_ELEMENT,
+	OP_SET_ELEMENT,
+	OP_NEW,
+	OP_ENTER_OBJECT,
+	OP_LEAVE_OBJECT,
+
+	OP_BEGIN_CALL,
+	OP_CALL,
+	//A call the Resolver marked as tail call, always followed by OP_RETURN
+	OP_TAIL_CALL,
+	OP_INTRINSIC,
+	OP_RETURN,
+	OP_RETURN_DEFAULT,
+
+	OP_INVERT,
+	OP_INCREMENT,
+	OP_DECREMENT,
+	OP_BITWISE_NOT,
+
+	OP_ADD,
+	OP_SUBTRACT,
+	OP_MULTIPLY,
+	OP_DIVIDE,
+	OP_LEFT_BITSHIFT,
+	OP_RIGHT_BITSHIFT,
+	OP_GREATER,
+	OP_LESS,
+	OP_GREATER_EQUAL,
+	OP_LESS_EQUAL,
+	OP_EQUAL,
+	OP_NOT_EQUAL,
+	OP_AND,
+	OP_OR,
+	OP_BITWISE_AND,
+	OP_BITWISE_OR,
+	OP_BITWISE_XOR,
+
+	OP_JUMP,
+	OP_JUMP_IF_FALSE,
+	OP_JUMP_IF_ERROR,
+	OP_LOOP,
+
+	OP_POP,
+	OP_PRINT,
+	OP_PUSH_SCOPE,
+	OP_POP_SCOPE,
+	OP_BEGIN_PARALLEL,
+	OP_END_PARALLEL,
+
+	OP_DEFINE_VAR,
+	OP_DEFINE_ARR,
+	OP_DEFINE_FUNC,
+	OP_DEFINE_CLASS,
+
+	OP_END
+};
+
+class Chunk;
+typedef std::shared_ptr<Chunk> chunk_ptr;
+
+class Chunk
+{
+public:
+	Chunk();
+
+	void write_op(OpCode op, Position pos);
+	void write_short(uint16_t value);
+	void patch_short(size_t offset, uint16_t value);
+
+	uint16_t add_number(double value);
+	uint16_t add_string(const std::string& value);
+	uint16_t add_name(const std::string& name);
+	uint16_t add_decl(Statement* decl);
+
+	const uint8_t* code() const
+	{ return code_.data(); }
+
+	size_t size() const
+	{ return code_.size(); }
+
+	double number(uint16_t index) const
+	{ return numbers_[index]; }
+
+	//String literals are materialized once when they are added
+	const value_t& string(uint16_t index) const
+	{ return strings_[index]; }
+
+	const std::string& name(uint16_t index) const
+	{ return names_[index]; }
+
+	Statement* decl(uint16_t index) const
+	{ return decls_[index]; }
+
+	Position pos_at(size_t offset) const;
+
+	void disassemble(std::ostream& os, const std::string& title) const;
+private:
+	size_t disassemble_instruction(std::ostream& os, size_t offset) const;
+
+	uint16_t read_short(size_t offset) const
+	{ return (uint16_t)(code_[offset] | (code_[offset + 1] << 8)); }
+
+	std::vector<uint8_t> code_;
+
+	std::vector<double> numbers_;
+	std::vector<value_t> strings_;
+	std::vector<std::string> names_;
+	//Declarations are owned by the program the chunk was compiled from
+	std::vector<Statement*> decls_;
+
+	std::vector<size_t> pos_offsets_;
+	std::vector<Position> positions_;
+};
@@ -21,7 +21,7 @@ void LLVMBackend::init()
 void LLVMBackend::gen_statement(stmt_ptr stmt)
 {
 	builder_->SetInsertPoint(entry_);
-	val IR = gen_stmt(stmt);
+	val IR = visit_stmt(stmt);
 	//IR->print(llvm::errs());
 	//llvm::errs() << "\n";
 }
@@ -31,43 +31,17 @@ void LLVMBackend::dump()
 	module_->dump();
 }
 
-val LLVMBackend::gen_expr(expr_ptr expr)
+val LLVMBackend::visit_error_expr(ErrorExpression* expr)
 {
-	switch (expr->type())
-	{
-	case ExprType::EXPRESSION_ERROR:
-		throw unsupported(expr->pos(), PrimaryType::PRIMARY_NONE);
-	case ExprType::EXPRESSION_GROUPING:
-		return gen_grouping_expr(std::dynamic_pointer_cast<GroupingExpression, Expression>(expr));
-	case ExprType::EXPRESSION_CALL:
-		return gen_call_expr(std::dynamic_pointer_cast<CallExpression, Expression>(expr));
-	case ExprType::EXPRESSION_ACCESS:
-		return gen_access_expr(std::dynamic_pointer_cast<AccessExpression, Expression>(expr));
-	case ExprType::EXPRESSION_NEW:
-		return gen_new_expr(std::dynamic_pointer_cast<NewExpression, Expression>(expr));
-	case ExprType::EXPRESSION_ARRAY_ACCESS:
-		return gen_array_access_expr(std::dynamic_pointer_cast<ArrayAccessExpression, Expression>(expr));
-	case ExprType::EXPRESSION_PRIMARY:
-		return gen_primary_expr(std::dynamic_pointer_cast<PrimaryExpression, Expression>(expr));
-	case ExprType::EXPRESSION_UNARY:
-		return gen_unary_expr(std::dynamic_pointer_cast<UnaryExpression, Expression>(expr));
-	case ExprType::EXPRESSION_BINARY:
-		return gen_binary_expr(std::dynamic_pointer_cast<BinaryExpression, Expression>(expr));
-	case ExprType::EXPRESSION_TERNARY:
-		return gen_ternary_expr(std::dynamic_pointer_cast<TernaryExpression, Expression>(expr));
-	case ExprType::EXPRESSION_ASSIGNMENT:
-		return gen_assignment_expr(std::dynamic_pointer_cast<AssignmentExpression, Expression>(expr));
-	default:
-		throw CILError::error(expr->pos(), "Incomplete handling of expressions");
-	}
+	throw unsupported(expr->pos(), PrimaryType::PRIMARY_NONE);
 }
 
-val LLVMBackend::gen_grouping_expr(std::shared_ptr<GroupingExpression> expr)
+val LLVMBackend::visit_grouping_expr(GroupingExpression* expr)
 {
-	return gen_expr(expr->expr());
+	return visit_expr(expr->expr());
 }
 
-val LLVMBackend::gen_primary_expr(std::shared_ptr<PrimaryExpression> expr)
+val LLVMBackend::visit_primary_expr(PrimaryExpression* expr)
 {
 	switch (expr->primary_type())
 	{
@@ -93,7 +67,7 @@ val LLVMBackend::gen_primary_expr(std::shared_ptr<PrimaryExpression> expr)
 	}
 }
 
-val LLVMBackend::gen_call_expr(std::shared_ptr<CallExpression> expr)
+val LLVMBackend::visit_call_expr(CallExpression* expr)
 {
 	llvm::Function* func = module_->getFunction(expr->identifier());
 	if (!func)
@@ -109,30 +83,30 @@ val LLVMBackend::gen_call_expr(std::shared_ptr<CallExpression> expr)
 	std::vector<val> args;
 	for (int i = 0; i < func->arg_size(); i++)
 	{
-		args.push_back(gen_expr(expr->args()[i]));
+		args.push_back(visit_expr(expr->args()[i]));
 	}
 
 	return builder_->CreateCall(func, args);
 }
 
-val LLVMBackend::gen_access_expr(std::shared_ptr<AccessExpression> expr)
+val LLVMBackend::visit_access_expr(AccessExpression* expr)
 {
 	throw unsupported(expr->pos(), ExprType::EXPRESSION_ACCESS);
 }
 
-val LLVMBackend::gen_new_expr(std::shared_ptr<NewExpression> expr)
+val LLVMBackend::visit_new_expr(NewExpression* expr)
 {
 	throw unsupported(expr->pos(), ExprType::EXPRESSION_NEW);
 }
 
-val LLVMBackend::gen_array_access_expr(std::shared_ptr<ArrayAccessExpression> expr)
+val LLVMBackend::visit_array_access_expr(ArrayAccessExpression* expr)
 {
 	throw unsupported(expr->pos(), ExprType::EXPRESSION_ARRAY_ACCESS);
 }
 
-val LLVMBackend::gen_unary_expr(std::shared_ptr<UnaryExpression> expr)
+val LLVMBackend::visit_unary_expr(UnaryExpression* expr)
 {
-	val inner = gen_expr(expr->expr());
+	val inner = visit_expr(expr->expr());
 
 	switch (expr->op())
 	{
@@ -183,10 +157,10 @@ val LLVMBackend::gen_unary_expr(std::shared_ptr<UnaryExpression> expr)
 	}
 }
 
-val LLVMBackend::gen_binary_expr(std::shared_ptr<BinaryExpression> expr)
+val LLVMBackend::visit_binary_expr(BinaryExpression* expr)
 {
-	val left = gen_expr(expr->left());
-	val right = gen_expr(expr->right());
+	val left = visit_expr(expr->left());
+	val right = visit_expr(expr->right());
 
 	switch (expr->op())
 	{
@@ -330,109 +304,74 @@ val LLVMBackend::gen_binary_expr(std::shared_ptr<BinaryExpression> expr)
 	}
 }
 
-val LLVMBackend::gen_ternary_expr(std::shared_ptr<TernaryExpression> expr)
+val LLVMBackend::visit_ternary_expr(TernaryExpression* expr)
 {
 	throw unsupported(expr->pos(), ExprType::EXPRESSION_TERNARY);
 }
 
-val LLVMBackend::gen_assignment_expr(std::shared_ptr<AssignmentExpression> expr)
+val LLVMBackend::visit_assignment_expr(AssignmentExpression* expr)
 {
 	throw unsupported(expr->pos(), ExprType::EXPRESSION_ASSIGNMENT);
 }
 
-val LLVMBackend::gen_stmt(stmt_ptr stmt)
-{
-	switch (stmt->type())
-	{
-	case StmtType::STATEMENT_BLOCK:
-		return gen_block_stmt(std::dynamic_pointer_cast<BlockStatement, Statement>(stmt));
-	case StmtType::STATEMENT_BREAK:
-		return gen_break_stmt(std::dynamic_pointer_cast<BreakStatement, Statement>(stmt));
-	case StmtType::STATEMENT_RETURN:
-		return gen_return_stmt(std::dynamic_pointer_cast<ReturnStatement, Statement>(stmt));
-	case StmtType::STATEMENT_PRINT:
-		return gen_print_stmt(std::dynamic_pointer_cast<PrintStatement, Statement>(stmt));
-	case StmtType::STATEMENT_ELIF:
-		return gen_elif_stmt(std::dynamic_pointer_cast<ElifStatement, Statement>(stmt));
-	case StmtType::STATEMENT_IF:
-		return gen_if_stmt(std::dynamic_pointer_cast<IfStatement, Statement>(stmt));
-	case StmtType::STATEMENT_WHILE:
-		return gen_while_stmt(std::dynamic_pointer_cast<WhileStatement, Statement>(stmt));
-	case StmtType::STATEMENT_FOR:
-		return gen_for_stmt(std::dynamic_pointer_cast<ForStatement, Statement>(stmt));
-	case StmtType::STATEMENT_VAR_DECL:
-		return gen_var_decl_stmt(std::dynamic_pointer_cast<VarDeclStatement, Statement>(stmt));
-	case StmtType::STATEMENT_ARR_DECL:
-		return gen_arr_decl_stmt(std::dynamic_pointer_cast<ArrDeclStatement, Statement>(stmt));
-	case StmtType::STATEMENT_FUNC_DECL:
-		return gen_func_decl_stmt(std::dynamic_pointer_cast<FuncDeclStatement, Statement>(stmt));
-	case StmtType::STATEMENT_CLASS_DECL:
-		return gen_class_decl_stmt(std::dynamic_pointer_cast<ClassDeclStatement, Statement>(stmt));
-	case StmtType::STATEMENT_EXPR:
-		return gen_expr_stmt(std::dynamic_pointer_cast<ExprStatement, Statement>(stmt));
-	default:
-		throw CILError::error(stmt->pos(), "Incomplete handling of statements");
-	}
-}
-
-val LLVMBackend::gen_block_stmt(std::shared_ptr<BlockStatement> stmt)
+val LLVMBackend::visit_block_stmt(BlockStatement* stmt)
 {
 	//TODO: Change this maybe?
 	val last_stmt = nullptr;
-	for (stmt_ptr inner : stmt->inner())
+	for (const stmt_ptr& inner : stmt->inner())
 	{
-		last_stmt = gen_stmt(inner);
+		last_stmt = visit_stmt(inner);
 	}
 	return last_stmt;
 }
 
-val LLVMBackend::gen_break_stmt(std::shared_ptr<BreakStatement> stmt)
+val LLVMBackend::visit_break_stmt(BreakStatement* stmt)
 {
 	throw unsupported(stmt->pos(), StmtType::STATEMENT_BREAK);
 }
 
-val LLVMBackend::gen_return_stmt(std::shared_ptr<ReturnStatement> stmt)
+val LLVMBackend::visit_return_stmt(ReturnStatement* stmt)
 {
-	val ret_val = gen_expr(stmt->expr());
+	val ret_val = visit_expr(stmt->expr());
 	return builder_->CreateRet(ret_val);
 }
 
-val LLVMBackend::gen_print_stmt(std::shared_ptr<PrintStatement> stmt)
+val LLVMBackend::visit_print_stmt(PrintStatement* stmt)
 {
 	throw unsupported(stmt->pos(), StmtType::STATEMENT_PRINT);
 }
 
-val LLVMBackend::gen_elif_stmt(std::shared_ptr<ElifStatement> stmt)
+val LLVMBackend::visit_elif_stmt(ElifStatement* stmt)
 {
 	throw unsupported(stmt->pos(), StmtType::STATEMENT_ELIF);
 }
 
-val LLVMBackend::gen_if_stmt(std::shared_ptr<IfStatement> stmt)
+val LLVMBackend::visit_if_stmt(IfStatement* stmt)
 {
 	throw unsupported(stmt->pos(), StmtType::STATEMENT_IF);
 }
 
-val LLVMBackend::gen_while_stmt(std::shared_ptr<WhileStatement> stmt)
+val LLVMBackend::visit_while_stmt(WhileStatement* stmt)
 {
 	throw unsupported(stmt->pos(), StmtType::STATEMENT_WHILE);
 }
 
-val LLVMBackend::gen_for_stmt(std::shared_ptr<ForStatement> stmt)
+val LLVMBackend::visit_for_stmt(ForStatement* stmt)
 {
 	throw unsupported(stmt->pos(), StmtType::STATEMENT_FOR);
 }
 
-val LLVMBackend::gen_var_decl_stmt(std::shared_ptr<VarDeclStatement> stmt)
+val LLVMBackend::visit_var_decl_stmt(VarDeclStatement* stmt)
 {
 	throw unsupported(stmt->pos(), StmtType::STATEMENT_VAR_DECL);
 }
 
-val LLVMBackend::gen_arr_decl_stmt(std::shared_ptr<ArrDeclStatement> stmt)
+val LLVMBackend::visit_arr_decl_stmt(ArrDeclStatement* stmt)
 {
 	throw unsupported(stmt->pos(), StmtType::STATEMENT_ARR_DECL);
 }
 
-llvm::Function* LLVMBackend::gen_func_decl_stmt(std::shared_ptr<FuncDeclStatement> stmt)
+llvm::Function* LLVMBackend::visit_func_decl_stmt(FuncDeclStatement* stmt)
 {
 	llvm::Function* function = module_->getFunction(stmt->info().name);
 
@@ -475,7 +414,7 @@ llvm::Function* LLVMBackend::gen_func_decl_stmt(std::shared_ptr<FuncDeclStatemen
 				named_values_[std::string(arg.getName())] = &arg;
 			}
 
-			val body = gen_stmt(stmt->body());
+			val body = visit_stmt(stmt->body());
 
 			if (!stmt->info().has_return)
 			{
@@ -489,14 +428,14 @@ llvm::Function* LLVMBackend::gen_func_decl_stmt(std::shared_ptr<FuncDeclStatemen
 	}
 }
 
-val LLVMBackend::gen_class_decl_stmt(std::shared_ptr<ClassDeclStatement> stmt)
+val LLVMBackend::visit_class_decl_stmt(ClassDeclStatement* stmt)
 {
 	throw unsupported(stmt->pos(), StmtType::STATEMENT_CLASS_DECL);
 }
 
-val LLVMBackend::gen_expr_stmt(std::shared_ptr<ExprStatement> stmt)
+val LLVMBackend::visit_expr_stmt(ExprStatement* stmt)
 {
-	return gen_expr(stmt->expr());
+	return visit_expr(stmt->expr());
 }
 
 bool LLVMBackend::is_num(val value)
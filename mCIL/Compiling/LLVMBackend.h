@@ -3,47 +3,46 @@
 #include "Backend.h"
 #include "../Parsing/Expression.h"
 #include "../Parsing/Statement.h"
+#include "../Parsing/ASTVisitor.h"
 #include "../Diagnostics/CILError.h"
 #include "../Diagnostics/Diagnostics.h"
 
 typedef llvm::Value* val;
 
-class LLVMBackend : public Backend
+class LLVMBackend : public Backend, public ASTVisitor<LLVMBackend, val, val>
 {
+	friend ASTVisitor<LLVMBackend, val, val>;
 public:
 	LLVMBackend();
 	virtual void init() override;
 	virtual void gen_statement(stmt_ptr stmt) override;
 	virtual void dump() override;
 private:
-	val gen_expr(expr_ptr expr);
+	val visit_error_expr(ErrorExpression* expr);
+	val visit_grouping_expr(GroupingExpression* expr);
+	val visit_primary_expr(PrimaryExpression* expr);
+	val visit_call_expr(CallExpression* expr);
+	val visit_access_expr(AccessExpression* expr);
+	val visit_new_expr(NewExpression* expr);
+	val visit_array_access_expr(ArrayAccessExpression* expr);
+	val visit_unary_expr(UnaryExpression* expr);
+	val visit_binary_expr(BinaryExpression* expr);
+	val visit_ternary_expr(TernaryExpression* expr);
+	val visit_assignment_expr(AssignmentExpression* expr);
 
-	val gen_grouping_expr(std::shared_ptr<GroupingExpression> expr);
-	val gen_primary_expr(std::shared_ptr<PrimaryExpression> expr);
-	val gen_call_expr(std::shared_ptr<CallExpression> expr);
-	val gen_access_expr(std::shared_ptr<AccessExpression> expr);
-	val gen_new_expr(std::shared_ptr<NewExpression> expr);
-	val gen_array_access_expr(std::shared_ptr<ArrayAccessExpression> expr);
-	val gen_unary_expr(std::shared_ptr<UnaryExpression> expr);
-	val gen_binary_expr(std::shared_ptr<BinaryExpression> expr);
-	val gen_ternary_expr(std::shared_ptr<TernaryExpression> expr);
-	val gen_assignment_expr(std::shared_ptr<AssignmentExpression> expr);
-
-	val gen_stmt(stmt_ptr stmt);
-
-	val gen_block_stmt(std::shared_ptr<BlockStatement> stmt);
-	val gen_break_stmt(std::shared_ptr<BreakStatement> stmt);
-	val gen_return_stmt(std::shared_ptr<ReturnStatement> stmt);
-	val gen_print_stmt(std::shared_ptr<PrintStatement> stmt);
-	val gen_elif_stmt(std::shared_ptr<ElifStatement> stmt);
-	val gen_if_stmt(std::shared_ptr<IfStatement> stmt);
-	val gen_while_stmt(std::shared_ptr<WhileStatement> stmt);
-	val gen_for_stmt(std::shared_ptr<ForStatement> stmt);
-	val gen_var_decl_stmt(std::shared_ptr<VarDeclStatement> stmt);
-	val gen_arr_decl_stmt(std::shared_ptr<ArrDeclStatement> stmt);
-	llvm::Function* gen_func_decl_stmt(std::shared_ptr<FuncDeclStatement> stmt);
-	val gen_class_decl_stmt(std::shared_ptr<ClassDeclStatement> stmt);
-	val gen_expr_stmt(std::shared_ptr<ExprStatement> stmt);
+	val visit_block_stmt(BlockStatement* stmt);
+	val visit_break_stmt(BreakStatement* stmt);
+	val visit_return_stmt(ReturnStatement* stmt);
+	val visit_print_stmt(PrintStatement* stmt);
+	val visit_elif_stmt(ElifStatement* stmt);
+	val visit_if_stmt(IfStatement* stmt);
+	val visit_while_stmt(WhileStatement* stmt);
+	val visit_for_stmt(ForStatement* stmt);
+	val visit_var_decl_stmt(VarDeclStatement* stmt);
+	val visit_arr_decl_stmt(ArrDeclStatement* stmt);
+	llvm::Function* visit_func_decl_stmt(FuncDeclStatement* stmt);
+	val visit_class_decl_stmt(ClassDeclStatement* stmt);
+	val visit_expr_stmt(ExprStatement* stmt);
 
 	std::unique_ptr<llvm::LLVMContext> context_;
 	std::unique_ptr<llvm::IRBuilder<>> builder_;
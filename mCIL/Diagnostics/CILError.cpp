@@ -1,6 +1,6 @@
 #include "CILError.h"
 
-const char* CILError::what() const
+const char* CILError::what() const noexcept
 {
 	return this->msg_.c_str();
 }
@@ -36,7 +36,7 @@ public:
 		return CILError(msg, range, focus);
 	}
 
-	const char* what() const override;
+	const char* what() const noexcept override;
 	const Position range() const;
 	const Position focus() const;
 	bool has_pos() const;
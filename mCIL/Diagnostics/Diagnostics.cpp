@@ -1,12 +1,11 @@
 #include "Diagnostics.h"
-
-bool ErrorManager::error_ocurred = false;
-std::vector<CILError> ErrorManager::errors{};
+#include "../Interpreting/Isolate.h"
 
 void ErrorManager::cil_error(const CILError& err)
 {
-	ErrorManager::errors.push_back(err);
-	ErrorManager::error_ocurred = true;
+	ErrorLog& log = Isolate::current().diagnostics();
+	log.errors.push_back(err);
+	log.error_ocurred = true;
 }
 
 void ErrorManager::cil_warning(const Position& pos, const std::string& msg)
@@ -16,7 +15,7 @@ void ErrorManager::cil_warning(const Position& pos, const std::string& msg)
 
 void ErrorManager::report_errors(SourceManager& source)
 {
-	for (const CILError& error : ErrorManager::errors)
+	for (const CILError& error : ErrorManager::errors())
 	{
 
 		if (error.range().range().multi_line)
@@ -33,25 +32,11 @@ void ErrorManager::report_errors(SourceManager& source)
 		}
 		else
 		{
-			std::string line_prefix = std::to_string(error.range().start_pos().line_off + 1) + " | ";
-			size_t prefix_len = line_prefix.size();
-			std::string source_line_raw = source.get_line_at_off(error.range().start_pos().line_off);
-			std::string source_line_edited = "";
+			std::string line_prefix = ErrorManager::line_prefix(error.range().start_pos().line_off);
+			size_t tabs = 0;
+			std::string source_line_edited = ErrorManager::render_line(source, error.range().start_pos().line_off, tabs);
 
-			size_t num_space_prefix = prefix_len + error.focus().start_pos().char_off;
-
-			for (char c : source_line_raw)
-			{
-				switch (c)
-				{
-				case '\t':
-					source_line_edited += "    ";
-					num_space_prefix += 3;
-					break;
-				default:
-					source_line_edited += c;
-				}
-			}
+			size_t num_space_prefix = line_prefix.size() + error.focus().start_pos().char_off + 3 * tabs;
 
 			std::string carot_prefix = std::string(num_space_prefix, ' ');
 			std::string underline = std::string(error.focus().end_pos().char_off - error.focus().start_pos().char_off + 1, '^');
@@ -63,8 +48,43 @@ void ErrorManager::report_errors(SourceManager& source)
 	}
 }
 
+std::string ErrorManager::line_prefix(size_t line_off, size_t width)
+{
+	std::string number = std::to_string(line_off + 1);
+	if (number.size() < width)
+	{ number.insert(0, width - number.size(), ' '); }
+	return number + " | ";
+}
+
+std::string ErrorManager::render_line(SourceManager& source, size_t line_off, size_t& tabs)
+{
+	std::string source_line_raw = source.get_line_at_off(line_off);
+	std::string source_line_edited = "";
+	tabs = 0;
+	for (char c : source_line_raw)
+	{
+		switch (c)
+		{
+		case '\t':
+			source_line_edited += "    ";
+			tabs++;
+			break;
+		default:
+			source_line_edited += c;
+		}
+	}
+	return source_line_edited;
+}
+
 void ErrorManager::clear_errors()
 {
-	ErrorManager::errors.clear();
-	ErrorManager::error_ocurred = false;
-}
\ No newline at end of file
+	ErrorLog& log = Isolate::current().diagnostics();
+	log.errors.clear();
+	log.error_ocurred = false;
+}
+
+bool ErrorManager::error_ocurred()
+{ return Isolate::current().diagnostics().error_ocurred; }
+
+std::vector<CILError>& ErrorManager::errors()
+{ return Isolate::current().diagnostics().errors; }
\ No newline at end of file
@@ -4,6 +4,14 @@
 #include "Position.h"
 #include "CILError.h"
 
+//What went wrong in one isolate
+struct ErrorLog
+{
+	bool error_ocurred = false;
+	std::vector<CILError> errors;
+};
+
+//Reports to the ErrorLog of the isolate the calling thread is in
 struct ErrorManager
 {
 	static void cil_error(const CILError& err);
@@ -12,8 +20,14 @@ struct ErrorManager
 
 	static void report_errors(SourceManager& source);
 
+	//"<line> | ", with the line number right-aligned to 'width' digits
+	static std::string line_prefix(size_t line_off, size_t width = 0);
+	//The source line at 'line_off' as reports print it, tabs are widened to four
+	//spaces and 'tabs' receives how many there were
+	static std::string render_line(SourceManager& source, size_t line_off, size_t& tabs);
+
 	static void clear_errors();
 
-	static bool error_ocurred;
-	static std::vector<CILError> errors;
+	static bool error_ocurred();
+	static std::vector<CILError>& errors();
 };
\ No newline at end of file
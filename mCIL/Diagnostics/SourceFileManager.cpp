@@ -68,7 +68,7 @@ bool SourceFileManager::get_next_line(char* line_buffer, size_t max_size, size_t
 	if (this->line_buffer_.size() >= max_size)
 	{ return false; }
 
-	strcpy_s(line_buffer, max_size, this->line_buffer_.c_str());
+	std::snprintf(line_buffer, max_size, "%s", this->line_buffer_.c_str());
 	new_size = this->line_buffer_.size();
 
 	this->line_buffer_.clear();
@@ -0,0 +1,42 @@
+#include "SourceStringManager.h"
+
+SourceStringManager::SourceStringManager(const std::string& source)
+	: lines_(), curr_line_(0)
+{
+	size_t start = 0;
+	while (start < source.size())
+	{
+		size_t end = source.find('\n', start);
+		end = end == std::string::npos ? source.size() : end + 1;
+		lines_.push_back(source.substr(start, end - start));
+		start = end;
+	}
+}
+
+SourceStringManager::~SourceStringManager()
+{
+}
+
+bool SourceStringManager::get_next_line(char* line_buffer, size_t max_size, size_t& new_size)
+{
+	const std::string& line = lines_[curr_line_];
+	if (line.size() >= max_size)
+	{ return false; }
+
+	std::snprintf(line_buffer, max_size, "%s", line.c_str());
+	new_size = line.size();
+	curr_line_++;
+	return true;
+}
+
+std::string SourceStringManager::get_line_at_off(size_t line_off)
+{
+	if (line_off < lines_.size())
+	{ return lines_[line_off]; }
+	return "";
+}
+
+bool SourceStringManager::is_at_end()
+{
+	return curr_line_ == lines_.size();
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "../cil-system.h"
+#include "SourceManager.h"
+
+//Serves a program that is already in memory, line by line like SourceFileManager
+class SourceStringManager : public SourceManager
+{
+public:
+	SourceStringManager(const std::string& source);
+	~SourceStringManager();
+
+	virtual bool get_next_line(char* line_buffer, size_t max_size, size_t& new_size) override;
+	virtual std::string get_line_at_off(size_t line_off) override;
+	virtual bool is_at_end() override;
+
+private:
+	//Every line keeps its '\n', except for a last one without
+	std::vector<std::string> lines_;
+	size_t curr_line_;
+};
@@ -120,6 +120,8 @@ namespace TokenPrinter
 			return "this";
 		case Keyword::KEYWORD_EXTENDS:
 			return "extends";
+		case Keyword::KEYWORD_PARALLEL:
+			return "parallel";
 		default:
 			return "INVALID_KEYWORD";
 		}
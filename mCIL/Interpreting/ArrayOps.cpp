@@ -0,0 +1,129 @@
+#include "ArrayOps.h"
+#include "../Utils/Simd/ArrayKernels.h"
+
+//Arguments each intrinsic takes, errors count them from 1 like the parameters of a function
+static size_t arity(Intrinsic intrinsic)
+{
+	switch (intrinsic)
+	{
+	case Intrinsic::INTRINSIC_SUM:
+	case Intrinsic::INTRINSIC_MIN:
+	case Intrinsic::INTRINSIC_MAX:
+		return 1;
+	case Intrinsic::INTRINSIC_DOT:
+		return 2;
+	default:
+		return 3;
+	}
+}
+
+static const Environment::Array& num_array(const std::string& name, const std::vector<ArrayOps::Operand>& operands, size_t index)
+{
+	const Environment::Array* array = operands[index].array;
+	if (!array || array->storage != Environment::Array::Storage::NUM)
+	{ throw CILError::error("Argument $ of '$' must be an array of 'num'", index + 1, name); }
+	return *array;
+}
+
+//An array of the size of the result or a 'num' for every element
+static ArrayKernels::Operand element_operand(const std::string& name, const std::vector<ArrayOps::Operand>& operands,
+	size_t index, size_t size)
+{
+	const ArrayOps::Operand& operand = operands[index];
+	if (!operand.array)
+	{
+		if (!operand.value.is_num())
+		{ throw CILError::error("Argument $ of '$' must be a 'num' or an array of 'num', got '$'", index + 1, name, operand.value.type()); }
+		return { nullptr, operand.value.as_num() };
+	}
+	const Environment::Array& array = num_array(name, operands, index);
+	if (array.size != size)
+	{ throw CILError::error("Argument $ of '$' has $ elements, the result $", index + 1, name, array.size, size); }
+	return { array.nums.data(), 0 };
+}
+
+value_t ArrayOps::call(Intrinsic intrinsic, const std::string& name, const std::vector<Operand>& operands)
+{
+	if (operands.size() != arity(intrinsic))
+	{ throw CILError::error("Function '$' expects $ arguments, got $", name, arity(intrinsic), operands.size()); }
+	//An argument that failed to evaluate was reported already
+	for (const Operand& operand : operands)
+	{
+		if (!operand.array && operand.value.is_error())
+		{ return value_t::error(); }
+	}
+
+	switch (intrinsic)
+	{
+	case Intrinsic::INTRINSIC_SUM:
+	{
+		const Environment::Array& array = num_array(name, operands, 0);
+		return value_t::number(ArrayKernels::sum(array.nums.data(), array.size));
+	}
+	case Intrinsic::INTRINSIC_MIN:
+	case Intrinsic::INTRINSIC_MAX:
+	{
+		const Environment::Array& array = num_array(name, operands, 0);
+		if (array.size == 0)
+		{ throw CILError::error("Cannot take the '$' of an empty array", name); }
+		bool min = intrinsic == Intrinsic::INTRINSIC_MIN;
+		return value_t::number(min ? ArrayKernels::min(array.nums.data(), array.size) : ArrayKernels::max(array.nums.data(), array.size));
+	}
+	case Intrinsic::INTRINSIC_DOT:
+	{
+		const Environment::Array& left = num_array(name, operands, 0);
+		const Environment::Array& right = num_array(name, operands, 1);
+		if (left.size != right.size)
+		{ throw CILError::error("Arrays of '$' must have the same size, got $ and $", name, left.size, right.size); }
+		return value_t::number(ArrayKernels::dot(left.nums.data(), right.nums.data(), left.size));
+	}
+	default:
+		break;
+	}
+
+	//Element-wise, the result goes into the first argument
+	Environment::Array* dst = operands[0].array;
+	bool arith = intrinsic <= Intrinsic::INTRINSIC_DIVIDE;
+	Environment::Array::Storage storage = arith ? Environment::Array::Storage::NUM : Environment::Array::Storage::BOOL;
+	if (!dst || dst->storage != storage)
+	{ throw CILError::error("Argument 1 of '$' must be an array of '$' to hold the result", name, arith ? "num" : "bool"); }
+	ArrayKernels::Operand left = element_operand(name, operands, 1, dst->size);
+	ArrayKernels::Operand right = element_operand(name, operands, 2, dst->size);
+
+	switch (intrinsic)
+	{
+	case Intrinsic::INTRINSIC_ADD:
+		ArrayKernels::arith(ArrayKernels::Arith::ARITH_ADD, dst->nums.data(), left, right, dst->size);
+		break;
+	case Intrinsic::INTRINSIC_SUBTRACT:
+		ArrayKernels::arith(ArrayKernels::Arith::ARITH_SUBTRACT, dst->nums.data(), left, right, dst->size);
+		break;
+	case Intrinsic::INTRINSIC_MULTIPLY:
+		ArrayKernels::arith(ArrayKernels::Arith::ARITH_MULTIPLY, dst->nums.data(), left, right, dst->size);
+		break;
+	case Intrinsic::INTRINSIC_DIVIDE:
+		ArrayKernels::arith(ArrayKernels::Arith::ARITH_DIVIDE, dst->nums.data(), left, right, dst->size);
+		break;
+	case Intrinsic::INTRINSIC_LESS:
+		ArrayKernels::compare(ArrayKernels::Compare::COMPARE_LESS, dst->bools.data(), left, right, dst->size);
+		break;
+	case Intrinsic::INTRINSIC_GREATER:
+		ArrayKernels::compare(ArrayKernels::Compare::COMPARE_GREATER, dst->bools.data(), left, right, dst->size);
+		break;
+	case Intrinsic::INTRINSIC_LESS_EQUAL:
+		ArrayKernels::compare(ArrayKernels::Compare::COMPARE_LESS_EQUAL, dst->bools.data(), left, right, dst->size);
+		break;
+	case Intrinsic::INTRINSIC_GREATER_EQUAL:
+		ArrayKernels::compare(ArrayKernels::Compare::COMPARE_GREATER_EQUAL, dst->bools.data(), left, right, dst->size);
+		break;
+	case Intrinsic::INTRINSIC_EQUAL:
+		ArrayKernels::compare(ArrayKernels::Compare::COMPARE_EQUAL, dst->bools.data(), left, right, dst->size);
+		break;
+	case Intrinsic::INTRINSIC_NOT_EQUAL:
+		ArrayKernels::compare(ArrayKernels::Compare::COMPARE_NOT_EQUAL, dst->bools.data(), left, right, dst->size);
+		break;
+	default:
+		throw CILError::error("Incomplete handling of intrinsics");
+	}
+	return value_t::none();
+}
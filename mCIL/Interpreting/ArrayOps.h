@@ -0,0 +1,28 @@
+#pragma once
+#include "../cil-system.h"
+#include "../Parsing/Expression.h"
+#include "Environment.h"
+
+//The intrinsics of the language, shared by both engines. They work on arrays
+//of 'num' in place, through the SIMD kernels of ArrayKernels:
+//  sum(a), min(a), max(a), dot(a, b)      reduce to a 'num'
+//  add(dst, x, y) ... divide(dst, x, y)   element-wise arithmetic into a 'num' array
+//  less(dst, x, y) ... not_equal(...)     element-wise comparisons into a 'bool' array
+//where x and y are arrays of the size of dst or a 'num' used for every element.
+class ArrayOps
+{
+public:
+	//An argument as the engine found it: the array a plain name refers to, otherwise the value of the expression
+	struct Operand
+	{
+		Environment::Array* array = nullptr;
+		value_t value;
+	};
+
+	//Whether 'intrinsic' writes into the array given first
+	static bool writes(Intrinsic intrinsic)
+	{ return intrinsic >= Intrinsic::INTRINSIC_ADD; }
+
+	//Errors are thrown without a position, the engine adds the call's
+	static value_t call(Intrinsic intrinsic, const std::string& name, const std::vector<Operand>& operands);
+};
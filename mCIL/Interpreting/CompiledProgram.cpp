@@ -0,0 +1,115 @@
+#include "CompiledProgram.h"
+#include "Interpreter.h"
+#include "../Lexing/Lexer.h"
+#include "../Scanning/Scanner.h"
+#include "../Parsing/Parser.h"
+#include "../Parsing/Optimizer.h"
+#include "../Parsing/Resolver.h"
+#include "../Diagnostics/SourceStringManager.h"
+#include "../Diagnostics/Diagnostics.h"
+
+CompiledProgram::CompiledProgram(const std::string& source, bool optimize)
+	: source_(source), optimized_(optimize), compile_ms_(0), errors_(),
+	  warmup_lock_(), warmed_up_(false), limits_lock_(), heap_limits_(), isolate_(), program_(), constants_()
+{
+}
+
+std::shared_ptr<const CompiledProgram> CompiledProgram::compile(const std::string& source, bool optimize)
+{
+	std::shared_ptr<CompiledProgram> program{ new CompiledProgram(source, optimize) };
+	Isolate::Scope scope{ program->isolate_ };
+
+	auto start = std::chrono::steady_clock::now();
+	try
+	{
+		program->build();
+	}
+	catch (CILError& err)
+	{
+		ErrorManager::cil_error(err);
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	program->compile_ms_ = elapsed.count();
+
+	program->errors_ = std::move(ErrorManager::errors());
+	ErrorManager::clear_errors();
+	return program;
+}
+
+void CompiledProgram::build()
+{
+	SourceStringManager source{ source_ };
+	Lexer lexer{ isolate_, source };
+	token_list tokens = lexer.scan_file();
+	if (ErrorManager::error_ocurred())
+	{ return; }
+
+	Scanner scanner{ isolate_, tokens };
+	token_list top_level_tokens = scanner.scan();
+	if (ErrorManager::error_ocurred())
+	{ return; }
+
+	Parser parser{ isolate_, top_level_tokens };
+	stmt_list& stmts = parser.parse();
+	program_ = std::move(stmts);
+	delete &stmts;
+	if (ErrorManager::error_ocurred())
+	{ return; }
+
+	Optimizer optimizer{ program_, constants_ };
+	if (optimized_)
+	{ optimizer.optimize(); }
+	Resolver resolver{ program_, constants_ };
+	resolver.resolve();
+}
+
+void CompiledProgram::set_heap_limits(const Heap::Limits& limits) const
+{
+	std::unique_lock lock{ limits_lock_ };
+	heap_limits_ = limits;
+}
+
+CompiledProgram::Run CompiledProgram::run(const Inputs& inputs) const
+{
+	Run result{};
+	if (!ok())
+	{
+		result.errors = std::vector<CILError>(errors_);
+		return result;
+	}
+
+	std::unique_lock warmup{ warmup_lock_, std::defer_lock };
+	if (!warmed_up_.load(std::memory_order_acquire))
+	{ warmup.lock(); }
+	bool quicken = warmup.owns_lock() && !warmed_up_.load(std::memory_order_relaxed);
+	if (!quicken && warmup.owns_lock())
+	{ warmup.unlock(); }
+
+	Isolate isolate{ isolate_ };
+	{
+		std::unique_lock lock{ limits_lock_ };
+		isolate.heap().set_limits(heap_limits_);
+	}
+	Isolate::Scope scope{ isolate };
+
+	auto start = std::chrono::steady_clock::now();
+	std::stringstream out{};
+	{
+		Interpreter interpreter{ isolate, program_ };
+		interpreter.set_output(&out);
+		interpreter.set_quickening(quicken);
+		interpreter.define_global_symbols();
+		for (const auto& [name, value] : inputs)
+		{ interpreter.define_global(name, value); }
+		if (!ErrorManager::error_ocurred())
+		{ interpreter.run(); }
+	}
+	if (quicken)
+	{ warmed_up_.store(true, std::memory_order_release); }
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	result.out = out.str();
+	result.errors = std::move(ErrorManager::errors());
+	result.run_ms = elapsed.count();
+	return result;
+}
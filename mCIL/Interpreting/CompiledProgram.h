@@ -0,0 +1,72 @@
+#pragma once
+#include "../cil-system.h"
+#include "../Parsing/Statement.h"
+#include "../Types/ConstantPool.h"
+#include "../Types/Value.h"
+#include "../Diagnostics/CILError.h"
+#include "Isolate.h"
+
+//A program that was lexed, scanned, parsed, optimized and resolved once and can
+//be run any number of times after. It keeps the isolate it was compiled in, so
+//the types and global symbols it declared are there for every run, and every
+//run only creates a fresh Interpreter with a fresh global Environment, in an
+//isolate of its own that holds its heap and errors. The first run specializes
+//the nodes of the AST and the runs that start meanwhile wait for it. After that
+//the program does not change, and any number of runs share it without a lock.
+class CompiledProgram
+{
+public:
+	struct Run
+	{
+		std::string out;
+		std::vector<CILError> errors;
+		double run_ms = 0;
+
+		bool ok() const
+		{ return errors.empty(); }
+	};
+
+	//Variables defined before the program runs, it reads them like globals it did not declare
+	typedef std::map<std::string, value_t> Inputs;
+
+	//Never fails, a program that does not compile holds the errors and every run reports them again
+	static std::shared_ptr<const CompiledProgram> compile(const std::string& source, bool optimize = true);
+
+	Run run(const Inputs& inputs = {}) const;
+
+	//Applies to the objects and strings of all later runs
+	void set_heap_limits(const Heap::Limits& limits) const;
+
+	bool ok() const
+	{ return errors_.empty(); }
+	const std::vector<CILError>& errors() const
+	{ return errors_; }
+
+	const std::string& source() const
+	{ return source_; }
+	bool optimized() const
+	{ return optimized_; }
+	//What compiling took, and what every run of the program from a cache saves
+	double compile_ms() const
+	{ return compile_ms_; }
+private:
+	CompiledProgram(const std::string& source, bool optimize);
+
+	void build();
+
+	std::string source_;
+	bool optimized_;
+	double compile_ms_;
+	std::vector<CILError> errors_;
+
+	//Held by the first run, the only one that rewrites nodes of the AST
+	mutable std::mutex warmup_lock_;
+	mutable std::atomic<bool> warmed_up_;
+	mutable std::mutex limits_lock_;
+	mutable Heap::Limits heap_limits_;
+
+	//Only read by runs, they use its types and global symbols
+	mutable Isolate isolate_;
+	mutable stmt_list program_;
+	ConstantPool constants_;
+};
@@ -1,26 +1,64 @@
 #include "Environment.h"
+#include "../Types/Object.h"
+#include "../Types/TypeTable.h"
+#include "Isolate.h"
 
 Environment::Environment()
-	: variables_(), arrays_(), functions_(), classes_(), enclosing_(nullptr)
+	: variables_(), arrays_(), functions_(), classes_(), var_slots_(), func_slots_(), enclosing_(nullptr), scoped_functions_(false), isolate_(nullptr),
+	  receiver_(), object_(nullptr)
 {
 }
 
 Environment::Environment(Environment* enclosing)
-	: variables_(), arrays_(), functions_(), classes_(), enclosing_(enclosing)
+	: variables_(), arrays_(), functions_(), classes_(), var_slots_(), func_slots_(), enclosing_(enclosing), scoped_functions_(false), isolate_(nullptr),
+	  receiver_(), object_(nullptr)
+{
+}
+
+Environment::Environment(Environment* enclosing, std::pmr::memory_resource* resource)
+	: variables_(resource), arrays_(resource), functions_(resource), classes_(resource),
+	  var_slots_(resource), func_slots_(resource), enclosing_(enclosing), scoped_functions_(false), isolate_(nullptr),
+	  receiver_(), object_(nullptr)
 {
 }
 
 Environment::~Environment()
 {
+	forget_functions();
 }
 
-void Environment::define_var(Variable var)
+void Environment::reset(Environment* enclosing)
 {
-	if (this->variables_.contains(var.name))
+	variables_.clear();
+	arrays_.clear();
+	forget_functions();
+	classes_.clear();
+	//clear() would keep the capacity, which points into an arena the pool is about to rewind
+	std::pmr::vector<Variable*>(var_slots_.get_allocator()).swap(var_slots_);
+	std::pmr::vector<Function*>(func_slots_.get_allocator()).swap(func_slots_);
+	enclosing_ = enclosing;
+	//Call sites only cache functions the object's methods do not hide, nothing to invalidate here
+	if (object_)
 	{
-		throw CILError::error("Redifinition of variable '$'", var.name.c_str());
+		object_ = nullptr;
+		receiver_ = nullptr;
+	}
+}
+
+void Environment::define_var(Variable var, int slot)
+{
+	auto [it, inserted] = this->variables_.try_emplace(var.name, std::move(var));
+	if (!inserted)
+	{
+		throw CILError::error("Redifinition of variable '$'", it->first.c_str());
+	}
+	Variable& defined = it->second;
+	if (slot >= 0)
+	{
+		if ((size_t)slot >= var_slots_.size())
+		{ var_slots_.resize(slot + 1, nullptr); }
+		var_slots_[slot] = &defined;
 	}
-	this->variables_.insert({ var.name, var });
 }
 
 void Environment::define_arr(Array arr)
@@ -29,10 +67,10 @@ void Environment::define_arr(Array arr)
 	{
 		throw CILError::error("Redifinition of array '$'", arr.name.c_str());
 	}
-	this->arrays_.insert({ arr.name, arr });
+	this->arrays_.emplace(arr.name, std::move(arr));
 }
 
-void Environment::define_func(Function func)
+void Environment::define_func(Function func, int slot)
 {
 	if (this->functions_.contains(func.name))
 	{
@@ -42,7 +80,21 @@ void Environment::define_func(Function func)
 		}
 		functions_.at(func.name) = func;
 	}
-	this->functions_.insert({ func.name, func });
+	Function& defined = this->functions_.insert({ func.name, func }).first->second;
+	if (!isolate_)
+	{ isolate_ = &Isolate::current(); }
+	if (enclosing_ && !scoped_functions_)
+	{
+		scoped_functions_ = true;
+		isolate_->scoped_function_envs()++;
+	}
+	functions_changed();
+	if (slot >= 0)
+	{
+		if ((size_t)slot >= func_slots_.size())
+		{ func_slots_.resize(slot + 1, nullptr); }
+		func_slots_[slot] = &defined;
+	}
 }
 
 void Environment::define_class(Class cls)
@@ -51,71 +103,166 @@ void Environment::define_class(Class cls)
 	{
 		throw CILError::error("Redifinition of class '$'", cls.name.c_str());
 	}
+	cls.shape = std::make_shared<Shape>(Shape{ cls.name, Type::make(cls.name), cls.members, cls.methods });
 	classes_.insert({ cls.name, cls });
 }
 
-Environment::Variable& Environment::get_var(const std::string name)
+Environment::VarRef Environment::get_var(const std::string name)
 {
-	if (this->variables_.contains(name))
+	VarRef var = find_var(name);
+	if (!var)
 	{
-		return this->variables_.at(name);
+		throw CILError::error("Undefined variable '$'", name.c_str());
 	}
-	else if (this->enclosing_ && this->enclosing_->var_exists(name))
+	return var;
+}
+
+Environment::Array& Environment::get_arr(const std::string name)
+{
+	Array* arr = find_arr(name);
+	if (!arr)
 	{
-		return this->enclosing_->get_var(name);
+		throw CILError::error("Undefined array '$'", name.c_str());
 	}
-	else
+	return *arr;
+}
+
+Environment::Function& Environment::get_func(const std::string name)
+{
+	Function* func = find_func(name);
+	if (!func)
 	{
-		throw CILError::error("Undefined variable '$'", name.c_str());
+		throw CILError::error("Undefined function '$'", name.c_str());
 	}
+	return *func;
 }
 
-Environment::Array& Environment::get_arr(const std::string name)
+Environment::Class& Environment::get_class(const std::string name)
 {
-	if (this->arrays_.contains(name))
+	if (classes_.contains(name))
 	{
-		return this->arrays_.at(name);
+		return classes_.at(name);
 	}
-	else if (this->enclosing_ && this->enclosing_->arr_exists(name))
+	else if (enclosing_ && enclosing_->class_exists(name))
 	{
-		return this->enclosing_->get_arr(name);
+		return enclosing_->get_class(name);
 	}
 	else
 	{
-		throw CILError::error("Undefined array '$'", name.c_str());
+		throw CILError::error("Undefined class '$'", name.c_str());
 	}
 }
 
-Environment::Function& Environment::get_func(const std::string name)
+Environment::VarRef Environment::get_var(int depth, int slot, const std::string& name)
 {
-	if (this->functions_.contains(name))
+	VarRef var = find_var(depth, slot, name);
+	if (!var)
 	{
-		return this->functions_.at(name);
+		throw CILError::error("Undefined variable '$'", name.c_str());
 	}
-	else if (this->enclosing_ && this->enclosing_->func_exists(name))
+	return var;
+}
+
+Environment::Function& Environment::get_func(int depth, int slot, const std::string& name)
+{
+	Environment* env = this;
+	for (int i = 0; i < depth && env; i++)
+	{ env = env->enclosing_; }
+	if (env && slot >= 0 && (size_t)slot < env->func_slots_.size() && env->func_slots_[slot])
+	{ return *env->func_slots_[slot]; }
+	return get_func(name);
+}
+
+Environment::Function& Environment::get_func(int depth, int slot, const std::string& name, bool& cacheable)
+{
+	cacheable = false;
+	Environment* env = this;
+	for (int i = 0; i < depth && env; i++)
+	{ env = env->enclosing_; }
+	if (env && slot >= 0 && (size_t)slot < env->func_slots_.size() && env->func_slots_[slot])
+	{ return *env->func_slots_[slot]; }
+
+	for (env = this; env; env = env->enclosing_)
 	{
-		return this->enclosing_->get_func(name);
+		auto it = env->functions_.find(name);
+		if (it != env->functions_.end())
+		{
+			cacheable = !env->enclosing_ && env->isolate_->scoped_function_envs() == 0;
+			return it->second;
+		}
+		if (env->object_)
+		{
+			if (Function* method = env->object_->shape().find_method(name))
+			{ return *method; }
+		}
 	}
-	else
+	throw CILError::error("Undefined function '$'", name.c_str());
+}
+
+Environment::Array* Environment::find_arr(const std::string& name)
+{
+	for (Environment* env = this; env; env = env->enclosing_)
 	{
-		throw CILError::error("Undefined function '$'", name.c_str());
+		auto it = env->arrays_.find(name);
+		if (it != env->arrays_.end())
+		{ return &it->second; }
 	}
+	return nullptr;
 }
 
-Environment::Class& Environment::get_class(const std::string name)
+Environment::VarRef Environment::find_var(const std::string& name)
 {
-	if (classes_.contains(name))
+	for (Environment* env = this; env; env = env->enclosing_)
 	{
-		return classes_.at(name);
+		auto it = env->variables_.find(name);
+		if (it != env->variables_.end())
+		{ return { &it->second, &it->second.value }; }
+		if (env->object_)
+		{
+			int slot = env->object_->shape().member_slot(name);
+			if (slot >= 0)
+			{ return { &env->object_->shape().members[slot], &env->object_->member(slot) }; }
+		}
 	}
-	else if (enclosing_ && enclosing_->class_exists(name))
+	return {};
+}
+
+Environment::VarRef Environment::find_var(int depth, int slot, const std::string& name)
+{
+	Environment* env = this;
+	for (int i = 0; i < depth && env; i++)
+	{ env = env->enclosing_; }
+	if (env && slot >= 0 && (size_t)slot < env->var_slots_.size() && env->var_slots_[slot])
 	{
-		return enclosing_->get_class(name);
+		Variable* var = env->var_slots_[slot];
+		return { var, &var->value };
 	}
-	else
+	return find_var(name);
+}
+
+void Environment::share_vars(bool shared)
+{
+	for (Environment* env = this; env; env = env->enclosing_)
 	{
-		throw CILError::error("Undefined class '$'", name.c_str());
+		for (auto& [name, var] : env->variables_)
+		{ var.shared = shared; }
+	}
+}
+
+Environment::Function* Environment::find_func(const std::string& name)
+{
+	for (Environment* env = this; env; env = env->enclosing_)
+	{
+		auto it = env->functions_.find(name);
+		if (it != env->functions_.end())
+		{ return &it->second; }
+		if (env->object_)
+		{
+			if (Function* method = env->object_->shape().find_method(name))
+			{ return method; }
+		}
 	}
+	return nullptr;
 }
 
 bool Environment::var_exists(const std::string name)
@@ -189,7 +336,106 @@ bool Environment::class_exists(Class cls)
 }
 
 void Environment::add_enclosing(Environment* other)
-{ enclosing_ = other; }
+{
+	enclosing_ = other;
+	if (!functions_.empty())
+	{ functions_changed(); }
+}
 
 void Environment::rem_enclosing()
-{ enclosing_ = nullptr; }
+{
+	enclosing_ = nullptr;
+	if (!functions_.empty())
+	{ functions_changed(); }
+}
+
+void Environment::bind_object(value_t object)
+{
+	receiver_ = object;
+	object_ = receiver_.as<CIL::Object>();
+	//Methods shadow functions of the same name, call sites may not keep what they found before
+	if (object_ && shadows_cached_functions(object_->shape()))
+	{ functions_changed(); }
+}
+
+bool Environment::shadows_cached_functions(Shape& shape)
+{
+	if (shape.methods.empty())
+	{ return false; }
+
+	//Only functions of the root scope are cached, and they cannot change without a new epoch
+	uint64_t epoch = Isolate::current().function_epoch();
+	if (shape.checked_epoch != epoch)
+	{
+		Environment* root = this;
+		while (root->enclosing_)
+		{ root = root->enclosing_; }
+		shape.shadows_functions = std::any_of(shape.methods.begin(), shape.methods.end(),
+			[root](const Function& method) { return root->functions_.contains(method.name); });
+		shape.checked_epoch = epoch;
+	}
+	return shape.shadows_functions;
+}
+
+Environment::Array Environment::Array::create(const std::string& name, Type type, const std::vector<value_t>& elements)
+{
+	Array arr{ name, elements.size(), type, Storage::BOXED, {}, {}, {} };
+	if (type.is(type_id("num")))
+	{
+		arr.storage = Storage::NUM;
+		arr.nums.reserve(elements.size());
+		for (const value_t& element : elements)
+		{ arr.nums.push_back(element.as_num()); }
+	}
+	else if (type.is(type_id("bool")))
+	{
+		arr.storage = Storage::BOOL;
+		arr.bools.reserve(elements.size());
+		for (const value_t& element : elements)
+		{ arr.bools.push_back(element.as_bool()); }
+	}
+	else
+	{ arr.values = elements; }
+	return arr;
+}
+
+int Environment::Shape::member_slot(const std::string& name) const
+{
+	for (size_t i = 0; i < members.size(); i++)
+	{
+		if (members[i].name == name)
+		{ return (int)i; }
+	}
+	return -1;
+}
+
+Environment::Function* Environment::Shape::find_method(const std::string& name)
+{
+	for (Function& method : methods)
+	{
+		if (method.name == name)
+		{ return &method; }
+	}
+	return nullptr;
+}
+
+void Environment::functions_changed()
+{
+	Isolate& isolate = isolate_ ? *isolate_ : Isolate::current();
+	isolate.functions_changed();
+}
+
+void Environment::forget_functions()
+{
+	if (functions_.empty())
+	{ return; }
+
+	functions_.clear();
+	if (scoped_functions_)
+	{
+		scoped_functions_ = false;
+		isolate_->scoped_function_envs()--;
+	}
+	functions_changed();
+	isolate_ = nullptr;
+}
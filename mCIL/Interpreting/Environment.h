@@ -3,6 +3,10 @@
 #include "../Diagnostics/CILError.h"
 #include "../Types/Value.h"
 
+namespace CIL
+{ class Object; }
+class Isolate;
+
 class Environment
 {
 public:
@@ -10,15 +14,60 @@ public:
 		std::string name;
 		Type type;
 
-		value_ptr value;
+		value_t value;
+		//Visible to the chunks of a running parallel loop, which may not assign to it
+		bool shared = false;
+	};
+
+	//A variable found by name, either one of a scope or the member of an object.
+	//Members are declared once in the shape of their class and keep only their
+	//value in the object, so the declaration and the value are referred to apart.
+	struct VarRef {
+		const Variable* decl = nullptr;
+		value_t* value = nullptr;
+
+		explicit operator bool() const
+		{ return decl != nullptr; }
 	};
 
+	//Arrays of 'num' keep their elements unboxed in one buffer of doubles and arrays
+	//of 'bool' one byte per element, only arrays of other types hold values. Bytes
+	//rather than bits, chunks of a parallel loop write neighbouring elements at once.
 	struct Array {
+		enum class Storage { BOXED, NUM, BOOL };
+
 		std::string name;
 		size_t size;
 		Type type;
 
-		std::vector<value_ptr> values;
+		Storage storage;
+		std::vector<value_t> values;
+		std::vector<double> nums;
+		std::vector<uint8_t> bools;
+
+		//The elements have to be of 'type' already
+		static Array create(const std::string& name, Type type, const std::vector<value_t>& elements);
+
+		value_t get(size_t index) const
+		{
+			switch (storage)
+			{
+			case Storage::NUM:  return value_t::number(nums[index]);
+			case Storage::BOOL: return value_t::boolean(bools[index] != 0);
+			default:            return values[index];
+			}
+		}
+
+		//'value' has to be of 'type' already
+		void set(size_t index, const value_t& value)
+		{
+			switch (storage)
+			{
+			case Storage::NUM:  nums[index] = value.as_num(); break;
+			case Storage::BOOL: bools[index] = value.as_bool(); break;
+			default:            values[index] = value; break;
+			}
+		}
 	};
 
 	struct Function {
@@ -30,31 +79,77 @@ public:
 		stmt_ptr body;
 	};
 
+	//What all instances of a class share: the names and types of the members
+	//in the order of their slots, with the values every instance starts out
+	//with, and the methods, which exist once per class instead of once per instance
+	struct Shape {
+		std::string name;
+		Type type;
+
+		std::vector<Variable> members;
+		std::vector<Function> methods;
+
+		//The slot of member 'name', -1 if the class has no such member
+		int member_slot(const std::string& name) const;
+		Function* find_method(const std::string& name);
+
+		//Whether a method has the name of a function of the root scope, as of function epoch 'checked_epoch'
+		bool shadows_functions = false;
+		uint64_t checked_epoch = UINT64_MAX;
+	};
+
 	struct Class {
 		std::string name;
 
 		std::vector<Variable> members;
 		std::vector<Function> methods;
+
+		//Built by define_class, the instances of the class all point to it
+		std::shared_ptr<Shape> shape = nullptr;
 	};
 public:
 	Environment();
 	Environment(Environment* enclosing);
+	//Allocates all bookkeeping of this scope from 'resource'
+	Environment(Environment* enclosing, std::pmr::memory_resource* resource);
 
 	~Environment();
+
+	//Forgets every definition so the environment can be reused as a fresh scope
+	void reset(Environment* enclosing);
 	
-	void define_var(Variable var);
+	void define_var(Variable var, int slot = -1);
 
 	void define_arr(Array arr);
 
-	void define_func(Function func);
+	void define_func(Function func, int slot = -1);
 
 	void define_class(Class cls);
 
-	Variable& get_var(const std::string name);
+	VarRef get_var(const std::string name);
 	Array& get_arr(const std::string name);
 	Function& get_func(const std::string name);
 	Class& get_class(const std::string name);
 
+	//Resolved lookups: walk 'depth' scopes outwards and index the slot directly,
+	//falling back to the name if the slot was never filled
+	VarRef get_var(int depth, int slot, const std::string& name);
+	Function& get_func(int depth, int slot, const std::string& name);
+
+	//Same as get_func(depth, slot, name), additionally reports whether a call site
+	//may keep the result until the function epoch of its isolate changes. That is only the case for
+	//functions of a root environment while no scope-local function could shadow them.
+	Function& get_func(int depth, int slot, const std::string& name, bool& cacheable);
+
+	Array* find_arr(const std::string& name);
+	//Evaluates to false if there is no such variable
+	VarRef find_var(const std::string& name);
+	VarRef find_var(int depth, int slot, const std::string& name);
+
+	//Marks the variables of this scope and all enclosing ones as shared, or no longer shared
+	void share_vars(bool shared);
+	Function* find_func(const std::string& name);
+
 	bool var_exists(const std::string name);
 	bool var_exists(Variable var);
 
@@ -70,14 +165,32 @@ public:
 	void add_enclosing(Environment* other);
 	void rem_enclosing();
 
+	//Makes the members and methods of 'object' visible in this scope until it is reset,
+	//the scope keeps the object alive until then
+	void bind_object(value_t object);
+
 	bool has_enclosing()
 	{ return this->enclosing_ != nullptr; }
 private:
-	std::map<const std::string, Variable> variables_;
-	std::map<const std::string, Array> arrays_;
-	std::map<const std::string, Function> functions_;
-	std::map<const std::string, Class> classes_;
+	void functions_changed();
+	void forget_functions();
+	//Whether binding an object of 'shape' hides a function call sites may have cached
+	bool shadows_cached_functions(Shape& shape);
+
+	std::pmr::map<const std::string, Variable> variables_;
+	std::pmr::map<const std::string, Array> arrays_;
+	std::pmr::map<const std::string, Function> functions_;
+	std::pmr::map<const std::string, Class> classes_;
+
+	std::pmr::vector<Variable*> var_slots_;
+	std::pmr::vector<Function*> func_slots_;
 
 	Environment* enclosing_;
+	bool scoped_functions_;
+	//The isolate the functions of this scope were defined in, set while there are any
+	Isolate* isolate_;
+
+	value_t receiver_;
+	CIL::Object* object_;
 };
 
@@ -0,0 +1,75 @@
+#include "EnvironmentPool.h"
+
+EnvironmentPool::EnvironmentPool()
+	: upstream_(), frames_(), depth_(0), pushes_(0)
+{
+}
+
+EnvironmentPool::~EnvironmentPool()
+{
+}
+
+Environment* EnvironmentPool::push(Environment* enclosing)
+{
+	pushes_++;
+	if (depth_ == frames_.size())
+	{
+		frames_.push_back(std::make_unique<Frame>(enclosing, &upstream_));
+		return &frames_[depth_++]->env;
+	}
+
+	Environment* env = &frames_[depth_++]->env;
+	env->reset(enclosing);
+	return env;
+}
+
+void EnvironmentPool::pop()
+{
+	assert(depth_ > 0);
+	depth_--;
+	Frame& frame = *frames_[depth_];
+	//The maps have to let go of their nodes before the arena is rewound
+	frame.env.reset(nullptr);
+	frame.arena.release();
+}
+
+void EnvironmentPool::unwind(size_t depth)
+{
+	while (depth_ > depth)
+	{
+		pop();
+	}
+}
+
+EnvironmentPool::Stats EnvironmentPool::stats() const
+{
+	//Frames are never given back while the pool lives, so their peak is what exists now
+	return { pushes_, frames_.size(), frames_.size() * sizeof(Frame) + upstream_.peak() };
+}
+
+void EnvironmentPool::dump_stats(std::ostream& os) const
+{
+	Stats s = stats();
+	os << "Environment frames:\n"
+	   << "  scopes entered:    " << s.pushes << "\n"
+	   << "  peak depth:        " << s.peak_depth << "\n"
+	   << "  peak frame memory: " << s.peak_bytes << " bytes\n";
+}
+
+void* EnvironmentPool::CountingResource::do_allocate(size_t bytes, size_t alignment)
+{
+	current_ += bytes;
+	peak_ = std::max(peak_, current_);
+	return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void EnvironmentPool::CountingResource::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+{
+	current_ -= bytes;
+	std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+}
+
+bool EnvironmentPool::CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "../cil-system.h"
+#include "Environment.h"
+
+//Hands out the environments of blocks and calls in LIFO order. Every frame
+//owns a fixed arena its maps bump-allocate from. A popped environment is
+//cleared and its arena rewound, so entering a scope at a depth that was
+//reached before does no heap work unless the scope outgrows its arena.
+class EnvironmentPool
+{
+public:
+	struct Stats
+	{
+		size_t pushes;
+		size_t peak_depth;
+		size_t peak_bytes;
+	};
+
+	EnvironmentPool();
+	~EnvironmentPool();
+
+	EnvironmentPool(const EnvironmentPool&) = delete;
+	EnvironmentPool& operator=(const EnvironmentPool&) = delete;
+
+	Environment* push(Environment* enclosing);
+	void pop();
+	//Pops environments until only 'depth' are left, used when an error unwinds scopes
+	void unwind(size_t depth);
+
+	size_t depth() const
+	{ return depth_; }
+
+	Stats stats() const;
+	void dump_stats(std::ostream& os) const;
+private:
+	//Counts the bytes scopes that outgrow their arena request from the global allocator
+	class CountingResource : public std::pmr::memory_resource
+	{
+	public:
+		CountingResource()
+			: current_(0), peak_(0) {}
+
+		size_t peak() const
+		{ return peak_; }
+	private:
+		virtual void* do_allocate(size_t bytes, size_t alignment) override;
+		virtual void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+		virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+		size_t current_;
+		size_t peak_;
+	};
+
+	static constexpr size_t ARENA_SIZE = 1024;
+
+	//The environment is declared last so it is destroyed before its arena
+	struct Frame
+	{
+		Frame(Environment* enclosing, std::pmr::memory_resource* upstream)
+			: buffer(), arena(buffer, ARENA_SIZE, upstream), env(enclosing, &arena) {}
+
+		alignas(std::max_align_t) std::byte buffer[ARENA_SIZE];
+		std::pmr::monotonic_buffer_resource arena;
+		Environment env;
+	};
+
+	CountingResource upstream_;
+	std::vector<std::unique_ptr<Frame>> frames_;
+	size_t depth_;
+
+	size_t pushes_;
+};
@@ -1,35 +1,82 @@
 #include "Interpreter.h"
 
-Interpreter::Interpreter()
-	: program_(), env_() 
+//Operand types a node has to see in a row before it is specialized
+static constexpr uint8_t QUICKEN_AFTER = 2;
+//Guard failures after which a node stays generic for good
+static constexpr uint8_t MAX_DEOPTS = 4;
+
+static bool is_variable(const expr_ptr& expr)
+{
+	return expr->is_primary_expr() &&
+		static_cast<PrimaryExpression*>(expr.get())->primary_type() == PrimaryType::PRIMARY_IDENTIFIER;
+}
+
+Interpreter::Interpreter(Isolate& isolate)
+	: isolate_(isolate), program_(), env_pool_(), env_(), return_value_(),
+	  call_sites_(), call_site_hits_(0), call_site_misses_(0), args_(),
+	  access_sites_(), access_hits_(0), access_misses_(0), megamorphic_sites_(0), object_type_(type_id("object")),
+	  quicken_(true), quickened_(0), deopts_(0), tail_callee_(nullptr), tail_returns_(), tail_calls_(0),
+	  profiler_(nullptr), out_(&std::cout), thread_count_(0), threads_(), parallel_loops_(0), chunks_(0),
+	  chunk_scope_(nullptr), concurrent_(false)
 {
-	this->env_ = new Environment();
+	this->env_ = env_pool_.push(nullptr);
 }
 
-Interpreter::Interpreter(stmt_list& program)
-	: program_(program), env_()
+Interpreter::Interpreter(Isolate& isolate, stmt_list& program)
+	: isolate_(isolate), program_(program), env_pool_(), env_(), return_value_(),
+	  call_sites_(), call_site_hits_(0), call_site_misses_(0), args_(),
+	  access_sites_(), access_hits_(0), access_misses_(0), megamorphic_sites_(0), object_type_(type_id("object")),
+	  quicken_(true), quickened_(0), deopts_(0), tail_callee_(nullptr), tail_returns_(), tail_calls_(0),
+	  profiler_(nullptr), out_(&std::cout), thread_count_(0), threads_(), parallel_loops_(0), chunks_(0),
+	  chunk_scope_(nullptr), concurrent_(false)
 {
-	this->env_ = new Environment();
+	this->env_ = env_pool_.push(nullptr);
 }
 
 Interpreter::~Interpreter()
 {
-	delete this->env_;
+}
+
+void Interpreter::set_threads(size_t count)
+{
+	thread_count_ = count;
+	threads_.reset();
+}
+
+void Interpreter::dump_stats(std::ostream& os) const
+{
+	env_pool_.dump_stats(os);
+	os << "Call sites:\n"
+	   << "  cached callees:    " << call_site_hits_ << "\n"
+	   << "  uncached lookups:  " << call_site_misses_ << "\n"
+	   << "  tail calls:        " << tail_calls_ << "\n"
+	   << "Inline caches:\n"
+	   << "  cached accesses:   " << access_hits_ << "\n"
+	   << "  uncached accesses: " << access_misses_ << "\n"
+	   << "  megamorphic sites: " << megamorphic_sites_ << "\n"
+	   << "Quickening:\n"
+	   << "  nodes specialized: " << quickened_ << "\n"
+	   << "  deoptimizations:   " << deopts_ << "\n"
+	   << "Parallel loops:\n"
+	   << "  loops run:         " << parallel_loops_ << "\n"
+	   << "  chunks:            " << chunks_ << "\n";
 }
 
 void Interpreter::run()
 {
-	for (stmt_ptr stmt : program_)
+	Isolate::Scope scope{ isolate_ };
+
+	for (const stmt_ptr& stmt : program_)
 	{
 		try
 		{
-			this->run_stmt(stmt);
+			this->visit_stmt(stmt);
 		}
 		catch (CILError& err)
 		{
 			if (!err.has_pos())
 			{ err.add_range(stmt->pos()); }
-			ErrorManager::cil_error(err);
+			report(err);
 			break;
 		}
 	}
@@ -37,71 +84,68 @@ void Interpreter::run()
 
 void Interpreter::run_single_statement(stmt_ptr stmt)
 {
+	Isolate::Scope scope{ isolate_ };
+
+	Environment* previous = this->env_;
+	size_t scope_depth = env_pool_.depth();
 	try
 	{
-		this->run_stmt(stmt);
+		this->visit_stmt(stmt);
 	}
 	catch (CILError& err)
 	{
+		env_pool_.unwind(scope_depth);
+		this->env_ = previous;
 		if (!err.has_pos())
 		{ err.add_range(stmt->pos()); }
-		ErrorManager::cil_error(err);
+		report(err);
 	}
 }
 
-value_ptr Interpreter::run_single_expression(expr_ptr expr)
+Completion Interpreter::visit_profiled_stmt(Statement* stmt)
 {
+	const Statement* previous = profiler_->at(stmt);
+	Completion completion = ASTVisitor::visit_stmt(stmt);
+	profiler_->restore(previous);
+	return completion;
+}
+
+value_t Interpreter::run_single_expression(expr_ptr expr)
+{
+	Isolate::Scope scope{ isolate_ };
+
+	Environment* previous = this->env_;
+	size_t scope_depth = env_pool_.depth();
 	try
 	{
-		return this->run_expr(expr);
+		return this->visit_expr(expr);
 	}
 	catch (CILError& err)
 	{
+		env_pool_.unwind(scope_depth);
+		this->env_ = previous;
 		if (!err.has_pos())
 		{ err.add_range(expr->pos()); }
-		ErrorManager::cil_error(err);
+		report(err);
 		return CIL::ErrorValue::create();
 	}
 }
 
-value_ptr Interpreter::run_expr(expr_ptr expr)
+value_t Interpreter::visit_error_expr(ErrorExpression*)
 {
-	switch (expr->type())
-	{
-	case ExprType::EXPRESSION_ERROR:
-		return CIL::ErrorValue::create();
-	case ExprType::EXPRESSION_GROUPING:
-		return this->run_grouping_expr(std::dynamic_pointer_cast<GroupingExpression, Expression>(expr));
-	case ExprType::EXPRESSION_CALL:
-		return this->run_call_expr(std::dynamic_pointer_cast<CallExpression, Expression>(expr));
-	case ExprType::EXPRESSION_ACCESS:
-		return run_access_expr(std::dynamic_pointer_cast<AccessExpression, Expression>(expr));
-	case ExprType::EXPRESSION_NEW:
-		return run_new_expr(std::dynamic_pointer_cast<NewExpression, Expression>(expr));
-	case ExprType::EXPRESSION_ARRAY_ACCESS:
-		return this->run_array_access_expr(std::dynamic_pointer_cast<ArrayAccessExpression, Expression>(expr));
-	case ExprType::EXPRESSION_PRIMARY:
-		return this->run_primary_expr(std::dynamic_pointer_cast<PrimaryExpression, Expression>(expr));
-	case ExprType::EXPRESSION_UNARY:
-		return this->run_unary_expr(std::dynamic_pointer_cast<UnaryExpression, Expression>(expr));
-	case ExprType::EXPRESSION_BINARY:
-		return this->run_binary_expr(std::dynamic_pointer_cast<BinaryExpression, Expression>(expr));
-	case ExprType::EXPRESSION_TERNARY:
-		return this->run_ternary_expr(std::dynamic_pointer_cast<TernaryExpression, Expression>(expr));
-	case ExprType::EXPRESSION_ASSIGNMENT:
-		return this->run_assignment_expr(std::dynamic_pointer_cast<AssignmentExpression, Expression>(expr));
-	default:
-		throw CILError::error(expr->pos(), "Incomplete handling of expressions");
-	}
+	return CIL::ErrorValue::create();
 }
 
-value_ptr Interpreter::run_grouping_expr(std::shared_ptr<GroupingExpression> expr)
+value_t Interpreter::visit_grouping_expr(GroupingExpression* expr)
 {
-	return this->run_expr(expr->expr());
+	return this->visit_expr(expr->expr());
 }
 
-value_ptr Interpreter::run_primary_expr(std::shared_ptr<PrimaryExpression> expr)
+value_t Interpreter::visit_primary_expr(PrimaryExpression* expr)
 {
+	if (expr->constant())
+	{ return *expr->constant(); }
+
 	switch (expr->primary_type())
 	{
 	case PrimaryType::PRIMARY_NONE:
@@ -116,13 +160,13 @@ value_ptr Interpreter::run_primary_expr(std::shared_ptr<PrimaryExpression> expr)
 	{
 		try
 		{
-			return this->env_->get_var(*expr->val().identifier_val).value;
+			return *this->env_->get_var(expr->slot().depth, expr->slot().slot, *expr->val().identifier_val).value;
 		}
 		catch (CILError& err)
 		{
 			if (!err.has_pos())
 			{ err.add_range(expr->pos()); }
-			ErrorManager::cil_error(err);
+			report(err);
 			return CIL::ErrorValue::create();
 		}
 	}
@@ -131,207 +175,526 @@ value_ptr Interpreter::run_primary_expr(std::shared_ptr<PrimaryExpression> expr)
 	}
 }
 
-value_ptr Interpreter::run_call_expr(std::shared_ptr<CallExpression> expr)
+value_t Interpreter::visit_call_expr(CallExpression* expr)
 {
+	if (expr->intrinsic() != Intrinsic::INTRINSIC_NONE)
+	{ return call_intrinsic(expr); }
+	return call(expr, nullptr);
+}
+
+value_t Interpreter::call_intrinsic(CallExpression* expr)
+{
+	//Other chunks may be writing single elements of the same array meanwhile
+	if (chunk_scope_ && ArrayOps::writes(expr->intrinsic()))
+	{ throw CILError::error(expr->pos(), "'$' cannot write whole arrays inside a parallel loop", expr->identifier()); }
+
+	std::vector<ArrayOps::Operand> operands(expr->args().size());
+	for (size_t i = 0; i < operands.size(); i++)
+	{
+		const expr_ptr& arg = expr->args()[i];
+		if (is_variable(arg))
+		{ operands[i].array = env_->find_arr(*static_cast<PrimaryExpression*>(arg.get())->val().identifier_val); }
+		if (!operands[i].array)
+		{ operands[i].value = this->visit_expr(arg); }
+	}
 	try
 	{
-		Environment::Function func = this->env_->get_func(expr->identifier());
-		if (!func.body)
-		{
-			throw CILError::error(expr->pos(), "Function '$' was declared but never defined", func.name);
-		}
-		std::vector<Environment::Variable> args {};
-		if (expr->args().size() != func.parameters.size())
-		{
-			//TODO: Add default arguments
-			throw CILError::error(expr->pos(), "Function '$' expects $ arguments, got $",
-				func.name.c_str(), func.parameters.size(), expr->args().size());
-		}
-		for (int i = 0; i < func.parameters.size(); i++)
-		{
-			value_ptr arg_val = this->run_expr(expr->args()[i]);
-			Type required_type = func.parameters[i].type;
-			if (!arg_val->type().is(required_type))
-			{
-				throw CILError::error(expr->pos(), "Argument '$' of function '$' must be '$' not '$'",
-					func.parameters[i].name.c_str(), func.name.c_str(), required_type, arg_val->type());
-			}
-			Environment::Variable arg{ func.parameters[i].name, arg_val->type(), arg_val };
-			args.push_back(arg);
-		}
+		return ArrayOps::call(expr->intrinsic(), expr->identifier(), operands);
+	}
+	catch (CILError& err)
+	{
+		if (!err.has_pos())
+		{ err.add_range(expr->pos()); }
+		throw;
+	}
+}
+
+value_t Interpreter::call(CallExpression* expr, const Environment::Function* callee)
+{
+	Environment* caller = this->env_;
+	size_t scope_depth = env_pool_.depth();
+	size_t args_base = args_.size();
+	size_t returns_base = tail_returns_.size();
+	size_t profile_depth = profiler_ ? profiler_->depth() : 0;
+#ifdef CIL_COUNTERS
+	size_t count_depth = counters_ ? counters_->depth() : 0;
+#endif
+	try
+	{
+		const Environment::Function* func = callee ? callee : &lookup_callee(expr);
+		push_arguments(expr, *func);
+		if (profiler_)
+		{ profiler_->enter(func->name); }
+#ifdef CIL_COUNTERS
+		if (counters_)
+		{ counters_->enter(*func); }
+#endif
 
 		Environment* previous = this->env_;
-		this->env_ = new Environment(previous);
-		for (Environment::Variable arg : args)
-		{
-			this->env_->define_var(arg);
-		}
+		this->env_ = env_pool_.push(previous);
+		bind_arguments(*func, args_base);
 
-		try
+		Completion completion = this->visit_stmt(func->body);
+		//A tail call replaces the scope of the function that made it, so a chain
+		//of them runs in one scope and one native frame
+		while (completion == Completion::COMPLETION_RETURN && tail_callee_)
 		{
-			this->run_stmt(func.body);
+			//A function called again moves its entry to the innermost position
+			auto returned = std::find(tail_returns_.begin() + returns_base, tail_returns_.end(), func);
+			if (returned == tail_returns_.end())
+			{ tail_returns_.push_back(func); }
+			else
+			{ std::rotate(returned, returned + 1, tail_returns_.end()); }
+
+			func = tail_callee_;
+			tail_callee_ = nullptr;
+			tail_calls_++;
+			if (profiler_)
+			{ profiler_->replace(func->name); }
+#ifdef CIL_COUNTERS
+			if (counters_)
+			{ counters_->replace(*func); }
+#endif
+
+			env_pool_.pop();
+			this->env_ = env_pool_.push(previous);
+			bind_arguments(*func, args_base);
+			completion = this->visit_stmt(func->body);
 		}
-		catch (Return& ret)
+		env_pool_.pop();
+		this->env_ = previous;
+		if (profiler_)
+		{ profiler_->leave(); }
+#ifdef CIL_COUNTERS
+		if (counters_)
+		{ counters_->leave(); }
+#endif
+
+		//'break' never escapes a function body, the parser only accepts it inside loops
+		if (completion == Completion::COMPLETION_RETURN)
 		{
-			delete this->env_;
-			this->env_ = previous;
-			if (!ret.ret_val()->type().is(func.ret_type))
+			value_t ret_val = std::move(return_value_);
+			//Every function of the chain checks the value it returns once, innermost
+			//first, like nested calls would. A failed check returns an error to the next one
+			auto check_return = [this, &ret_val](const Environment::Function& returned)
 			{
-				throw CILError::error(func.body->pos(), "Function '$' should return '$' not '$'",
-					func.name, func.ret_type, ret.ret_val()->type());
+				if (!ret_val.type().is(returned.ret_type))
+				{
+					report(CILError::error(returned.body->pos(), "Function '$' should return '$' not '$'",
+						returned.name, returned.ret_type, ret_val.type()));
+					ret_val = CIL::ErrorValue::create();
+				}
+			};
+			check_return(*func);
+			for (size_t i = tail_returns_.size(); i > returns_base; i--)
+			{
+				if (tail_returns_[i - 1] != func)
+				{ check_return(*tail_returns_[i - 1]); }
 			}
-			return ret.ret_val();
+			tail_returns_.resize(returns_base);
+			return ret_val;
 		}
-		delete this->env_;
-		this->env_ = previous;
+		tail_returns_.resize(returns_base);
 		//TODO: Change to none
 		return CIL::ErrorValue::create();
 	}
 	catch (CILError& err)
 	{
+		env_pool_.unwind(scope_depth);
+		this->env_ = caller;
+		args_.resize(args_base);
+		tail_callee_ = nullptr;
+		tail_returns_.resize(returns_base);
+		if (profiler_)
+		{ profiler_->unwind(profile_depth); }
+#ifdef CIL_COUNTERS
+		if (counters_)
+		{ counters_->unwind(count_depth); }
+#endif
 		if (!err.has_pos())
 		{ err.add_range(expr->pos()); }
-		ErrorManager::cil_error(err);
+		report(err);
 		return CIL::ErrorValue::create();
 	}
 }
 
-value_ptr Interpreter::run_access_expr(std::shared_ptr<AccessExpression> expr)
+void Interpreter::push_arguments(CallExpression* expr, const Environment::Function& func)
+{
+	if (!func.body)
+	{
+		throw CILError::error(expr->pos(), "Function '$' was declared but never defined", func.name);
+	}
+	if (expr->args().size() != func.parameters.size())
+	{
+		//TODO: Add default arguments
+		throw CILError::error(expr->pos(), "Function '$' expects $ arguments, got $",
+			func.name.c_str(), func.parameters.size(), expr->args().size());
+	}
+	for (size_t i = 0; i < func.parameters.size(); i++)
+	{
+		value_t arg_val = this->visit_expr(expr->args()[i]);
+		Type required_type = func.parameters[i].type;
+		if (!arg_val.type().is(required_type))
+		{
+			throw CILError::error(expr->pos(), "Argument '$' of function '$' must be '$' not '$'",
+				func.parameters[i].name.c_str(), func.name.c_str(), required_type, arg_val.type());
+		}
+		args_.push_back(std::move(arg_val));
+	}
+}
+
+void Interpreter::bind_arguments(const Environment::Function& func, size_t args_base)
+{
+	for (size_t i = 0; i < func.parameters.size(); i++)
+	{
+		value_t& arg_val = args_[args_base + i];
+		this->env_->define_var({ func.parameters[i].name, arg_val.type(), std::move(arg_val) }, (int)i);
+	}
+	args_.resize(args_base);
+}
+
+Completion Interpreter::tail_call(CallExpression* expr)
+{
+	Environment* caller = this->env_;
+	size_t scope_depth = env_pool_.depth();
+	size_t args_base = args_.size();
+	try
+	{
+		const Environment::Function& func = lookup_callee(expr);
+		push_arguments(expr, func);
+		tail_callee_ = &func;
+	}
+	catch (CILError& err)
+	{
+		//Fails exactly like the call would have, which returns an error value
+		env_pool_.unwind(scope_depth);
+		this->env_ = caller;
+		args_.resize(args_base);
+		if (!err.has_pos())
+		{ err.add_range(expr->pos()); }
+		report(err);
+		return_value_ = CIL::ErrorValue::create();
+	}
+	return Completion::COMPLETION_RETURN;
+}
+
+const Environment::Function& Interpreter::lookup_callee(CallExpression* expr)
 {
-	Environment::Variable var = env_->get_var(expr->identifier());
-	if(!var.type.is_subtype_of(type_id("object")))
-	{ throw CILError::error(expr->pos(), "Can only access variables of objects, got '$'", var.type); }
-	CIL::Object obj = *std::dynamic_pointer_cast<CIL::Object, CIL::Value>(var.value);
+	if (expr->site() >= call_sites_.size())
+	{ call_sites_.resize(expr->site() + 1); }
 
+	//Programs that were not resolved share site 0, so the entry remembers its node
+	CallSite& site = call_sites_[expr->site()];
+	uint64_t epoch = isolate_.function_epoch();
+	if (site.expr == expr && site.epoch == epoch)
+	{
+		call_site_hits_++;
+		return *site.func;
+	}
+
+	call_site_misses_++;
+	bool cacheable = false;
+	const Environment::Function& func = env_->get_func(expr->slot().depth, expr->slot().slot, expr->identifier(), cacheable);
+	if (cacheable)
+	{ site = { expr, &func, epoch }; }
+	return func;
+}
+
+value_t Interpreter::visit_access_expr(AccessExpression* expr)
+{
+	//Accessing an object splices its scope into the caller's, chunks running at the same time would race on that
+	if (chunk_scope_)
+	{ throw CILError::error(expr->pos(), "Objects cannot be accessed inside a parallel loop"); }
+	Environment::VarRef var = env_->get_var(expr->slot().depth, expr->slot().slot, expr->identifier());
+	if(!var.decl->type.is_subtype_of(object_type_))
+	{ throw CILError::error(expr->pos(), "Can only access variables of objects, got '$'", var.decl->type); }
+
+	CIL::Object* object = var.value->as<CIL::Object>();
+	const AccessSite::Entry* entry = object ? lookup_access(expr, object) : nullptr;
+	//Members are read straight from their slot, without a scope for the object
+	if (entry && entry->slot >= 0)
+	{ return object->member(entry->slot); }
+	const Environment::Function* method = entry ? entry->method : nullptr;
+
+	//The members and methods are visible in a scope of their own that encloses the caller's
 	Environment* previous = this->env_;
-	env_ = obj.env();
-	env_->add_enclosing(previous);
-	value_ptr val = run_expr(expr->inner());
-	env_->rem_enclosing();
+	env_ = env_pool_.push(previous);
+	env_->bind_object(*var.value);
+	value_t val = method ? call(static_cast<CallExpression*>(expr->inner().get()), method) : visit_expr(expr->inner());
+	env_pool_.pop();
 	this->env_ = previous;
 	return val;
 }
 
-value_ptr Interpreter::run_new_expr(std::shared_ptr<NewExpression> expr)
+const Interpreter::AccessSite::Entry* Interpreter::lookup_access(AccessExpression* expr, CIL::Object* object)
+{
+	if (expr->site() >= access_sites_.size())
+	{ access_sites_.resize(expr->site() + 1); }
+
+	//Programs that were not resolved share site 0, so the site remembers its node
+	AccessSite& site = access_sites_[expr->site()];
+	if (site.expr != expr)
+	{ site = AccessSite{ expr, {}, 0, false }; }
+
+	Environment::Shape& shape = object->shape();
+	for (size_t i = 0; i < site.size; i++)
+	{
+		if (site.entries[i].shape.get() == &shape)
+		{
+			access_hits_++;
+			return &site.entries[i];
+		}
+	}
+	if (site.megamorphic)
+	{ return nullptr; }
+
+	access_misses_++;
+	if (site.size == MAX_ACCESS_SHAPES)
+	{
+		site.megamorphic = true;
+		megamorphic_sites_++;
+		return nullptr;
+	}
+
+	//A name the class does not define is looked up in the caller's scopes, the entry then has neither
+	AccessSite::Entry& entry = site.entries[site.size++];
+	entry.shape = object->shared_shape();
+	const expr_ptr& inner = expr->inner();
+	if (is_variable(inner))
+	{ entry.slot = shape.member_slot(*static_cast<PrimaryExpression*>(inner.get())->val().identifier_val); }
+	else if (inner->is_call_expr())
+	{ entry.method = shape.find_method(static_cast<CallExpression*>(inner.get())->identifier()); }
+	return &entry;
+}
+
+value_t Interpreter::visit_new_expr(NewExpression* expr)
 {
-	Environment::Class cls = env_->get_class(expr->identifier());
-	value_ptr obj = CIL::Object::create(cls);
-	return obj;
+	Environment::Class& cls = env_->get_class(expr->identifier());
+	//Chunks running at the same time create objects too, their garbage waits until the loop joined
+	if (!concurrent_)
+	{ isolate_.heap().maybe_collect(); }
+	return CIL::Object::create(cls.shape);
 }
 
-value_ptr Interpreter::run_array_access_expr(std::shared_ptr<ArrayAccessExpression> expr)
+value_t Interpreter::visit_array_access_expr(ArrayAccessExpression* expr)
 {
-	value_ptr index_num = this->run_expr(expr->index());
-	if(!index_num->type().is_subtype_of(type_id("num")))
-	{ throw CILError::error(expr->pos(), "Index must be 'num' not '$'", index_num->type()); }
-	int index = (int)std::dynamic_pointer_cast<CIL::Number>(index_num)->value();
-	Environment::Array arr = this->env_->get_arr(expr->identifier());
+	value_t index_num = this->visit_expr(expr->index());
+	if (!index_num.is_num())
+	{ throw CILError::error(expr->pos(), "Index must be 'num' not '$'", index_num.type()); }
+	int index = (int)index_num.as_num();
+	const Environment::Array& arr = this->env_->get_arr(expr->identifier());
 	if (index < 0 || index >= arr.size)
 	{ throw CILError::error(expr->pos(), "Index must be in the range [$,$[", 0, arr.size); }
-	return arr.values[index];
+	return arr.get(index);
 }
 
-value_ptr Interpreter::run_unary_expr(std::shared_ptr<UnaryExpression> expr)
+value_t Interpreter::visit_unary_expr(UnaryExpression* expr)
 {
-	value_ptr inner = this->run_expr(expr->expr());
-	if (inner->type().is(type_id("error")))
+	QuickState& quick = expr->quick();
+	if (quick.specialized())
+	{
+		//'++' and '--' on a variable update it in place instead of reading it through the expression
+		PrimaryExpression* primary = static_cast<PrimaryExpression*>(expr->expr().get());
+		Environment::VarRef var = env_->find_var(primary->slot().depth, primary->slot().slot, *primary->val().identifier_val);
+		if (var && var.value->is_num())
+		{
+			check_private(var, expr->pos());
+			double delta = quick.form == QuickForm::QUICK_VAR_INCREMENT ? 1 : -1;
+			*var.value = value_t::number(var.value->as_num() + delta);
+			return *var.value;
+		}
+		deoptimize(quick);
+	}
+
+	value_t inner = this->visit_expr(expr->expr());
+	if (inner.is_error())
 	{ return CIL::ErrorValue::create(); }
+	if (quick.form == QuickForm::QUICK_UNTRIED)
+	{ observe(quick, unary_form(expr, inner)); }
 	switch (expr->op())
 	{
 	case Operator::OPERATOR_BANG:
-		TRY_OP(return inner->invert(), expr->pos());
+		TRY_OP(return inner.invert(), expr->pos());
 	case Operator::OPERATOR_SUBTRACT:
-		TRY_OP(return inner->invert(), expr->pos());
+		TRY_OP(return inner.invert(), expr->pos());
 	case Operator::OPERATOR_INCREMENT:
-		TRY_OP(return inner->increment(), expr->pos());
+		TRY_OP(return store_back(expr->expr(), inner.increment()), expr->pos());
 	case Operator::OPERATOR_DECREMENT:
-		TRY_OP(return inner->decrement(), expr->pos());
+		TRY_OP(return store_back(expr->expr(), inner.decrement()), expr->pos());
 	case Operator::OPERATOR_BITWISE_NOT:
-		TRY_OP(return inner->bitwise_not(), expr->pos());
+		TRY_OP(return inner.bitwise_not(), expr->pos());
 	default:
 		throw CILError::error(expr->pos(), "Incomplete handling of unary expressions");
 	}
 }
 
-value_ptr Interpreter::run_binary_expr(std::shared_ptr<BinaryExpression> expr)
+value_t Interpreter::store_back(expr_ptr target, value_t value)
+{
+	//Numbers are immediate values, so '++' and '--' have to write their result back
+	if (target->is_primary_expr())
+	{
+		PrimaryExpression* primary = static_cast<PrimaryExpression*>(target.get());
+		if (primary->primary_type() == PrimaryType::PRIMARY_IDENTIFIER)
+		{
+			Environment::VarRef var = env_->find_var(primary->slot().depth, primary->slot().slot, *primary->val().identifier_val);
+			check_private(var, target->pos());
+			if (var)
+			{ *var.value = value; }
+		}
+	}
+	return value;
+}
+
+value_t Interpreter::visit_binary_expr(BinaryExpression* expr)
 {
-	value_ptr left = this->run_expr(expr->left());
-	if (left->type().is(type_id("error")))
+	value_t left = this->visit_expr(expr->left());
+	if (left.is_error())
 	{ return CIL::ErrorValue::create(); }
-	value_ptr right = this->run_expr(expr->right());
-	if (right->type().is(type_id("error")))
+	value_t right = this->visit_expr(expr->right());
+	if (right.is_error())
 	{ return CIL::ErrorValue::create(); }
 
+	QuickState& quick = expr->quick();
+	if (quick.specialized())
+	{
+		if (left.is_num() && right.is_num())
+		{
+			double l = left.as_num();
+			double r = right.as_num();
+			switch (quick.form)
+			{
+			case QuickForm::QUICK_NUM_ADD:
+				return value_t::number(l + r);
+			case QuickForm::QUICK_NUM_SUBTRACT:
+				return value_t::number(l - r);
+			case QuickForm::QUICK_NUM_MULTIPLY:
+				return value_t::number(l * r);
+			case QuickForm::QUICK_NUM_DIVIDE:
+				return value_t::number(l / r);
+			case QuickForm::QUICK_NUM_LESS:
+				return value_t::boolean(l < r);
+			case QuickForm::QUICK_NUM_GREATER:
+				return value_t::boolean(l > r);
+			case QuickForm::QUICK_NUM_LESS_EQUAL:
+				return value_t::boolean(l <= r);
+			case QuickForm::QUICK_NUM_GREATER_EQUAL:
+				return value_t::boolean(l >= r);
+			case QuickForm::QUICK_NUM_EQUAL:
+				return value_t::boolean(l == r);
+			case QuickForm::QUICK_NUM_NOT_EQUAL:
+				return value_t::boolean(l != r);
+			default:
+				break;
+			}
+		}
+		else if (left.is_bool() && right.is_bool())
+		{
+			if (quick.form == QuickForm::QUICK_BOOL_AND)
+			{ return value_t::boolean(left.as_bool() && right.as_bool()); }
+			if (quick.form == QuickForm::QUICK_BOOL_OR)
+			{ return value_t::boolean(left.as_bool() || right.as_bool()); }
+		}
+		else if (CIL::String* l = left.as<CIL::String>())
+		{
+			CIL::String* r = right.as<CIL::String>();
+			if (r && quick.form == QuickForm::QUICK_STR_ADD)
+			{ return CIL::String::concat(left, right); }
+			if (r && quick.form == QuickForm::QUICK_STR_EQUAL)
+			{ return value_t::boolean(l->equal(*r)); }
+			if (r && quick.form == QuickForm::QUICK_STR_NOT_EQUAL)
+			{ return value_t::boolean(!l->equal(*r)); }
+		}
+		deoptimize(quick);
+	}
+	else if (quick.form == QuickForm::QUICK_UNTRIED)
+	{ observe(quick, binary_form(expr->op(), left, right)); }
+
 	switch (expr->op())
 	{
 	case Operator::OPERATOR_ADD:
-		TRY_OP(return left->add(right), expr->pos());
+		TRY_OP(return left.add(right), expr->pos());
 	case Operator::OPERATOR_SUBTRACT:
-		TRY_OP(return left->subtract(right), expr->pos());
+		TRY_OP(return left.subtract(right), expr->pos());
 	case Operator::OPERATOR_MULTIPLY:
-		TRY_OP(return left->multiply(right), expr->pos());
+		TRY_OP(return left.multiply(right), expr->pos());
 	case Operator::OPERATOR_DIVIDE:
-		TRY_OP(return left->divide(right), expr->pos());
+		TRY_OP(return left.divide(right), expr->pos());
 	case Operator::OPERATOR_LEFT_BITSHIFT:
-		TRY_OP(return left->left_bitshift(right), expr->pos());
+		TRY_OP(return left.left_bitshift(right), expr->pos());
 	case Operator::OPERATOR_RIGHT_BITSHIFT:
-		TRY_OP(return left->right_bitshift(right), expr->pos());
+		TRY_OP(return left.right_bitshift(right), expr->pos());
 	case Operator::OPERATOR_GREATER:
-		TRY_OP(return left->greater(right), expr->pos());
+		TRY_OP(return left.greater(right), expr->pos());
 	case Operator::OPERATOR_LESS:
-		TRY_OP(return left->less(right), expr->pos());
+		TRY_OP(return left.less(right), expr->pos());
 	case Operator::OPERATOR_GREATER_EQUAL:
-		TRY_OP(return left->greater_equals(right), expr->pos());
+		TRY_OP(return left.greater_equals(right), expr->pos());
 	case Operator::OPERATOR_LESS_EQUAL:
-		TRY_OP(return left->less_equals(right), expr->pos());
+		TRY_OP(return left.less_equals(right), expr->pos());
 	case Operator::OPERATOR_EQUAL_EQUAL:
-		TRY_OP(return left->equals(right), expr->pos());
+		TRY_OP(return left.equals(right), expr->pos());
 	case Operator::OPERATOR_NOT_EQUAL:
-		TRY_OP(return left->not_equals(right), expr->pos());
+		TRY_OP(return left.not_equals(right), expr->pos());
 	case Operator::OPERATOR_AND:
-		TRY_OP(return left->logical_and(right), expr->pos());
+		TRY_OP(return left.logical_and(right), expr->pos());
 	case Operator::OPERATOR_OR:
-		TRY_OP(return left->logical_or(right), expr->pos());
+		TRY_OP(return left.logical_or(right), expr->pos());
 	case Operator::OPERATOR_BITWISE_AND:
-		TRY_OP(return left->bitwise_and(right), expr->pos());
+		TRY_OP(return left.bitwise_and(right), expr->pos());
 	case Operator::OPERATOR_BITWISE_OR:
-		TRY_OP(return left->bitwise_or(right), expr->pos());
+		TRY_OP(return left.bitwise_or(right), expr->pos());
 	case Operator::OPERATOR_BITWISE_XOR:
-		TRY_OP(return left->bitwise_xor(right), expr->pos());
+		TRY_OP(return left.bitwise_xor(right), expr->pos());
 	default:
 		throw CILError::error(expr->pos(), "Incomplete handling of binary expressions");
 	}
 }
 
-value_ptr Interpreter::run_ternary_expr(std::shared_ptr<TernaryExpression> expr)
+value_t Interpreter::visit_ternary_expr(TernaryExpression* expr)
 {
-	value_ptr cond = this->run_expr(expr->cond());
-	if (cond->type().is(type_id("error")))
+	value_t cond = this->visit_expr(expr->cond());
+	if (cond.is_error())
 	{ return CIL::ErrorValue::create(); }
 
-	if (cond->to_bool())
+	if (cond.to_bool())
 	{
-		return this->run_expr(expr->left());
+		return this->visit_expr(expr->left());
 	}
-	return this->run_expr(expr->right());
+	return this->visit_expr(expr->right());
 }
 
-value_ptr Interpreter::run_assignment_expr(std::shared_ptr<AssignmentExpression> expr)
+value_t Interpreter::visit_assignment_expr(AssignmentExpression* expr)
 {
-	value_ptr value = this->run_expr(expr->expr());
-	if (value->type().is(type_id("error")))
+	value_t value = this->visit_expr(expr->expr());
+	if (value.is_error())
 	{ return CIL::ErrorValue::create(); }
 
+	//The target was checked to be a variable when the node was specialized, that can not change
+	QuickState& quick = expr->quick();
+	if (quick.specialized())
+	{
+		PrimaryExpression* primary = static_cast<PrimaryExpression*>(expr->target().get());
+		Environment::VarRef var = env_->find_var(primary->slot().depth, primary->slot().slot, *primary->val().identifier_val);
+		check_private(var, expr->pos());
+		if (var)
+		{ *var.value = value; }
+		return value;
+	}
+	if (quick.form == QuickForm::QUICK_UNTRIED)
+	{ observe(quick, assignment_form(expr)); }
+
 	if (expr->target()->is_primary_expr())
 	{
-		std::shared_ptr<PrimaryExpression> primary = std::dynamic_pointer_cast<PrimaryExpression, Expression>(expr->target());
+		PrimaryExpression* primary = static_cast<PrimaryExpression*>(expr->target().get());
 		if (primary->primary_type() == PrimaryType::PRIMARY_IDENTIFIER)
 		{
-			std::string identifier = *primary->val().identifier_val;
+			const std::string& identifier = *primary->val().identifier_val;
 
-			if (env_->var_exists(identifier))
+			Environment::VarRef var = env_->find_var(primary->slot().depth, primary->slot().slot, identifier);
+			check_private(var, expr->pos());
+			if (var)
 			{
-				env_->get_var(identifier).value = value;
+				*var.value = value;
 			}
 		}
 		else
@@ -339,6 +702,23 @@ value_ptr Interpreter::run_assignment_expr(std::shared_ptr<AssignmentExpression>
 			throw CILError::error(expr->pos(), "Cannot assign to '$'", primary->primary_type());
 		}
 	}
+	else if (expr->target()->is_array_access_expr())
+	{
+		ArrayAccessExpression* access = static_cast<ArrayAccessExpression*>(expr->target().get());
+		value_t index_num = this->visit_expr(access->index());
+		if (!index_num.is_num())
+		{ throw CILError::error(access->pos(), "Index must be 'num' not '$'", index_num.type()); }
+		int index = (int)index_num.as_num();
+		Environment::Array& arr = this->env_->get_arr(access->identifier());
+		if (index < 0 || (size_t)index >= arr.size)
+		{ throw CILError::error(access->pos(), "Index must be in the range [$,$[", 0, arr.size); }
+		if (!value.type().is(arr.type))
+		{
+			throw CILError::error(expr->pos(), "Cannot assign value of type '$' to element of array of type '$'",
+				value.type(), arr.type);
+		}
+		arr.set(index, value);
+	}
 	else
 	{
 		throw CILError::error(expr->pos(), "Cannot only assign to primary values");
@@ -347,185 +727,372 @@ value_ptr Interpreter::run_assignment_expr(std::shared_ptr<AssignmentExpression>
 	return value;
 }
 
-void Interpreter::run_stmt(stmt_ptr stmt)
-{
-	switch (stmt->type())
-	{
-	case StmtType::STATEMENT_BLOCK:
-		this->run_block_stmt(std::dynamic_pointer_cast<BlockStatement, Statement>(stmt));
-		break;
-	case StmtType::STATEMENT_BREAK:
-		this->run_break_stmt(std::dynamic_pointer_cast<BreakStatement, Statement>(stmt));
-		break;
-	case StmtType::STATEMENT_RETURN:
-		this->run_return_stmt(std::dynamic_pointer_cast<ReturnStatement, Statement>(stmt));
-		break;
-	case StmtType::STATEMENT_PRINT:
-		this->run_print_stmt(std::dynamic_pointer_cast<PrintStatement, Statement>(stmt));
-		break;
-	case StmtType::STATEMENT_IF:
-		this->run_if_stmt(std::dynamic_pointer_cast<IfStatement, Statement>(stmt));
-		break;
-	case StmtType::STATEMENT_WHILE:
-		this->run_while_stmt(std::dynamic_pointer_cast<WhileStatement, Statement>(stmt));
-		break;
-	case StmtType::STATEMENT_FOR:
-		this->run_for_stmt(std::dynamic_pointer_cast<ForStatement, Statement>(stmt));
-		break;
-	case StmtType::STATEMENT_VAR_DECL:
-		this->run_var_decl_stmt(std::dynamic_pointer_cast<VarDeclStatement, Statement>(stmt));
-		break;
-	case StmtType::STATEMENT_ARR_DECL:
-		this->run_arr_decl_stmt(std::dynamic_pointer_cast<ArrDeclStatement, Statement>(stmt));
-		break;
-	case StmtType::STATEMENT_FUNC_DECL:
-		this->run_func_decl_stmt(std::dynamic_pointer_cast<FuncDeclStatement, Statement>(stmt));
-		break;
-	case StmtType::STATEMENT_CLASS_DECL:
-		run_class_decl_stmt(std::dynamic_pointer_cast<ClassDeclStatement, Statement>(stmt));
-		break;
-	case StmtType::STATEMENT_EXPR:
-		this->run_expr_stmt(std::dynamic_pointer_cast<ExprStatement, Statement>(stmt));
-		break;
-	default:
-		throw CILError::error(stmt->pos(), "Incomplete handling of statements");
-	}
-}
-
-void Interpreter::run_block_stmt(std::shared_ptr<BlockStatement> stmt)
+QuickForm Interpreter::binary_form(Operator op, const value_t& left, const value_t& right)
 {
-	Environment* previous = this->env_;
-	this->env_ = new Environment(previous);
-	for (stmt_ptr inner : stmt->inner())
+	if (left.is_num() && right.is_num())
 	{
-		try
+		switch (op)
 		{
-			this->run_stmt(inner);
+		case Operator::OPERATOR_ADD:           return QuickForm::QUICK_NUM_ADD;
+		case Operator::OPERATOR_SUBTRACT:      return QuickForm::QUICK_NUM_SUBTRACT;
+		case Operator::OPERATOR_MULTIPLY:      return QuickForm::QUICK_NUM_MULTIPLY;
+		case Operator::OPERATOR_DIVIDE:        return QuickForm::QUICK_NUM_DIVIDE;
+		case Operator::OPERATOR_LESS:          return QuickForm::QUICK_NUM_LESS;
+		case Operator::OPERATOR_GREATER:       return QuickForm::QUICK_NUM_GREATER;
+		case Operator::OPERATOR_LESS_EQUAL:    return QuickForm::QUICK_NUM_LESS_EQUAL;
+		case Operator::OPERATOR_GREATER_EQUAL: return QuickForm::QUICK_NUM_GREATER_EQUAL;
+		case Operator::OPERATOR_EQUAL_EQUAL:   return QuickForm::QUICK_NUM_EQUAL;
+		case Operator::OPERATOR_NOT_EQUAL:     return QuickForm::QUICK_NUM_NOT_EQUAL;
+		default:                               return QuickForm::QUICK_GENERIC;
 		}
-		catch (Return& ret)
+	}
+	if (left.is_bool() && right.is_bool())
+	{
+		switch (op)
+		{
+		case Operator::OPERATOR_AND: return QuickForm::QUICK_BOOL_AND;
+		case Operator::OPERATOR_OR:  return QuickForm::QUICK_BOOL_OR;
+		default:                     return QuickForm::QUICK_GENERIC;
+		}
+	}
+	if (left.as<CIL::String>() && right.as<CIL::String>())
+	{
+		switch (op)
 		{
-			delete this->env_;
-			this->env_ = previous;
-			throw ret;
+		case Operator::OPERATOR_ADD:         return QuickForm::QUICK_STR_ADD;
+		case Operator::OPERATOR_EQUAL_EQUAL: return QuickForm::QUICK_STR_EQUAL;
+		case Operator::OPERATOR_NOT_EQUAL:   return QuickForm::QUICK_STR_NOT_EQUAL;
+		default:                             return QuickForm::QUICK_GENERIC;
 		}
 	}
-	delete this->env_;
+	return QuickForm::QUICK_GENERIC;
+}
+
+QuickForm Interpreter::unary_form(UnaryExpression* expr, const value_t& inner)
+{
+	if (!inner.is_num() || !is_variable(expr->expr()))
+	{ return QuickForm::QUICK_GENERIC; }
+	switch (expr->op())
+	{
+	case Operator::OPERATOR_INCREMENT: return QuickForm::QUICK_VAR_INCREMENT;
+	case Operator::OPERATOR_DECREMENT: return QuickForm::QUICK_VAR_DECREMENT;
+	default:                           return QuickForm::QUICK_GENERIC;
+	}
+}
+
+QuickForm Interpreter::assignment_form(AssignmentExpression* expr)
+{
+	return is_variable(expr->target()) ? QuickForm::QUICK_VAR_STORE : QuickForm::QUICK_GENERIC;
+}
+
+void Interpreter::observe(QuickState& quick, QuickForm form)
+{
+	//Chunks running at the same time share the nodes, none of them may rewrite one
+	if (concurrent_ || !quicken_)
+	{ return; }
+	if (form != quick.pending)
+	{
+		quick.pending = form;
+		quick.warmup = 0;
+	}
+	if (form != QuickForm::QUICK_GENERIC && ++quick.warmup >= QUICKEN_AFTER)
+	{
+		quick.form = form;
+		quickened_++;
+	}
+}
+
+void Interpreter::deoptimize(QuickState& quick)
+{
+	if (concurrent_ || !quicken_)
+	{ return; }
+	deopts_++;
+	quick.form = ++quick.deopts >= MAX_DEOPTS ? QuickForm::QUICK_GENERIC : QuickForm::QUICK_UNTRIED;
+	quick.pending = QuickForm::QUICK_UNTRIED;
+	quick.warmup = 0;
+}
+
+Completion Interpreter::visit_block_stmt(BlockStatement* stmt)
+{
+	Environment* previous = this->env_;
+	this->env_ = env_pool_.push(previous);
+	Completion completion = Completion::COMPLETION_NORMAL;
+	for (const stmt_ptr& inner : stmt->inner())
+	{
+		completion = this->visit_stmt(inner);
+		if (completion != Completion::COMPLETION_NORMAL)
+		{ break; }
+	}
+	env_pool_.pop();
 	this->env_ = previous;
+	return completion;
 }
 
-void Interpreter::run_break_stmt(std::shared_ptr<BreakStatement> stmt)
+Completion Interpreter::visit_break_stmt(BreakStatement*)
 {
-	throw Break();
+	return Completion::COMPLETION_BREAK;
 }
 
-void Interpreter::run_return_stmt(std::shared_ptr<ReturnStatement> stmt)
+Completion Interpreter::visit_return_stmt(ReturnStatement* stmt)
 {
-	value_ptr val = this->run_expr(stmt->expr());
-	throw Return(val);
+	if (stmt->expr() && stmt->expr()->is_call_expr())
+	{
+		CallExpression* call = static_cast<CallExpression*>(stmt->expr().get());
+		if (call->tail())
+		{ return tail_call(call); }
+	}
+	return_value_ = this->visit_expr(stmt->expr());
+	return Completion::COMPLETION_RETURN;
 }
 
-void Interpreter::run_print_stmt(std::shared_ptr<PrintStatement> stmt)
+Completion Interpreter::visit_print_stmt(PrintStatement* stmt)
 {
-	value_ptr val = this->run_expr(stmt->expr());
-	std::cout << val->to_string();
+	value_t val = this->visit_expr(stmt->expr());
+	*out_ << val.to_string();
+	return Completion::COMPLETION_NORMAL;
 }
 
-void Interpreter::run_elif_stmt(std::shared_ptr<ElifStatement> stmt)
+Completion Interpreter::visit_elif_stmt(ElifStatement* stmt)
 {
-	if (stmt->cond() == nullptr || run_expr(stmt->cond())->to_bool())
+	if (stmt->cond() == nullptr || visit_expr(stmt->cond()).to_bool())
 	{
-		run_stmt(stmt->inner());
+		return visit_stmt(stmt->inner());
 	}
 	else if (stmt->next_elif() != nullptr)
 	{
-		run_elif_stmt(std::dynamic_pointer_cast<ElifStatement, Statement>(stmt->next_elif()));
+		return visit_stmt(stmt->next_elif());
 	}
+	return Completion::COMPLETION_NORMAL;
 }
 
-void Interpreter::run_if_stmt(std::shared_ptr<IfStatement> stmt)
+Completion Interpreter::visit_if_stmt(IfStatement* stmt)
 {
-	value_ptr val = this->run_expr(stmt->cond());
-	if (val->to_bool())
+	value_t val = this->visit_expr(stmt->cond());
+	if (val.to_bool())
 	{
-		this->run_stmt(stmt->if_branch());
+		return this->visit_stmt(stmt->if_branch());
 	}
 	else if (stmt->top_elif() != nullptr)
 	{
-		run_stmt(stmt->top_elif());
+		return visit_stmt(stmt->top_elif());
 	}
+	return Completion::COMPLETION_NORMAL;
 }
 
-void Interpreter::run_while_stmt(std::shared_ptr<WhileStatement> stmt)
+Completion Interpreter::visit_while_stmt(WhileStatement* stmt)
 {
+	while (this->visit_expr(stmt->cond()).to_bool())
+	{
+		Completion completion = this->visit_stmt(stmt->inner());
+		if (completion == Completion::COMPLETION_BREAK)
+		{ break; }
+		if (completion == Completion::COMPLETION_RETURN)
+		{ return completion; }
+	}
+	return Completion::COMPLETION_NORMAL;
+}
+
+Completion Interpreter::visit_for_stmt(ForStatement* stmt)
+{
+	if (stmt->parallel())
+	{
+		if (!chunk_scope_)
+		{ return run_parallel_for(stmt); }
+
+		//A parallel loop inside a chunk runs on the chunk's thread, in the scope the resolver gave it.
+		//'break' and 'return' cannot leave it, the parser made sure
+		Environment* previous = this->env_;
+		this->env_ = env_pool_.push(previous);
+		for (this->visit_stmt(stmt->init()); this->visit_expr(stmt->cond()).to_bool(); this->visit_expr(stmt->exec()))
+		{ this->visit_stmt(stmt->inner()); }
+		env_pool_.pop();
+		this->env_ = previous;
+		return Completion::COMPLETION_NORMAL;
+	}
+
+	for (
+		this->visit_stmt(stmt->init());
+		this->visit_expr(stmt->cond()).to_bool();
+		this->visit_expr(stmt->exec())
+		)
+	{
+		Completion completion = this->visit_stmt(stmt->inner());
+		if (completion == Completion::COMPLETION_BREAK)
+		{ break; }
+		if (completion == Completion::COMPLETION_RETURN)
+		{ return completion; }
+	}
+	return Completion::COMPLETION_NORMAL;
+}
+
+Completion Interpreter::run_parallel_for(ForStatement* stmt)
+{
+	VarDeclStatement* init = static_cast<VarDeclStatement*>(stmt->init().get());
+	BinaryExpression* cond = static_cast<BinaryExpression*>(stmt->cond().get());
+
+	//The bounds are evaluated once, in a scope standing in for the one the loop variable lives in
+	Environment* previous = this->env_;
+	this->env_ = env_pool_.push(previous);
+	value_t first = this->visit_expr(init->val());
+	value_t last = this->visit_expr(cond->right());
+	env_pool_.pop();
+	this->env_ = previous;
+	if (!first.is_num())
+	{
+		throw CILError::error(init->pos(), "Cannot initialize variable of type '$' with value of type '$'",
+			init->info().type, first.type());
+	}
+	if (!last.is_num())
+	{ throw CILError::error(cond->pos(), "Bound of a parallel loop must be 'num' not '$'", last.type()); }
+
+	double span = last.as_num() - first.as_num();
+	size_t iterations = 0;
+	if (cond->op() == Operator::OPERATOR_LESS_EQUAL)
+	{ iterations = span >= 0 ? (size_t)std::floor(span) + 1 : 0; }
+	else
+	{ iterations = span > 0 ? (size_t)std::ceil(span) : 0; }
+	if (iterations == 0)
+	{ return Completion::COMPLETION_NORMAL; }
+
+	if (!threads_)
+	{
+		if (thread_count_ == 0)
+		{ thread_count_ = std::max<size_t>(std::thread::hardware_concurrency(), 1); }
+		threads_ = std::make_unique<ThreadManager>(thread_count_);
+	}
+	//The first iterations run alone, while the nodes of the body may still be specialized.
+	//The rest is split into a few chunks per thread, so one slow chunk does not hold up the others for long
+	size_t warmup = std::min<size_t>(iterations, QUICKEN_AFTER);
+	size_t rest = iterations - warmup;
+	size_t chunk_count = std::min(rest, thread_count_ * 4);
+	std::vector<Chunk> chunks(chunk_count + 1);
+	double start = first.as_num();
+	std::atomic<size_t> failed{ SIZE_MAX };
+	previous->share_vars(true);
 	try
 	{
-		while (this->run_expr(stmt->cond())->to_bool())
+		run_chunk(stmt, previous, chunks[0], 0, failed, start, start + warmup, false);
+		if (!chunks[0].failure && chunk_count > 0)
 		{
-			this->run_stmt(stmt->inner());
+			std::vector<std::unique_ptr<const JobResult<bool>>> results{};
+			for (size_t i = 0; i < chunk_count; i++)
+			{
+				double begin = start + warmup + (double)(rest * i / chunk_count);
+				double end = start + warmup + (double)(rest * (i + 1) / chunk_count);
+				Chunk* chunk = &chunks[i + 1];
+				std::atomic<size_t>* first_failed = &failed;
+				std::function<bool()> job = [this, stmt, previous, chunk, i, first_failed, begin, end]()
+				{
+					run_chunk(stmt, previous, *chunk, i + 1, *first_failed, begin, end, true);
+					return !chunk->failure;
+				};
+				results.emplace_back(threads_->schedule_func(job));
+			}
+			//Rethrows what escaped a chunk that was not a CILError, once all of them stopped
+			threads_->wait_all();
 		}
 	}
-	catch (Break)
+	catch (...)
+	{
+		previous->share_vars(false);
+		throw;
+	}
+	previous->share_vars(false);
+	parallel_loops_++;
+	chunks_ += chunk_count + 1;
+
+	for (Chunk& chunk : chunks)
 	{
+		*out_ << chunk.out.str();
+		if (chunk.failure)
+		{ throw *chunk.failure; }
 	}
+	return Completion::COMPLETION_NORMAL;
 }
 
-void Interpreter::run_for_stmt(std::shared_ptr<ForStatement> stmt)
+void Interpreter::run_chunk(ForStatement* stmt, Environment* shared, Chunk& chunk, size_t index, std::atomic<size_t>& failed,
+	double begin, double end, bool concurrent)
 {
+	//Chunks run on the threads of threads_, which have to enter the loop's isolate themselves
+	Isolate::Scope scope{ isolate_ };
+	VarDeclStatement* init = static_cast<VarDeclStatement*>(stmt->init().get());
+
+	Interpreter worker{ isolate_ };
+	worker.out_ = &chunk.out;
+	worker.env_ = worker.env_pool_.push(shared);
+	worker.chunk_scope_ = worker.env_;
+	worker.concurrent_ = concurrent;
+	worker.quicken_ = quicken_;
 	try
 	{
-		for (
-			this->run_stmt(stmt->init());
-			this->run_expr(stmt->cond())->to_bool();
-			this->run_expr(stmt->exec())
-			)
+		worker.env_->define_var({ init->info().name, init->info().type, value_t::number(begin) }, init->slot());
+		value_t& var = *worker.env_->get_var(init->info().name).value;
+		//Nothing after a failed chunk is replayed, so it is not run either
+		for (double i = begin; i < end && failed.load(std::memory_order_relaxed) > index; i++)
 		{
-			this->run_stmt(stmt->inner());
+			var = value_t::number(i);
+			worker.visit_stmt(stmt->inner());
 		}
 	}
-	catch (Break)
+	catch (CILError& err)
 	{
+		if (!err.has_pos())
+		{ err.add_range(stmt->pos()); }
+		chunk.failure.emplace(err);
+		size_t first = failed.load(std::memory_order_relaxed);
+		while (index < first && !failed.compare_exchange_weak(first, index, std::memory_order_relaxed))
+		{ }
 	}
 }
 
-void Interpreter::run_var_decl_stmt(std::shared_ptr<VarDeclStatement> stmt)
+void Interpreter::report(const CILError& err)
+{
+	//Errors inside a chunk would otherwise repeat for every iteration
+	if (chunk_scope_)
+	{ throw err; }
+	ErrorManager::cil_error(err);
+}
+
+Completion Interpreter::visit_var_decl_stmt(VarDeclStatement* stmt)
 {
-	value_ptr value = this->run_expr(stmt->val());
+	value_t value = this->visit_expr(stmt->val());
 
-	if (!stmt->info().type.is(value->type()))
+	if (!stmt->info().type.is(value.type()))
 	{
 		throw CILError::error(stmt->pos(), "Cannot initialize variable of type '$' with value of type '$'",
-			stmt->info().type, value->type());
+			stmt->info().type, value.type());
 	}
 	
 	Environment::Variable var{ stmt->info().name, stmt->info().type, value};
 
-	this->env_->define_var(var);
+	this->env_->define_var(var, stmt->slot());
+	return Completion::COMPLETION_NORMAL;
 }
 
-void Interpreter::run_arr_decl_stmt(std::shared_ptr<ArrDeclStatement> stmt)
+Completion Interpreter::visit_arr_decl_stmt(ArrDeclStatement* stmt)
 {
 	if (stmt->info().size != stmt->vals().size())
 	{
 		throw CILError::error(stmt->pos(), "Array of size '$' cannot be initialized with '$' elements",
 			stmt->info().size, stmt->vals().size());
 	}
-	std::vector<value_ptr> vals{};
-	for (expr_ptr expr : stmt->vals())
+	std::vector<value_t> vals{};
+	for (const expr_ptr& expr : stmt->vals())
 	{
-		value_ptr val = this->run_expr(expr);
-		if (!val->type().is(stmt->info().type))
+		value_t val = this->visit_expr(expr);
+		if (!val.type().is(stmt->info().type))
 		{
 			throw CILError::error(stmt->pos(), "Cannot initizalize array of type '$' with value of type '$'",
-				stmt->info().type, val->type());
+				stmt->info().type, val.type());
 		}
 		vals.push_back(val);
 	}
 	
-	Environment::Array arr{ stmt->info().name, stmt->info().size, stmt->info().type, vals};
-	this->env_->define_arr(arr);
+	this->env_->define_arr(Environment::Array::create(stmt->info().name, stmt->info().type, vals));
+	return Completion::COMPLETION_NORMAL;
 }
 
-void Interpreter::run_func_decl_stmt(std::shared_ptr<FuncDeclStatement> stmt)
+Completion Interpreter::visit_func_decl_stmt(FuncDeclStatement* stmt)
 {
 	std::vector<Environment::Variable> args{};
 	for (VarInfo arg : stmt->info().args)
@@ -533,17 +1100,18 @@ void Interpreter::run_func_decl_stmt(std::shared_ptr<FuncDeclStatement> stmt)
 		args.push_back({ arg.name, arg.type, nullptr });
 	}
 	Environment::Function func{ stmt->info().name, stmt->info().ret_type, args, stmt->body() };
-	this->env_->define_func(func);
+	this->env_->define_func(func, stmt->slot());
+	return Completion::COMPLETION_NORMAL;
 }
 
-void Interpreter::run_class_decl_stmt(std::shared_ptr<ClassDeclStatement> stmt)
+Completion Interpreter::visit_class_decl_stmt(ClassDeclStatement* stmt)
 {
 	std::vector<Environment::Function> methods{};
 	std::vector<Environment::Variable> members{};
 
-	for (stmt_ptr s : stmt->methods())
+	for (const stmt_ptr& s : stmt->methods())
 	{
-		std::shared_ptr<FuncDeclStatement> method_ptr = std::dynamic_pointer_cast<FuncDeclStatement, Statement>(s);
+		FuncDeclStatement* method_ptr = static_cast<FuncDeclStatement*>(s.get());
 		std::vector<Environment::Variable> args{};
 		for (VarInfo arg : method_ptr->info().args)
 		{
@@ -552,28 +1120,32 @@ void Interpreter::run_class_decl_stmt(std::shared_ptr<ClassDeclStatement> stmt)
 		methods.push_back({ method_ptr->info().name, method_ptr->info().ret_type, args, method_ptr->body() });
 	}
 
-	for (stmt_ptr s : stmt->members())
+	for (const stmt_ptr& s : stmt->members())
 	{
-		std::shared_ptr<VarDeclStatement> member_ptr = std::dynamic_pointer_cast<VarDeclStatement, Statement>(s);
-		value_ptr value = run_expr(member_ptr->val());
+		VarDeclStatement* member_ptr = static_cast<VarDeclStatement*>(s.get());
+		value_t value = visit_expr(member_ptr->val());
 		members.push_back({ member_ptr->info().name, member_ptr->info().type, value });
 	}
 
 	Environment::Class cls{ stmt->info().name, members, methods };
 	env_->define_class(cls);
+	return Completion::COMPLETION_NORMAL;
 }
 
-void Interpreter::run_expr_stmt(std::shared_ptr<ExprStatement> stmt)
+Completion Interpreter::visit_expr_stmt(ExprStatement* stmt)
 {
-	this->run_expr(stmt->expr());
+	this->visit_expr(stmt->expr());
+	return Completion::COMPLETION_NORMAL;
 }
 
 void Interpreter::define_symbols(SymbolTable& table)
 {
+	Isolate::Scope scope{ isolate_ };
+
 	for (auto& pair : table.vars_)
 	{
 		SymbolTable::Variable& var = pair.second;
-		value_ptr value = var.init_expr == nullptr ? nullptr : this->run_expr(var.init_expr);
+		value_t value = var.init_expr == nullptr ? nullptr : this->visit_expr(var.init_expr);
 		env_->define_var({ var.name, var.type, value });
 	}
 	for (auto& pair : table.funcs_)
@@ -582,7 +1154,7 @@ void Interpreter::define_symbols(SymbolTable& table)
 		std::vector<Environment::Variable> args{};
 		for (SymbolTable::Variable arg : func.args)
 		{
-			value_ptr value = arg.init_expr == nullptr ? nullptr : this->run_expr(arg.init_expr);
+			value_t value = arg.init_expr == nullptr ? nullptr : this->visit_expr(arg.init_expr);
 			args.push_back({ arg.name, arg.type, value });
 		}
 		env_->define_func({ func.name, func.ret_type, args, func.body });
@@ -598,7 +1170,7 @@ void Interpreter::define_symbols(SymbolTable& table)
 			std::vector<Environment::Variable> args{};
 			for (SymbolTable::Variable arg : method.args)
 			{
-				value_ptr value = arg.init_expr == nullptr ? nullptr : this->run_expr(arg.init_expr);
+				value_t value = arg.init_expr == nullptr ? nullptr : this->visit_expr(arg.init_expr);
 				args.push_back({ arg.name, arg.type, value });
 			}
 			methods.push_back({ method.name, method.ret_type, args, method.body });
@@ -606,7 +1178,7 @@ void Interpreter::define_symbols(SymbolTable& table)
 
 		for (SymbolTable::Variable member : cls.members)
 		{
-			value_ptr value = member.init_expr == nullptr ? nullptr : this->run_expr(member.init_expr);
+			value_t value = member.init_expr == nullptr ? nullptr : this->visit_expr(member.init_expr);
 			members.push_back({ member.name, member.type, value });
 		}
 
@@ -616,24 +1188,26 @@ void Interpreter::define_symbols(SymbolTable& table)
 
 void Interpreter::define_global_symbols()
 {
-	for (auto& pair : SymbolTable::global_table_->vars_)
+	Isolate::Scope scope{ isolate_ };
+
+	for (auto& pair : SymbolTable::global_table()->vars_)
 	{
 		SymbolTable::Variable& var = pair.second;
-		value_ptr value = var.init_expr == nullptr ? nullptr : this->run_expr(var.init_expr);
+		value_t value = var.init_expr == nullptr ? nullptr : this->visit_expr(var.init_expr);
 		env_->define_var({ var.name, var.type, value });
 	}
-	for (auto& pair : SymbolTable::global_table_->funcs_)
+	for (auto& pair : SymbolTable::global_table()->funcs_)
 	{
 		SymbolTable::Function& func = pair.second;
 		std::vector<Environment::Variable> args{};
 		for (SymbolTable::Variable arg : func.args)
 		{
-			value_ptr value = arg.init_expr == nullptr ? nullptr : this->run_expr(arg.init_expr);
+			value_t value = arg.init_expr == nullptr ? nullptr : this->visit_expr(arg.init_expr);
 			args.push_back({ arg.name, arg.type, value });
 		}
 		env_->define_func({ func.name, func.ret_type, args, func.body });
 	}
-	for (auto& pair : SymbolTable::global_table_->classes_)
+	for (auto& pair : SymbolTable::global_table()->classes_)
 	{
 		SymbolTable::Class& cls = pair.second;
 		std::vector<Environment::Function> methods{};
@@ -644,7 +1218,7 @@ void Interpreter::define_global_symbols()
 			std::vector<Environment::Variable> args{};
 			for (SymbolTable::Variable arg : method.args)
 			{
-				value_ptr value = arg.init_expr == nullptr ? nullptr : this->run_expr(arg.init_expr);
+				value_t value = arg.init_expr == nullptr ? nullptr : this->visit_expr(arg.init_expr);
 				args.push_back({ arg.name, arg.type, value });
 			}
 			methods.push_back({ method.name, method.ret_type, args, method.body });
@@ -652,10 +1226,24 @@ void Interpreter::define_global_symbols()
 
 		for (SymbolTable::Variable member : cls.members)
 		{
-			value_ptr value = member.init_expr == nullptr ? nullptr : this->run_expr(member.init_expr);
+			value_t value = member.init_expr == nullptr ? nullptr : this->visit_expr(member.init_expr);
 			members.push_back({ member.name, member.type, value });
 		}
 
 		env_->define_class({ cls.name, members, methods });
 	}
 }
+
+void Interpreter::define_global(const std::string& name, value_t value)
+{
+	Isolate::Scope scope{ isolate_ };
+
+	try
+	{
+		env_->define_var({ name, value.type(), value });
+	}
+	catch (CILError& err)
+	{
+		report(err);
+	}
+}
@@ -5,11 +5,20 @@
 #include "../Types/TypeTable.h"
 #include "../Types/cil-types.h"
 #include "Environment.h"
+#include "EnvironmentPool.h"
+#include "ArrayOps.h"
 #include "../Parsing/Expression.h"
 #include "../Parsing/Statement.h"
+#include "../Parsing/ASTVisitor.h"
 #include "../Diagnostics/CILError.h"
 #include "../Diagnostics/Diagnostics.h"
 #include "../Scanning/SymbolTable.h"
+#include "Isolate.h"
+#include "../Utils/Debugging/Profiler.h"
+#include "../Utils/Threading/ThreadManager.h"
+#ifdef CIL_COUNTERS
+#include "../Utils/Debugging/HitCounters.h"
+#endif
 
 #define TRY_OP(op, pos) \
 try                     \
@@ -22,69 +31,233 @@ catch(CILError& err)    \
 	throw err;          \
 }                       \
 
-class Return : public std::exception
+//How a statement finished executing. 'return' and 'break' travel up through
+//run_stmt as a completion instead of a C++ exception, a returned value is
+//kept in Interpreter::return_value_ until the call picks it up.
+enum class Completion
 {
-public:
-	Return(value_ptr ret_val)
-		: ret_val_(ret_val) {}
-
-	value_ptr ret_val()
-	{ return this->ret_val_; }
-private:
-	value_ptr ret_val_;
+	COMPLETION_NORMAL,
+	COMPLETION_BREAK,
+	COMPLETION_RETURN
 };
 
-class Break : public std::exception
-{
-};
-
-class Interpreter
+class Interpreter : public ASTVisitor<Interpreter, value_t, Completion>
 {
+	friend ASTVisitor<Interpreter, value_t, Completion>;
 public:
-	Interpreter();
-	Interpreter(stmt_list& program);
+	Interpreter(Isolate& isolate);
+	Interpreter(Isolate& isolate, stmt_list& program);
 
 	~Interpreter();
 
 	void run();
 
 	void run_single_statement(stmt_ptr stmt);
-	value_ptr run_single_expression(expr_ptr expr);
+	value_t run_single_expression(expr_ptr expr);
 
 	void define_symbols(SymbolTable& table);
 	void define_global_symbols();
+	//Defines a variable for the program that it does not declare itself, hosts pass inputs this way
+	void define_global(const std::string& name, value_t value);
+
+	void dump_stats(std::ostream& os) const;
+
+	//Keeps 'profiler' informed of the CIL call stack, nullptr turns it off again
+	void set_profiler(Profiler* profiler)
+	{ profiler_ = profiler; }
+
+#ifdef CIL_COUNTERS
+	//Counts every statement and call into 'counters', nullptr stops counting
+	void set_counters(HitCounters* counters)
+	{ counters_ = counters; }
+#endif
+
+	//Runs the chunks of parallel loops on 'count' threads, 0 uses one per hardware thread
+	void set_threads(size_t count);
+
+	//Where 'print' writes to, std::cout unless set
+	void set_output(std::ostream* out)
+	{ out_ = out; }
+
+	//Whether the nodes of the program are specialized to the operands they see. Hosts
+	//that run one program on several threads at once turn it off while others may run it
+	void set_quickening(bool quicken)
+	{ quicken_ = quicken; }
 private:
-	value_ptr run_expr(expr_ptr expr);
-
-	value_ptr run_grouping_expr(std::shared_ptr<GroupingExpression> expr);
-	value_ptr run_primary_expr(std::shared_ptr<PrimaryExpression> expr);
-	value_ptr run_call_expr(std::shared_ptr<CallExpression> expr);
-	value_ptr run_access_expr(std::shared_ptr<AccessExpression> expr);
-	value_ptr run_new_expr(std::shared_ptr<NewExpression> expr);
-	value_ptr run_array_access_expr(std::shared_ptr<ArrayAccessExpression> expr);
-	value_ptr run_unary_expr(std::shared_ptr<UnaryExpression> expr);
-	value_ptr run_binary_expr(std::shared_ptr<BinaryExpression> expr);
-	value_ptr run_ternary_expr(std::shared_ptr<TernaryExpression> expr);
-	value_ptr run_assignment_expr(std::shared_ptr<AssignmentExpression> expr);
-
-	void run_stmt(stmt_ptr stmt);
-
-	void run_block_stmt(std::shared_ptr<BlockStatement> stmt);
-	void run_break_stmt(std::shared_ptr<BreakStatement> stmt);
-	void run_return_stmt(std::shared_ptr<ReturnStatement> stmt);
-	void run_print_stmt(std::shared_ptr<PrintStatement> stmt);
-	void run_elif_stmt(std::shared_ptr<ElifStatement> stmt);
-	void run_if_stmt(std::shared_ptr<IfStatement> stmt);
-	void run_while_stmt(std::shared_ptr<WhileStatement> stmt);
-	void run_for_stmt(std::shared_ptr<ForStatement> stmt);
-	void run_var_decl_stmt(std::shared_ptr<VarDeclStatement> stmt);
-	void run_arr_decl_stmt(std::shared_ptr<ArrDeclStatement> stmt);
-	void run_func_decl_stmt(std::shared_ptr<FuncDeclStatement> stmt);
-	void run_class_decl_stmt(std::shared_ptr<ClassDeclStatement> stmt);
-	void run_expr_stmt(std::shared_ptr<ExprStatement> stmt);
+	//Hide the visitor's entry points so every statement passes the profiler and counters
+	Completion visit_stmt(const stmt_ptr& stmt)
+	{ return visit_stmt(stmt.get()); }
+
+	Completion visit_stmt(Statement* stmt)
+	{
+#ifdef CIL_COUNTERS
+		if (counters_)
+		{ counters_->hit(stmt); }
+#endif
+		if (!profiler_)
+		{ return ASTVisitor::visit_stmt(stmt); }
+		return visit_profiled_stmt(stmt);
+	}
+
+	Completion visit_profiled_stmt(Statement* stmt);
+
+	value_t visit_error_expr(ErrorExpression* expr);
+	value_t visit_grouping_expr(GroupingExpression* expr);
+	value_t visit_primary_expr(PrimaryExpression* expr);
+	value_t visit_call_expr(CallExpression* expr);
+	//Calls 'callee' if it is set, the function 'expr' names otherwise
+	value_t call(CallExpression* expr, const Environment::Function* callee);
+	value_t call_intrinsic(CallExpression* expr);
+	value_t visit_access_expr(AccessExpression* expr);
+	value_t visit_new_expr(NewExpression* expr);
+	value_t visit_array_access_expr(ArrayAccessExpression* expr);
+	value_t visit_unary_expr(UnaryExpression* expr);
+	value_t store_back(expr_ptr target, value_t value);
+	value_t visit_binary_expr(BinaryExpression* expr);
+	value_t visit_ternary_expr(TernaryExpression* expr);
+	value_t visit_assignment_expr(AssignmentExpression* expr);
+
+	Completion visit_block_stmt(BlockStatement* stmt);
+	Completion visit_break_stmt(BreakStatement* stmt);
+	Completion visit_return_stmt(ReturnStatement* stmt);
+	Completion visit_print_stmt(PrintStatement* stmt);
+	Completion visit_elif_stmt(ElifStatement* stmt);
+	Completion visit_if_stmt(IfStatement* stmt);
+	Completion visit_while_stmt(WhileStatement* stmt);
+	Completion visit_for_stmt(ForStatement* stmt);
+	Completion visit_var_decl_stmt(VarDeclStatement* stmt);
+	Completion visit_arr_decl_stmt(ArrDeclStatement* stmt);
+	Completion visit_func_decl_stmt(FuncDeclStatement* stmt);
+	Completion visit_class_decl_stmt(ClassDeclStatement* stmt);
+	Completion visit_expr_stmt(ExprStatement* stmt);
+
+	//Parallel loops: the range is split into chunks that run as jobs of threads_,
+	//each on an interpreter of its own whose scope for the loop variable encloses
+	//the scope the loop is in. Chunks may read everything and write array elements,
+	//assigning to a variable that is not their own is an error. Output is held
+	//back and replayed in chunk order once all chunks joined, so a loop behaves
+	//as if its iterations had run in order, as far as it can tell. The first
+	//error stops its chunk and the chunks after it, and the loop fails with it.
+	//Outside of a function that ends the program, like any failed statement does
+	struct Chunk
+	{
+		std::stringstream out;
+		//The error that stopped the chunk, the loop stops with the first of them
+		std::optional<CILError> failure;
+	};
+
+	Completion run_parallel_for(ForStatement* stmt);
+	//'failed' is the index of the first chunk that failed so far, later chunks stop
+	void run_chunk(ForStatement* stmt, Environment* shared, Chunk& chunk, size_t index, std::atomic<size_t>& failed,
+		double begin, double end, bool concurrent);
 
+	//Reports and goes on, but inside a chunk the error stops the chunk instead
+	void report(const CILError& err);
+
+	void check_private(Environment::VarRef var, const Position& pos) const
+	{
+		if (var && var.decl->shared)
+		{ throw CILError::error(pos, "Parallel loop assigns to shared variable '$'", var.decl->name); }
+	}
+
+	//Quickening: nodes start out generic and record the operand types they see.
+	//After QUICKEN_AFTER identical observations they switch to the matching
+	//specialized form, a failed guard sends them back to collecting feedback.
+	static QuickForm binary_form(Operator op, const value_t& left, const value_t& right);
+	static QuickForm unary_form(UnaryExpression* expr, const value_t& inner);
+	static QuickForm assignment_form(AssignmentExpression* expr);
+	void observe(QuickState& quick, QuickForm form);
+	void deoptimize(QuickState& quick);
+
+	//Returns the function a call refers to, without a lookup by name if the
+	//call site already found it and no function was (re)defined since
+	const Environment::Function& lookup_callee(CallExpression* expr);
+
+	//Checks the arguments of a call against the callee and evaluates them onto
+	//args_, bind_arguments moves them into the callee's freshly pushed scope
+	void push_arguments(CallExpression* expr, const Environment::Function& func);
+	void bind_arguments(const Environment::Function& func, size_t args_base);
+
+	//Evaluates the callee and arguments of a call marked as tail call and leaves
+	//them in tail_callee_, the enclosing call then runs it in the same frame
+	Completion tail_call(CallExpression* expr);
+
+	//What a call site remembers about the function it called last
+	struct CallSite
+	{
+		const CallExpression* expr = nullptr;
+		const Environment::Function* func = nullptr;
+		uint64_t epoch = 0;
+	};
+
+	//Inline caches of accesses: the classes an access saw, each with the slot of the
+	//member it reads or the method it calls. After MAX_ACCESS_SHAPES classes the
+	//site is megamorphic and leaves the lookups to the object's scope again.
+	static constexpr size_t MAX_ACCESS_SHAPES = 4;
+
+	struct AccessSite
+	{
+		struct Entry
+		{
+			std::shared_ptr<Environment::Shape> shape = nullptr;
+			int slot = -1;
+			const Environment::Function* method = nullptr;
+		};
+
+		const AccessExpression* expr = nullptr;
+		Entry entries[MAX_ACCESS_SHAPES];
+		size_t size = 0;
+		bool megamorphic = false;
+	};
+
+	//The entry of the class of 'object' in the cache of 'expr', nullptr if the site is megamorphic
+	const AccessSite::Entry* lookup_access(AccessExpression* expr, CIL::Object* object);
+
+	Isolate& isolate_;
 	stmt_list program_;
 
+	EnvironmentPool env_pool_;
 	Environment* env_;
+
+	value_t return_value_;
+
+	std::vector<CallSite> call_sites_;
+	size_t call_site_hits_;
+	size_t call_site_misses_;
+	//Arguments of the calls being set up, they are evaluated in the caller's scope
+	//before the callee's scope exists
+	std::vector<value_t> args_;
+
+	std::vector<AccessSite> access_sites_;
+	size_t access_hits_;
+	size_t access_misses_;
+	size_t megamorphic_sites_;
+	TypeID object_type_;
+
+	bool quicken_;
+	size_t quickened_;
+	size_t deopts_;
+
+	const Environment::Function* tail_callee_;
+	//Functions a chain of tail calls returned through, their return types are
+	//checked once the last callee returns. Every function has one entry, ordered
+	//by its innermost call, so any cycle of tail calls keeps the chain bounded
+	std::vector<const Environment::Function*> tail_returns_;
+	size_t tail_calls_;
+
+	Profiler* profiler_;
+
+	std::ostream* out_;
+	size_t thread_count_;
+	std::unique_ptr<ThreadManager> threads_;
+	size_t parallel_loops_;
+	size_t chunks_;
+	//Set on the interpreters running a chunk: the scope of its loop variable
+	Environment* chunk_scope_;
+	//Other chunks run the same nodes at the same time, so quickening leaves them alone
+	bool concurrent_;
+#ifdef CIL_COUNTERS
+	HitCounters* counters_ = nullptr;
+#endif
 };
 
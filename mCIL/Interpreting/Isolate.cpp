@@ -0,0 +1,38 @@
+#include "Isolate.h"
+
+thread_local Isolate* Isolate::current_ = nullptr;
+
+Isolate::Isolate()
+	: heap_(), types_(), globals_(), diagnostics_(), program_(nullptr), function_epoch_(0), scoped_function_envs_(0)
+{
+	Scope scope{ *this };
+	TypeTable::add_builtin_types();
+}
+
+Isolate::Isolate(Isolate& program)
+	: heap_(), types_(), globals_(), diagnostics_(), program_(&program), function_epoch_(0), scoped_function_envs_(0)
+{
+}
+
+Isolate::~Isolate()
+{
+}
+
+Isolate& Isolate::current()
+{
+	if (current_)
+	{ return *current_; }
+	static Isolate fallback{};
+	return fallback;
+}
+
+Isolate::Scope::Scope(Isolate& isolate)
+	: previous_(current_)
+{
+	current_ = &isolate;
+}
+
+Isolate::Scope::~Scope()
+{
+	current_ = previous_;
+}
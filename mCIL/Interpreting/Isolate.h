@@ -0,0 +1,78 @@
+#pragma once
+#include "../cil-system.h"
+#include "../Types/TypeTable.h"
+#include "../Scanning/SymbolTable.h"
+#include "../Diagnostics/Diagnostics.h"
+#include "../Types/Heap.h"
+#include "../Utils/Threading/ThreadSafeObj.h"
+
+//Everything a program leaves behind outside of its AST and environments: the
+//types it declares, its global symbols, the errors it reported, the heap
+//its strings and objects live on and the state call site caches depend on. Programs in
+//different isolates do not see each other, so they can run on different threads
+//at the same time. Lexer, Scanner, Parser and Interpreter work in the isolate
+//they were created with, the static TypeTable, SymbolTable and ErrorManager APIs
+//use the isolate the calling thread entered last.
+class Isolate
+{
+public:
+	Isolate();
+	//An isolate for one run of a program compiled in 'program'. It uses the types and
+	//global symbols of 'program', which has to outlive it, everything else is its own
+	explicit Isolate(Isolate& program);
+	~Isolate();
+
+	Isolate(const Isolate&) = delete;
+	Isolate& operator=(const Isolate&) = delete;
+
+	TypeTable& types()
+	{ return program_ ? program_->types_ : types_; }
+	ThreadSafeObj<SymbolTable>& globals()
+	{ return program_ ? program_->globals_ : globals_; }
+	ErrorLog& diagnostics()
+	{ return diagnostics_; }
+	Heap& heap()
+	{ return heap_; }
+
+	//Advances whenever a function is defined, dropped or spliced into a scope chain
+	//of this isolate, call sites keep the function they found until it does
+	uint64_t function_epoch() const
+	{ return function_epoch_.load(std::memory_order_relaxed); }
+	void functions_changed()
+	{ function_epoch_.fetch_add(1, std::memory_order_relaxed); }
+
+	//Live environments with an enclosing scope that define functions, no call site
+	//caches a function while there are any
+	std::atomic<size_t>& scoped_function_envs()
+	{ return scoped_function_envs_; }
+
+	//The isolate the calling thread is in, a thread that never entered one
+	//shares a default isolate with every other such thread
+	static Isolate& current();
+
+	//Enters 'isolate' on the calling thread until the scope ends
+	class Scope
+	{
+	public:
+		Scope(Isolate& isolate);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	private:
+		Isolate* previous_;
+	};
+private:
+	//First so it outlives the strings held by the global symbols
+	Heap heap_;
+	TypeTable types_;
+	ThreadSafeObj<SymbolTable> globals_;
+	ErrorLog diagnostics_;
+	Isolate* program_;
+
+	//Parallel loops run on several threads of one isolate
+	std::atomic<uint64_t> function_epoch_;
+	std::atomic<size_t> scoped_function_envs_;
+
+	static thread_local Isolate* current_;
+};
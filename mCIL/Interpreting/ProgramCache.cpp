@@ -0,0 +1,90 @@
+#include "ProgramCache.h"
+
+ProgramCache::ProgramCache(size_t capacity)
+	: capacity_(capacity == 0 ? 1 : capacity), entries_(), index_(), stats_(), lock_()
+{
+}
+
+uint64_t ProgramCache::hash(const std::string& source, bool optimize)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : source)
+	{
+		hash ^= (unsigned char)c;
+		hash *= 1099511628211ull;
+	}
+	hash ^= optimize ? 1 : 0;
+	hash *= 1099511628211ull;
+	return hash;
+}
+
+std::shared_ptr<const CompiledProgram> ProgramCache::get(const std::string& source, bool optimize)
+{
+	uint64_t key = hash(source, optimize);
+	{
+		std::unique_lock lock{ lock_ };
+		auto found = index_.find(key);
+		//The source is compared as well, two sources with the same hash take turns in the entry
+		if (found != index_.end() && found->second->program->source() == source)
+		{
+			entries_.splice(entries_.begin(), entries_, found->second);
+			stats_.hits++;
+			stats_.saved_ms += found->second->program->compile_ms();
+			return found->second->program;
+		}
+	}
+
+	std::shared_ptr<const CompiledProgram> program = CompiledProgram::compile(source, optimize);
+
+	std::unique_lock lock{ lock_ };
+	stats_.misses++;
+	stats_.compile_ms += program->compile_ms();
+	auto found = index_.find(key);
+	if (found != index_.end())
+	{
+		entries_.erase(found->second);
+		index_.erase(found);
+	}
+	entries_.push_front({ key, program });
+	index_[key] = entries_.begin();
+	while (entries_.size() > capacity_)
+	{
+		index_.erase(entries_.back().key);
+		entries_.pop_back();
+		stats_.evictions++;
+	}
+	return program;
+}
+
+ProgramCache::Stats ProgramCache::stats() const
+{
+	std::unique_lock lock{ lock_ };
+	return stats_;
+}
+
+size_t ProgramCache::size() const
+{
+	std::unique_lock lock{ lock_ };
+	return entries_.size();
+}
+
+void ProgramCache::clear()
+{
+	std::unique_lock lock{ lock_ };
+	entries_.clear();
+	index_.clear();
+}
+
+void ProgramCache::dump_stats(std::ostream& os) const
+{
+	Stats stats = this->stats();
+	os << "Program cache:\n"
+	   << "  programs:          " << size() << " of " << capacity_ << "\n"
+	   << "  hits:              " << stats.hits << "\n"
+	   << "  misses:            " << stats.misses << "\n"
+	   << "  evictions:         " << stats.evictions << "\n"
+	   << std::fixed << std::setprecision(3)
+	   << "  compile ms:        " << stats.compile_ms << "\n"
+	   << "  saved ms:          " << stats.saved_ms << "\n"
+	   << "  saved ms per run:  " << stats.saved_per_run() << "\n";
+}
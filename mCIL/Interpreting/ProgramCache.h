@@ -0,0 +1,52 @@
+#pragma once
+#include "../cil-system.h"
+#include "CompiledProgram.h"
+
+//Compiled programs by a hash of their source, for hosts that run the same
+//scripts over and over. Once more than 'capacity' programs are held, the least
+//recently used one is dropped, programs already handed out stay valid. Several
+//threads may use one cache, a source two of them miss at the same time is
+//compiled by both and the later one is kept.
+class ProgramCache
+{
+public:
+	struct Stats
+	{
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t evictions = 0;
+		//Spent compiling on misses, and what hits did not spend because the program was compiled already
+		double compile_ms = 0;
+		double saved_ms = 0;
+
+		double saved_per_run() const
+		{ return hits + misses == 0 ? 0 : saved_ms / (hits + misses); }
+	};
+
+	ProgramCache(size_t capacity = 64);
+
+	std::shared_ptr<const CompiledProgram> get(const std::string& source, bool optimize = true);
+
+	Stats stats() const;
+	size_t size() const;
+	void clear();
+
+	void dump_stats(std::ostream& os) const;
+private:
+	struct Entry
+	{
+		uint64_t key;
+		std::shared_ptr<const CompiledProgram> program;
+	};
+
+	//64-bit FNV-1a over the source and whether it is optimized
+	static uint64_t hash(const std::string& source, bool optimize);
+
+	size_t capacity_;
+	//Most recently used first
+	std::list<Entry> entries_;
+	std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+	Stats stats_;
+
+	mutable std::mutex lock_;
+};
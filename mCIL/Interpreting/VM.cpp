@@ -0,0 +1,797 @@
+#include "VM.h"
+#include "ArrayOps.h"
+#include "Isolate.h"
+
+#define VM_UNARY_OP(method)                       \
+{                                                 \
+	value_t inner = pop();                      \
+	if (is_error(inner))                          \
+	{ push(CIL::ErrorValue::create()); break; }   \
+	TRY_VM_OP(push(inner.method()));             \
+	break;                                        \
+}
+
+#define VM_BINARY_OP(method)                      \
+{                                                 \
+	value_t right = pop();                      \
+	value_t left = pop();                       \
+	if (is_error(right))                          \
+	{ push(CIL::ErrorValue::create()); break; }   \
+	TRY_VM_OP(push(left.method(right)));         \
+	break;                                        \
+}
+
+#define TRY_VM_OP(op)                             \
+try                                               \
+{                                                 \
+	op;                                           \
+}                                                 \
+catch (CILError& err)                             \
+{                                                 \
+	err.add_range(current_pos());                 \
+	throw err;                                    \
+}
+
+VM::VM()
+	: program_(), compiler_(), functions_(), stack_(), env_pool_(), scopes_(), frames_(), guards_(), parallel_(), call_sites_(),
+	  call_site_hits_(0), call_site_misses_(0), tail_returns_(), tail_calls_(0), env_(),
+	  error_type_(type_id("error")), num_type_(type_id("num")), object_type_(type_id("object"))
+{
+	this->env_ = env_pool_.push(nullptr);
+	scopes_.push_back({ env_, true });
+	stack_.reserve(256);
+}
+
+VM::VM(stmt_list& program)
+	: program_(program), compiler_(), functions_(), stack_(), env_pool_(), scopes_(), frames_(), guards_(), parallel_(), call_sites_(),
+	  call_site_hits_(0), call_site_misses_(0), tail_returns_(), tail_calls_(0), env_(),
+	  error_type_(type_id("error")), num_type_(type_id("num")), object_type_(type_id("object"))
+{
+	this->env_ = env_pool_.push(nullptr);
+	scopes_.push_back({ env_, true });
+	stack_.reserve(256);
+}
+
+VM::~VM()
+{
+	unwind_scopes(0);
+}
+
+void VM::dump_stats(std::ostream& os) const
+{
+	env_pool_.dump_stats(os);
+	os << "Call sites:\n"
+	   << "  cached callees:    " << call_site_hits_ << "\n"
+	   << "  uncached lookups:  " << call_site_misses_ << "\n"
+	   << "  tail calls:        " << tail_calls_ << "\n";
+}
+
+void VM::run()
+{
+	for (const stmt_ptr& stmt : program_)
+	{
+		try
+		{
+			this->run_chunk(compiler_.compile_statement(stmt));
+		}
+		catch (CILError& err)
+		{
+			if (!err.has_pos())
+			{ err.add_range(stmt->pos()); }
+			ErrorManager::cil_error(err);
+			break;
+		}
+	}
+}
+
+value_t VM::run_expr(expr_ptr expr)
+{
+	this->run_chunk(compiler_.compile_expression(expr));
+	return pop();
+}
+
+void VM::run_chunk(chunk_ptr chunk)
+{
+	frames_.push_back({ chunk.get(), chunk->code(), stack_.size(), scopes_.size(), nullptr, Position(0, 0), tail_returns_.size() });
+	this->execute(frames_.size() - 1);
+}
+
+chunk_ptr VM::function_chunk(const Environment::Function& func)
+{
+	auto it = functions_.find(func.body.get());
+	if (it != functions_.end())
+	{ return it->second; }
+
+	chunk_ptr chunk = compiler_.compile_function(func.body);
+	functions_.insert({ func.body.get(), chunk });
+	return chunk;
+}
+
+void VM::execute(size_t base_depth)
+{
+	CallFrame* frame = &frames_.back();
+	const uint8_t* ip = frame->ip;
+	const uint8_t* op_start = ip;
+
+	auto read_short = [&ip]() -> uint16_t
+	{
+		uint16_t value = (uint16_t)(ip[0] | (ip[1] << 8));
+		ip += 2;
+		return value;
+	};
+	auto current_pos = [&frame, &op_start]() -> Position
+	{ return frame->chunk->pos_at(op_start - frame->chunk->code()); };
+
+	while (true)
+	{
+		try
+		{
+			while (true)
+			{
+				op_start = ip;
+				switch ((OpCode)*ip++)
+				{
+				case OpCode::OP_NONE:
+					push(CIL::None::create());
+					break;
+				case OpCode::OP_TRUE:
+					push(CIL::Bool::create(true));
+					break;
+				case OpCode::OP_FALSE:
+					push(CIL::Bool::create(false));
+					break;
+				case OpCode::OP_NUMBER:
+					push(CIL::Number::create(frame->chunk->number(read_short())));
+					break;
+				case OpCode::OP_STRING:
+					push(frame->chunk->string(read_short()));
+					break;
+				case OpCode::OP_ERROR:
+					push(CIL::ErrorValue::create());
+					break;
+				case OpCode::OP_GET_VAR:
+				{
+					const std::string& name = frame->chunk->name(read_short());
+					try
+					{
+						push(*env_->get_var(name).value);
+					}
+					catch (CILError& err)
+					{
+						if (!err.has_pos())
+						{ err.add_range(current_pos()); }
+						report(err);
+						push(CIL::ErrorValue::create());
+					}
+					break;
+				}
+				case OpCode::OP_SET_VAR:
+				{
+					const std::string& name = frame->chunk->name(read_short());
+					value_t& value = stack_.back();
+					if (!is_error(value))
+					{
+						Environment::VarRef var = env_->find_var(name);
+						check_private(var, current_pos());
+						if (var)
+						{ *var.value = value; }
+					}
+					break;
+				}
+				case OpCode::OP_GET_LOCAL:
+				{
+					const std::string& name = frame->chunk->name(read_short());
+					uint16_t depth = read_short();
+					uint16_t slot = read_short();
+					try
+					{
+						push(*env_->get_var(depth, slot, name).value);
+					}
+					catch (CILError& err)
+					{
+						if (!err.has_pos())
+						{ err.add_range(current_pos()); }
+						report(err);
+						push(CIL::ErrorValue::create());
+					}
+					break;
+				}
+				case OpCode::OP_SET_LOCAL:
+				{
+					const std::string& name = frame->chunk->name(read_short());
+					uint16_t depth = read_short();
+					uint16_t slot = read_short();
+					value_t& value = stack_.back();
+					if (!is_error(value))
+					{
+						Environment::VarRef var = env_->find_var(depth, slot, name);
+						check_private(var, current_pos());
+						if (var)
+						{ *var.value = value; }
+					}
+					break;
+				}
+				case OpCode::OP_GET_ELEMENT:
+				{
+					const std::string& name = frame->chunk->name(read_short());
+					value_t index_num = pop();
+					if (!index_num.is_num())
+					{ throw CILError::error(current_pos(), "Index must be 'num' not '$'", index_num.type()); }
+					int index = (int)index_num.as_num();
+					Environment::Array& arr = env_->get_arr(name);
+					if (index < 0 || (size_t)index >= arr.size)
+					{ throw CILError::error(current_pos(), "Index must be in the range [$,$[", 0, arr.size); }
+					push(arr.get(index));
+					break;
+				}
+				case OpCode::OP_SET_ELEMENT:
+				{
+					const std::string& name = frame->chunk->name(read_short());
+					value_t index_num = pop();
+					value_t& value = stack_.back();
+					if (is_error(value))
+					{ break; }
+					if (!index_num.is_num())
+					{ throw CILError::error(current_pos(), "Index must be 'num' not '$'", index_num.type()); }
+					int index = (int)index_num.as_num();
+					Environment::Array& arr = env_->get_arr(name);
+					if (index < 0 || (size_t)index >= arr.size)
+					{ throw CILError::error(current_pos(), "Index must be in the range [$,$[", 0, arr.size); }
+					if (!value.type().is(arr.type))
+					{
+						throw CILError::error(current_pos(), "Cannot assign value of type '$' to element of array of type '$'",
+							value.type(), arr.type);
+					}
+					arr.set(index, value);
+					break;
+				}
+				case OpCode::OP_NEW:
+				{
+					Environment::Class& cls = env_->get_class(frame->chunk->name(read_short()));
+					Heap::current().maybe_collect();
+					push(CIL::Object::create(cls.shape));
+					break;
+				}
+				case OpCode::OP_ENTER_OBJECT:
+				{
+					const std::string& name = frame->chunk->name(read_short());
+					if (!parallel_.empty())
+					{ throw CILError::error(current_pos(), "Objects cannot be accessed inside a parallel loop"); }
+					Environment::VarRef var = env_->get_var(name);
+					if (!var.decl->type.is_subtype_of(object_type_))
+					{ throw CILError::error(current_pos(), "Can only access variables of objects, got '$'", var.decl->type); }
+					Environment* obj_env = env_pool_.push(env_);
+					obj_env->bind_object(*var.value);
+					push_scope(obj_env, true);
+					break;
+				}
+				case OpCode::OP_LEAVE_OBJECT:
+					pop_scope();
+					break;
+				case OpCode::OP_BEGIN_CALL:
+				{
+					const std::string& name = frame->chunk->name(read_short());
+					uint16_t argc = read_short();
+					uint16_t depth = read_short();
+					uint16_t slot = read_short();
+					uint16_t site = read_short();
+					uint16_t resume = read_short();
+
+					Position pos = current_pos();
+					guards_.push_back({ nullptr, stack_.size(), scopes_.size(), frames_.size(), ip + resume, pos });
+
+					const Environment::Function& func = lookup_callee(site, name, depth, slot);
+					if (!func.body)
+					{
+						throw CILError::error(pos, "Function '$' was declared but never defined", func.name);
+					}
+					if (argc != func.parameters.size())
+					{
+						//Arguments have to match the parameter count exactly
+						throw CILError::error(pos, "Function '$' expects $ arguments, got $",
+							func.name.c_str(), func.parameters.size(), argc);
+					}
+					guards_.back().func = &func;
+					break;
+				}
+				case OpCode::OP_INTRINSIC:
+				{
+					const std::string& name = frame->chunk->name(read_short());
+					Intrinsic intrinsic = (Intrinsic)read_short();
+					uint16_t argc = read_short();
+					if (!parallel_.empty() && ArrayOps::writes(intrinsic))
+					{ throw CILError::error(current_pos(), "'$' cannot write whole arrays inside a parallel loop", name); }
+					std::vector<ArrayOps::Operand> operands(argc);
+					//The evaluated arguments are on the stack in the order of the call
+					const uint8_t* args = ip;
+					size_t stack_base = stack_.size();
+					for (uint16_t i = 0; i < argc; i++)
+					{
+						if (read_short() == UINT16_MAX)
+						{ stack_base--; }
+					}
+					ip = args;
+					size_t stack_arg = stack_base;
+					for (uint16_t i = 0; i < argc; i++)
+					{
+						uint16_t arg = read_short();
+						if (arg == UINT16_MAX)
+						{
+							operands[i].value = std::move(stack_[stack_arg++]);
+							continue;
+						}
+						const std::string& arg_name = frame->chunk->name(arg);
+						operands[i].array = env_->find_arr(arg_name);
+						if (operands[i].array)
+						{ continue; }
+						try
+						{
+							operands[i].value = *env_->get_var(arg_name).value;
+						}
+						catch (CILError& err)
+						{
+							if (!err.has_pos())
+							{ err.add_range(current_pos()); }
+							report(err);
+							operands[i].value = CIL::ErrorValue::create();
+						}
+					}
+					stack_.resize(stack_base);
+					TRY_VM_OP(push(ArrayOps::call(intrinsic, name, operands)));
+					break;
+				}
+				case OpCode::OP_CALL:
+				case OpCode::OP_TAIL_CALL:
+				{
+					CallGuard& guard = guards_.back();
+					const Environment::Function& func = *guard.func;
+					size_t args_base = stack_.size() - func.parameters.size();
+					for (size_t i = 0; i < func.parameters.size(); i++)
+					{
+						value_t& arg_val = stack_[args_base + i];
+						Type required_type = func.parameters[i].type;
+						if (!arg_val.type().is(required_type))
+						{
+							throw CILError::error(guard.pos, "Argument '$' of function '$' must be '$' not '$'",
+								func.parameters[i].name.c_str(), func.name.c_str(), required_type, arg_val.type());
+						}
+					}
+					chunk_ptr chunk = function_chunk(func);
+
+					//A tail call replaces the frame and scope of the function that made it, so
+					//a chain of them runs in one frame. The callee encloses the caller's scope
+					if ((OpCode)*op_start == OpCode::OP_TAIL_CALL && frame->func && frames_.size() - 1 > base_depth)
+					{
+						//A function called again moves its entry to the innermost position
+						auto returned = std::find(tail_returns_.begin() + frame->tail_base, tail_returns_.end(), frame->func);
+						if (returned == tail_returns_.end())
+						{ tail_returns_.push_back(frame->func); }
+						else
+						{ std::rotate(returned, returned + 1, tail_returns_.end()); }
+
+						for (size_t i = 0; i < func.parameters.size(); i++)
+						{ stack_[frame->stack_base + i] = std::move(stack_[args_base + i]); }
+						args_base = frame->stack_base;
+						guards_.pop_back();
+						unwind_scopes(frame->scope_base);
+
+						Environment* call_env = env_pool_.push(env_);
+						for (size_t i = 0; i < func.parameters.size(); i++)
+						{
+							value_t& arg_val = stack_[args_base + i];
+							call_env->define_var({ func.parameters[i].name, arg_val.type(), arg_val }, (int)i);
+						}
+						stack_.resize(args_base);
+						push_scope(call_env, true);
+
+						frame->chunk = chunk.get();
+						frame->func = &func;
+						frame->ip = chunk->code();
+						ip = frame->ip;
+						tail_calls_++;
+						break;
+					}
+
+					Environment* call_env = env_pool_.push(env_);
+					for (size_t i = 0; i < func.parameters.size(); i++)
+					{
+						value_t& arg_val = stack_[args_base + i];
+						call_env->define_var({ func.parameters[i].name, arg_val.type(), arg_val }, (int)i);
+					}
+					stack_.resize(args_base);
+
+					Position call_pos = guard.pos;
+					guards_.pop_back();
+
+					frame->ip = ip;
+					push_scope(call_env, true);
+					frames_.push_back({ chunk.get(), chunk->code(), stack_.size(), scopes_.size() - 1, &func, call_pos, tail_returns_.size() });
+					frame = &frames_.back();
+					ip = frame->ip;
+					break;
+				}
+				case OpCode::OP_RETURN:
+				case OpCode::OP_RETURN_DEFAULT:
+				{
+					value_t value;
+					if ((OpCode)*op_start == OpCode::OP_RETURN)
+					{
+						value = pop();
+						//Every function of a tail-call chain checks the value it returns once, innermost
+						//first, like nested calls would. A failed check returns an error to the next one
+						auto check_return = [this, &value](const Environment::Function& returned)
+						{
+							if (!value.type().is(returned.ret_type))
+							{
+								report(CILError::error(returned.body->pos(), "Function '$' should return '$' not '$'",
+									returned.name, returned.ret_type, value.type()));
+								value = CIL::ErrorValue::create();
+							}
+						};
+						check_return(*frame->func);
+						for (size_t i = tail_returns_.size(); i > frame->tail_base; i--)
+						{
+							if (tail_returns_[i - 1] != frame->func)
+							{ check_return(*tail_returns_[i - 1]); }
+						}
+					}
+					else
+					{
+						//Falling off the end returns an error value, like the interpreter
+						value = CIL::ErrorValue::create();
+					}
+					tail_returns_.resize(frame->tail_base);
+					stack_.resize(frame->stack_base);
+					unwind_scopes(frame->scope_base);
+					frames_.pop_back();
+
+					frame = &frames_.back();
+					ip = frame->ip;
+					push(value);
+					break;
+				}
+				case OpCode::OP_INVERT:
+					VM_UNARY_OP(invert);
+				case OpCode::OP_INCREMENT:
+					VM_UNARY_OP(increment);
+				case OpCode::OP_DECREMENT:
+					VM_UNARY_OP(decrement);
+				case OpCode::OP_BITWISE_NOT:
+					VM_UNARY_OP(bitwise_not);
+				case OpCode::OP_ADD:
+					VM_BINARY_OP(add);
+				case OpCode::OP_SUBTRACT:
+					VM_BINARY_OP(subtract);
+				case OpCode::OP_MULTIPLY:
+					VM_BINARY_OP(multiply);
+				case OpCode::OP_DIVIDE:
+					VM_BINARY_OP(divide);
+				case OpCode::OP_LEFT_BITSHIFT:
+					VM_BINARY_OP(left_bitshift);
+				case OpCode::OP_RIGHT_BITSHIFT:
+					VM_BINARY_OP(right_bitshift);
+				case OpCode::OP_GREATER:
+					VM_BINARY_OP(greater);
+				case OpCode::OP_LESS:
+					VM_BINARY_OP(less);
+				case OpCode::OP_GREATER_EQUAL:
+					VM_BINARY_OP(greater_equals);
+				case OpCode::OP_LESS_EQUAL:
+					VM_BINARY_OP(less_equals);
+				case OpCode::OP_EQUAL:
+					VM_BINARY_OP(equals);
+				case OpCode::OP_NOT_EQUAL:
+					VM_BINARY_OP(not_equals);
+				case OpCode::OP_AND:
+					VM_BINARY_OP(logical_and);
+				case OpCode::OP_OR:
+					VM_BINARY_OP(logical_or);
+				case OpCode::OP_BITWISE_AND:
+					VM_BINARY_OP(bitwise_and);
+				case OpCode::OP_BITWISE_OR:
+					VM_BINARY_OP(bitwise_or);
+				case OpCode::OP_BITWISE_XOR:
+					VM_BINARY_OP(bitwise_xor);
+				case OpCode::OP_JUMP:
+				{
+					uint16_t offset = read_short();
+					ip += offset;
+					break;
+				}
+				case OpCode::OP_JUMP_IF_FALSE:
+				{
+					uint16_t offset = read_short();
+					if (!pop().to_bool())
+					{ ip += offset; }
+					break;
+				}
+				case OpCode::OP_JUMP_IF_ERROR:
+				{
+					uint16_t offset = read_short();
+					if (is_error(stack_.back()))
+					{ ip += offset; }
+					break;
+				}
+				case OpCode::OP_LOOP:
+				{
+					uint16_t offset = read_short();
+					ip -= offset;
+					break;
+				}
+				case OpCode::OP_POP:
+					stack_.pop_back();
+					break;
+				case OpCode::OP_PRINT:
+					std::cout << pop().to_string();
+					break;
+				case OpCode::OP_PUSH_SCOPE:
+					push_scope(env_pool_.push(env_), true);
+					break;
+				case OpCode::OP_POP_SCOPE:
+					pop_scope();
+					break;
+				case OpCode::OP_BEGIN_PARALLEL:
+					//Loops nested in a parallel loop run as part of its iterations
+					if (parallel_.empty())
+					{ env_->share_vars(true); }
+					parallel_.push_back({ stack_.size(), scopes_.size(), frames_.size(), guards_.size() });
+					push_scope(env_pool_.push(env_), true);
+					break;
+				case OpCode::OP_END_PARALLEL:
+					pop_scope();
+					parallel_.pop_back();
+					if (parallel_.empty())
+					{ env_->share_vars(false); }
+					break;
+				case OpCode::OP_DEFINE_VAR:
+				{
+					VarDeclStatement* stmt = static_cast<VarDeclStatement*>(frame->chunk->decl(read_short()));
+					value_t value = pop();
+					if (!stmt->info().type.is(value.type()))
+					{
+						throw CILError::error(stmt->pos(), "Cannot initialize variable of type '$' with value of type '$'",
+							stmt->info().type, value.type());
+					}
+					env_->define_var({ stmt->info().name, stmt->info().type, value }, stmt->slot());
+					break;
+				}
+				case OpCode::OP_DEFINE_ARR:
+				{
+					ArrDeclStatement* stmt = static_cast<ArrDeclStatement*>(frame->chunk->decl(read_short()));
+					size_t vals_base = stack_.size() - stmt->vals().size();
+					if ((size_t)stmt->info().size != stmt->vals().size())
+					{
+						throw CILError::error(stmt->pos(), "Array of size '$' cannot be initialized with '$' elements",
+							stmt->info().size, stmt->vals().size());
+					}
+					std::vector<value_t> vals{};
+					for (size_t i = vals_base; i < stack_.size(); i++)
+					{
+						if (!stack_[i].type().is(stmt->info().type))
+						{
+							throw CILError::error(stmt->pos(), "Cannot initizalize array of type '$' with value of type '$'",
+								stmt->info().type, stack_[i].type());
+						}
+						vals.push_back(stack_[i]);
+					}
+					stack_.resize(vals_base);
+					env_->define_arr(Environment::Array::create(stmt->info().name, stmt->info().type, vals));
+					break;
+				}
+				case OpCode::OP_DEFINE_FUNC:
+				{
+					FuncDeclStatement* stmt = static_cast<FuncDeclStatement*>(frame->chunk->decl(read_short()));
+					std::vector<Environment::Variable> args{};
+					for (VarInfo arg : stmt->info().args)
+					{
+						args.push_back({ arg.name, arg.type, nullptr });
+					}
+					env_->define_func({ stmt->info().name, stmt->info().ret_type, args, stmt->body() }, stmt->slot());
+					break;
+				}
+				case OpCode::OP_DEFINE_CLASS:
+				{
+					ClassDeclStatement* stmt = static_cast<ClassDeclStatement*>(frame->chunk->decl(read_short()));
+					std::vector<Environment::Function> methods{};
+					std::vector<Environment::Variable> members{};
+
+					for (const stmt_ptr& s : stmt->methods())
+					{
+						FuncDeclStatement* method_ptr = static_cast<FuncDeclStatement*>(s.get());
+						std::vector<Environment::Variable> args{};
+						for (VarInfo arg : method_ptr->info().args)
+						{
+							args.push_back({ arg.name, arg.type, nullptr });
+						}
+						methods.push_back({ method_ptr->info().name, method_ptr->info().ret_type, args, method_ptr->body() });
+					}
+
+					size_t members_base = stack_.size() - stmt->members().size();
+					for (size_t i = 0; i < stmt->members().size(); i++)
+					{
+						VarDeclStatement* member_ptr = static_cast<VarDeclStatement*>(stmt->members()[i].get());
+						members.push_back({ member_ptr->info().name, member_ptr->info().type, stack_[members_base + i] });
+					}
+					stack_.resize(members_base);
+
+					env_->define_class({ stmt->info().name, members, methods });
+					break;
+				}
+				case OpCode::OP_END:
+					frames_.pop_back();
+					return;
+				default:
+					throw CILError::error(current_pos(), "Unknown opcode '$'", (int)*op_start);
+				}
+			}
+		}
+		catch (CILError& err)
+		{
+			if (!recover(err, base_depth))
+			{ throw; }
+			frame = &frames_.back();
+			ip = frame->ip;
+		}
+	}
+}
+
+bool VM::recover(CILError& err, size_t base_depth)
+{
+	//Nothing inside a parallel loop recovers, the error leaves the outermost one as if it was raised there
+	if (!parallel_.empty() && parallel_.front().frame_depth > base_depth)
+	{
+		ParallelLoop loop = parallel_.front();
+		parallel_.clear();
+		if (!err.has_pos() && frames_.size() > loop.frame_depth)
+		{ err.add_range(frames_.back().call_pos); }
+		if (frames_.size() > loop.frame_depth)
+		{ tail_returns_.resize(frames_[loop.frame_depth].tail_base); }
+		while (frames_.size() > loop.frame_depth)
+		{ frames_.pop_back(); }
+		while (guards_.size() > loop.guard_base)
+		{ guards_.pop_back(); }
+		stack_.resize(loop.stack_base);
+		unwind_scopes(loop.scope_base);
+		env_->share_vars(false);
+	}
+
+	//Errors inside the arguments of a call are reported at the call
+	if (!guards_.empty() && guards_.back().frame_depth == frames_.size())
+	{
+		CallGuard guard = guards_.back();
+		guards_.pop_back();
+		stack_.resize(guard.stack_base);
+		unwind_scopes(guard.scope_base);
+		if (!err.has_pos())
+		{ err.add_range(guard.pos); }
+		ErrorManager::cil_error(err);
+		push(CIL::ErrorValue::create());
+		frames_.back().ip = guard.resume;
+		return true;
+	}
+
+	//Errors inside a function body abort the call, the caller continues
+	if (frames_.size() - 1 > base_depth)
+	{
+		CallFrame callee = frames_.back();
+		frames_.pop_back();
+		tail_returns_.resize(callee.tail_base);
+		stack_.resize(callee.stack_base);
+		unwind_scopes(callee.scope_base);
+		if (!err.has_pos())
+		{ err.add_range(callee.call_pos); }
+		ErrorManager::cil_error(err);
+		push(CIL::ErrorValue::create());
+		return true;
+	}
+
+	CallFrame base = frames_.back();
+	frames_.pop_back();
+	tail_returns_.resize(base.tail_base);
+	stack_.resize(base.stack_base);
+	unwind_scopes(base.scope_base);
+	while (!guards_.empty() && guards_.back().frame_depth > frames_.size())
+	{ guards_.pop_back(); }
+	return false;
+}
+
+const Environment::Function& VM::lookup_callee(uint16_t site, const std::string& name, uint16_t depth, uint16_t slot)
+{
+	uint64_t epoch = Isolate::current().function_epoch();
+	if (site != UINT16_MAX && site < call_sites_.size() && call_sites_[site].func && call_sites_[site].epoch == epoch)
+	{
+		call_site_hits_++;
+		return *call_sites_[site].func;
+	}
+
+	call_site_misses_++;
+	bool cacheable = false;
+	const Environment::Function& func = depth == UINT16_MAX
+		? env_->get_func(0, -1, name, cacheable) : env_->get_func(depth, slot, name, cacheable);
+	if (cacheable && site != UINT16_MAX)
+	{
+		if (site >= call_sites_.size())
+		{ call_sites_.resize(site + 1); }
+		call_sites_[site] = { &func, epoch };
+	}
+	return func;
+}
+
+void VM::report(const CILError& err)
+{
+	//Errors inside a parallel loop stop it, they would otherwise repeat for every iteration
+	if (!parallel_.empty())
+	{ throw err; }
+	ErrorManager::cil_error(err);
+}
+
+void VM::push_scope(Environment* env, bool owned)
+{
+	scopes_.push_back({ env, owned });
+	env_ = env;
+}
+
+void VM::pop_scope()
+{
+	Scope scope = scopes_.back();
+	scopes_.pop_back();
+	if (scope.owned)
+	{ env_pool_.pop(); }
+	else
+	{ scope.env->rem_enclosing(); }
+	env_ = scopes_.empty() ? nullptr : scopes_.back().env;
+}
+
+void VM::unwind_scopes(size_t base)
+{
+	while (scopes_.size() > base)
+	{
+		pop_scope();
+	}
+}
+
+void VM::define_global_symbols()
+{
+	for (auto& pair : SymbolTable::global_table()->vars_)
+	{
+		SymbolTable::Variable& var = pair.second;
+		value_t value = var.init_expr == nullptr ? nullptr : this->run_expr(var.init_expr);
+		env_->define_var({ var.name, var.type, value });
+	}
+	for (auto& pair : SymbolTable::global_table()->funcs_)
+	{
+		SymbolTable::Function& func = pair.second;
+		std::vector<Environment::Variable> args{};
+		for (SymbolTable::Variable arg : func.args)
+		{
+			value_t value = arg.init_expr == nullptr ? nullptr : this->run_expr(arg.init_expr);
+			args.push_back({ arg.name, arg.type, value });
+		}
+		env_->define_func({ func.name, func.ret_type, args, func.body });
+	}
+	for (auto& pair : SymbolTable::global_table()->classes_)
+	{
+		SymbolTable::Class& cls = pair.second;
+		std::vector<Environment::Function> methods{};
+		std::vector<Environment::Variable> members{};
+
+		for (SymbolTable::Function method : cls.methods)
+		{
+			std::vector<Environment::Variable> args{};
+			for (SymbolTable::Variable arg : method.args)
+			{
+				value_t value = arg.init_expr == nullptr ? nullptr : this->run_expr(arg.init_expr);
+				args.push_back({ arg.name, arg.type, value });
+			}
+			methods.push_back({ method.name, method.ret_type, args, method.body });
+		}
+
+		for (SymbolTable::Variable member : cls.members)
+		{
+			value_t value = member.init_expr == nullptr ? nullptr : this->run_expr(member.init_expr);
+			members.push_back({ member.name, member.type, value });
+		}
+
+		env_->define_class({ cls.name, members, methods });
+	}
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include "../cil-system.h"
+#include "../Types/Type.h"
+#include "../Types/BuiltinTypes.h"
+#include "../Types/TypeTable.h"
+#include "../Types/cil-types.h"
+#include "Environment.h"
+#include "EnvironmentPool.h"
+#include "../Compiling/Chunk.h"
+#include "../Compiling/BytecodeBackend.h"
+#include "../Parsing/Expression.h"
+#include "../Parsing/Statement.h"
+#include "../Diagnostics/CILError.h"
+#include "../Diagnostics/Diagnostics.h"
+#include "../Scanning/SymbolTable.h"
+
+class VM
+{
+public:
+	VM();
+	VM(stmt_list& program);
+
+	~VM();
+
+	void run();
+
+	void define_global_symbols();
+
+	void dump_stats(std::ostream& os) const;
+private:
+	//Owned scopes come from env_pool_ and are handed back when popped
+	struct Scope
+	{
+		Environment* env;
+		bool owned;
+	};
+
+	//A call whose arguments are being evaluated. Errors raised before the
+	//callee's frame is pushed are reported at the call and resume after it.
+	struct CallGuard
+	{
+		const Environment::Function* func;
+		size_t stack_base;
+		size_t scope_base;
+		size_t frame_depth;
+		const uint8_t* resume;
+		Position pos;
+	};
+
+	//A parallel loop being run. Its iterations run in order, but may only assign
+	//to variables of their own and the first error stops the loop, as in the interpreter
+	struct ParallelLoop
+	{
+		size_t stack_base;
+		size_t scope_base;
+		size_t frame_depth;
+		size_t guard_base;
+	};
+
+	//What a call site remembers about the function it called last
+	struct CallSite
+	{
+		const Environment::Function* func = nullptr;
+		uint64_t epoch = 0;
+	};
+
+	struct CallFrame
+	{
+		const Chunk* chunk;
+		const uint8_t* ip;
+		size_t stack_base;
+		size_t scope_base;
+		const Environment::Function* func;
+		Position call_pos;
+		//Where the functions this frame tail-called from start in tail_returns_
+		size_t tail_base;
+	};
+
+	value_t run_expr(expr_ptr expr);
+	void run_chunk(chunk_ptr chunk);
+	void execute(size_t base_depth);
+	bool recover(CILError& err, size_t base_depth);
+	//Reports an error the VM goes on after
+	void report(const CILError& err);
+
+	chunk_ptr function_chunk(const Environment::Function& func);
+
+	//Returns the function a call refers to, without a lookup by name if the
+	//call site already found it and no function was (re)defined since. Calls
+	//run in their caller's scope, so the lookup walks as deep as the recursion is
+	const Environment::Function& lookup_callee(uint16_t site, const std::string& name, uint16_t depth, uint16_t slot);
+
+	void push_scope(Environment* env, bool owned);
+	void pop_scope();
+	void unwind_scopes(size_t base);
+
+	void check_private(Environment::VarRef var, const Position& pos) const
+	{
+		if (var && var.decl->shared)
+		{ throw CILError::error(pos, "Parallel loop assigns to shared variable '$'", var.decl->name); }
+	}
+
+	value_t pop()
+	{
+		value_t value = std::move(stack_.back());
+		stack_.pop_back();
+		return value;
+	}
+
+	void push(value_t value)
+	{ stack_.push_back(std::move(value)); }
+
+	bool is_error(const value_t& value) const
+	{ return value.is_error(); }
+
+	stmt_list program_;
+
+	BytecodeBackend compiler_;
+	std::map<const Statement*, chunk_ptr> functions_;
+
+	std::vector<value_t> stack_;
+	EnvironmentPool env_pool_;
+	std::vector<Scope> scopes_;
+	std::vector<CallFrame> frames_;
+	std::vector<CallGuard> guards_;
+	std::vector<ParallelLoop> parallel_;
+	std::vector<CallSite> call_sites_;
+	size_t call_site_hits_;
+	size_t call_site_misses_;
+	//Functions a chain of tail calls returned through, checked like in the Interpreter
+	//once the last callee returns. Every function of a chain has one entry
+	std::vector<const Environment::Function*> tail_returns_;
+	size_t tail_calls_;
+
+	Environment* env_;
+
+	TypeID error_type_;
+	TypeID num_type_;
+	TypeID object_type_;
+};
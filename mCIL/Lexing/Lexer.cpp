@@ -1,6 +1,6 @@
 #include "Lexer.h"
 
-std::map<std::string, Keyword> Lexer::keyword_map =
+const std::map<std::string, Keyword> Lexer::keyword_map =
 {
 	{"auto"   , Keyword::KEYWORD_AUTO   },
 	{"const"  , Keyword::KEYWORD_CONST  },
@@ -18,11 +18,12 @@ std::map<std::string, Keyword> Lexer::keyword_map =
 	{"class"  , Keyword::KEYWORD_CLASS  },
 	{"new"    , Keyword::KEYWORD_NEW    },
 	{"this"   , Keyword::KEYWORD_THIS   },
-	{"extends", Keyword::KEYWORD_EXTENDS}
+	{"extends", Keyword::KEYWORD_EXTENDS},
+	{"parallel", Keyword::KEYWORD_PARALLEL}
 };
 
-Lexer::Lexer(SourceManager& source)
-	: source_(source), current_line_(nullptr),
+Lexer::Lexer(Isolate& isolate, SourceManager& source)
+	: isolate_(isolate), source_(source), current_line_(nullptr),
 	max_line_size_(128), cur_line_size_(0), char_off_(0), line_off_(0), start_char_(0)
 {
 	this->current_line_ = new char[this->max_line_size_];
@@ -35,6 +36,8 @@ Lexer::~Lexer()
 
 token_list Lexer::scan_file()
 {
+	Isolate::Scope scope{ isolate_ };
+
 	this->cur_line_size_ = 0;
 	this->char_off_ = 0;
 	this->line_off_ = 0;
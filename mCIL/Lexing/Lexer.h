@@ -4,12 +4,13 @@
 #include "../Diagnostics/Position.h"
 #include "../Diagnostics/SourceManager.h"
 #include "../Diagnostics/CILError.h"
+#include "../Interpreting/Isolate.h"
 #include "Token.h"
 
 class Lexer
 {
 public:
-	Lexer(SourceManager& source);
+	Lexer(Isolate& isolate, SourceManager& source);
 	~Lexer();
 
 	token_list scan_file();
@@ -41,6 +42,7 @@ private:
 	token_ptr get_keyword(bool& found);
 	token_ptr get_identifier(bool& found);
 
+	Isolate& isolate_;
 	SourceManager& source_;
 	char* current_line_;
 	size_t max_line_size_;
@@ -50,5 +52,5 @@ private:
 
 	size_t start_char_;
 
-	static std::map<std::string, Keyword> keyword_map;
+	static const std::map<std::string, Keyword> keyword_map;
 };
\ No newline at end of file
@@ -78,7 +78,8 @@ enum class Keyword
 	KEYWORD_CLASS,
 	KEYWORD_NEW,
 	KEYWORD_THIS,
-	KEYWORD_EXTENDS
+	KEYWORD_EXTENDS,
+	KEYWORD_PARALLEL
 };
 
 class Token
@@ -0,0 +1,99 @@
+#pragma once
+#include "../cil-system.h"
+#include "../Diagnostics/CILError.h"
+#include "Expression.h"
+#include "Statement.h"
+
+//Statically dispatched traversal of the AST. 'Derived' implements one
+//visit_<kind>_expr / visit_<kind>_stmt member per node kind, each taking
+//a non-owning pointer to the concrete node. Dispatch switches on the node's
+//type tag and static_casts, so visiting a node costs no RTTI check and no
+//reference count traffic.
+template <typename Derived, typename ExprResult = void, typename StmtResult = void>
+class ASTVisitor
+{
+public:
+	ExprResult visit_expr(const expr_ptr& expr)
+	{ return visit_expr(expr.get()); }
+
+	StmtResult visit_stmt(const stmt_ptr& stmt)
+	{ return visit_stmt(stmt.get()); }
+
+	ExprResult visit_expr(Expression* expr)
+	{
+		switch (expr->type())
+		{
+		case ExprType::EXPRESSION_ERROR:
+			return derived().visit_error_expr(static_cast<ErrorExpression*>(expr));
+		case ExprType::EXPRESSION_GROUPING:
+			return derived().visit_grouping_expr(static_cast<GroupingExpression*>(expr));
+		case ExprType::EXPRESSION_PRIMARY:
+			return derived().visit_primary_expr(static_cast<PrimaryExpression*>(expr));
+		case ExprType::EXPRESSION_CALL:
+			return derived().visit_call_expr(static_cast<CallExpression*>(expr));
+		case ExprType::EXPRESSION_ACCESS:
+			return derived().visit_access_expr(static_cast<AccessExpression*>(expr));
+		case ExprType::EXPRESSION_NEW:
+			return derived().visit_new_expr(static_cast<NewExpression*>(expr));
+		case ExprType::EXPRESSION_ARRAY_ACCESS:
+			return derived().visit_array_access_expr(static_cast<ArrayAccessExpression*>(expr));
+		case ExprType::EXPRESSION_UNARY:
+			return derived().visit_unary_expr(static_cast<UnaryExpression*>(expr));
+		case ExprType::EXPRESSION_BINARY:
+			return derived().visit_binary_expr(static_cast<BinaryExpression*>(expr));
+		case ExprType::EXPRESSION_TERNARY:
+			return derived().visit_ternary_expr(static_cast<TernaryExpression*>(expr));
+		case ExprType::EXPRESSION_ASSIGNMENT:
+			return derived().visit_assignment_expr(static_cast<AssignmentExpression*>(expr));
+		default:
+			throw CILError::error(expr->pos(), "Incomplete handling of expressions");
+		}
+	}
+
+	StmtResult visit_stmt(Statement* stmt)
+	{
+		switch (stmt->type())
+		{
+		case StmtType::STATEMENT_ERROR:
+			return derived().visit_error_stmt(static_cast<ErrorStatement*>(stmt));
+		case StmtType::STATEMENT_BLOCK:
+			return derived().visit_block_stmt(static_cast<BlockStatement*>(stmt));
+		case StmtType::STATEMENT_BREAK:
+			return derived().visit_break_stmt(static_cast<BreakStatement*>(stmt));
+		case StmtType::STATEMENT_RETURN:
+			return derived().visit_return_stmt(static_cast<ReturnStatement*>(stmt));
+		case StmtType::STATEMENT_PRINT:
+			return derived().visit_print_stmt(static_cast<PrintStatement*>(stmt));
+		case StmtType::STATEMENT_IF:
+			return derived().visit_if_stmt(static_cast<IfStatement*>(stmt));
+		case StmtType::STATEMENT_ELIF:
+			return derived().visit_elif_stmt(static_cast<ElifStatement*>(stmt));
+		case StmtType::STATEMENT_WHILE:
+			return derived().visit_while_stmt(static_cast<WhileStatement*>(stmt));
+		case StmtType::STATEMENT_FOR:
+			return derived().visit_for_stmt(static_cast<ForStatement*>(stmt));
+		case StmtType::STATEMENT_VAR_DECL:
+			return derived().visit_var_decl_stmt(static_cast<VarDeclStatement*>(stmt));
+		case StmtType::STATEMENT_ARR_DECL:
+			return derived().visit_arr_decl_stmt(static_cast<ArrDeclStatement*>(stmt));
+		case StmtType::STATEMENT_FUNC_DECL:
+			return derived().visit_func_decl_stmt(static_cast<FuncDeclStatement*>(stmt));
+		case StmtType::STATEMENT_CLASS_DECL:
+			return derived().visit_class_decl_stmt(static_cast<ClassDeclStatement*>(stmt));
+		case StmtType::STATEMENT_EXPR:
+			return derived().visit_expr_stmt(static_cast<ExprStatement*>(stmt));
+		default:
+			throw CILError::error(stmt->pos(), "Incomplete handling of statements");
+		}
+	}
+
+	//Error nodes only reach consumers that explicitly opt in by hiding these
+	ExprResult visit_error_expr(ErrorExpression* expr)
+	{ throw CILError::error(expr->pos(), "Incomplete handling of expressions"); }
+
+	StmtResult visit_error_stmt(ErrorStatement* stmt)
+	{ throw CILError::error(stmt->pos(), "Incomplete handling of statements"); }
+private:
+	Derived& derived()
+	{ return static_cast<Derived&>(*this); }
+};
@@ -44,9 +44,9 @@ expr_ptr Expression::make_identifier_expr(token_ptr token)
 	return expr_ptr(new PrimaryExpression(PrimaryType::PRIMARY_IDENTIFIER, value, token->pos()));
 }
 
-expr_ptr Expression::make_call_expr(token_ptr token, expr_list args, Position pos)
+expr_ptr Expression::make_call_expr(token_ptr token, expr_list args, Position pos, Intrinsic intrinsic)
 {
-	return expr_ptr(new CallExpression(token->identifier(), args, pos));
+	return expr_ptr(new CallExpression(token->identifier(), args, pos, intrinsic));
 }
 
 expr_ptr Expression::make_access_expr(token_ptr token, expr_ptr inner, Position pos)
@@ -87,3 +87,25 @@ expr_ptr Expression::make_assignment_expr(expr_ptr target, expr_ptr right)
 	Position pos{target->pos(), right->pos()};
 	return expr_ptr(new AssignmentExpression(target, right, pos));
 }
+
+Intrinsic CallExpression::intrinsic_named(const std::string& name)
+{
+	static const std::unordered_map<std::string, Intrinsic> intrinsics{
+		{ "sum", Intrinsic::INTRINSIC_SUM },
+		{ "min", Intrinsic::INTRINSIC_MIN },
+		{ "max", Intrinsic::INTRINSIC_MAX },
+		{ "dot", Intrinsic::INTRINSIC_DOT },
+		{ "add", Intrinsic::INTRINSIC_ADD },
+		{ "subtract", Intrinsic::INTRINSIC_SUBTRACT },
+		{ "multiply", Intrinsic::INTRINSIC_MULTIPLY },
+		{ "divide", Intrinsic::INTRINSIC_DIVIDE },
+		{ "less", Intrinsic::INTRINSIC_LESS },
+		{ "greater", Intrinsic::INTRINSIC_GREATER },
+		{ "less_equal", Intrinsic::INTRINSIC_LESS_EQUAL },
+		{ "greater_equal", Intrinsic::INTRINSIC_GREATER_EQUAL },
+		{ "equal", Intrinsic::INTRINSIC_EQUAL },
+		{ "not_equal", Intrinsic::INTRINSIC_NOT_EQUAL }
+	};
+	auto it = intrinsics.find(name);
+	return it == intrinsics.end() ? Intrinsic::INTRINSIC_NONE : it->second;
+}
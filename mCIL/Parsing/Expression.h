@@ -3,6 +3,8 @@
 #include "../Diagnostics/Position.h"
 #include "../Lexing/Token.h"
 
+class value_t;
+
 class Expression;
 typedef std::shared_ptr<Expression> expr_ptr;
 typedef std::vector<expr_ptr> expr_list;
@@ -39,6 +41,83 @@ union primary_value
 	const std::string* identifier_val;
 };
 
+//Whole-array operations the engines run themselves, calls name them when no
+//function of the same name exists
+enum class Intrinsic
+{
+	INTRINSIC_NONE,
+
+	//Reductions of 'num' arrays to a 'num'
+	INTRINSIC_SUM,
+	INTRINSIC_MIN,
+	INTRINSIC_MAX,
+	INTRINSIC_DOT,
+
+	//Element-wise into the array given first, from arrays or scalars
+	INTRINSIC_ADD,
+	INTRINSIC_SUBTRACT,
+	INTRINSIC_MULTIPLY,
+	INTRINSIC_DIVIDE,
+	INTRINSIC_LESS,
+	INTRINSIC_GREATER,
+	INTRINSIC_LESS_EQUAL,
+	INTRINSIC_GREATER_EQUAL,
+	INTRINSIC_EQUAL,
+	INTRINSIC_NOT_EQUAL
+};
+
+//Location of a name relative to the scope it is used in, filled in by the Resolver.
+//Unresolved names (depth -1) are looked up by name at runtime.
+struct ScopeSlot
+{
+	int depth = -1;
+	int slot = -1;
+
+	bool resolved() const
+	{ return depth >= 0; }
+};
+
+//Specialized forms the interpreter rewrites a node to once the node kept seeing
+//the same operand types. Every specialized form guards on its operand types and
+//deoptimizes back to the generic evaluation when the guard fails.
+enum class QuickForm : uint8_t
+{
+	QUICK_UNTRIED,
+	QUICK_GENERIC,
+
+	//Everything below is specialized
+	QUICK_NUM_ADD,
+	QUICK_NUM_SUBTRACT,
+	QUICK_NUM_MULTIPLY,
+	QUICK_NUM_DIVIDE,
+	QUICK_NUM_LESS,
+	QUICK_NUM_GREATER,
+	QUICK_NUM_LESS_EQUAL,
+	QUICK_NUM_GREATER_EQUAL,
+	QUICK_NUM_EQUAL,
+	QUICK_NUM_NOT_EQUAL,
+	QUICK_STR_ADD,
+	QUICK_STR_EQUAL,
+	QUICK_STR_NOT_EQUAL,
+	QUICK_BOOL_AND,
+	QUICK_BOOL_OR,
+	QUICK_VAR_INCREMENT,
+	QUICK_VAR_DECREMENT,
+	QUICK_VAR_STORE
+};
+
+//Type feedback collected on a node while it runs generically
+struct QuickState
+{
+	QuickForm form = QuickForm::QUICK_UNTRIED;
+	QuickForm pending = QuickForm::QUICK_UNTRIED;
+	uint8_t warmup = 0;
+	uint8_t deopts = 0;
+
+	bool specialized() const
+	{ return form > QuickForm::QUICK_GENERIC; }
+};
+
 class Expression
 {
 public:
@@ -54,7 +133,7 @@ public:
 	static expr_ptr make_num_expr(token_ptr);
 	static expr_ptr make_str_expr(token_ptr);
 	static expr_ptr make_identifier_expr(token_ptr);
-	static expr_ptr make_call_expr(token_ptr, expr_list, Position);
+	static expr_ptr make_call_expr(token_ptr, expr_list, Position, Intrinsic intrinsic = Intrinsic::INTRINSIC_NONE);
 	static expr_ptr make_access_expr(token_ptr, expr_ptr, Position);
 	static expr_ptr make_new_expr(token_ptr, expr_list, Position);
 	static expr_ptr make_array_access_expr(token_ptr, expr_ptr, Position);
@@ -120,7 +199,7 @@ public:
 	GroupingExpression(expr_ptr expr, Position pos)
 		: Expression(ExprType::EXPRESSION_GROUPING, pos), expr_(expr) {}
 
-	const expr_ptr expr() const
+	const expr_ptr& expr() const
 	{ return expr_; }
 private:
 	expr_ptr expr_;
@@ -137,25 +216,74 @@ public:
 
 	const primary_value val() const
 	{ return val_; }
+
+	const ScopeSlot& slot() const
+	{ return slot_; }
+
+	void resolve(ScopeSlot slot)
+	{ slot_ = slot; }
+
+	//The pre-materialized value of a literal, or nullptr if it was not interned
+	const value_t* constant() const
+	{ return constant_; }
+
+	void intern(const value_t* constant)
+	{ constant_ = constant; }
 private:
 	PrimaryType primary_type_;
 	primary_value val_;
+
+	ScopeSlot slot_;
+	const value_t* constant_ = nullptr;
 };
 
 class CallExpression : public Expression
 {
 public:
-	CallExpression(const std::string& identifier, expr_list args, Position pos)
-		: Expression(ExprType::EXPRESSION_CALL, pos), identifier_(identifier), args_(args) {}
+	CallExpression(const std::string& identifier, expr_list args, Position pos, Intrinsic intrinsic = Intrinsic::INTRINSIC_NONE)
+		: Expression(ExprType::EXPRESSION_CALL, pos), identifier_(identifier), args_(args), intrinsic_(intrinsic) {}
+
+	//The intrinsic called 'name', INTRINSIC_NONE if there is none
+	static Intrinsic intrinsic_named(const std::string& name);
 
 	const std::string& identifier() const
 	{ return identifier_; }
 
-	const expr_list args() const
+	Intrinsic intrinsic() const
+	{ return intrinsic_; }
+
+	const expr_list& args() const
 	{ return args_; }
+
+	const ScopeSlot& slot() const
+	{ return slot_; }
+
+	//Index of this call among all calls of the program, engines keep their
+	//per call-site state (like the cached callee) in a table indexed by it
+	size_t site() const
+	{ return site_; }
+
+	void resolve(ScopeSlot slot, size_t site)
+	{
+		slot_ = slot;
+		site_ = site;
+	}
+
+	//Set by the Resolver on 'return f(...)' calls that may run in place of the
+	//frame of the function they return from
+	bool tail() const
+	{ return tail_; }
+
+	void mark_tail()
+	{ tail_ = true; }
 private:
 	const std::string& identifier_;
 	expr_list args_;
+	Intrinsic intrinsic_;
+
+	ScopeSlot slot_;
+	size_t site_ = 0;
+	bool tail_ = false;
 };
 
 class AccessExpression : public Expression
@@ -167,11 +295,29 @@ public:
 	const std::string& identifier() const
 	{ return identifier_; }
 
-	const expr_ptr inner() const
+	const expr_ptr& inner() const
 	{ return inner_; }
+
+	//Where the object being accessed lives, the inner expression is resolved against the object
+	const ScopeSlot& slot() const
+	{ return slot_; }
+
+	//Index of this access among all accesses of the program, the interpreter keeps
+	//the classes an access saw (its inline cache) in a table indexed by it
+	size_t site() const
+	{ return site_; }
+
+	void resolve(ScopeSlot slot, size_t site)
+	{
+		slot_ = slot;
+		site_ = site;
+	}
 private:
 	const std::string identifier_;
 	expr_ptr inner_;
+
+	ScopeSlot slot_;
+	size_t site_ = 0;
 };
 
 class NewExpression : public Expression
@@ -183,7 +329,7 @@ public:
 	const std::string& identifier() const
 	{ return identifier_; }
 
-	const expr_list args() const
+	const expr_list& args() const
 	{ return args_; }
 private:
 	const std::string identifier_;
@@ -199,7 +345,7 @@ public:
 	const std::string& identifier() const
 	{ return identifier_; }
 
-	const expr_ptr index() const
+	const expr_ptr& index() const
 	{ return index_; }
 private:
 	const std::string& identifier_;
@@ -215,11 +361,16 @@ public:
 	const Operator op() const
 	{ return op_; }
 
-	const expr_ptr expr() const
+	const expr_ptr& expr() const
 	{ return expr_; }
+
+	QuickState& quick()
+	{ return quick_; }
 private:
 	Operator op_;
 	expr_ptr expr_;
+
+	QuickState quick_;
 };
 
 class BinaryExpression : public Expression
@@ -231,15 +382,20 @@ public:
 	const Operator op() const
 	{ return op_; }
 
-	const expr_ptr left() const
+	const expr_ptr& left() const
 	{ return left_; }
 
-	const expr_ptr right() const
+	const expr_ptr& right() const
 	{ return right_; }
+
+	QuickState& quick()
+	{ return quick_; }
 private:
 	Operator op_;
 	expr_ptr left_;
 	expr_ptr right_;
+
+	QuickState quick_;
 };
 
 class TernaryExpression : public Expression
@@ -249,13 +405,13 @@ public:
 		: Expression(ExprType::EXPRESSION_TERNARY, pos), cond_(cond), left_(left), right_(right) {}
 
 
-	const expr_ptr cond() const
+	const expr_ptr& cond() const
 	{ return cond_; }
 
-	const expr_ptr left() const
+	const expr_ptr& left() const
 	{ return left_; }
 
-	const expr_ptr right() const
+	const expr_ptr& right() const
 	{ return right_; }
 private:
 	expr_ptr cond_;
@@ -269,12 +425,17 @@ public:
 	AssignmentExpression(expr_ptr target, expr_ptr right, Position pos)
 		: Expression(ExprType::EXPRESSION_ASSIGNMENT, pos), target_(target), expr_(right) {}
 
-	expr_ptr target() const
+	const expr_ptr& target() const
 	{ return target_; }
 
-	const expr_ptr expr() const
+	const expr_ptr& expr() const
 	{ return expr_; }
+
+	QuickState& quick()
+	{ return quick_; }
 private:
 	expr_ptr target_;
 	expr_ptr expr_;
+
+	QuickState quick_;
 };
\ No newline at end of file
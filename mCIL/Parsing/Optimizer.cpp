@@ -0,0 +1,1088 @@
+#include "Optimizer.h"
+#include "../Types/String.h"
+
+//Counts the declarations of every name and how often it is assigned or
+//incremented. A 'const' is only propagated and an expression only hoisted out
+//of a loop if none of these can reach the names involved
+class NameCollector : public ASTVisitor<NameCollector>
+{
+	friend ASTVisitor<NameCollector>;
+public:
+	NameCollector(std::unordered_map<std::string, size_t>& declarations, std::unordered_map<std::string, size_t>& written,
+		std::unordered_map<std::string, Type>& types)
+		: declarations_(declarations), written_(written), types_(types), writing_(false) {}
+
+	void declare(const std::string& name, Type type)
+	{
+		declarations_[name]++;
+		types_.insert_or_assign(name, type);
+	}
+
+	void collect_expr(const expr_ptr& expr)
+	{
+		if (expr)
+		{ visit_expr(expr); }
+	}
+
+	void collect_stmt(const stmt_ptr& stmt)
+	{
+		if (stmt)
+		{ visit_stmt(stmt); }
+	}
+private:
+	//Every name inside a target counts as written, the engines resolve it dynamically
+	void collect_target(const expr_ptr& expr)
+	{
+		//The index of an element only selects what is written
+		if (expr && expr->is_array_access_expr())
+		{
+			collect_expr(expr);
+			return;
+		}
+		bool writing = writing_;
+		writing_ = true;
+		collect_expr(expr);
+		writing_ = writing;
+	}
+
+	void visit_error_expr(ErrorExpression*)
+	{
+	}
+
+	void visit_grouping_expr(GroupingExpression* expr)
+	{ collect_expr(expr->expr()); }
+
+	void visit_primary_expr(PrimaryExpression* expr)
+	{
+		if (writing_ && expr->primary_type() == PrimaryType::PRIMARY_IDENTIFIER)
+		{ written_[*expr->val().identifier_val]++; }
+	}
+
+	void visit_call_expr(CallExpression* expr)
+	{
+		for (const expr_ptr& arg : expr->args())
+		{ collect_expr(arg); }
+	}
+
+	void visit_access_expr(AccessExpression* expr)
+	{ collect_expr(expr->inner()); }
+
+	void visit_new_expr(NewExpression* expr)
+	{
+		for (const expr_ptr& arg : expr->args())
+		{ collect_expr(arg); }
+	}
+
+	void visit_array_access_expr(ArrayAccessExpression* expr)
+	{ collect_expr(expr->index()); }
+
+	void visit_unary_expr(UnaryExpression* expr)
+	{
+		if (expr->op() == Operator::OPERATOR_INCREMENT || expr->op() == Operator::OPERATOR_DECREMENT)
+		{ collect_target(expr->expr()); }
+		else
+		{ collect_expr(expr->expr()); }
+	}
+
+	void visit_binary_expr(BinaryExpression* expr)
+	{
+		collect_expr(expr->left());
+		collect_expr(expr->right());
+	}
+
+	void visit_ternary_expr(TernaryExpression* expr)
+	{
+		collect_expr(expr->cond());
+		collect_expr(expr->left());
+		collect_expr(expr->right());
+	}
+
+	void visit_assignment_expr(AssignmentExpression* expr)
+	{
+		collect_target(expr->target());
+		collect_expr(expr->expr());
+	}
+
+	void visit_error_stmt(ErrorStatement*)
+	{
+	}
+
+	void visit_block_stmt(BlockStatement* stmt)
+	{
+		for (const stmt_ptr& inner : stmt->inner())
+		{ collect_stmt(inner); }
+	}
+
+	void visit_break_stmt(BreakStatement*)
+	{
+	}
+
+	void visit_return_stmt(ReturnStatement* stmt)
+	{ collect_expr(stmt->expr()); }
+
+	void visit_print_stmt(PrintStatement* stmt)
+	{ collect_expr(stmt->expr()); }
+
+	void visit_if_stmt(IfStatement* stmt)
+	{
+		collect_expr(stmt->cond());
+		collect_stmt(stmt->if_branch());
+		collect_stmt(stmt->top_elif());
+	}
+
+	void visit_elif_stmt(ElifStatement* stmt)
+	{
+		collect_expr(stmt->cond());
+		collect_stmt(stmt->inner());
+		collect_stmt(stmt->next_elif());
+	}
+
+	void visit_while_stmt(WhileStatement* stmt)
+	{
+		collect_expr(stmt->cond());
+		collect_stmt(stmt->inner());
+	}
+
+	void visit_for_stmt(ForStatement* stmt)
+	{
+		collect_stmt(stmt->init());
+		collect_expr(stmt->cond());
+		collect_expr(stmt->exec());
+		collect_stmt(stmt->inner());
+	}
+
+	void visit_var_decl_stmt(VarDeclStatement* stmt)
+	{
+		declare(stmt->info().name, stmt->info().type);
+		collect_expr(stmt->val());
+	}
+
+	void visit_arr_decl_stmt(ArrDeclStatement* stmt)
+	{
+		for (const expr_ptr& val : stmt->vals())
+		{ collect_expr(val); }
+	}
+
+	void visit_func_decl_stmt(FuncDeclStatement* stmt)
+	{
+		for (const VarInfo& arg : stmt->info().args)
+		{ declare(arg.name, arg.type); }
+		collect_stmt(stmt->body());
+	}
+
+	void visit_class_decl_stmt(ClassDeclStatement* stmt)
+	{
+		for (const stmt_ptr& member : stmt->members())
+		{ collect_stmt(member); }
+		for (const stmt_ptr& method : stmt->methods())
+		{ collect_stmt(method); }
+	}
+
+	void visit_expr_stmt(ExprStatement* stmt)
+	{ collect_expr(stmt->expr()); }
+
+	std::unordered_map<std::string, size_t>& declarations_;
+	std::unordered_map<std::string, size_t>& written_;
+	std::unordered_map<std::string, Type>& types_;
+	bool writing_;
+};
+
+//How often every name is written by one loop
+static std::unordered_map<std::string, size_t> count_writes(const expr_ptr& cond, const expr_ptr& exec, const stmt_ptr& body)
+{
+	std::unordered_map<std::string, size_t> declarations{};
+	std::unordered_map<std::string, size_t> written{};
+	std::unordered_map<std::string, Type> types{};
+	NameCollector collector{ declarations, written, types };
+	collector.collect_expr(cond);
+	collector.collect_expr(exec);
+	collector.collect_stmt(body);
+	return written;
+}
+
+//Strips groupings, hoisting a lone name or literal would only add a copy
+static bool is_operation(const expr_ptr& expr)
+{
+	Expression* inner = expr.get();
+	while (inner->is_grouping_expr())
+	{ inner = static_cast<GroupingExpression*>(inner)->expr().get(); }
+	return inner->is_binary_expr() || inner->is_unary_expr();
+}
+
+Optimizer::Optimizer(stmt_list& program, ConstantPool& constants)
+	: program_(program), constants_(constants), declarations_(), written_(), types_(), known_constants_(),
+	  visible_(), visible_index_(), loop_depth_(0), hoisting_(false), hoist_visible_(0), hoisted_(),
+	  hoisted_names_(), report_(nullptr), stats_()
+{
+}
+
+void Optimizer::optimize()
+{
+	collect_names();
+
+	//The top level runs first, so its constants are known in every body below
+	optimize_list(program_);
+
+	for (auto& pair : SymbolTable::global_table()->vars_)
+	{
+		optimize_expr(pair.second.init_expr);
+	}
+	for (auto& pair : SymbolTable::global_table()->funcs_)
+	{
+		std::vector<std::string> params{};
+		for (SymbolTable::Variable& arg : pair.second.args)
+		{
+			params.push_back(arg.name);
+		}
+		optimize_function(params, pair.second.body);
+	}
+	for (auto& pair : SymbolTable::global_table()->classes_)
+	{
+		for (SymbolTable::Variable& member : pair.second.members)
+		{
+			optimize_expr(member.init_expr);
+		}
+		for (SymbolTable::Function& method : pair.second.methods)
+		{
+			std::vector<std::string> params{};
+			for (SymbolTable::Variable& arg : method.args)
+			{
+				params.push_back(arg.name);
+			}
+			optimize_function(params, method.body);
+		}
+	}
+}
+
+void Optimizer::dump_stats(std::ostream& os) const
+{
+	os << "Optimizer:\n"
+		<< "  folded expressions:   " << stats_.folded << "\n"
+		<< "  propagated constants: " << stats_.propagated << "\n"
+		<< "  removed branches:     " << stats_.branches << "\n"
+		<< "  hoisted expressions:  " << stats_.hoisted << "\n"
+		<< "  induction variables:  " << stats_.induction_variables << "\n";
+}
+
+void Optimizer::collect_names()
+{
+	NameCollector collector{ declarations_, written_, types_ };
+	for (const stmt_ptr& stmt : program_)
+	{
+		collector.collect_stmt(stmt);
+	}
+
+	for (auto& pair : SymbolTable::global_table()->vars_)
+	{
+		collector.declare(pair.first, pair.second.type);
+		collector.collect_expr(pair.second.init_expr);
+	}
+	for (auto& pair : SymbolTable::global_table()->funcs_)
+	{
+		for (SymbolTable::Variable& arg : pair.second.args)
+		{
+			collector.declare(arg.name, arg.type);
+		}
+		collector.collect_stmt(pair.second.body);
+	}
+	for (auto& pair : SymbolTable::global_table()->classes_)
+	{
+		for (SymbolTable::Variable& member : pair.second.members)
+		{
+			collector.declare(member.name, member.type);
+			collector.collect_expr(member.init_expr);
+		}
+		for (SymbolTable::Function& method : pair.second.methods)
+		{
+			for (SymbolTable::Variable& arg : method.args)
+			{
+				collector.declare(arg.name, arg.type);
+			}
+			collector.collect_stmt(method.body);
+		}
+	}
+}
+
+bool Optimizer::optimize_expr(expr_ptr& expr)
+{
+	if (!expr)
+	{ return false; }
+
+	//Checked before the children, so the largest invariant expression is hoisted
+	Type type = Type::make(type_id("num"));
+	if (hoisting_ && is_operation(expr) && invariant_type(expr, type))
+	{
+		expr = hoist(expr, type);
+		return true;
+	}
+
+	expr_ptr result = visit_expr(expr);
+	if (!result)
+	{ return false; }
+	expr = result;
+	return true;
+}
+
+bool Optimizer::optimize_stmt(stmt_ptr& stmt)
+{
+	if (!stmt)
+	{ return false; }
+
+	stmt_ptr result = visit_stmt(stmt);
+	if (!result)
+	{ return false; }
+	stmt = result;
+	return true;
+}
+
+bool Optimizer::optimize_branch(stmt_ptr& stmt)
+{
+	//A declaration that might not run does not make its name visible
+	size_t mark = visible_.size();
+	bool changed = optimize_stmt(stmt);
+	forget_visible(mark);
+	return changed;
+}
+
+bool Optimizer::optimize_list(stmt_list& stmts)
+{
+	bool changed = false;
+	for (size_t i = 0; i < stmts.size(); i++)
+	{
+		size_t visible = visible_.size();
+		changed |= optimize_stmt(stmts[i]);
+
+		if (hoisting_ || loop_depth_ > 0 || !(stmts[i]->is_while_stmt() || stmts[i]->is_for_stmt()))
+		{ continue; }
+		hoist_invariants(stmts[i], visible);
+		if (!hoisted_.empty())
+		{
+			stmts.insert(stmts.begin() + i, hoisted_.begin(), hoisted_.end());
+			i += hoisted_.size();
+			hoisted_.clear();
+			changed = true;
+		}
+	}
+
+	//Branches that were removed entirely leave an empty block behind
+	auto removed = std::remove_if(stmts.begin(), stmts.end(), [](const stmt_ptr& stmt)
+		{
+			return stmt->is_block_stmt() && static_cast<BlockStatement*>(stmt.get())->inner().empty();
+		});
+	if (removed != stmts.end())
+	{
+		stmts.erase(removed, stmts.end());
+		changed = true;
+	}
+	return changed;
+}
+
+bool Optimizer::optimize_function(const std::vector<std::string>& params, stmt_ptr& body)
+{
+	//Bodies run in a scope of their own, nothing of the enclosing code is visible
+	std::vector<std::string> visible = std::move(visible_);
+	std::unordered_map<std::string, size_t> visible_index = std::move(visible_index_);
+	size_t loop_depth = loop_depth_;
+	bool hoisting = hoisting_;
+	visible_.clear();
+	visible_index_.clear();
+	loop_depth_ = 0;
+	hoisting_ = false;
+
+	for (const std::string& param : params)
+	{
+		declare_visible(param);
+	}
+	bool changed = optimize_stmt(body);
+
+	visible_ = std::move(visible);
+	visible_index_ = std::move(visible_index);
+	loop_depth_ = loop_depth;
+	hoisting_ = hoisting;
+	return changed;
+}
+
+bool Optimizer::optimize_list(expr_list& exprs)
+{
+	bool changed = false;
+	for (expr_ptr& expr : exprs)
+	{
+		changed |= optimize_expr(expr);
+	}
+	return changed;
+}
+
+stmt_ptr Optimizer::optimize_elif_chain(const stmt_ptr& elif, bool& changed)
+{
+	if (!elif)
+	{ return nullptr; }
+
+	ElifStatement* elif_ptr = static_cast<ElifStatement*>(elif.get());
+	expr_ptr cond = elif_ptr->cond();
+	stmt_ptr inner = elif_ptr->inner();
+	bool local_change = optimize_expr(cond);
+	local_change |= optimize_branch(inner);
+	stmt_ptr next = optimize_elif_chain(elif_ptr->next_elif(), changed);
+	local_change |= next != elif_ptr->next_elif();
+
+	if (is_known_condition(cond))
+	{
+		changed = true;
+		stats_.branches++;
+		//A true condition turns this branch into the final else
+		if (literal_value(cond).as_bool())
+		{ return Statement::make_elif_stmt(nullptr, inner, nullptr, elif->pos()); }
+		return next;
+	}
+
+	if (!local_change)
+	{ return elif; }
+	changed = true;
+	return Statement::make_elif_stmt(cond, inner, next, elif->pos());
+}
+
+expr_ptr Optimizer::visit_error_expr(ErrorExpression*)
+{
+	return nullptr;
+}
+
+expr_ptr Optimizer::visit_grouping_expr(GroupingExpression* expr)
+{
+	expr_ptr inner = expr->expr();
+	bool changed = optimize_expr(inner);
+	if (is_literal(inner))
+	{ return inner; }
+	return changed ? Expression::make_grouping_expr(inner, expr->pos()) : nullptr;
+}
+
+expr_ptr Optimizer::visit_primary_expr(PrimaryExpression* expr)
+{
+	if (expr->primary_type() != PrimaryType::PRIMARY_IDENTIFIER)
+	{ return nullptr; }
+
+	auto it = known_constants_.find(*expr->val().identifier_val);
+	if (it == known_constants_.end())
+	{ return nullptr; }
+
+	//A fresh node keeps the position of the use for error messages
+	PrimaryExpression* value = static_cast<PrimaryExpression*>(it->second.get());
+	stats_.propagated++;
+	return expr_ptr(new PrimaryExpression(value->primary_type(), value->val(), expr->pos()));
+}
+
+expr_ptr Optimizer::visit_call_expr(CallExpression* expr)
+{
+	expr_list args = expr->args();
+	if (!optimize_list(args))
+	{ return nullptr; }
+	return expr_ptr(new CallExpression(expr->identifier(), args, expr->pos(), expr->intrinsic()));
+}
+
+expr_ptr Optimizer::visit_access_expr(AccessExpression* expr)
+{
+	//Names inside an access refer to the object's members first
+	bool hoisting = hoisting_;
+	hoisting_ = false;
+	expr_ptr inner = expr->inner();
+	bool changed = optimize_expr(inner);
+	hoisting_ = hoisting;
+	if (!changed)
+	{ return nullptr; }
+	return expr_ptr(new AccessExpression(expr->identifier(), inner, expr->pos()));
+}
+
+expr_ptr Optimizer::visit_new_expr(NewExpression* expr)
+{
+	expr_list args = expr->args();
+	if (!optimize_list(args))
+	{ return nullptr; }
+	return expr_ptr(new NewExpression(expr->identifier(), args, expr->pos()));
+}
+
+expr_ptr Optimizer::visit_array_access_expr(ArrayAccessExpression* expr)
+{
+	expr_ptr index = expr->index();
+	if (!optimize_expr(index))
+	{ return nullptr; }
+	return expr_ptr(new ArrayAccessExpression(expr->identifier(), index, expr->pos()));
+}
+
+expr_ptr Optimizer::visit_unary_expr(UnaryExpression* expr)
+{
+	//'++' and '--' write back to their operand, so it has to stay a name
+	if (expr->op() == Operator::OPERATOR_INCREMENT || expr->op() == Operator::OPERATOR_DECREMENT)
+	{ return nullptr; }
+
+	expr_ptr inner = expr->expr();
+	bool changed = optimize_expr(inner);
+	//Unary '-' is evaluated like '!' by the engines, folding it would change the result
+	if (is_literal(inner) && expr->op() != Operator::OPERATOR_SUBTRACT)
+	{
+		try
+		{
+			value_t operand = literal_value(inner);
+			value_t result = expr->op() == Operator::OPERATOR_BANG ? operand.invert() : operand.bitwise_not();
+			expr_ptr folded = make_literal(result, expr->pos());
+			if (folded)
+			{
+				stats_.folded++;
+				return folded;
+			}
+		}
+		catch (CILError&)
+		{
+			//Operators that fail are left for the engines to report at runtime
+		}
+	}
+	return changed ? expr_ptr(new UnaryExpression(expr->op(), inner, expr->pos())) : nullptr;
+}
+
+expr_ptr Optimizer::visit_binary_expr(BinaryExpression* expr)
+{
+	expr_ptr left = expr->left();
+	expr_ptr right = expr->right();
+	bool changed = optimize_expr(left);
+	changed |= optimize_expr(right);
+
+	//Both operands are always evaluated, so only literal pairs can fold
+	if (is_literal(left) && is_literal(right))
+	{
+		try
+		{
+			value_t l = literal_value(left);
+			value_t r = literal_value(right);
+			value_t result{};
+			switch (expr->op())
+			{
+			case Operator::OPERATOR_ADD:           result = l.add(r); break;
+			case Operator::OPERATOR_SUBTRACT:      result = l.subtract(r); break;
+			case Operator::OPERATOR_MULTIPLY:      result = l.multiply(r); break;
+			case Operator::OPERATOR_DIVIDE:        result = l.divide(r); break;
+			case Operator::OPERATOR_LEFT_BITSHIFT: result = l.left_bitshift(r); break;
+			case Operator::OPERATOR_RIGHT_BITSHIFT:result = l.right_bitshift(r); break;
+			case Operator::OPERATOR_GREATER:       result = l.greater(r); break;
+			case Operator::OPERATOR_LESS:          result = l.less(r); break;
+			case Operator::OPERATOR_GREATER_EQUAL: result = l.greater_equals(r); break;
+			case Operator::OPERATOR_LESS_EQUAL:    result = l.less_equals(r); break;
+			case Operator::OPERATOR_EQUAL_EQUAL:   result = l.equals(r); break;
+			case Operator::OPERATOR_NOT_EQUAL:     result = l.not_equals(r); break;
+			case Operator::OPERATOR_AND:           result = l.logical_and(r); break;
+			case Operator::OPERATOR_OR:            result = l.logical_or(r); break;
+			case Operator::OPERATOR_BITWISE_AND:   result = l.bitwise_and(r); break;
+			case Operator::OPERATOR_BITWISE_OR:    result = l.bitwise_or(r); break;
+			case Operator::OPERATOR_BITWISE_XOR:   result = l.bitwise_xor(r); break;
+			default:
+				result = value_t::error();
+				break;
+			}
+
+			expr_ptr folded = make_literal(result, expr->pos());
+			if (folded)
+			{
+				stats_.folded++;
+				return folded;
+			}
+		}
+		catch (CILError&)
+		{
+		}
+	}
+	return changed ? expr_ptr(new BinaryExpression(expr->op(), left, right, expr->pos())) : nullptr;
+}
+
+expr_ptr Optimizer::visit_ternary_expr(TernaryExpression* expr)
+{
+	expr_ptr cond = expr->cond();
+	expr_ptr left = expr->left();
+	expr_ptr right = expr->right();
+	bool changed = optimize_expr(cond);
+	changed |= optimize_expr(left);
+	changed |= optimize_expr(right);
+
+	if (is_known_condition(cond))
+	{
+		stats_.folded++;
+		return literal_value(cond).as_bool() ? left : right;
+	}
+	return changed ? expr_ptr(new TernaryExpression(cond, left, right, expr->pos())) : nullptr;
+}
+
+expr_ptr Optimizer::visit_assignment_expr(AssignmentExpression* expr)
+{
+	//The target is a place, not a value, and is never rewritten
+	expr_ptr value = expr->expr();
+	if (!optimize_expr(value))
+	{ return nullptr; }
+	return expr_ptr(new AssignmentExpression(expr->target(), value, expr->pos()));
+}
+
+stmt_ptr Optimizer::visit_error_stmt(ErrorStatement*)
+{
+	return nullptr;
+}
+
+stmt_ptr Optimizer::visit_block_stmt(BlockStatement* stmt)
+{
+	size_t mark = visible_.size();
+	stmt_list inner = stmt->inner();
+	bool changed = optimize_list(inner);
+	forget_visible(mark);
+	if (!changed)
+	{ return nullptr; }
+	return Statement::make_block_stmt(inner, stmt->pos());
+}
+
+stmt_ptr Optimizer::visit_break_stmt(BreakStatement*)
+{
+	return nullptr;
+}
+
+stmt_ptr Optimizer::visit_return_stmt(ReturnStatement* stmt)
+{
+	expr_ptr expr = stmt->expr();
+	if (!optimize_expr(expr))
+	{ return nullptr; }
+	return Statement::make_return_stmt(expr, stmt->pos());
+}
+
+stmt_ptr Optimizer::visit_print_stmt(PrintStatement* stmt)
+{
+	expr_ptr expr = stmt->expr();
+	if (!optimize_expr(expr))
+	{ return nullptr; }
+	return Statement::make_print_stmt(expr, stmt->pos());
+}
+
+stmt_ptr Optimizer::visit_if_stmt(IfStatement* stmt)
+{
+	expr_ptr cond = stmt->cond();
+	stmt_ptr if_branch = stmt->if_branch();
+	bool changed = optimize_expr(cond);
+	changed |= optimize_branch(if_branch);
+	stmt_ptr top_elif = optimize_elif_chain(stmt->top_elif(), changed);
+
+	if (!is_known_condition(cond))
+	{ return changed ? Statement::make_if_stmt(cond, if_branch, top_elif, stmt->pos()) : nullptr; }
+
+	stats_.branches++;
+	if (literal_value(cond).as_bool())
+	{ return if_branch; }
+	if (!top_elif)
+	{ return make_empty(stmt->pos()); }
+
+	//The first remaining elif takes over as the if, a lone else is just its body
+	ElifStatement* elif = static_cast<ElifStatement*>(top_elif.get());
+	if (!elif->cond())
+	{ return elif->inner(); }
+	return Statement::make_if_stmt(elif->cond(), elif->inner(), elif->next_elif(), stmt->pos());
+}
+
+stmt_ptr Optimizer::visit_elif_stmt(ElifStatement*)
+{
+	//Chains are rewritten as a whole from their if statement
+	return nullptr;
+}
+
+stmt_ptr Optimizer::visit_while_stmt(WhileStatement* stmt)
+{
+	expr_ptr cond = stmt->cond();
+	stmt_ptr inner = stmt->inner();
+	loop_depth_++;
+	bool changed = optimize_expr(cond);
+	changed |= optimize_branch(inner);
+	loop_depth_--;
+
+	if (is_known_condition(cond) && !literal_value(cond).as_bool())
+	{
+		stats_.branches++;
+		return make_empty(stmt->pos());
+	}
+
+	//A counting while loop updates its variable as the last statement of the body
+	if (!hoisting_ && inner && inner->is_block_stmt())
+	{
+		stmt_list body = static_cast<BlockStatement*>(inner.get())->inner();
+		if (!body.empty() && body.back()->is_expr_stmt())
+		{
+			expr_ptr update = static_cast<ExprStatement*>(body.back().get())->expr();
+			if (induction_variable(update, nullptr, count_writes(cond, nullptr, inner)))
+			{
+				body.back() = Statement::make_expr_stmt(update, body.back()->pos());
+				inner = Statement::make_block_stmt(body, inner->pos());
+				changed = true;
+			}
+		}
+	}
+	return changed ? Statement::make_while_stmt(cond, inner, stmt->pos()) : nullptr;
+}
+
+stmt_ptr Optimizer::visit_for_stmt(ForStatement* stmt)
+{
+	//The initializer runs even if the loop does not, so for loops are kept
+	stmt_ptr init = stmt->init();
+	expr_ptr cond = stmt->cond();
+	expr_ptr exec = stmt->exec();
+	stmt_ptr inner = stmt->inner();
+	size_t mark = visible_.size();
+	loop_depth_++;
+	bool changed = optimize_stmt(init);
+	changed |= optimize_expr(cond);
+	changed |= optimize_expr(exec);
+	changed |= optimize_branch(inner);
+	loop_depth_--;
+
+	if (!hoisting_)
+	{ changed |= induction_variable(exec, init, count_writes(cond, exec, inner)); }
+	//The variable of a parallel loop is gone once the loop is
+	if (stmt->parallel())
+	{ forget_visible(mark); }
+	return changed ? Statement::make_for_stmt(init, cond, exec, inner, stmt->pos(), stmt->parallel()) : nullptr;
+}
+
+stmt_ptr Optimizer::visit_var_decl_stmt(VarDeclStatement* stmt)
+{
+	expr_ptr val = stmt->val();
+	bool changed = optimize_expr(val);
+
+	const VarInfo& info = stmt->info();
+	if (info.type.is_const() && is_literal(val) && !written_.contains(info.name)
+		&& declarations_[info.name] == 1 && info.type.is(literal_value(val).type()))
+	{ known_constants_[info.name] = val; }
+	if (!hoisting_)
+	{ declare_visible(info.name); }
+
+	return changed ? Statement::make_var_decl_stmt(info, val, stmt->pos()) : nullptr;
+}
+
+stmt_ptr Optimizer::visit_arr_decl_stmt(ArrDeclStatement* stmt)
+{
+	expr_list vals = stmt->vals();
+	if (!optimize_list(vals))
+	{ return nullptr; }
+	return Statement::make_arr_decl_stmt(stmt->info(), vals, stmt->pos());
+}
+
+stmt_ptr Optimizer::visit_func_decl_stmt(FuncDeclStatement* stmt)
+{
+	std::vector<std::string> params{};
+	for (const VarInfo& arg : stmt->info().args)
+	{
+		params.push_back(arg.name);
+	}
+	stmt_ptr body = stmt->body();
+	if (!optimize_function(params, body))
+	{ return nullptr; }
+	return Statement::make_func_decl_stmt(stmt->info(), body, stmt->pos());
+}
+
+stmt_ptr Optimizer::visit_class_decl_stmt(ClassDeclStatement* stmt)
+{
+	//Members live in the objects, not in the scope the class is declared in
+	size_t mark = visible_.size();
+	stmt_list methods = stmt->methods();
+	stmt_list members = stmt->members();
+	bool changed = optimize_list(methods);
+	changed |= optimize_list(members);
+	forget_visible(mark);
+	if (!changed)
+	{ return nullptr; }
+	return Statement::make_class_decl_stmt(stmt->info(), methods, members, stmt->pos());
+}
+
+stmt_ptr Optimizer::visit_expr_stmt(ExprStatement* stmt)
+{
+	expr_ptr expr = stmt->expr();
+	if (!optimize_expr(expr))
+	{ return nullptr; }
+	return Statement::make_expr_stmt(expr, stmt->pos());
+}
+
+void Optimizer::hoist_invariants(stmt_ptr& loop, size_t visible)
+{
+	hoisting_ = true;
+	hoist_visible_ = visible;
+	optimize_stmt(loop);
+	hoisting_ = false;
+
+	//The constants are declared in front of the loop from now on
+	for (const stmt_ptr& decl : hoisted_)
+	{
+		declare_visible(static_cast<VarDeclStatement*>(decl.get())->info().name);
+	}
+}
+
+bool Optimizer::invariant_type(const expr_ptr& expr, Type& type) const
+{
+	switch (expr->type())
+	{
+	case ExprType::EXPRESSION_PRIMARY:
+	{
+		PrimaryExpression* primary = static_cast<PrimaryExpression*>(expr.get());
+		switch (primary->primary_type())
+		{
+		case PrimaryType::PRIMARY_BOOL:
+			type = Type::make(type_id("bool"));
+			return true;
+		case PrimaryType::PRIMARY_NUM:
+			type = Type::make(type_id("num"));
+			return true;
+		case PrimaryType::PRIMARY_STR:
+			type = Type::make(type_id("str"));
+			return true;
+		case PrimaryType::PRIMARY_IDENTIFIER:
+		{
+			//Declared once and never written, the value always has the declared type
+			const std::string& name = *primary->val().identifier_val;
+			auto declarations = declarations_.find(name);
+			auto declared_type = types_.find(name);
+			auto visible = visible_index_.find(name);
+			if (declarations == declarations_.end() || declarations->second != 1 || written_.contains(name)
+				|| declared_type == types_.end() || visible == visible_index_.end() || visible->second >= hoist_visible_)
+			{ return false; }
+			type = Type::make(declared_type->second.id());
+			return type.is(type_id("num")) || type.is(type_id("bool")) || type.is(type_id("str"));
+		}
+		default:
+			return false;
+		}
+	}
+	case ExprType::EXPRESSION_GROUPING:
+		return invariant_type(static_cast<GroupingExpression*>(expr.get())->expr(), type);
+	case ExprType::EXPRESSION_UNARY:
+	{
+		UnaryExpression* unary = static_cast<UnaryExpression*>(expr.get());
+		if (unary->op() != Operator::OPERATOR_BANG || !invariant_type(unary->expr(), type))
+		{ return false; }
+		return type.is(type_id("bool"));
+	}
+	case ExprType::EXPRESSION_BINARY:
+	{
+		BinaryExpression* binary = static_cast<BinaryExpression*>(expr.get());
+		Type left = type;
+		Type right = type;
+		if (!invariant_type(binary->left(), left) || !invariant_type(binary->right(), right) || !left.is(right))
+		{ return false; }
+
+		bool num = left.is(type_id("num"));
+		bool str = left.is(type_id("str"));
+		bool boolean = left.is(type_id("bool"));
+		switch (binary->op())
+		{
+		case Operator::OPERATOR_ADD:
+			type = left;
+			return num || str;
+		case Operator::OPERATOR_SUBTRACT:
+		case Operator::OPERATOR_MULTIPLY:
+		case Operator::OPERATOR_DIVIDE:
+			type = left;
+			return num;
+		case Operator::OPERATOR_LESS:
+		case Operator::OPERATOR_GREATER:
+		case Operator::OPERATOR_LESS_EQUAL:
+		case Operator::OPERATOR_GREATER_EQUAL:
+			type = Type::make(type_id("bool"));
+			return num;
+		case Operator::OPERATOR_EQUAL_EQUAL:
+		case Operator::OPERATOR_NOT_EQUAL:
+			type = Type::make(type_id("bool"));
+			return num || str;
+		case Operator::OPERATOR_AND:
+		case Operator::OPERATOR_OR:
+			type = left;
+			return boolean;
+		default:
+			return false;
+		}
+	}
+	default:
+		return false;
+	}
+}
+
+expr_ptr Optimizer::hoist(const expr_ptr& expr, Type type)
+{
+	hoisted_names_.push_back("$inv" + std::to_string(stats_.hoisted++));
+	const std::string& name = hoisted_names_.back();
+	declarations_[name] = 1;
+	types_.insert_or_assign(name, type);
+
+	VarInfo info{ name, Type::make(type.id(), TypeFlags::CONST) };
+	hoisted_.push_back(Statement::make_var_decl_stmt(info, expr, expr->pos()));
+	report(expr->pos(), "hoisted loop-invariant " + type_name(type.id()) + " expression into '" + name + "'");
+
+	primary_value val{};
+	val.identifier_val = &name;
+	return expr_ptr(new PrimaryExpression(PrimaryType::PRIMARY_IDENTIFIER, val, expr->pos()));
+}
+
+bool Optimizer::induction_variable(expr_ptr& update, const stmt_ptr& init, const std::unordered_map<std::string, size_t>& loop_writes)
+{
+	if (!update)
+	{ return false; }
+
+	expr_ptr target{};
+	double step = 0;
+	if (update->is_unary_expr())
+	{
+		UnaryExpression* unary = static_cast<UnaryExpression*>(update.get());
+		if (unary->op() != Operator::OPERATOR_INCREMENT && unary->op() != Operator::OPERATOR_DECREMENT)
+		{ return false; }
+		target = unary->expr();
+		step = unary->op() == Operator::OPERATOR_INCREMENT ? 1 : -1;
+	}
+	else if (update->is_assignment_expr())
+	{
+		AssignmentExpression* assignment = static_cast<AssignmentExpression*>(update.get());
+		if (!assignment->expr()->is_binary_expr())
+		{ return false; }
+		BinaryExpression* binary = static_cast<BinaryExpression*>(assignment->expr().get());
+		if (binary->op() != Operator::OPERATOR_ADD && binary->op() != Operator::OPERATOR_SUBTRACT)
+		{ return false; }
+		if (!binary->left()->is_primary_expr() || !binary->right()->is_primary_expr() || !assignment->target()->is_primary_expr())
+		{ return false; }
+
+		PrimaryExpression* left = static_cast<PrimaryExpression*>(binary->left().get());
+		PrimaryExpression* right = static_cast<PrimaryExpression*>(binary->right().get());
+		PrimaryExpression* target_ptr = static_cast<PrimaryExpression*>(assignment->target().get());
+		if (left->primary_type() != PrimaryType::PRIMARY_IDENTIFIER || right->primary_type() != PrimaryType::PRIMARY_NUM
+			|| target_ptr->primary_type() != PrimaryType::PRIMARY_IDENTIFIER
+			|| *left->val().identifier_val != *target_ptr->val().identifier_val)
+		{ return false; }
+		target = assignment->target();
+		step = binary->op() == Operator::OPERATOR_ADD ? right->val().num_val : -right->val().num_val;
+	}
+	else
+	{ return false; }
+
+	if (!target->is_primary_expr())
+	{ return false; }
+	PrimaryExpression* primary = static_cast<PrimaryExpression*>(target.get());
+	if (primary->primary_type() != PrimaryType::PRIMARY_IDENTIFIER)
+	{ return false; }
+	const std::string& name = *primary->val().identifier_val;
+
+	//The update has to be the only write in the loop
+	auto writes = loop_writes.find(name);
+	if (writes == loop_writes.end() || writes->second != 1)
+	{ return false; }
+
+	stats_.induction_variables++;
+	std::stringstream ss{};
+	ss << "induction variable '" << name << "' steps by " << step;
+	report(update->pos(), ss.str());
+
+	if (update->is_unary_expr() || (step != 1 && step != -1))
+	{ return false; }
+
+	//'++' fails differently than '+' for anything but numbers, so the variable
+	//has to be declared by the loop or never be written outside of it
+	bool declared_num = false;
+	if (init && init->is_var_decl())
+	{
+		const VarInfo& info = static_cast<VarDeclStatement*>(init.get())->info();
+		declared_num = info.name == name && info.type.is(type_id("num"));
+	}
+	else
+	{
+		auto declarations = declarations_.find(name);
+		auto type = types_.find(name);
+		auto written = written_.find(name);
+		declared_num = declarations != declarations_.end() && declarations->second == 1
+			&& type != types_.end() && type->second.is(type_id("num"))
+			&& written != written_.end() && written->second == 1;
+	}
+	if (!declared_num)
+	{ return false; }
+
+	Operator op = step == 1 ? Operator::OPERATOR_INCREMENT : Operator::OPERATOR_DECREMENT;
+	update = expr_ptr(new UnaryExpression(op, target, update->pos()));
+	return true;
+}
+
+void Optimizer::declare_visible(const std::string& name)
+{
+	visible_index_.try_emplace(name, visible_.size());
+	visible_.push_back(name);
+}
+
+void Optimizer::forget_visible(size_t mark)
+{
+	while (visible_.size() > mark)
+	{
+		auto it = visible_index_.find(visible_.back());
+		if (it != visible_index_.end() && it->second == visible_.size() - 1)
+		{ visible_index_.erase(it); }
+		visible_.pop_back();
+	}
+}
+
+void Optimizer::report(Position pos, const std::string& message) const
+{
+	if (report_)
+	{ *report_ << pos.start_pos().line_off + 1 << ":" << pos.start_pos().char_off + 1 << ": " << message << "\n"; }
+}
+
+bool Optimizer::is_literal(const expr_ptr& expr)
+{
+	if (!expr || !expr->is_primary_expr())
+	{ return false; }
+
+	switch (static_cast<PrimaryExpression*>(expr.get())->primary_type())
+	{
+	case PrimaryType::PRIMARY_BOOL:
+	case PrimaryType::PRIMARY_NUM:
+	case PrimaryType::PRIMARY_STR:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool Optimizer::is_known_condition(const expr_ptr& expr)
+{
+	return is_literal(expr) && static_cast<PrimaryExpression*>(expr.get())->primary_type() == PrimaryType::PRIMARY_BOOL;
+}
+
+value_t Optimizer::literal_value(const expr_ptr& expr)
+{
+	PrimaryExpression* primary = static_cast<PrimaryExpression*>(expr.get());
+	switch (primary->primary_type())
+	{
+	case PrimaryType::PRIMARY_BOOL:
+		return value_t::boolean(primary->val().bool_val);
+	case PrimaryType::PRIMARY_NUM:
+		return value_t::number(primary->val().num_val);
+	case PrimaryType::PRIMARY_STR:
+		return CIL::String::create(*primary->val().str_val);
+	default:
+		return value_t::none();
+	}
+}
+
+expr_ptr Optimizer::make_literal(const value_t& value, Position pos)
+{
+	primary_value val{};
+	if (value.is_bool())
+	{
+		val.bool_val = value.as_bool();
+		return expr_ptr(new PrimaryExpression(PrimaryType::PRIMARY_BOOL, val, pos));
+	}
+	if (value.is_num())
+	{
+		val.num_val = value.as_num();
+		return expr_ptr(new PrimaryExpression(PrimaryType::PRIMARY_NUM, val, pos));
+	}
+	if (const CIL::String* str = value.as<CIL::String>())
+	{
+		//Folded strings have no token to point into, the pool keeps them alive
+		const value_t* pooled = constants_.add_string(str->value());
+		val.str_val = &pooled->as<CIL::String>()->value();
+		return expr_ptr(new PrimaryExpression(PrimaryType::PRIMARY_STR, val, pos));
+	}
+	return nullptr;
+}
+
+stmt_ptr Optimizer::make_empty(Position pos) const
+{
+	return Statement::make_block_stmt({}, pos);
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include "../cil-system.h"
+#include "Expression.h"
+#include "Statement.h"
+#include "ASTVisitor.h"
+#include "../Scanning/SymbolTable.h"
+#include "../Types/ConstantPool.h"
+
+//Simplifies the parsed program before it is resolved. Operators whose operands
+//are all literals are folded, reads of 'const' variables that are declared once
+//and never written are replaced by their value, and if/elif/while statements
+//whose condition is a literal lose the branches that can never run.
+//Inside loops, expressions that can neither fail nor change between iterations
+//are computed once before the outermost loop, and counting induction variables
+//are updated in place.
+//Nodes are never mutated: every visit returns the rewritten node, or nullptr
+//if the subtree stayed the same, so only the path to a change is rebuilt.
+class Optimizer : public ASTVisitor<Optimizer, expr_ptr, stmt_ptr>
+{
+	friend ASTVisitor<Optimizer, expr_ptr, stmt_ptr>;
+public:
+	struct Stats
+	{
+		size_t folded = 0;
+		size_t propagated = 0;
+		size_t branches = 0;
+		size_t hoisted = 0;
+		size_t induction_variables = 0;
+	};
+
+	Optimizer(stmt_list& program, ConstantPool& constants);
+
+	void optimize();
+
+	const Stats& stats() const
+	{ return stats_; }
+
+	void dump_stats(std::ostream& os) const;
+
+	//Describes every hoisted expression and induction variable on 'os'
+	void report_loops(std::ostream& os)
+	{ report_ = &os; }
+private:
+	//Collects how often every name is declared and written and its declared type
+	void collect_names();
+
+	//Rewrite the slot in place, optional children may be missing
+	bool optimize_expr(expr_ptr& expr);
+	bool optimize_stmt(stmt_ptr& stmt);
+	bool optimize_branch(stmt_ptr& stmt);
+	bool optimize_list(stmt_list& stmts);
+	bool optimize_list(expr_list& exprs);
+	bool optimize_function(const std::vector<std::string>& params, stmt_ptr& body);
+
+	//Returns the new head of an elif chain, nullptr once no branch is left
+	stmt_ptr optimize_elif_chain(const stmt_ptr& elif, bool& changed);
+
+	expr_ptr visit_error_expr(ErrorExpression* expr);
+	expr_ptr visit_grouping_expr(GroupingExpression* expr);
+	expr_ptr visit_primary_expr(PrimaryExpression* expr);
+	expr_ptr visit_call_expr(CallExpression* expr);
+	expr_ptr visit_access_expr(AccessExpression* expr);
+	expr_ptr visit_new_expr(NewExpression* expr);
+	expr_ptr visit_array_access_expr(ArrayAccessExpression* expr);
+	expr_ptr visit_unary_expr(UnaryExpression* expr);
+	expr_ptr visit_binary_expr(BinaryExpression* expr);
+	expr_ptr visit_ternary_expr(TernaryExpression* expr);
+	expr_ptr visit_assignment_expr(AssignmentExpression* expr);
+
+	stmt_ptr visit_error_stmt(ErrorStatement* stmt);
+	stmt_ptr visit_block_stmt(BlockStatement* stmt);
+	stmt_ptr visit_break_stmt(BreakStatement* stmt);
+	stmt_ptr visit_return_stmt(ReturnStatement* stmt);
+	stmt_ptr visit_print_stmt(PrintStatement* stmt);
+	stmt_ptr visit_if_stmt(IfStatement* stmt);
+	stmt_ptr visit_elif_stmt(ElifStatement* stmt);
+	stmt_ptr visit_while_stmt(WhileStatement* stmt);
+	stmt_ptr visit_for_stmt(ForStatement* stmt);
+	stmt_ptr visit_var_decl_stmt(VarDeclStatement* stmt);
+	stmt_ptr visit_arr_decl_stmt(ArrDeclStatement* stmt);
+	stmt_ptr visit_func_decl_stmt(FuncDeclStatement* stmt);
+	stmt_ptr visit_class_decl_stmt(ClassDeclStatement* stmt);
+	stmt_ptr visit_expr_stmt(ExprStatement* stmt);
+
+	//Loop-invariant code motion. The outermost loop of a nest that sits in a
+	//statement list is walked a second time, and every maximal invariant
+	//expression is replaced by a constant declared in front of the loop.
+	//'visible' is the number of names that were declared before the loop
+	void hoist_invariants(stmt_ptr& loop, size_t visible);
+	//The type an expression is known to have, if it only reads names that are
+	//declared once, never written and already declared in front of the loop.
+	//Operators are limited to the ones that can not fail for these types
+	bool invariant_type(const expr_ptr& expr, Type& type) const;
+	expr_ptr hoist(const expr_ptr& expr, Type type);
+
+	//Recognizes 'i++', 'i--', 'i = i + c' and 'i = i - c' updates of a variable
+	//that is not written anywhere else in the loop. Steps of one are rewritten
+	//to '++'/'--', which the interpreter specializes to an in-place update
+	bool induction_variable(expr_ptr& update, const stmt_ptr& init, const std::unordered_map<std::string, size_t>& loop_writes);
+
+	void declare_visible(const std::string& name);
+	void forget_visible(size_t mark);
+	void report(Position pos, const std::string& message) const;
+
+	static bool is_literal(const expr_ptr& expr);
+	//Only bool literals are known conditions, anything else is left to the engines
+	static bool is_known_condition(const expr_ptr& expr);
+	static value_t literal_value(const expr_ptr& expr);
+
+	//nullptr if the value has no literal form
+	expr_ptr make_literal(const value_t& value, Position pos);
+	stmt_ptr make_empty(Position pos) const;
+
+	stmt_list& program_;
+	ConstantPool& constants_;
+
+	std::unordered_map<std::string, size_t> declarations_;
+	std::unordered_map<std::string, size_t> written_;
+	std::unordered_map<std::string, Type> types_;
+	std::unordered_map<std::string, expr_ptr> known_constants_;
+
+	//Names declared so far in the function (or top level) being optimized, in
+	//declaration order, blocks drop theirs when they end
+	std::vector<std::string> visible_;
+	std::unordered_map<std::string, size_t> visible_index_;
+
+	size_t loop_depth_;
+	//While hoisting, only names declared before this index may be read
+	bool hoisting_;
+	size_t hoist_visible_;
+	stmt_list hoisted_;
+	//Hoisted expressions are read through these names, the AST points into them
+	std::deque<std::string> hoisted_names_;
+	std::ostream* report_;
+
+	Stats stats_;
+};
@@ -1,10 +1,13 @@
 #include "Parser.h"
 
-Parser::Parser(token_list& tokens)
-    : tokens_(tokens), current(0), func_level(0), loop_level(0), has_return_(false) {}
+Parser::Parser(Isolate& isolate, token_list& tokens)
+    : isolate_(isolate), tokens_(tokens), current(0), func_level(0), loop_level(0), parallel_func_level(-1), parallel_loop_level(-1),
+      has_return_(false) {}
 
 stmt_list& Parser::parse()
 {
+    Isolate::Scope scope{ isolate_ };
+
     stmt_list* program = new stmt_list();
     while (!this->atEnd())
     {
@@ -15,6 +18,8 @@ stmt_list& Parser::parse()
 
 expr_ptr Parser::parse_single_expr()
 {
+    Isolate::Scope scope{ isolate_ };
+
     expr_ptr expr = this->expression();
     if (!this->atEnd())
     {
@@ -25,6 +30,8 @@ expr_ptr Parser::parse_single_expr()
 
 stmt_ptr Parser::parse_single_stmt()
 {
+    Isolate::Scope scope{ isolate_ };
+
     return this->statement();
 }
 
@@ -109,6 +116,7 @@ void Parser::synchronize()
         if (this->match_keyword(Keyword::KEYWORD_PRINT) ||
             this->match_keyword(Keyword::KEYWORD_IF   ) ||
             this->match_keyword(Keyword::KEYWORD_FOR  ) ||
+            this->match_keyword(Keyword::KEYWORD_PARALLEL) ||
             this->match_keyword(Keyword::KEYWORD_WHILE) ||
             this->match_keyword(Keyword::KEYWORD_DEF  ) ||
             this->match_keyword(Keyword::KEYWORD_CLASS) ||
@@ -314,8 +322,14 @@ expr_ptr Parser::call_expr()
                 }
             }
             //TODO: Add a local symbol table
+            //Functions of the program take precedence over intrinsics of the same name
             if (!SymbolTable::global_function_exists(id->identifier()))
-			{ throw CILError::error(id->pos(), "Function '" + id->identifier() + "' does not exist"); }
+            {
+                Intrinsic intrinsic = CallExpression::intrinsic_named(id->identifier());
+                if (intrinsic == Intrinsic::INTRINSIC_NONE)
+                { throw CILError::error(id->pos(), "Function '" + id->identifier() + "' does not exist"); }
+                return Expression::make_call_expr(id, args, this->pos_from_tokens(id, r_paren), intrinsic);
+            }
             
             parse_function(SymbolTable::get_global_function(id->identifier()));
 
@@ -606,6 +620,8 @@ stmt_ptr Parser::break_stmt()
     {
         if (this->loop_level < 1)
         { throw CILError::error(break_keyword->pos(), "'break' can only be used inside a loop body"); }
+        if (this->loop_level == this->parallel_loop_level)
+        { throw CILError::error(break_keyword->pos(), "'break' cannot leave a parallel loop"); }
         const token_ptr semicolon = this->peek();
         expect_symbol(Symbol::SEMICOLON);
         return Statement::make_break_stmt(this->pos_from_tokens(break_keyword, semicolon));
@@ -620,6 +636,8 @@ stmt_ptr Parser::return_stmt()
     {
         if(this->func_level < 1)
         { throw CILError::error(ret_keyword->pos(), "'return' can only be used inside a function body"); }
+        if (this->func_level == this->parallel_func_level)
+        { throw CILError::error(ret_keyword->pos(), "'return' cannot leave a parallel loop"); }
         expr_ptr expr = this->expression();
         const token_ptr semicolon = this->peek();
         expect_symbol(Symbol::SEMICOLON);
@@ -697,22 +715,80 @@ stmt_ptr Parser::while_stmt()
 stmt_ptr Parser::for_stmt()
 {
     const token_ptr for_keyword = this->peek();
-    if (this->match_keyword(Keyword::KEYWORD_FOR))
+    bool parallel = this->match_keyword(Keyword::KEYWORD_PARALLEL);
+    if (parallel)
+    { expect_keyword(Keyword::KEYWORD_FOR); }
+    if (parallel || this->match_keyword(Keyword::KEYWORD_FOR))
     {
         expect_symbol(Symbol::LEFT_PAREN);
         stmt_ptr init = this->statement();
         expr_ptr cond = this->expression();
         expect_symbol(Symbol::SEMICOLON);
         expr_ptr exec = this->expression();
+        const token_ptr r_paren = this->peek();
         expect_symbol(Symbol::RIGHT_PAREN);
+        //The iterations are split up before any of them runs, so the range has to be known up front
+        if (parallel && !is_counting_loop(init, cond, exec))
+        {
+            throw CILError::error(Position{ for_keyword->pos(), r_paren->pos() },
+                "A parallel loop has to count a 'num' up by one, like 'parallel for (num i = 0; i < n; i++)'");
+        }
+
+        int parallel_func = this->parallel_func_level;
+        int parallel_loop = this->parallel_loop_level;
         this->loop_level++;
+        if (parallel)
+        {
+            this->parallel_func_level = this->func_level;
+            this->parallel_loop_level = this->loop_level;
+        }
         stmt_ptr inner = this->statement();
         this->loop_level--;
-        return Statement::make_for_stmt(init, cond, exec, inner, Position{ for_keyword->pos(), inner->pos() });
+        this->parallel_func_level = parallel_func;
+        this->parallel_loop_level = parallel_loop;
+        return Statement::make_for_stmt(init, cond, exec, inner, Position{ for_keyword->pos(), inner->pos() }, parallel);
     }
     return this->while_stmt();
 }
 
+bool Parser::is_counting_loop(const stmt_ptr& init, const expr_ptr& cond, const expr_ptr& exec)
+{
+    auto is_identifier = [](const expr_ptr& expr, const std::string& name)
+    {
+        if (!expr->is_primary_expr())
+        { return false; }
+        PrimaryExpression* primary = static_cast<PrimaryExpression*>(expr.get());
+        return primary->primary_type() == PrimaryType::PRIMARY_IDENTIFIER && *primary->val().identifier_val == name;
+    };
+
+    if (!init->is_var_decl() || !static_cast<VarDeclStatement*>(init.get())->info().type.is(type_id("num")))
+    { return false; }
+    const std::string& name = static_cast<VarDeclStatement*>(init.get())->info().name;
+
+    if (!cond->is_binary_expr())
+    { return false; }
+    BinaryExpression* compare = static_cast<BinaryExpression*>(cond.get());
+    if ((compare->op() != Operator::OPERATOR_LESS && compare->op() != Operator::OPERATOR_LESS_EQUAL)
+        || !is_identifier(compare->left(), name))
+    { return false; }
+
+    if (exec->is_unary_expr())
+    {
+        UnaryExpression* step = static_cast<UnaryExpression*>(exec.get());
+        return step->op() == Operator::OPERATOR_INCREMENT && is_identifier(step->expr(), name);
+    }
+    if (!exec->is_assignment_expr())
+    { return false; }
+    AssignmentExpression* assignment = static_cast<AssignmentExpression*>(exec.get());
+    if (!is_identifier(assignment->target(), name) || !assignment->expr()->is_binary_expr())
+    { return false; }
+    BinaryExpression* step = static_cast<BinaryExpression*>(assignment->expr().get());
+    if (step->op() != Operator::OPERATOR_ADD || !is_identifier(step->left(), name) || !step->right()->is_primary_expr())
+    { return false; }
+    PrimaryExpression* one = static_cast<PrimaryExpression*>(step->right().get());
+    return one->primary_type() == PrimaryType::PRIMARY_NUM && one->val().num_val == 1;
+}
+
 stmt_ptr Parser::var_decl_stmt()
 {
     Type type = Type::make("error");
@@ -941,11 +1017,14 @@ void Parser::parse_variable(SymbolTable::Variable& var)
 void Parser::parse_function(SymbolTable::Function& func)
 {
     //TODO: Implement parsing of parameter-default values
-    Parser p{ func.tokens };
+    //Marked before parsing, so recursive calls inside the body do not reparse it
+    if (func.parsed)
+    { return; }
+    func.parsed = true;
+    Parser p{ isolate_, func.tokens };
     p.func_level++;
     stmt_ptr body = p.parse_single_stmt();
     func.body = body;
-    func.parsed = true;
 }
 
 void Parser::parse_class(SymbolTable::Class& cls)
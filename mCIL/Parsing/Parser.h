@@ -8,11 +8,12 @@
 #include "Expression.h"
 #include "Statement.h"
 #include "../Scanning/SymbolTable.h"
+#include "../Interpreting/Isolate.h"
 
 class Parser
 {
 public:
-	Parser(token_list& tokens);
+	Parser(Isolate& isolate, token_list& tokens);
 
 	stmt_list& parse();
 
@@ -83,6 +84,8 @@ private:
 	stmt_ptr if_stmt();
 	stmt_ptr while_stmt();
 	stmt_ptr for_stmt();
+	//Whether a loop counts a 'num' it declares up by one, like 'num i = a; i < b; i++'
+	static bool is_counting_loop(const stmt_ptr& init, const expr_ptr& cond, const expr_ptr& exec);
 	stmt_ptr var_decl_stmt();
 	stmt_ptr arr_decl_stmt();
 	stmt_ptr func_decl_stmt();
@@ -93,11 +96,15 @@ private:
 	void parse_function(SymbolTable::Function& func);
 	void parse_class(SymbolTable::Class& cls);
 
+	Isolate& isolate_;
 	token_list& tokens_;
 	int current;
 
 	int func_level;
 	int loop_level;
+	//Levels of the innermost parallel loop's body, 'break' and 'return' may not leave it
+	int parallel_func_level;
+	int parallel_loop_level;
 
 	bool has_return_;
 };
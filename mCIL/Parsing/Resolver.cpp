@@ -0,0 +1,465 @@
+#include "Resolver.h"
+
+Resolver::Resolver(stmt_list& program, ConstantPool& constants)
+	: program_(program), constants_(constants), scopes_(), dynamic_level_(0), conditional_(false), call_sites_(0), access_sites_(0),
+	  functions_(), function_(nullptr), tail_candidates_(), tail_calls_(0)
+{
+}
+
+void Resolver::resolve()
+{
+	begin_scope();
+	for (const stmt_ptr& stmt : program_)
+	{
+		resolve_stmt(stmt);
+	}
+	end_scope();
+
+	for (auto& pair : SymbolTable::global_table()->funcs_)
+	{
+		SymbolTable::Function& func = pair.second;
+		if (!func.body)
+		{ continue; }
+
+		std::vector<std::string> params{};
+		for (SymbolTable::Variable& arg : func.args)
+		{
+			params.push_back(arg.name);
+		}
+		resolve_function(pair.first, params, func.body);
+	}
+
+	mark_tail_calls();
+}
+
+void Resolver::resolve_function(const std::string& name, const std::vector<std::string>& params, const stmt_ptr& body)
+{
+	if (!body)
+	{ return; }
+
+	FunctionInfo* function = function_;
+	function_ = &functions_[name];
+
+	//Function bodies only see their own scopes statically, the caller's
+	//scopes are reachable through the environment chain by name
+	std::vector<Scope> enclosing = std::move(scopes_);
+	int dynamic_level = dynamic_level_;
+	bool conditional = conditional_;
+	scopes_.clear();
+	dynamic_level_ = 0;
+	conditional_ = false;
+
+	begin_scope();
+	for (const std::string& param : params)
+	{
+		declare_var(param);
+		declare_name(param);
+	}
+	resolve_stmt(body);
+	end_scope();
+
+	function_ = function;
+	scopes_ = std::move(enclosing);
+	dynamic_level_ = dynamic_level;
+	conditional_ = conditional;
+}
+
+void Resolver::resolve_expr(const expr_ptr& expr)
+{
+	if (expr)
+	{ visit_expr(expr); }
+}
+
+void Resolver::resolve_stmt(const stmt_ptr& stmt)
+{
+	if (stmt)
+	{ visit_stmt(stmt); }
+}
+
+void Resolver::visit_error_expr(ErrorExpression*)
+{
+}
+
+void Resolver::visit_grouping_expr(GroupingExpression* expr)
+{
+	resolve_expr(expr->expr());
+}
+
+void Resolver::visit_primary_expr(PrimaryExpression* expr)
+{
+	if (expr->primary_type() == PrimaryType::PRIMARY_IDENTIFIER)
+	{
+		expr->resolve(lookup_var(*expr->val().identifier_val));
+		if (!expr->slot().resolved())
+		{ use_name(*expr->val().identifier_val); }
+	}
+	else
+	{ intern_literal(expr); }
+}
+
+void Resolver::visit_call_expr(CallExpression* expr)
+{
+	//Intrinsics only look up the arrays they are given, which is no reason to give up on tail calls
+	if (expr->intrinsic() != Intrinsic::INTRINSIC_NONE)
+	{
+		for (const expr_ptr& arg : expr->args())
+		{ resolve_expr(arg); }
+		return;
+	}
+	expr->resolve(lookup_func(expr->identifier()), call_sites_++);
+	if (!expr->slot().resolved())
+	{ use_name(expr->identifier()); }
+	if (function_)
+	{ function_->calls.insert(expr->identifier()); }
+	for (const expr_ptr& arg : expr->args())
+	{
+		resolve_expr(arg);
+	}
+}
+
+void Resolver::visit_access_expr(AccessExpression* expr)
+{
+	expr->resolve(lookup_var(expr->identifier()), access_sites_++);
+	if (!expr->slot().resolved())
+	{ use_name(expr->identifier()); }
+	if (function_)
+	{ function_->opaque = true; }
+	dynamic_level_++;
+	resolve_expr(expr->inner());
+	dynamic_level_--;
+}
+
+void Resolver::visit_new_expr(NewExpression* expr)
+{
+	//Member initializers run when the object is created
+	if (function_)
+	{ function_->opaque = true; }
+	for (const expr_ptr& arg : expr->args())
+	{
+		resolve_expr(arg);
+	}
+}
+
+void Resolver::visit_array_access_expr(ArrayAccessExpression* expr)
+{
+	use_name(expr->identifier());
+	resolve_expr(expr->index());
+}
+
+void Resolver::visit_unary_expr(UnaryExpression* expr)
+{
+	resolve_expr(expr->expr());
+}
+
+void Resolver::visit_binary_expr(BinaryExpression* expr)
+{
+	resolve_expr(expr->left());
+	resolve_expr(expr->right());
+}
+
+void Resolver::visit_ternary_expr(TernaryExpression* expr)
+{
+	resolve_expr(expr->cond());
+	resolve_expr(expr->left());
+	resolve_expr(expr->right());
+}
+
+void Resolver::visit_assignment_expr(AssignmentExpression* expr)
+{
+	resolve_expr(expr->expr());
+	resolve_expr(expr->target());
+}
+
+void Resolver::visit_error_stmt(ErrorStatement*)
+{
+}
+
+void Resolver::visit_block_stmt(BlockStatement* stmt)
+{
+	bool conditional = conditional_;
+	conditional_ = false;
+	begin_scope();
+	for (const stmt_ptr& inner : stmt->inner())
+	{
+		resolve_stmt(inner);
+	}
+	end_scope();
+	conditional_ = conditional;
+}
+
+void Resolver::visit_break_stmt(BreakStatement*)
+{
+}
+
+void Resolver::visit_return_stmt(ReturnStatement* stmt)
+{
+	resolve_expr(stmt->expr());
+	if (function_ && stmt->expr() && stmt->expr()->is_call_expr())
+	{ tail_candidates_.push_back({ static_cast<CallExpression*>(stmt->expr().get()), function_ }); }
+}
+
+void Resolver::visit_print_stmt(PrintStatement* stmt)
+{
+	resolve_expr(stmt->expr());
+}
+
+void Resolver::visit_if_stmt(IfStatement* stmt)
+{
+	resolve_expr(stmt->cond());
+	resolve_branch(stmt->if_branch());
+	resolve_stmt(stmt->top_elif());
+}
+
+void Resolver::visit_elif_stmt(ElifStatement* stmt)
+{
+	resolve_expr(stmt->cond());
+	resolve_branch(stmt->inner());
+	resolve_stmt(stmt->next_elif());
+}
+
+void Resolver::visit_while_stmt(WhileStatement* stmt)
+{
+	resolve_expr(stmt->cond());
+	resolve_branch(stmt->inner());
+}
+
+void Resolver::visit_for_stmt(ForStatement* stmt)
+{
+	//The initializer is declared in the enclosing scope, just like the interpreter does.
+	//Parallel loops give every chunk a scope of its own that holds the loop variable
+	if (stmt->parallel())
+	{ begin_scope(); }
+	resolve_stmt(stmt->init());
+	resolve_expr(stmt->cond());
+	resolve_branch(stmt->inner());
+	resolve_expr(stmt->exec());
+	if (stmt->parallel())
+	{ end_scope(); }
+}
+
+void Resolver::visit_var_decl_stmt(VarDeclStatement* stmt)
+{
+	resolve_expr(stmt->val());
+	stmt->resolve(declare_var(stmt->info().name));
+	declare_name(stmt->info().name);
+}
+
+void Resolver::visit_arr_decl_stmt(ArrDeclStatement* stmt)
+{
+	declare_name(stmt->info().name);
+	for (const expr_ptr& val : stmt->vals())
+	{
+		resolve_expr(val);
+	}
+}
+
+void Resolver::visit_func_decl_stmt(FuncDeclStatement* stmt)
+{
+	stmt->resolve(declare_func(stmt->info().name));
+	declare_name(stmt->info().name);
+
+	std::vector<std::string> params{};
+	for (const VarInfo& arg : stmt->info().args)
+	{
+		params.push_back(arg.name);
+	}
+	resolve_function(stmt->info().name, params, stmt->body());
+}
+
+void Resolver::visit_class_decl_stmt(ClassDeclStatement* stmt)
+{
+	declare_name(stmt->info().name);
+	for (const stmt_ptr& member : stmt->members())
+	{
+		resolve_expr(static_cast<VarDeclStatement*>(member.get())->val());
+	}
+	for (const stmt_ptr& method : stmt->methods())
+	{
+		FuncDeclStatement* method_ptr = static_cast<FuncDeclStatement*>(method.get());
+		std::vector<std::string> params{};
+		for (const VarInfo& arg : method_ptr->info().args)
+		{
+			params.push_back(arg.name);
+		}
+		resolve_function(method_ptr->info().name, params, method_ptr->body());
+	}
+}
+
+void Resolver::visit_expr_stmt(ExprStatement* stmt)
+{
+	resolve_expr(stmt->expr());
+}
+
+void Resolver::resolve_branch(const stmt_ptr& stmt)
+{
+	bool conditional = conditional_;
+	conditional_ = true;
+	resolve_stmt(stmt);
+	conditional_ = conditional;
+}
+
+void Resolver::mark_tail_calls()
+{
+	//Close the dynamic names over the call graph until nothing changes anymore
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		for (auto& pair : functions_)
+		{
+			FunctionInfo& caller = pair.second;
+			if (caller.opaque)
+			{ continue; }
+			for (const std::string& name : caller.calls)
+			{
+				auto callee = functions_.find(name);
+				//Calls to unknown functions may end up in a method
+				if (callee == functions_.end() || callee->second.opaque)
+				{
+					caller.opaque = true;
+					changed = true;
+					break;
+				}
+				for (const std::string& dynamic : callee->second.dynamic)
+				{
+					changed |= caller.dynamic.insert(dynamic).second;
+				}
+			}
+		}
+	}
+
+	for (auto& [call, caller] : tail_candidates_)
+	{
+		auto callee = functions_.find(call->identifier());
+		if (callee == functions_.end() || callee->second.opaque || caller->declared.contains(call->identifier()))
+		{ continue; }
+
+		bool shadowed = false;
+		for (const std::string& name : callee->second.dynamic)
+		{
+			if (caller->declared.contains(name))
+			{
+				shadowed = true;
+				break;
+			}
+		}
+		if (!shadowed)
+		{
+			call->mark_tail();
+			tail_calls_++;
+		}
+	}
+	tail_candidates_.clear();
+}
+
+void Resolver::declare_name(const std::string& name)
+{
+	if (function_)
+	{ function_->declared.insert(name); }
+}
+
+void Resolver::use_name(const std::string& name)
+{
+	if (function_)
+	{ function_->dynamic.insert(name); }
+}
+
+void Resolver::begin_scope()
+{
+	scopes_.push_back({});
+}
+
+void Resolver::end_scope()
+{
+	scopes_.pop_back();
+}
+
+int Resolver::declare_var(const std::string& name)
+{
+	Scope& scope = scopes_.back();
+	//A declaration that might not run leaves the name to be looked up dynamically
+	if (conditional_)
+	{
+		scope.vars[name] = -1;
+		return -1;
+	}
+
+	auto it = scope.vars.find(name);
+	if (it != scope.vars.end() && it->second >= 0)
+	{ return it->second; }
+	scope.vars[name] = scope.var_count;
+	return scope.var_count++;
+}
+
+int Resolver::declare_func(const std::string& name)
+{
+	Scope& scope = scopes_.back();
+	if (conditional_)
+	{
+		scope.funcs[name] = -1;
+		return -1;
+	}
+
+	auto it = scope.funcs.find(name);
+	if (it != scope.funcs.end() && it->second >= 0)
+	{ return it->second; }
+	scope.funcs[name] = scope.func_count;
+	return scope.func_count++;
+}
+
+ScopeSlot Resolver::lookup_var(const std::string& name) const
+{
+	if (dynamic_level_ > 0)
+	{ return {}; }
+
+	for (size_t i = scopes_.size(); i-- > 0;)
+	{
+		auto it = scopes_[i].vars.find(name);
+		if (it != scopes_[i].vars.end())
+		{
+			if (it->second < 0)
+			{ return {}; }
+			return { (int)(scopes_.size() - 1 - i), it->second };
+		}
+	}
+	return {};
+}
+
+ScopeSlot Resolver::lookup_func(const std::string& name) const
+{
+	if (dynamic_level_ > 0)
+	{ return {}; }
+
+	for (size_t i = scopes_.size(); i-- > 0;)
+	{
+		auto it = scopes_[i].funcs.find(name);
+		if (it != scopes_[i].funcs.end())
+		{
+			if (it->second < 0)
+			{ return {}; }
+			return { (int)(scopes_.size() - 1 - i), it->second };
+		}
+	}
+	return {};
+}
+
+void Resolver::intern_literal(PrimaryExpression* primary)
+{
+	switch (primary->primary_type())
+	{
+	case PrimaryType::PRIMARY_NONE:
+		primary->intern(constants_.add_none());
+		break;
+	case PrimaryType::PRIMARY_BOOL:
+		primary->intern(constants_.add_bool(primary->val().bool_val));
+		break;
+	case PrimaryType::PRIMARY_NUM:
+		primary->intern(constants_.add_number(primary->val().num_val));
+		break;
+	case PrimaryType::PRIMARY_STR:
+		primary->intern(constants_.add_string(*primary->val().str_val));
+		break;
+	default:
+		break;
+	}
+}
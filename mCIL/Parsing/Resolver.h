@@ -0,0 +1,120 @@
+#pragma once
+#include "../cil-system.h"
+#include "Expression.h"
+#include "Statement.h"
+#include "ASTVisitor.h"
+#include "../Scanning/SymbolTable.h"
+#include "../Types/ConstantPool.h"
+
+//Assigns (depth, slot) pairs to identifiers that are declared lexically inside
+//the same function body (or top-level program) as their use. Everything else
+//(globals, object members, names only visible through the caller) stays
+//unresolved and is looked up by name at runtime.
+//Literals are interned into the constant pool on the same walk.
+//It also marks 'return f(...)' calls that may reuse the returning function's
+//frame, see mark_tail_calls.
+class Resolver : public ASTVisitor<Resolver>
+{
+	friend ASTVisitor<Resolver>;
+public:
+	Resolver(stmt_list& program, ConstantPool& constants);
+
+	void resolve();
+
+	size_t call_sites() const
+	{ return call_sites_; }
+
+	size_t tail_calls() const
+	{ return tail_calls_; }
+private:
+	struct Scope
+	{
+		std::unordered_map<std::string, int> vars;
+		std::unordered_map<std::string, int> funcs;
+		int var_count = 0;
+		int func_count = 0;
+	};
+
+	//What a function body contributes to the tail call analysis. Functions are
+	//keyed by name, bodies sharing a name are merged
+	struct FunctionInfo
+	{
+		//Everything the body may put into its own frame or one of its blocks
+		std::unordered_set<std::string> declared;
+		//Names the body looks up through the environment chain
+		std::unordered_set<std::string> dynamic;
+		std::unordered_set<std::string> calls;
+		//Objects bring names of their own, nothing is known about their lookups
+		bool opaque = false;
+	};
+
+	void resolve_function(const std::string& name, const std::vector<std::string>& params, const stmt_ptr& body);
+
+	//A call in tail position can run in place of the returning function's frame
+	//if nothing the callee (or anything it calls) looks up by name could have been
+	//declared by the returning function, since that frame is gone once it runs
+	void mark_tail_calls();
+	void declare_name(const std::string& name);
+	void use_name(const std::string& name);
+
+	//Optional children (initializers, else branches) may be missing
+	void resolve_expr(const expr_ptr& expr);
+	void resolve_stmt(const stmt_ptr& stmt);
+	void resolve_branch(const stmt_ptr& stmt);
+
+	void visit_error_expr(ErrorExpression* expr);
+	void visit_grouping_expr(GroupingExpression* expr);
+	void visit_primary_expr(PrimaryExpression* expr);
+	void visit_call_expr(CallExpression* expr);
+	void visit_access_expr(AccessExpression* expr);
+	void visit_new_expr(NewExpression* expr);
+	void visit_array_access_expr(ArrayAccessExpression* expr);
+	void visit_unary_expr(UnaryExpression* expr);
+	void visit_binary_expr(BinaryExpression* expr);
+	void visit_ternary_expr(TernaryExpression* expr);
+	void visit_assignment_expr(AssignmentExpression* expr);
+
+	void visit_error_stmt(ErrorStatement* stmt);
+	void visit_block_stmt(BlockStatement* stmt);
+	void visit_break_stmt(BreakStatement* stmt);
+	void visit_return_stmt(ReturnStatement* stmt);
+	void visit_print_stmt(PrintStatement* stmt);
+	void visit_if_stmt(IfStatement* stmt);
+	void visit_elif_stmt(ElifStatement* stmt);
+	void visit_while_stmt(WhileStatement* stmt);
+	void visit_for_stmt(ForStatement* stmt);
+	void visit_var_decl_stmt(VarDeclStatement* stmt);
+	void visit_arr_decl_stmt(ArrDeclStatement* stmt);
+	void visit_func_decl_stmt(FuncDeclStatement* stmt);
+	void visit_class_decl_stmt(ClassDeclStatement* stmt);
+	void visit_expr_stmt(ExprStatement* stmt);
+
+	void begin_scope();
+	void end_scope();
+
+	int declare_var(const std::string& name);
+	int declare_func(const std::string& name);
+
+	ScopeSlot lookup_var(const std::string& name) const;
+	ScopeSlot lookup_func(const std::string& name) const;
+
+	void intern_literal(PrimaryExpression* primary);
+
+	stmt_list& program_;
+	ConstantPool& constants_;
+
+	std::vector<Scope> scopes_;
+
+	//Inside the inner expression of an access, names refer to the object first
+	int dynamic_level_;
+	//Declarations that are the direct body of a branch or loop may not run
+	bool conditional_;
+	size_t call_sites_;
+	size_t access_sites_;
+
+	std::unordered_map<std::string, FunctionInfo> functions_;
+	//nullptr on the top level
+	FunctionInfo* function_;
+	std::vector<std::pair<CallExpression*, FunctionInfo*>> tail_candidates_;
+	size_t tail_calls_;
+};
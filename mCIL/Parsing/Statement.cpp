@@ -40,9 +40,9 @@ stmt_ptr Statement::make_while_stmt(expr_ptr cond, stmt_ptr inner, Position pos)
     return stmt_ptr(new WhileStatement(cond, inner, pos));
 }
 
-stmt_ptr Statement::make_for_stmt(stmt_ptr init, expr_ptr cond, expr_ptr exec, stmt_ptr inner, Position pos)
+stmt_ptr Statement::make_for_stmt(stmt_ptr init, expr_ptr cond, expr_ptr exec, stmt_ptr inner, Position pos, bool parallel)
 {
-    return stmt_ptr(new ForStatement(init, cond, exec, inner, pos));
+    return stmt_ptr(new ForStatement(init, cond, exec, inner, pos, parallel));
 }
 
 stmt_ptr Statement::make_var_decl_stmt(VarInfo info, expr_ptr val, Position pos)
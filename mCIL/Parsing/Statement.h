@@ -42,7 +42,7 @@ public:
 	static stmt_ptr make_if_stmt(expr_ptr cond, stmt_ptr if_branch, stmt_ptr top_elif, Position pos);
 	static stmt_ptr make_elif_stmt(expr_ptr cond, stmt_ptr inner, stmt_ptr next_elif, Position pos);
 	static stmt_ptr make_while_stmt(expr_ptr cond, stmt_ptr inner, Position pos);
-	static stmt_ptr make_for_stmt(stmt_ptr init, expr_ptr cond, expr_ptr exec, stmt_ptr inner, Position pos);
+	static stmt_ptr make_for_stmt(stmt_ptr init, expr_ptr cond, expr_ptr exec, stmt_ptr inner, Position pos, bool parallel = false);
 	static stmt_ptr make_var_decl_stmt(VarInfo info, expr_ptr val, Position pos);
 	static stmt_ptr make_arr_decl_stmt(ArrInfo info, expr_list vals, Position pos);
 	static stmt_ptr make_func_decl_stmt(FuncInfo info, stmt_ptr body, Position pos);
@@ -115,7 +115,7 @@ public:
 	BlockStatement(stmt_list inner, Position pos)
 		: Statement(StmtType::STATEMENT_BLOCK, pos), inner_(inner) {}
 
-	const stmt_list inner() const
+	const stmt_list& inner() const
 	{ return inner_; }
 private:
 	stmt_list inner_;
@@ -134,7 +134,7 @@ public:
 	ReturnStatement(expr_ptr expr, Position pos)
 		: Statement(StmtType::STATEMENT_RETURN, pos), expr_(expr) {}
 
-	const expr_ptr expr() const
+	const expr_ptr& expr() const
 	{ return this->expr_; }
 private:
 	expr_ptr expr_;
@@ -146,7 +146,7 @@ public:
 	PrintStatement(expr_ptr expr, Position pos)
 		: Statement(StmtType::STATEMENT_PRINT, pos), expr_(expr) {}
 
-	const expr_ptr expr() const
+	const expr_ptr& expr() const
 	{ return expr_; }
 private:
 	expr_ptr expr_;
@@ -158,13 +158,13 @@ public:
 	IfStatement(expr_ptr cond, stmt_ptr if_branch, stmt_ptr top_elif, Position pos)
 		: Statement(StmtType::STATEMENT_IF, pos), cond_(cond), if_branch_(if_branch), top_elif_(top_elif) {}
 
-	const expr_ptr cond() const
+	const expr_ptr& cond() const
 	{ return cond_; }
 
-	const stmt_ptr if_branch() const
+	const stmt_ptr& if_branch() const
 	{ return if_branch_; }
 
-	const stmt_ptr top_elif() const
+	const stmt_ptr& top_elif() const
 	{ return top_elif_; }
 private:
 	expr_ptr cond_;
@@ -178,13 +178,13 @@ public:
 	ElifStatement(expr_ptr cond, stmt_ptr inner, stmt_ptr next_elif, Position pos)
 		: Statement(StmtType::STATEMENT_ELIF, pos), cond_(cond), inner_(inner), next_elif_(next_elif) {}
 
-	const expr_ptr cond() const
+	const expr_ptr& cond() const
 	{ return cond_;	}
 
-	const stmt_ptr inner() const
+	const stmt_ptr& inner() const
 	{ return inner_; }
 
-	const stmt_ptr next_elif() const
+	const stmt_ptr& next_elif() const
 	{ return next_elif_; }
 private:
 	expr_ptr cond_;
@@ -198,10 +198,10 @@ public:
 	WhileStatement(expr_ptr cond, stmt_ptr inner, Position pos)
 		: Statement(StmtType::STATEMENT_WHILE, pos), cond_(cond), inner_(inner) {}
 
-	const expr_ptr cond() const
+	const expr_ptr& cond() const
 	{ return cond_; }
 
-	const stmt_ptr inner() const
+	const stmt_ptr& inner() const
 	{ return inner_; }
 private:
 	expr_ptr cond_;
@@ -211,25 +211,31 @@ private:
 class ForStatement : public Statement
 {
 public:
-	ForStatement(stmt_ptr init, expr_ptr cond, expr_ptr exec, stmt_ptr inner, Position pos)
-		: Statement(StmtType::STATEMENT_FOR, pos), init_(init), cond_(cond), exec_(exec), inner_(inner) {}
+	ForStatement(stmt_ptr init, expr_ptr cond, expr_ptr exec, stmt_ptr inner, Position pos, bool parallel = false)
+		: Statement(StmtType::STATEMENT_FOR, pos), init_(init), cond_(cond), exec_(exec), inner_(inner), parallel_(parallel) {}
 
-	const stmt_ptr init() const
+	const stmt_ptr& init() const
 	{ return init_; }
 
-	const expr_ptr cond() const
+	const expr_ptr& cond() const
 	{ return cond_; }
 
-	const expr_ptr exec() const
+	const expr_ptr& exec() const
 	{ return exec_; }
 
-	const stmt_ptr inner() const
+	const stmt_ptr& inner() const
 	{ return inner_; }
+
+	//'parallel for': the parser made sure the loop counts a 'num' declared by
+	//init up by one, the loop variable lives in a scope of the loop's own
+	bool parallel() const
+	{ return parallel_; }
 private:
 	stmt_ptr init_;
 	expr_ptr cond_;
 	expr_ptr exec_;
 	stmt_ptr inner_;
+	bool parallel_;
 };
 
 class VarDeclStatement : public Statement
@@ -238,14 +244,23 @@ public:
 	VarDeclStatement(VarInfo info, expr_ptr val, Position pos)
 		: Statement(StmtType::STATEMENT_VAR_DECL, pos), info_(info), val_(val) {}
 
-	const VarInfo info() const
+	const VarInfo& info() const
 	{ return this->info_; }
 
-	const expr_ptr val() const
+	const expr_ptr& val() const
 	{ return this->val_; }
+
+	//Slot in the declaring scope, -1 if the variable is only reachable by name
+	int slot() const
+	{ return slot_; }
+
+	void resolve(int slot)
+	{ slot_ = slot; }
 private:
 	VarInfo info_;
 	expr_ptr val_;
+
+	int slot_ = -1;
 };
 
 class ArrDeclStatement : public Statement
@@ -254,10 +269,10 @@ public:
 	ArrDeclStatement(ArrInfo info, expr_list vals, Position pos)
 		: Statement(StmtType::STATEMENT_ARR_DECL, pos), info_(info), vals_(vals) {}
 
-	const ArrInfo info() const
+	const ArrInfo& info() const
 	{ return this->info_; }
 
-	const expr_list vals() const
+	const expr_list& vals() const
 	{ return this->vals_; }
 private:
 	ArrInfo info_;
@@ -270,14 +285,22 @@ public:
 	FuncDeclStatement(FuncInfo info, stmt_ptr body, Position pos)
 		: Statement(StmtType::STATEMENT_FUNC_DECL, pos), info_(info), body_(body) {}
 
-	const FuncInfo info() const
+	const FuncInfo& info() const
 	{ return this->info_; }
 
-	const stmt_ptr body() const
+	const stmt_ptr& body() const
 	{ return this->body_; }
+
+	int slot() const
+	{ return slot_; }
+
+	void resolve(int slot)
+	{ slot_ = slot; }
 private:
 	FuncInfo info_;
 	stmt_ptr body_;
+
+	int slot_ = -1;
 };
 
 class ClassDeclStatement : public Statement
@@ -286,13 +309,13 @@ public:
 	ClassDeclStatement(ClassInfo info, stmt_list methods, stmt_list members, Position pos)
 		: Statement(StmtType::STATEMENT_CLASS_DECL, pos), info_(info), methods_(methods), members_(members) {}
 
-	const ClassInfo info() const
+	const ClassInfo& info() const
 	{ return info_; }
 
-	const stmt_list methods() const
+	const stmt_list& methods() const
 	{ return methods_; }
 
-	const stmt_list members() const
+	const stmt_list& members() const
 	{ return members_; }
 private:
 	ClassInfo info_;
@@ -306,7 +329,7 @@ public:
 	ExprStatement(expr_ptr expr, Position pos)
 		: Statement(StmtType::STATEMENT_EXPR, pos), expr_(expr) {}
 
-	const expr_ptr expr() const
+	const expr_ptr& expr() const
 	{ return expr_; }
 private:
 	expr_ptr expr_;
@@ -1,13 +1,14 @@
 #include "REPL.h"
 
 REPL::REPL()
-	: source_(), lexer_(source_) {}
+	: isolate_(), source_(), lexer_(isolate_, source_) {}
 
 void REPL::run()
 {
 	std::cout << "mCIL's REPL:\n";
 
-	Interpreter interpreter{};
+	Isolate::Scope scope{ isolate_ };
+	Interpreter interpreter{ isolate_ };
 
 	bool run = true;
 	while (run)
@@ -18,7 +19,7 @@ void REPL::run()
 		this->source_.add_line(buffer);
 
 		token_list tokens = this->lexer_.scan_file();
-		if (ErrorManager::error_ocurred)
+		if (ErrorManager::error_ocurred())
 		{
 			ErrorManager::report_errors(this->source_);
 			ErrorManager::clear_errors();
@@ -26,15 +27,15 @@ void REPL::run()
 			continue;
 		}
 
-		Parser parser{ tokens };
+		Parser parser{ isolate_, tokens };
 
 		expr_ptr expr = parser.parse_single_expr();
 		if (!expr->is_error_expr())
 		{
-			value_ptr value = interpreter.run_single_expression(expr);
-			if (!value->type().is(type_id("error")))
+			value_t value = interpreter.run_single_expression(expr);
+			if (!value.is_error())
 			{
-				std::cout << value->to_string() << std::endl;
+				std::cout << value.to_string() << std::endl;
 				continue;
 			}
 		}
@@ -49,7 +50,7 @@ void REPL::run()
 			}
 		}
 
-		if (ErrorManager::error_ocurred)
+		if (ErrorManager::error_ocurred())
 		{
 			ErrorManager::report_errors(this->source_);
 			ErrorManager::clear_errors();
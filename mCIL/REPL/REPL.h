@@ -8,6 +8,7 @@
 #include "../Parsing/Statement.h"
 #include "../Types/BuiltinTypes.h"
 #include "../Interpreting/Interpreter.h"
+#include "../Interpreting/Isolate.h"
 
 class REPL
 {
@@ -16,6 +17,7 @@ public:
 
 	void run();
 private:
+	Isolate isolate_;
 	Lexer lexer_;
 	REPLFileManager source_;
 };
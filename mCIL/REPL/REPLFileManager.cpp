@@ -28,7 +28,7 @@ bool REPLFileManager::get_next_line(char* line_buffer, size_t max_size, size_t&
 {
 	if (this->curr_line_ < this->lines_ || this->source_[this->curr_line_].size() < max_size)
 	{
-		strcpy_s(line_buffer, max_size, this->source_[this->curr_line_].c_str());
+		std::snprintf(line_buffer, max_size, "%s", this->source_[this->curr_line_].c_str());
 		new_size = this->source_[this->curr_line_].size();
 		this->curr_line_++;
 		return true;
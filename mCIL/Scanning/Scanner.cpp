@@ -1,12 +1,14 @@
 #include "Scanner.h"
 
-Scanner::Scanner(token_list& code)
-	: code_(code), table_(), current_(0)
+Scanner::Scanner(Isolate& isolate, token_list& code)
+	: isolate_(isolate), code_(code), table_(), current_(0)
 {
 }
 
 token_list Scanner::scan()
 {
+	Isolate::Scope scope{ isolate_ };
+
 	token_list list;
     while (!at_end())
 	{
@@ -5,11 +5,12 @@
 #include "../Lexing/Token.h"
 #include "../Diagnostics/CILError.h"
 #include "SymbolTable.h"
+#include "../Interpreting/Isolate.h"
 
 class Scanner
 {
 public:
-	Scanner(token_list& code);
+	Scanner(Isolate& isolate, token_list& code);
 
 	token_list scan();
 private:
@@ -42,6 +43,7 @@ private:
 	bool scan_function();
 	bool scan_class();
 
+	Isolate& isolate_;
 	token_list& code_;
 	SymbolTable table_;
 
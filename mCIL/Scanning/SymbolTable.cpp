@@ -1,6 +1,5 @@
 #include "SymbolTable.h"
-
-ThreadSafeObj<SymbolTable> SymbolTable::global_table_{};
+#include "../Interpreting/Isolate.h"
 
 SymbolTable::SymbolTable()
     : vars_(), funcs_(), classes_()
@@ -38,13 +37,13 @@ void SymbolTable::declare_local_class(std::string name, std::vector<Variable> me
 }
 
 void SymbolTable::declare_global_variable(std::string name, Type type, token_list tokens)
-{ global_table_->declare_local_variable(name, type, tokens); }
+{ global_table()->declare_local_variable(name, type, tokens); }
 
 void SymbolTable::declare_global_function(std::string name, std::vector<Variable> args, Type ret_type, token_list tokens)
-{ global_table_->declare_local_function(name, args, ret_type, tokens); }
+{ global_table()->declare_local_function(name, args, ret_type, tokens); }
 
 void SymbolTable::declare_global_class(std::string name, std::vector<Variable> members, std::vector<Function> methods, token_list tokens)
-{ global_table_->declare_local_class(name, members, methods, tokens); }
+{ global_table()->declare_local_class(name, members, methods, tokens); }
 
 const bool SymbolTable::local_variable_exists(std::string name) const
 { return vars_.contains(name); }
@@ -56,13 +55,13 @@ const bool SymbolTable::local_class_exists(std::string name) const
 { return classes_.contains(name); }
 
 const bool SymbolTable::global_variable_exists(std::string name)
-{ return SymbolTable::global_table_->local_variable_exists(name); }
+{ return SymbolTable::global_table()->local_variable_exists(name); }
 
 const bool SymbolTable::global_function_exists(std::string name)
-{ return SymbolTable::global_table_->local_function_exists(name); }
+{ return SymbolTable::global_table()->local_function_exists(name); }
 
 const bool SymbolTable::global_class_exists(std::string name)
-{ return SymbolTable::global_table_->local_class_exists(name); }
+{ return SymbolTable::global_table()->local_class_exists(name); }
 
 SymbolTable::Variable& SymbolTable::get_local_variable(std::string name)
 { return vars_.at(name); }
@@ -74,20 +73,30 @@ SymbolTable::Class& SymbolTable::get_local_class(std::string name)
 { return classes_.at(name); }
 
 SymbolTable::Variable& SymbolTable::get_global_variable(std::string name)
-{ return SymbolTable::global_table_->get_local_variable(name); }
+{ return SymbolTable::global_table()->get_local_variable(name); }
 
 SymbolTable::Function& SymbolTable::get_global_function(std::string name)
-{ return SymbolTable::global_table_->get_local_function(name); }
+{ return SymbolTable::global_table()->get_local_function(name); }
 
 SymbolTable::Class& SymbolTable::get_global_class(std::string name)
-{ return SymbolTable::global_table_->get_local_class(name); }
+{ return SymbolTable::global_table()->get_local_class(name); }
 
 void SymbolTable::make_table_global()
 {
 	for (auto& var : vars_)
-		SymbolTable::global_table_->vars_.insert(var);
+		SymbolTable::global_table()->vars_.insert(var);
 	for (auto& func : funcs_)
-		SymbolTable::global_table_->funcs_.insert(func);
+		SymbolTable::global_table()->funcs_.insert(func);
 	for (auto& class_ : classes_)
-		SymbolTable::global_table_->classes_.insert(class_);
+		SymbolTable::global_table()->classes_.insert(class_);
 }
+
+void SymbolTable::clear_global_table()
+{
+	SymbolTable::global_table()->vars_.clear();
+	SymbolTable::global_table()->funcs_.clear();
+	SymbolTable::global_table()->classes_.clear();
+}
+
+ThreadSafeObj<SymbolTable>& SymbolTable::global_table()
+{ return Isolate::current().globals(); }
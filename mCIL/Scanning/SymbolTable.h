@@ -8,11 +8,21 @@
 #include "../Lexing/Token.h"
 
 class Interpreter;
+class VM;
+class Resolver;
+class Optimizer;
+class TraversalBenchmark;
+class HitCounters;
 
 class SymbolTable
 {
 public:
 	friend Interpreter;
+	friend VM;
+	friend Resolver;
+	friend Optimizer;
+	friend TraversalBenchmark;
+	friend HitCounters;
 
 	struct Variable {
 		std::string name;
@@ -70,10 +80,13 @@ public:
 	static Class& get_global_class(std::string name);
 
 	void make_table_global();
+	//Forgets every global declaration, so another program can be scanned
+	static void clear_global_table();
 private:
 	std::unordered_map<std::string, Variable> vars_;
 	std::unordered_map<std::string, Function> funcs_;
 	std::unordered_map<std::string, Class> classes_;
 
-	static ThreadSafeObj<SymbolTable> global_table_;
+	//The global table of the isolate the calling thread is in
+	static ThreadSafeObj<SymbolTable>& global_table();
 };
\ No newline at end of file
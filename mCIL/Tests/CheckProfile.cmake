@@ -0,0 +1,25 @@
+# Profiles PROGRAM with MCIL and fails unless line HOT got more samples than line COLD.
+# cmake -DMCIL=... -DPROGRAM=... -DPROFILE=... -DHOT=N -DCOLD=N -P CheckProfile.cmake
+execute_process(COMMAND "${MCIL}" "--profile=${PROFILE}" "${PROGRAM}" RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "Running ${PROGRAM} failed")
+endif()
+
+file(STRINGS "${PROFILE}" stacks)
+set(hot 0)
+set(cold 0)
+foreach(stack IN LISTS stacks)
+	# Samples are charged to the innermost frame, the last one of the stack
+	if(stack MATCHES ":([0-9]+) ([0-9]+)$")
+		if(CMAKE_MATCH_1 EQUAL HOT)
+			math(EXPR hot "${hot} + ${CMAKE_MATCH_2}")
+		elseif(CMAKE_MATCH_1 EQUAL COLD)
+			math(EXPR cold "${cold} + ${CMAKE_MATCH_2}")
+		endif()
+	endif()
+endforeach()
+
+message(STATUS "line ${HOT}: ${hot} samples, line ${COLD}: ${cold} samples")
+if(hot LESS_EQUAL cold)
+	message(FATAL_ERROR "Line ${HOT} should have more samples than line ${COLD}")
+endif()
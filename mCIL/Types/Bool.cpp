@@ -1,56 +1,41 @@
 #include "Bool.h"
 
-CIL::Bool::Bool(bool value, bool is_const)
-	: CIL::Value(Type::make("bool", (is_const ? TypeFlags::CONST : 0))), value_(value)
+value_t CIL::Bool::create(bool value)
 {
+	return value_t::boolean(value);
 }
 
-value_ptr CIL::Bool::create(bool value, bool is_const)
+value_t CIL::Bool::invert(bool value)
 {
-	return value_ptr(new CIL::Bool(value, is_const));
+	return CIL::Bool::create(!value);
 }
 
-const bool CIL::Bool::value() const
+value_t CIL::Bool::equals(bool value, const value_t& other)
 {
-	return value_;
+	return CIL::Bool::create(value == other.to_bool());
 }
 
-value_ptr CIL::Bool::invert()
+value_t CIL::Bool::not_equals(bool value, const value_t& other)
 {
-	return CIL::Bool::create(!value_, type_.is_const());
+	return CIL::Bool::create(value != other.to_bool());
 }
 
-value_ptr CIL::Bool::equals(value_ptr other)
+value_t CIL::Bool::logical_and(bool value, const value_t& other)
 {
-	return CIL::Bool::create(value_ == other->to_bool());
+	return CIL::Bool::create(value && other.to_bool());
 }
 
-value_ptr CIL::Bool::not_equals(value_ptr other)
+value_t CIL::Bool::logical_or(bool value, const value_t& other)
 {
-	return CIL::Bool::create(value_ != other->to_bool());
+	return CIL::Bool::create(value || other.to_bool());
 }
 
-value_ptr CIL::Bool::logical_and(value_ptr other)
+std::string CIL::Bool::to_string(bool value)
 {
-	return CIL::Bool::create(value_ && other->to_bool());
+	return (value ? "true" : "false");
 }
 
-value_ptr CIL::Bool::logical_or(value_ptr other)
+std::string CIL::Bool::to_debug_string(bool value)
 {
-	return CIL::Bool::create(value_ || other->to_bool());
-}
-
-std::string CIL::Bool::to_string()
-{
-	return (value_ ? "true" : "false");
-}
-
-std::string CIL::Bool::to_debug_string()
-{
-	return (value_ ? "(bool: true)" : "(bool: false)");
-}
-
-const bool CIL::Bool::to_bool()
-{
-	return value_;
+	return (value ? "(bool: true)" : "(bool: false)");
 }
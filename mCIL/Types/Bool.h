@@ -3,28 +3,21 @@
 
 namespace CIL
 {
-	class Bool : public Value
+	//Bools are stored inline in a value_t, this only holds their operations
+	class Bool
 	{
 	public:
-		static value_ptr create(bool value, bool is_const = false);
+		static value_t create(bool value);
 
-		const bool value() const;
+		static value_t invert(bool value);
 
-		virtual value_ptr invert() override;
+		static value_t equals(bool value, const value_t&);
+		static value_t not_equals(bool value, const value_t&);
+		static value_t logical_and(bool value, const value_t&);
+		static value_t logical_or(bool value, const value_t&);
 
-		virtual value_ptr equals(value_ptr) override;
-		virtual value_ptr not_equals(value_ptr) override;
-		virtual value_ptr logical_and(value_ptr) override;
-		virtual value_ptr logical_or(value_ptr) override;
-
-		virtual std::string to_string() override;
-		virtual std::string to_debug_string() override;
-
-		virtual const bool to_bool() override;
-	private:
-		Bool(bool value, bool is_const);
-
-		bool value_;
+		static std::string to_string(bool value);
+		static std::string to_debug_string(bool value);
 	};
 }
 
@@ -0,0 +1,50 @@
+#include "ConstantPool.h"
+#include "None.h"
+#include "Bool.h"
+#include "Number.h"
+#include "String.h"
+
+ConstantPool::ConstantPool()
+	: constants_(), immediates_(), strings_()
+{
+}
+
+const value_t* ConstantPool::add_none()
+{
+	return add(CIL::None::create());
+}
+
+const value_t* ConstantPool::add_bool(bool value)
+{
+	return add(CIL::Bool::create(value));
+}
+
+const value_t* ConstantPool::add_number(double value)
+{
+	return add(CIL::Number::create(value));
+}
+
+const value_t* ConstantPool::add_string(const std::string& value)
+{
+	auto it = strings_.find(value);
+	if (it != strings_.end())
+	{ return it->second; }
+
+	constants_.push_back(CIL::String::create(value));
+	const value_t* constant = &constants_.back();
+	strings_[value] = constant;
+	return constant;
+}
+
+const value_t* ConstantPool::add(value_t value)
+{
+	//Immediate values are equal exactly when their bits are
+	auto it = immediates_.find(value.bits());
+	if (it != immediates_.end())
+	{ return it->second; }
+
+	constants_.push_back(value);
+	const value_t* constant = &constants_.back();
+	immediates_[value.bits()] = constant;
+	return constant;
+}
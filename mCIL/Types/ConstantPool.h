@@ -0,0 +1,27 @@
+#pragma once
+#include "../cil-system.h"
+#include "Value.h"
+
+//Owns the literal values of a program. Every literal is materialized once,
+//equal literals share the same entry and the entries never move, so the AST
+//can keep plain pointers to them.
+class ConstantPool
+{
+public:
+	ConstantPool();
+
+	const value_t* add_none();
+	const value_t* add_bool(bool value);
+	const value_t* add_number(double value);
+	const value_t* add_string(const std::string& value);
+
+	size_t size() const
+	{ return constants_.size(); }
+private:
+	const value_t* add(value_t value);
+
+	std::deque<value_t> constants_;
+
+	std::unordered_map<uint64_t, const value_t*> immediates_;
+	std::unordered_map<std::string, const value_t*> strings_;
+};
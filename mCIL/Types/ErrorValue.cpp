@@ -1,13 +1,8 @@
 #include "ErrorValue.h"
 
-CIL::ErrorValue::ErrorValue()
-    : CIL::Value(Type::make("error", true))
+value_t CIL::ErrorValue::create()
 {
-}
-
-value_ptr CIL::ErrorValue::create()
-{
-    return value_ptr(new ErrorValue());
+    return value_t::error();
 }
 
 std::string CIL::ErrorValue::to_string()
@@ -19,8 +14,3 @@ std::string CIL::ErrorValue::to_debug_string()
 {
     return ("Error");
 }
-
-const bool CIL::ErrorValue::to_bool()
-{
-    return false;
-}
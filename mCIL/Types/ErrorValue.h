@@ -3,15 +3,12 @@
 
 namespace CIL
 {
-	class ErrorValue : public Value
+	class ErrorValue
 	{
 	public:
-		static value_ptr create();
+		static value_t create();
 
-		virtual std::string to_string() override;
-		virtual std::string to_debug_string() override;
-		virtual const bool to_bool() override;
-	private:
-		ErrorValue();
+		static std::string to_string();
+		static std::string to_debug_string();
 	};
 }
@@ -0,0 +1,194 @@
+#include "Heap.h"
+#include "Object.h"
+#include "../Interpreting/Isolate.h"
+
+Heap::Heap()
+	: limits_(), live_bytes_(0), peak_bytes_(0), allocated_since_(0), next_collection_(0),
+	  lock_(), objects_(nullptr), object_count_(0), stats_()
+{
+	schedule_next_collection();
+}
+
+Heap::~Heap()
+{
+	collect();
+
+	//Whatever is still referred to from outside lives on without the heap
+	std::lock_guard<std::mutex> guard{ lock_ };
+	for (CIL::Object* object = objects_; object; object = object->gc_next_)
+	{ object->heap_ = nullptr; }
+}
+
+Heap& Heap::current()
+{
+	return Isolate::current().heap();
+}
+
+void Heap::set_limits(Limits limits)
+{
+	limits_ = limits;
+	schedule_next_collection();
+}
+
+void Heap::allocate(size_t bytes)
+{
+	size_t live = live_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	if (limits_.max_bytes && live > limits_.max_bytes)
+	{
+		live_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+		throw CILError::error("Heap limit of $ bytes exceeded", limits_.max_bytes);
+	}
+
+	size_t peak = peak_bytes_.load(std::memory_order_relaxed);
+	while (live > peak && !peak_bytes_.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+	{ }
+}
+
+void Heap::release(size_t bytes)
+{
+	live_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void Heap::track(CIL::Object* object, size_t bytes)
+{
+	allocated_since_.fetch_add(bytes, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> guard{ lock_ };
+	object->gc_prev_ = nullptr;
+	object->gc_next_ = objects_;
+	if (objects_)
+	{ objects_->gc_prev_ = object; }
+	objects_ = object;
+	object_count_++;
+}
+
+void Heap::untrack(CIL::Object* object)
+{
+	std::lock_guard<std::mutex> guard{ lock_ };
+	if (object->gc_prev_)
+	{ object->gc_prev_->gc_next_ = object->gc_next_; }
+	else
+	{ objects_ = object->gc_next_; }
+	if (object->gc_next_)
+	{ object->gc_next_->gc_prev_ = object->gc_prev_; }
+	object_count_--;
+}
+
+size_t Heap::collect()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	//Holding a reference to every garbage object keeps them all alive until
+	//their members are cleared, the cycles then fall apart in one go
+	std::vector<value_t> garbage{};
+	{
+		std::lock_guard<std::mutex> guard{ lock_ };
+		auto tracked_member = [this](const value_t& member) -> CIL::Object*
+		{
+			CIL::Object* object = member.as<CIL::Object>();
+			return object && object->heap_ == this ? object : nullptr;
+		};
+
+		//Subtract the references objects hold to each other, what remains comes from outside
+		for (CIL::Object* object = objects_; object; object = object->gc_next_)
+		{
+			object->gc_refs_ = object->refs_.load(std::memory_order_relaxed);
+			object->gc_marked_ = false;
+		}
+		for (CIL::Object* object = objects_; object; object = object->gc_next_)
+		{
+			for (const value_t& member : object->members_)
+			{
+				if (CIL::Object* child = tracked_member(member))
+				{ child->gc_refs_--; }
+			}
+		}
+
+		std::vector<CIL::Object*> reachable{};
+		for (CIL::Object* object = objects_; object; object = object->gc_next_)
+		{
+			if (object->gc_refs_ > 0)
+			{
+				object->gc_marked_ = true;
+				reachable.push_back(object);
+			}
+		}
+		while (!reachable.empty())
+		{
+			CIL::Object* object = reachable.back();
+			reachable.pop_back();
+			for (const value_t& member : object->members_)
+			{
+				CIL::Object* child = tracked_member(member);
+				if (child && !child->gc_marked_)
+				{
+					child->gc_marked_ = true;
+					reachable.push_back(child);
+				}
+			}
+		}
+
+		for (CIL::Object* object = objects_; object; object = object->gc_next_)
+		{
+			if (!object->gc_marked_)
+			{ garbage.push_back(value_t(object)); }
+		}
+	}
+
+	//Members are cleared outside the lock, the objects they free untrack themselves
+	for (value_t& value : garbage)
+	{
+		for (value_t& member : value.as<CIL::Object>()->members_)
+		{ member = nullptr; }
+	}
+	size_t collected = garbage.size();
+	garbage.clear();
+
+	std::chrono::duration<double, std::milli> pause = std::chrono::steady_clock::now() - start;
+	{
+		std::lock_guard<std::mutex> guard{ lock_ };
+		stats_.collections++;
+		stats_.objects_collected += collected;
+		stats_.total_pause_ms += pause.count();
+		stats_.max_pause_ms = std::max(stats_.max_pause_ms, pause.count());
+	}
+	allocated_since_.store(0, std::memory_order_relaxed);
+	schedule_next_collection();
+	return collected;
+}
+
+size_t Heap::objects() const
+{
+	std::lock_guard<std::mutex> guard{ lock_ };
+	return object_count_;
+}
+
+Heap::Stats Heap::stats() const
+{
+	std::lock_guard<std::mutex> guard{ lock_ };
+	return stats_;
+}
+
+void Heap::dump_stats(std::ostream& os) const
+{
+	Stats stats = this->stats();
+	os << "Heap:\n"
+	   << "  live bytes:        " << live_bytes() << "\n"
+	   << "  peak bytes:        " << peak_bytes() << "\n"
+	   << "  live objects:      " << objects() << "\n"
+	   << "  collections:       " << stats.collections << "\n"
+	   << "  objects collected: " << stats.objects_collected << "\n"
+	   << std::fixed << std::setprecision(3)
+	   << "  total pause:       " << stats.total_pause_ms << "ms\n"
+	   << "  longest pause:     " << stats.max_pause_ms << "ms\n";
+}
+
+void Heap::schedule_next_collection()
+{
+	size_t live = live_bytes();
+	size_t next = std::max(limits_.collect_after, live / 100 * limits_.growth_percent);
+	//Close to the limit collections come sooner, so the heap can free cycles before it runs out
+	if (limits_.max_bytes)
+	{ next = std::min(next, limits_.max_bytes > live ? (limits_.max_bytes - live) / 2 : 0); }
+	next_collection_ = next;
+}
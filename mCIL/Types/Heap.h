@@ -0,0 +1,91 @@
+#pragma once
+#include "../cil-system.h"
+
+namespace CIL
+{ class Object; }
+
+//Accounts for the strings and objects of an isolate and collects the objects
+//that only keep each other alive. Reference counts free everything else as
+//soon as the last reference is dropped, so the collector only looks at objects,
+//the one kind of value that refers to others. It finds its roots without being
+//told about them: an object with more references than the other objects hold
+//is referred to from outside, by an environment, an array or a temporary of an
+//engine, and keeps everything it reaches alive. The rest is garbage.
+//Values must not outlive the heap they were allocated on.
+class Heap
+{
+public:
+	struct Limits
+	{
+		//Bytes of objects allocated since the last collection that trigger the next one
+		size_t collect_after = 4 * 1024 * 1024;
+		//The trigger also waits until the objects grew by this percentage of the live heap
+		size_t growth_percent = 100;
+		//Live bytes allocations may not grow the heap past, 0 for no limit
+		size_t max_bytes = 0;
+	};
+
+	struct Stats
+	{
+		size_t collections = 0;
+		size_t objects_collected = 0;
+		double total_pause_ms = 0;
+		double max_pause_ms = 0;
+	};
+
+	Heap();
+	~Heap();
+
+	Heap(const Heap&) = delete;
+	Heap& operator=(const Heap&) = delete;
+
+	//The heap of the isolate the calling thread is in
+	static Heap& current();
+
+	void set_limits(Limits limits);
+	const Limits& limits() const
+	{ return limits_; }
+
+	//Accounts for a value of 'bytes' before it is created, throws if that would exceed the limit
+	void allocate(size_t bytes);
+	void release(size_t bytes);
+
+	//Objects are known to the heap from construction to destruction
+	void track(CIL::Object* object, size_t bytes);
+	void untrack(CIL::Object* object);
+
+	//Collects if the trigger was reached. Engines call it where no other
+	//thread can run code of the isolate, between objects being created
+	void maybe_collect()
+	{
+		if (allocated_since_.load(std::memory_order_relaxed) >= next_collection_)
+		{ collect(); }
+	}
+
+	//Frees all objects that are only referred to by each other, returns how many
+	size_t collect();
+
+	size_t live_bytes() const
+	{ return live_bytes_.load(std::memory_order_relaxed); }
+	size_t peak_bytes() const
+	{ return peak_bytes_.load(std::memory_order_relaxed); }
+	size_t objects() const;
+	Stats stats() const;
+
+	void dump_stats(std::ostream& os) const;
+private:
+	void schedule_next_collection();
+
+	Limits limits_;
+
+	std::atomic<size_t> live_bytes_;
+	std::atomic<size_t> peak_bytes_;
+	std::atomic<size_t> allocated_since_;
+	size_t next_collection_;
+
+	//Chunks of a parallel loop create and drop objects at the same time
+	mutable std::mutex lock_;
+	CIL::Object* objects_;
+	size_t object_count_;
+	Stats stats_;
+};
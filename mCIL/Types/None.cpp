@@ -1,13 +1,8 @@
 #include "None.h"
 
-CIL::None::None()
-    : CIL::Value(Type::make("none", true))
+value_t CIL::None::create()
 {
-}
-
-value_ptr CIL::None::create()
-{
-    return value_ptr(new None());
+    return value_t::none();
 }
 
 std::string CIL::None::to_string()
@@ -19,8 +14,3 @@ std::string CIL::None::to_debug_string()
 {
     return ("None");
 }
-
-const bool CIL::None::to_bool()
-{
-    return false;
-}
@@ -3,15 +3,12 @@
 
 namespace CIL
 {
-	class None : public Value
+	class None
 	{
 	public:
-		static value_ptr create();
+		static value_t create();
 
-		virtual std::string to_string() override;
-		virtual std::string to_debug_string() override;
-		virtual const bool to_bool() override;
-	private:
-		None();
+		static std::string to_string();
+		static std::string to_debug_string();
 	};
 }
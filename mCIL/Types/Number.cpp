@@ -1,233 +1,221 @@
 #include "Number.h"
 
-CIL::Number::Number(double value, bool is_const)
-	: Value(Type::make("num", (is_const ? TypeFlags::CONST : 0))), value_(value)
+value_t CIL::Number::create(double value)
 {
+	return value_t::number(value);
 }
 
-value_ptr CIL::Number::create(double value, bool is_const)
+value_t CIL::Number::invert(double value)
 {
-	return value_ptr(new Number(value, is_const));
+	return CIL::Bool::create(!to_bool(value));
 }
 
-const double CIL::Number::value() const
+value_t CIL::Number::negate(double value)
 {
-	return value_;
+	return CIL::Number::create(-value);
 }
 
-value_ptr CIL::Number::invert()
+value_t CIL::Number::increment(double value)
 {
-	return CIL::Bool::create(!to_bool());
+	return CIL::Number::create(value + 1);
 }
 
-value_ptr CIL::Number::negate()
+value_t CIL::Number::decrement(double value)
 {
-	return CIL::Number::create(-value_);
+	return CIL::Number::create(value - 1);
 }
 
-value_ptr CIL::Number::increment()
+value_t CIL::Number::add(double value, const value_t& other)
 {
-	value_++;
-	return CIL::Number::create(value_, type_.is_const());
-}
-
-value_ptr CIL::Number::decrement()
-{
-	value_--;
-	return CIL::Number::create(value_, type_.is_const());
-}
-
-value_ptr CIL::Number::add(value_ptr other)
-{
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Number::create(
-			value_ + std::dynamic_pointer_cast<Number>(other)->value()
+			value + other.as_num()
 		);
 	}
-	throw binary_op_invalid_type("+", other);
+	throw Value::binary_op_invalid_type("+", create(value), other);
 }
 
-value_ptr CIL::Number::subtract(value_ptr other)
+value_t CIL::Number::subtract(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Number::create(
-			value_ - std::dynamic_pointer_cast<Number>(other)->value()
+			value - other.as_num()
 		);
 	}
-	throw binary_op_invalid_type("-", other);
+	throw Value::binary_op_invalid_type("-", create(value), other);
 }
 
-value_ptr CIL::Number::multiply(value_ptr other)
+value_t CIL::Number::multiply(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Number::create(
-			value_ * std::dynamic_pointer_cast<Number>(other)->value()
+			value * other.as_num()
 		);
 	}
-	throw binary_op_invalid_type("+", other);
+	throw Value::binary_op_invalid_type("+", create(value), other);
 }
 
-value_ptr CIL::Number::divide(value_ptr other)
+value_t CIL::Number::divide(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Number::create(
-			value_ / std::dynamic_pointer_cast<Number>(other)->value()
+			value / other.as_num()
 		);
 	}
-	throw binary_op_invalid_type("+", other);
+	throw Value::binary_op_invalid_type("+", create(value), other);
 }
 
-value_ptr CIL::Number::bitwise_not()
+value_t CIL::Number::bitwise_not(double value)
 {
-	return CIL::Number::create((double)~(__int64)value_);
+	return CIL::Number::create((double)~(int64_t)value);
 }
 
-value_ptr CIL::Number::bitwise_and(value_ptr other)
+value_t CIL::Number::bitwise_and(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Number::create(
-			(double)((__int64)value_ & (__int64)std::dynamic_pointer_cast<Number>(other)->value())
+			(double)((int64_t)value & (int64_t)other.as_num())
 		);
 	}
-	throw binary_op_invalid_type("&", other);
+	throw Value::binary_op_invalid_type("&", create(value), other);
 }
 
-value_ptr CIL::Number::bitwise_or(value_ptr other)
+value_t CIL::Number::bitwise_or(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Number::create(
-			(double)((__int64)value_ | (__int64)std::dynamic_pointer_cast<Number>(other)->value())
+			(double)((int64_t)value | (int64_t)other.as_num())
 		);
 	}
-	throw binary_op_invalid_type("|", other);
+	throw Value::binary_op_invalid_type("|", create(value), other);
 }
 
-value_ptr CIL::Number::bitwise_xor(value_ptr other)
+value_t CIL::Number::bitwise_xor(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Number::create(
-			(double)((__int64)value_ ^ (__int64)std::dynamic_pointer_cast<Number>(other)->value())
+			(double)((int64_t)value ^ (int64_t)other.as_num())
 		);
 	}
-	throw binary_op_invalid_type("^", other);
+	throw Value::binary_op_invalid_type("^", create(value), other);
 }
 
-value_ptr CIL::Number::left_bitshift(value_ptr other)
+value_t CIL::Number::left_bitshift(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Number::create(
-			(double)((__int64)value_ << (__int64)std::dynamic_pointer_cast<Number>(other)->value())
+			(double)((int64_t)value << (int64_t)other.as_num())
 		);
 	}
-	throw binary_op_invalid_type("+", other);
+	throw Value::binary_op_invalid_type("+", create(value), other);
 }
 
-value_ptr CIL::Number::right_bitshift(value_ptr other)
+value_t CIL::Number::right_bitshift(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Number::create(
-			(double)((__int64)value_ >> (__int64)std::dynamic_pointer_cast<Number>(other)->value())
+			(double)((int64_t)value >> (int64_t)other.as_num())
 		);
 	}
-	throw binary_op_invalid_type("+", other);
+	throw Value::binary_op_invalid_type("+", create(value), other);
 }
 
-value_ptr CIL::Number::equals(value_ptr other)
+value_t CIL::Number::equals(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Bool::create(
-			value_ == std::dynamic_pointer_cast<Number>(other)->value()
+			value == other.as_num()
 		);
 	}
-	throw binary_op_invalid_type("==", other);
+	throw Value::binary_op_invalid_type("==", create(value), other);
 }
 
-value_ptr CIL::Number::not_equals(value_ptr other)
+value_t CIL::Number::not_equals(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Bool::create(
-			value_ != std::dynamic_pointer_cast<Number>(other)->value()
+			value != other.as_num()
 		);
 	}
-	throw binary_op_invalid_type("!=", other);
+	throw Value::binary_op_invalid_type("!=", create(value), other);
 }
 
-value_ptr CIL::Number::greater(value_ptr other)
+value_t CIL::Number::greater(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Bool::create(
-			value_ > std::dynamic_pointer_cast<Number>(other)->value()
+			value > other.as_num()
 		);
 	}
-	throw binary_op_invalid_type(">", other);
+	throw Value::binary_op_invalid_type(">", create(value), other);
 }
 
-value_ptr CIL::Number::less(value_ptr other)
+value_t CIL::Number::less(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Bool::create(
-			value_ < std::dynamic_pointer_cast<Number>(other)->value()
+			value < other.as_num()
 		);
 	}
-	throw binary_op_invalid_type("<", other);
+	throw Value::binary_op_invalid_type("<", create(value), other);
 }
 
-value_ptr CIL::Number::greater_equals(value_ptr other)
+value_t CIL::Number::greater_equals(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Bool::create(
-			value_ >= std::dynamic_pointer_cast<Number>(other)->value()
+			value >= other.as_num()
 		);
 	}
-	throw binary_op_invalid_type(">=", other);
+	throw Value::binary_op_invalid_type(">=", create(value), other);
 }
 
-value_ptr CIL::Number::less_equals(value_ptr other)
+value_t CIL::Number::less_equals(double value, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_num())
 	{
 		return CIL::Bool::create(
-			value_ <= std::dynamic_pointer_cast<Number>(other)->value()
+			value <= other.as_num()
 		);
 	}
-	throw binary_op_invalid_type("<=", other);
+	throw Value::binary_op_invalid_type("<=", create(value), other);
 }
 
-value_ptr CIL::Number::logical_and(value_ptr other)
+value_t CIL::Number::logical_and(double value, const value_t& other)
 {
-	return CIL::Bool::create(to_bool() && other->to_bool());
+	return CIL::Bool::create(to_bool(value) && other.to_bool());
 }
 
-value_ptr CIL::Number::logical_or(value_ptr other)
+value_t CIL::Number::logical_or(double value, const value_t& other)
 {
-	return CIL::Bool::create(to_bool() || other->to_bool());
+	return CIL::Bool::create(to_bool(value) || other.to_bool());
 }
 
-std::string CIL::Number::to_string()
+std::string CIL::Number::to_string(double value)
 {
-	return std::to_string(value_);
+	return std::to_string(value);
 }
 
-std::string CIL::Number::to_debug_string()
+std::string CIL::Number::to_debug_string(double value)
 {
-	return ("(num: " + std::to_string(value_) + ")");
+	return ("(num: " + std::to_string(value) + ")");
 }
 
-const bool CIL::Number::to_bool()
+const bool CIL::Number::to_bool(double value)
 {
-	return value_ != 0;
+	return value != 0;
 }
\ No newline at end of file
@@ -4,48 +4,43 @@
 
 namespace CIL
 {
-	class Number : public Value
+	//Numbers are stored inline in a value_t, this only holds their operations
+	class Number
 	{
 	public:
-		static value_ptr create(double value, bool is_const = false);
-
-		const double value() const;
-
-		virtual value_ptr invert() override;
-		virtual value_ptr negate() override;
-		virtual value_ptr increment() override;
-		virtual value_ptr decrement() override;
-
-		virtual value_ptr add(value_ptr) override;
-		virtual value_ptr subtract(value_ptr) override;
-		virtual value_ptr multiply(value_ptr) override;
-		virtual value_ptr divide(value_ptr) override;
-
-		virtual value_ptr bitwise_not() override;
-		virtual value_ptr bitwise_and(value_ptr) override;
-		virtual value_ptr bitwise_or(value_ptr) override;
-		virtual value_ptr bitwise_xor(value_ptr) override;
-
-		virtual value_ptr left_bitshift(value_ptr) override;
-		virtual value_ptr right_bitshift(value_ptr) override;
-
-		virtual value_ptr equals(value_ptr) override;
-		virtual value_ptr not_equals(value_ptr) override;
-		virtual value_ptr greater(value_ptr) override;
-		virtual value_ptr less(value_ptr) override;
-		virtual value_ptr greater_equals(value_ptr) override;
-		virtual value_ptr less_equals(value_ptr) override;
-		virtual value_ptr logical_and(value_ptr) override;
-		virtual value_ptr logical_or(value_ptr) override;
-
-		virtual std::string to_string() override;
-		virtual std::string to_debug_string() override;
-
-		virtual const bool to_bool() override;
-	private:
-		Number(double value, bool is_const);
-
-		double value_;
+		static value_t create(double value);
+
+		static value_t invert(double value);
+		static value_t negate(double value);
+		static value_t increment(double value);
+		static value_t decrement(double value);
+
+		static value_t add(double value, const value_t&);
+		static value_t subtract(double value, const value_t&);
+		static value_t multiply(double value, const value_t&);
+		static value_t divide(double value, const value_t&);
+
+		static value_t bitwise_not(double value);
+		static value_t bitwise_and(double value, const value_t&);
+		static value_t bitwise_or(double value, const value_t&);
+		static value_t bitwise_xor(double value, const value_t&);
+
+		static value_t left_bitshift(double value, const value_t&);
+		static value_t right_bitshift(double value, const value_t&);
+
+		static value_t equals(double value, const value_t&);
+		static value_t not_equals(double value, const value_t&);
+		static value_t greater(double value, const value_t&);
+		static value_t less(double value, const value_t&);
+		static value_t greater_equals(double value, const value_t&);
+		static value_t less_equals(double value, const value_t&);
+		static value_t logical_and(double value, const value_t&);
+		static value_t logical_or(double value, const value_t&);
+
+		static std::string to_string(double value);
+		static std::string to_debug_string(double value);
+
+		static const bool to_bool(double value);
 	};
 }
 
@@ -1,38 +1,42 @@
 #include "Object.h"
 
-CIL::Object::Object(Environment::Class cls, bool is_const)
-	: CIL::Value(Type::make(cls.name, (is_const ? TypeFlags::CONST : 0))), cls_(cls), env_(new Environment())
+CIL::Object::Object(std::shared_ptr<Environment::Shape> shape, Heap& heap, size_t bytes)
+	: CIL::Value(shape->type), shape_(shape), members_(), heap_(&heap), bytes_(bytes),
+	  gc_prev_(nullptr), gc_next_(nullptr), gc_refs_(0), gc_marked_(false)
 {
-	for (Environment::Function method : cls_.methods)
-	{
-		env_->define_func(method);
-	}
+	members_.reserve(shape_->members.size());
+	for (const Environment::Variable& member : shape_->members)
+	{ members_.push_back(member.value); }
+}
 
-	for (Environment::Variable member : cls_.members)
+CIL::Object::~Object()
+{
+	if (heap_)
 	{
-		env_->define_var(member);
+		heap_->untrack(this);
+		heap_->release(bytes_);
 	}
 }
 
-value_ptr CIL::Object::create(Environment::Class info, bool is_const)
+value_t CIL::Object::create(std::shared_ptr<Environment::Shape> shape)
 {
-	return value_ptr(new Object(info, is_const));
+	Heap& heap = Heap::current();
+	size_t bytes = sizeof(Object) + shape->members.size() * sizeof(value_t);
+	heap.allocate(bytes);
+	//Only tracked once it is referred to, a collection could take it for garbage before
+	value_t object{ new Object(std::move(shape), heap, bytes) };
+	heap.track(static_cast<Object*>(object.as_heap()), bytes);
+	return object;
 }
 
-const Environment::Class CIL::Object::cls() const
-{ return cls_; }
-
-Environment* CIL::Object::env() const
-{ return env_; }
-
 std::string CIL::Object::to_string()
 {
-	return cls_.name;
+	return shape_->name;
 }
 
 std::string CIL::Object::to_debug_string()
 {
-	return "Object( " + cls_.name + " )";
+	return "Object( " + shape_->name + " )";
 }
 
 const bool CIL::Object::to_bool()
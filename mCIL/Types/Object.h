@@ -1,25 +1,50 @@
 #pragma once
 #include "Value.h"
+#include "Heap.h"
 #include "../Interpreting/Environment.h"
 
 namespace CIL
 {
+	//An instance of a class: the shape of its class and the value of every
+	//member, laid out like Shape::members. The names and types of the members
+	//and the methods are looked up on the shape.
+	//Members can refer back to the object, so the heap collects what their
+	//reference counts cannot free.
 	class Object : public Value
 	{
 	public:
-		static value_ptr create(Environment::Class cls, bool is_const = false);
+		static value_t create(std::shared_ptr<Environment::Shape> shape);
 
-		const Environment::Class cls() const;
-		Environment* env() const;
+		~Object();
+
+		Environment::Shape& shape() const
+		{ return *shape_; }
+
+		//For caches that remember the shape, holding it keeps its address from being reused
+		const std::shared_ptr<Environment::Shape>& shared_shape() const
+		{ return shape_; }
+
+		value_t& member(size_t slot)
+		{ return members_[slot]; }
 
 		virtual std::string to_string() override;
 		virtual std::string to_debug_string() override;
 		virtual const bool to_bool() override;
 	private:
-		Object(Environment::Class cls, bool is_const);
+		friend class ::Heap;
 
-		Environment::Class cls_;
-		Environment* env_;
+		Object(std::shared_ptr<Environment::Shape> shape, Heap& heap, size_t bytes);
+
+		std::shared_ptr<Environment::Shape> shape_;
+		std::vector<value_t> members_;
+
+		//nullptr once the heap is gone
+		Heap* heap_;
+		size_t bytes_;
+		//The heap's list of objects and the scratch space of its collections
+		Object* gc_prev_;
+		Object* gc_next_;
+		int64_t gc_refs_;
+		bool gc_marked_;
 	};
 }
-
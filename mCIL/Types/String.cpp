@@ -1,66 +1,183 @@
 #include "String.h"
 
-CIL::String::String(std::string value, bool is_const)
-	: CIL::Value(Type::make("str", (is_const ? TypeFlags::CONST : 0))), value_(value)
+CIL::String::String(std::string value, Heap& heap, size_t bytes)
+	: CIL::Value(Type::make("str")), value_(std::move(value)), left_(), right_(), size_(value_.size()), flat_(nullptr),
+	heap_(&heap), bytes_(bytes)
 {
 }
 
-value_ptr CIL::String::create(std::string value, bool is_const)
+CIL::String::String(value_t left, value_t right, Heap& heap, size_t bytes)
+	: CIL::Value(Type::make("str")), value_(), left_(std::move(left)), right_(std::move(right)), size_(0), flat_(nullptr),
+	heap_(&heap), bytes_(bytes)
 {
-	return value_ptr(new CIL::String(value, is_const));
+	size_ = this->left()->size_ + this->right()->size_;
 }
 
-const std::string CIL::String::value() const
+CIL::String::~String()
 {
-	return value_;
+	heap_->release(bytes_);
+	delete flat_.load(std::memory_order_acquire);
+	if (!is_node())
+	{ return; }
+
+	//Dropping the last reference to a long rope would destroy its nodes recursively,
+	//as deep as the rope is. The sides are queued and released by the outermost destructor
+	static thread_local std::vector<value_t> dropped{};
+	static thread_local bool releasing = false;
+	dropped.push_back(std::move(left_));
+	dropped.push_back(std::move(right_));
+	if (releasing)
+	{ return; }
+	releasing = true;
+	while (!dropped.empty())
+	{
+		value_t side = std::move(dropped.back());
+		dropped.pop_back();
+	}
+	releasing = false;
+}
+
+value_t CIL::String::create(std::string value)
+{
+	Heap& heap = Heap::current();
+	size_t bytes = sizeof(String) + value.size();
+	heap.allocate(bytes);
+	return value_t(new CIL::String(std::move(value), heap, bytes));
 }
 
-value_ptr CIL::String::add(value_ptr other)
+value_t CIL::String::node(value_t left, value_t right)
 {
-	if (other->is_type(type_))
+	Heap& heap = Heap::current();
+	size_t bytes = sizeof(String);
+	heap.allocate(bytes);
+	return value_t(new CIL::String(std::move(left), std::move(right), heap, bytes));
+}
+
+const value_t& CIL::String::settled(const value_t& str)
+{
+	const value_t* flat = static_cast<const String*>(str.as_heap())->flat_.load(std::memory_order_acquire);
+	return flat ? *flat : str;
+}
+
+value_t CIL::String::concat(const value_t& left_str, const value_t& right_str)
+{
+	//The new string never refers to a flattened node, which would keep the nodes
+	//below it alive next to their flattened copy
+	const value_t& left = settled(left_str);
+	const value_t& right = settled(right_str);
+	const String* l = static_cast<const String*>(left.as_heap());
+	const String* r = static_cast<const String*>(right.as_heap());
+	if (r->size_ == 0)
+	{ return left; }
+	if (l->size_ == 0)
+	{ return right; }
+	//Anything longer than FLAT_LIMIT is a node, so both sides are flat here
+	if (l->size_ + r->size_ <= FLAT_LIMIT)
+	{ return create(l->value_ + r->value_); }
+
+	//A short piece is merged with the short side of the node it is added to, instead of
+	//creating a node for every piece. Only that side is copied, the rest is shared
+	if (l->is_node() && !l->right()->is_node() && l->right()->size_ + r->size_ <= FLAT_LIMIT)
+	{ return node(l->left_, create(l->right()->value_ + r->value_)); }
+	if (r->is_node() && !r->left()->is_node() && l->size_ + r->left()->size_ <= FLAT_LIMIT)
+	{ return node(create(l->value_ + r->left()->value_), r->right_); }
+	return node(left, right);
+}
+
+const std::string& CIL::String::value() const
+{
+	if (!is_node())
+	{ return value_; }
+	const value_t* flat = flat_.load(std::memory_order_acquire);
+	if (!flat)
+	{ flat = flatten(); }
+	return static_cast<const String*>(flat->as_heap())->value_;
+}
+
+const value_t* CIL::String::flatten() const
+{
+	std::string text{};
+	text.reserve(size_);
+	//Left to right without recursion, ropes built in a loop are as deep as they have pieces
+	std::vector<const String*> pending{ this };
+	while (!pending.empty())
 	{
-		return CIL::String::create(
-			value_ + std::dynamic_pointer_cast<String>(other)->value()
-		);
+		const String* str = pending.back();
+		pending.pop_back();
+		if (!str->is_node())
+		{ text.append(str->value_); }
+		else if (const value_t* flat = str->flat_.load(std::memory_order_acquire))
+		{ text.append(static_cast<const String*>(flat->as_heap())->value_); }
+		else
+		{
+			pending.push_back(str->right());
+			pending.push_back(str->left());
+		}
+	}
+
+	size_t bytes = sizeof(String) + text.size();
+	heap_->allocate(bytes);
+	std::unique_ptr<value_t> leaf = std::make_unique<value_t>(new CIL::String(std::move(text), *heap_, bytes));
+	const value_t* published = nullptr;
+	if (!flat_.compare_exchange_strong(published, leaf.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+	{
+		//Another thread flattened this node first
+		return published;
 	}
-	throw binary_op_invalid_type("+", other);
+	return leaf.release();
+}
+
+bool CIL::String::equal(const String& other) const
+{
+	if (this == &other)
+	{ return true; }
+	if (size_ != other.size_)
+	{ return false; }
+	return value() == other.value();
+}
+
+value_t CIL::String::add(const value_t& self, const value_t& other)
+{
+	if (other.is_type(type_))
+	{ return CIL::String::concat(self, other); }
+	throw binary_op_invalid_type("+", self, other);
 }
 
-value_ptr CIL::String::equals(value_ptr other)
+value_t CIL::String::equals(const value_t& self, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_type(type_))
 	{
 		return CIL::Bool::create(
-			value_ == std::dynamic_pointer_cast<String>(other)->value()
+			equal(*other.as<String>())
 		);
 	}
-	throw binary_op_invalid_type("==", other);
+	throw binary_op_invalid_type("==", self, other);
 }
 
-value_ptr CIL::String::not_equals(value_ptr other)
+value_t CIL::String::not_equals(const value_t& self, const value_t& other)
 {
-	if (other->is_type(type_))
+	if (other.is_type(type_))
 	{
 		return CIL::Bool::create(
-			value_ != std::dynamic_pointer_cast<String>(other)->value()
+			!equal(*other.as<String>())
 		);
 	}
-	throw binary_op_invalid_type("!=", other);
+	throw binary_op_invalid_type("!=", self, other);
 }
 
 std::string CIL::String::to_string()
 {
-	if(value_ == "\\n")
+	if(size_ == 2 && value() == "\\n")
 	{ return "\n"; }
-	return value_;
+	return value();
 }
 
 std::string CIL::String::to_debug_string()
 {
-	return ("(str: " + value_ + ")");
+	return ("(str: " + value() + ")");
 }
 
 const bool CIL::String::to_bool()
 {
-	return value_ != "";
+	return size_ != 0;
 }
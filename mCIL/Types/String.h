@@ -1,28 +1,76 @@
 #pragma once
 #include "Value.h"
 #include "Bool.h"
+#include "Heap.h"
 
 namespace CIL
 {
+	//Strings are immutable ropes. Short strings hold their text, concatenating
+	//longer ones creates a node referring to both sides, so building a string
+	//piece by piece takes time linear in its length. A node is flattened into
+	//a flat string the first time its text is needed, and keeps it. Strings
+	//concatenated to a flattened node refer to that flat string instead of the
+	//node, so a string built and read in turns frees the copies it superseded.
 	class String : public Value
 	{
 	public:
-		static value_ptr create(std::string value, bool is_const = false);
+		static value_t create(std::string value);
 
-		const std::string value() const;
+		//'left' followed by 'right', both have to be strings
+		static value_t concat(const value_t& left, const value_t& right);
 
-		virtual value_ptr add(value_ptr) override;
+		//Flattens a node, the reference stays valid for the lifetime of the string
+		const std::string& value() const;
 
-		virtual value_ptr equals(value_ptr) override;
-		virtual value_ptr not_equals(value_ptr) override;
+		size_t size() const
+		{ return size_; }
+
+		//Compares the sizes before flattening either
+		bool equal(const String& other) const;
+
+		virtual value_t add(const value_t& self, const value_t&) override;
+
+		virtual value_t equals(const value_t& self, const value_t&) override;
+		virtual value_t not_equals(const value_t& self, const value_t&) override;
 
 		virtual std::string to_string() override;
 		virtual std::string to_debug_string() override;
 
 		virtual const bool to_bool() override;
+		~String();
 	private:
-		String(std::string value, bool is_const);
+		String(std::string value, Heap& heap, size_t bytes);
+		String(value_t left, value_t right, Heap& heap, size_t bytes);
+
+		static value_t node(value_t left, value_t right);
+
+		//Strings up to this many bytes are always stored flat
+		static constexpr size_t FLAT_LIMIT = 256;
 
+		bool is_node() const
+		{ return !left_.is_empty(); }
+
+		const String* left() const
+		{ return static_cast<const String*>(left_.as_heap()); }
+		const String* right() const
+		{ return static_cast<const String*>(right_.as_heap()); }
+
+		const value_t* flatten() const;
+
+		//The flat string a node was flattened into, or the string itself
+		static const value_t& settled(const value_t& str);
+
+		//The text of a flat string
 		std::string value_;
+		//The sides of a node, never changed after construction
+		value_t left_;
+		value_t right_;
+		size_t size_;
+		//The flat string holding the text of a node once it was flattened. Threads of
+		//a parallel loop may flatten the same node, the first one to finish publishes it
+		mutable std::atomic<const value_t*> flat_;
+
+		Heap* heap_;
+		size_t bytes_;
 	};
 }
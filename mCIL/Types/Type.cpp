@@ -3,12 +3,12 @@
 Type Type::make(std::string name, TypeQualifier flags)
 {
 	TypeID id = type_id(name);
-	return *(new Type(id, flags));
+	return Type(id, flags);
 }
 
 Type Type::make(TypeID id, TypeQualifier flags)
 {
-	return *(new Type(id, flags));
+	return Type(id, flags);
 }
 
 bool Type::is(TypeID id) const
@@ -3,7 +3,7 @@
 
 typedef unsigned char TypeQualifier;
 
-const enum TypeFlags
+enum TypeFlags
 {
 	PTR       = 1,
 	VOLATILE  = 2,
@@ -1,19 +1,26 @@
 #include "TypeTable.h"
+#include "../Interpreting/Isolate.h"
 
-TypeID TypeTable::type_count_ = 0;
-std::vector<TypeTable::TypeTableEntry> TypeTable::table_{};
+TypeTable::TypeTable()
+	: type_count_(0), table_()
+{
+}
+
+TypeTable& TypeTable::current()
+{ return Isolate::current().types(); }
 
 TypeID TypeTable::register_type(std::string name, TypeID super_type)
 {
-	TypeID id = type_count_++;
+	TypeTable& table = TypeTable::current();
+	TypeID id = table.type_count_++;
 	TypeTableEntry entry{ name, id, super_type };
-	table_.push_back(entry);
+	table.table_.push_back(entry);
 	return id;
 }
 
 TypeID TypeTable::get_type_id(std::string name)
 {
-	for (TypeTableEntry& entry : TypeTable::table_)
+	for (TypeTableEntry& entry : TypeTable::current().table_)
 	{
 		if (entry.name == name)
 		{ return entry.id; }
@@ -24,7 +31,7 @@ TypeID TypeTable::get_type_id(std::string name)
 
 std::string TypeTable::get_type_name(TypeID id)
 {
-	for (TypeTableEntry& entry : table_)
+	for (TypeTableEntry& entry : TypeTable::current().table_)
 	{
 		if (entry.id == id)
 		{ return entry.name; }
@@ -34,7 +41,7 @@ std::string TypeTable::get_type_name(TypeID id)
 
 TypeID TypeTable::get_super_type(TypeID id)
 {
-	for (TypeTableEntry& entry : table_)
+	for (TypeTableEntry& entry : TypeTable::current().table_)
 	{
 		if (entry.id == id)
 		{ return entry.parent; }
@@ -44,7 +51,7 @@ TypeID TypeTable::get_super_type(TypeID id)
 
 bool TypeTable::type_exists(TypeID id)
 {
-	for (TypeTableEntry& entry : table_)
+	for (TypeTableEntry& entry : TypeTable::current().table_)
 	{
 		if (entry.id == id)
 		{ return true; }
@@ -54,7 +61,7 @@ bool TypeTable::type_exists(TypeID id)
 
 bool TypeTable::type_exists(std::string name)
 {
-	for (TypeTableEntry& entry : table_)
+	for (TypeTableEntry& entry : TypeTable::current().table_)
 	{
 		if (entry.name == name)
 		{ return true; }
@@ -3,9 +3,15 @@
 
 typedef unsigned char TypeID;
 
+class Isolate;
+
+//The types known to an isolate. The static API works on the table of the
+//isolate the calling thread is in, see Isolate::current
 class TypeTable
 {
 public:
+	TypeTable();
+
 	static TypeID register_type(std::string name, TypeID super_type);
 
 	static TypeID get_type_id(std::string name);
@@ -15,8 +21,13 @@ public:
 	static bool type_exists(TypeID id);
 	static bool type_exists(std::string name);
 
-	static void add_builtin_types();
+	static TypeTable& current();
 private:
+	friend Isolate;
+
+	//Every isolate registers these first, so the builtin types have the same id everywhere
+	static void add_builtin_types();
+
 	struct TypeTableEntry
 	{
 		std::string name;
@@ -24,9 +35,9 @@ private:
 		TypeID parent;
 	};
 
-	static TypeID type_count_;
+	TypeID type_count_;
 
-	static std::vector<TypeTableEntry> table_;
+	std::vector<TypeTableEntry> table_;
 };
 
 #define type_id(name) TypeTable::get_type_id(name)
@@ -1,126 +1,389 @@
 #include "Value.h"
+#include "BuiltinTypes.h"
 
-value_ptr CIL::Value::invert()
+const Type value_t::type() const
 {
-	throw unary_op_not_implemented("!");
+	//Builtin ids are only known once the type table is filled
+	static const TypeID num_id = type_id("num");
+	static const TypeID bool_id = type_id("bool");
+	static const TypeID none_id = type_id("none");
+	static const TypeID error_id = type_id("error");
+
+	if (is_num())
+	{ return Type::make(num_id); }
+	if (is_heap())
+	{ return as_heap()->type(); }
+	if (is_bool())
+	{ return Type::make(bool_id); }
+	if (is_none())
+	{ return Type::make(none_id); }
+	return Type::make(error_id);
+}
+
+value_t value_t::invert() const
+{
+	if (is_num())
+	{ return CIL::Number::invert(as_num()); }
+	if (is_heap())
+	{ return as_heap()->invert(*this); }
+	if (is_bool())
+	{ return CIL::Bool::invert(as_bool()); }
+	throw CIL::Value::unary_op_not_implemented("!", *this);
+}
+
+value_t value_t::negate() const
+{
+	if (is_num())
+	{ return CIL::Number::negate(as_num()); }
+	if (is_heap())
+	{ return as_heap()->negate(*this); }
+	throw CIL::Value::unary_op_not_implemented("-", *this);
+}
+
+value_t value_t::increment() const
+{
+	if (is_num())
+	{ return CIL::Number::increment(as_num()); }
+	if (is_heap())
+	{ return as_heap()->increment(*this); }
+	throw CIL::Value::unary_op_not_implemented("++", *this);
+}
+
+value_t value_t::decrement() const
+{
+	if (is_num())
+	{ return CIL::Number::decrement(as_num()); }
+	if (is_heap())
+	{ return as_heap()->decrement(*this); }
+	throw CIL::Value::unary_op_not_implemented("--", *this);
+}
+
+value_t value_t::bitwise_not() const
+{
+	if (is_num())
+	{ return CIL::Number::bitwise_not(as_num()); }
+	if (is_heap())
+	{ return as_heap()->bitwise_not(*this); }
+	throw CIL::Value::unary_op_not_implemented("~", *this);
+}
+
+value_t value_t::add(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::add(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->add(*this, other); }
+	throw CIL::Value::binary_op_not_implemented("+", *this, other);
+}
+
+value_t value_t::subtract(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::subtract(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->subtract(*this, other); }
+	throw CIL::Value::binary_op_not_implemented("-", *this, other);
+}
+
+value_t value_t::multiply(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::multiply(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->multiply(*this, other); }
+	throw CIL::Value::binary_op_not_implemented("*", *this, other);
+}
+
+value_t value_t::divide(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::divide(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->divide(*this, other); }
+	throw CIL::Value::binary_op_not_implemented("/", *this, other);
+}
+
+value_t value_t::bitwise_and(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::bitwise_and(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->bitwise_and(*this, other); }
+	throw CIL::Value::binary_op_not_implemented("&", *this, other);
+}
+
+value_t value_t::bitwise_or(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::bitwise_or(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->bitwise_or(*this, other); }
+	throw CIL::Value::binary_op_not_implemented("|", *this, other);
+}
+
+value_t value_t::bitwise_xor(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::bitwise_xor(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->bitwise_xor(*this, other); }
+	throw CIL::Value::binary_op_not_implemented("^", *this, other);
+}
+
+value_t value_t::left_bitshift(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::left_bitshift(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->left_bitshift(*this, other); }
+	throw CIL::Value::binary_op_not_implemented("<<", *this, other);
+}
+
+value_t value_t::right_bitshift(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::right_bitshift(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->right_bitshift(*this, other); }
+	throw CIL::Value::binary_op_not_implemented(">>", *this, other);
+}
+
+value_t value_t::equals(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::equals(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->equals(*this, other); }
+	if (is_bool())
+	{ return CIL::Bool::equals(as_bool(), other); }
+	throw CIL::Value::binary_op_not_implemented("==", *this, other);
+}
+
+value_t value_t::not_equals(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::not_equals(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->not_equals(*this, other); }
+	if (is_bool())
+	{ return CIL::Bool::not_equals(as_bool(), other); }
+	throw CIL::Value::binary_op_not_implemented("!=", *this, other);
+}
+
+value_t value_t::greater(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::greater(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->greater(*this, other); }
+	throw CIL::Value::binary_op_not_implemented(">", *this, other);
+}
+
+value_t value_t::less(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::less(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->less(*this, other); }
+	throw CIL::Value::binary_op_not_implemented("<", *this, other);
+}
+
+value_t value_t::greater_equals(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::greater_equals(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->greater_equals(*this, other); }
+	throw CIL::Value::binary_op_not_implemented(">=", *this, other);
+}
+
+value_t value_t::less_equals(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::less_equals(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->less_equals(*this, other); }
+	throw CIL::Value::binary_op_not_implemented("<=", *this, other);
+}
+
+value_t value_t::logical_and(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::logical_and(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->logical_and(*this, other); }
+	if (is_bool())
+	{ return CIL::Bool::logical_and(as_bool(), other); }
+	throw CIL::Value::binary_op_not_implemented("&&", *this, other);
+}
+
+value_t value_t::logical_or(const value_t& other) const
+{
+	if (is_num())
+	{ return CIL::Number::logical_or(as_num(), other); }
+	if (is_heap())
+	{ return as_heap()->logical_or(*this, other); }
+	if (is_bool())
+	{ return CIL::Bool::logical_or(as_bool(), other); }
+	throw CIL::Value::binary_op_not_implemented("||", *this, other);
+}
+
+std::string value_t::to_string() const
+{
+	if (is_num())
+	{ return CIL::Number::to_string(as_num()); }
+	if (is_heap())
+	{ return as_heap()->to_string(); }
+	if (is_bool())
+	{ return CIL::Bool::to_string(as_bool()); }
+	if (is_none())
+	{ return CIL::None::to_string(); }
+	return CIL::ErrorValue::to_string();
+}
+
+std::string value_t::to_debug_string() const
+{
+	if (is_num())
+	{ return CIL::Number::to_debug_string(as_num()); }
+	if (is_heap())
+	{ return as_heap()->to_debug_string(); }
+	if (is_bool())
+	{ return CIL::Bool::to_debug_string(as_bool()); }
+	if (is_none())
+	{ return CIL::None::to_debug_string(); }
+	return CIL::ErrorValue::to_debug_string();
+}
+
+const bool value_t::to_bool() const
+{
+	if (is_num())
+	{ return CIL::Number::to_bool(as_num()); }
+	if (is_heap())
+	{ return as_heap()->to_bool(); }
+	return as_bool();
+}
+
+value_t CIL::Value::invert(const value_t& self)
+{
+	throw unary_op_not_implemented("!", self);
 }
 
-value_ptr CIL::Value::negate()
+value_t CIL::Value::negate(const value_t& self)
 {
-	throw unary_op_not_implemented("-");
+	throw unary_op_not_implemented("-", self);
 }
 
-value_ptr CIL::Value::increment()
+value_t CIL::Value::increment(const value_t& self)
 {
-	throw unary_op_not_implemented("++");
+	throw unary_op_not_implemented("++", self);
 }
 
-value_ptr CIL::Value::decrement()
+value_t CIL::Value::decrement(const value_t& self)
 {
-	throw unary_op_not_implemented("--");
+	throw unary_op_not_implemented("--", self);
 }
 
-value_ptr CIL::Value::add(value_ptr other)
+value_t CIL::Value::bitwise_not(const value_t& self)
 {
-	throw binary_op_not_implemented("+", other);
+	throw unary_op_not_implemented("~", self);
 }
 
-value_ptr CIL::Value::subtract(value_ptr other)
+value_t CIL::Value::add(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("-", other);
+	throw binary_op_not_implemented("+", self, other);
 }
 
-value_ptr CIL::Value::multiply(value_ptr other)
+value_t CIL::Value::subtract(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("*", other);
+	throw binary_op_not_implemented("-", self, other);
 }
 
-value_ptr CIL::Value::divide(value_ptr other)
+value_t CIL::Value::multiply(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("/", other);
+	throw binary_op_not_implemented("*", self, other);
 }
 
-value_ptr CIL::Value::bitwise_not()
+value_t CIL::Value::divide(const value_t& self, const value_t& other)
 {
-	throw unary_op_not_implemented("~");
+	throw binary_op_not_implemented("/", self, other);
 }
 
-value_ptr CIL::Value::bitwise_and(value_ptr other)
+value_t CIL::Value::bitwise_and(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("&", other);
+	throw binary_op_not_implemented("&", self, other);
 }
 
-value_ptr CIL::Value::bitwise_or(value_ptr other)
+value_t CIL::Value::bitwise_or(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("|", other);
+	throw binary_op_not_implemented("|", self, other);
 }
 
-value_ptr CIL::Value::bitwise_xor(value_ptr other)
+value_t CIL::Value::bitwise_xor(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("^", other);
+	throw binary_op_not_implemented("^", self, other);
 }
 
-value_ptr CIL::Value::left_bitshift(value_ptr other)
+value_t CIL::Value::left_bitshift(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("<<", other);
+	throw binary_op_not_implemented("<<", self, other);
 }
 
-value_ptr CIL::Value::right_bitshift(value_ptr other)
+value_t CIL::Value::right_bitshift(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented(">>", other);
+	throw binary_op_not_implemented(">>", self, other);
 }
 
-value_ptr CIL::Value::equals(value_ptr other)
+value_t CIL::Value::equals(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("==", other);
+	throw binary_op_not_implemented("==", self, other);
 }
 
-value_ptr CIL::Value::not_equals(value_ptr other)
+value_t CIL::Value::not_equals(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("!=", other);
+	throw binary_op_not_implemented("!=", self, other);
 }
 
-value_ptr CIL::Value::greater(value_ptr other)
+value_t CIL::Value::greater(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented(">", other);
+	throw binary_op_not_implemented(">", self, other);
 }
 
-value_ptr CIL::Value::less(value_ptr other)
+value_t CIL::Value::less(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("<", other);
+	throw binary_op_not_implemented("<", self, other);
 }
 
-value_ptr CIL::Value::greater_equals(value_ptr other)
+value_t CIL::Value::greater_equals(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented(">=", other);
+	throw binary_op_not_implemented(">=", self, other);
 }
 
-value_ptr CIL::Value::less_equals(value_ptr other)
+value_t CIL::Value::less_equals(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("<=", other);
+	throw binary_op_not_implemented("<=", self, other);
 }
 
-value_ptr CIL::Value::logical_and(value_ptr other)
+value_t CIL::Value::logical_and(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("&&", other);
+	throw binary_op_not_implemented("&&", self, other);
 }
 
-value_ptr CIL::Value::logical_or(value_ptr other)
+value_t CIL::Value::logical_or(const value_t& self, const value_t& other)
 {
-	throw binary_op_not_implemented("||", other);
+	throw binary_op_not_implemented("||", self, other);
 }
 
-CILError CIL::Value::unary_op_not_implemented(std::string op)
+CILError CIL::Value::unary_op_not_implemented(std::string op, const value_t& self)
 {
-	return CILError::error("Operator '$' is not implemented for type '$'", op, type());
+	return CILError::error("Operator '$' is not implemented for type '$'", op, self.type());
 }
 
-CILError CIL::Value::binary_op_not_implemented(std::string op, value_ptr val)
+CILError CIL::Value::binary_op_not_implemented(std::string op, const value_t& self, const value_t& val)
 {
-	return CILError::error("Operator '$' is not implemented for types '$' and '$'", op, type(), val->type());
+	return CILError::error("Operator '$' is not implemented for types '$' and '$'", op, self.type(), val.type());
 }
 
-CILError CIL::Value::binary_op_invalid_type(std::string op, value_ptr val)
+CILError CIL::Value::binary_op_invalid_type(std::string op, const value_t& self, const value_t& val)
 {
-	return CILError::error("Invalid operands '$' and '$' for operator '$'", type(), val->type(), op);
+	return CILError::error("Invalid operands '$' and '$' for operator '$'", self.type(), val.type(), op);
 }
\ No newline at end of file
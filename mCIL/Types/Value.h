@@ -5,61 +5,258 @@
 
 namespace CIL
 { class Value; }
+class Heap;
 
-typedef std::shared_ptr<CIL::Value> value_ptr;
+//A NaN-boxed 64-bit value. Numbers are stored as plain doubles, bool, none
+//and error are encoded in the payload of a quiet NaN and only strings and
+//objects are boxed on the heap, behind a tagged, reference counted pointer.
+class value_t
+{
+public:
+	value_t()
+		: bits_(EMPTY_BITS) {}
+
+	value_t(std::nullptr_t)
+		: bits_(EMPTY_BITS) {}
+
+	value_t(CIL::Value* heap);
+
+	value_t(const value_t& other)
+		: bits_(other.bits_)
+	{ retain(); }
+
+	value_t(value_t&& other) noexcept
+		: bits_(other.bits_)
+	{ other.bits_ = EMPTY_BITS; }
+
+	~value_t()
+	{ release(); }
+
+	value_t& operator=(const value_t& other)
+	{
+		if (bits_ != other.bits_)
+		{
+			other.retain();
+			release();
+			bits_ = other.bits_;
+		}
+		return *this;
+	}
+
+	value_t& operator=(value_t&& other) noexcept
+	{
+		if (this != &other)
+		{
+			release();
+			bits_ = other.bits_;
+			other.bits_ = EMPTY_BITS;
+		}
+		return *this;
+	}
+
+	static value_t number(double value)
+	{
+		value_t result{};
+		//All NaNs are folded into one, so they can never be mistaken for a tag
+		if (value != value)
+		{ result.bits_ = CANONICAL_NAN; }
+		else
+		{ std::memcpy(&result.bits_, &value, sizeof(double)); }
+		return result;
+	}
+
+	static value_t boolean(bool value)
+	{ return value_t(value ? TRUE_BITS : FALSE_BITS); }
+
+	static value_t none()
+	{ return value_t(NONE_BITS); }
+
+	static value_t error()
+	{ return value_t(ERROR_BITS); }
+
+	bool is_num() const
+	{ return (bits_ & QNAN) != QNAN; }
+
+	bool is_bool() const
+	{ return bits_ == TRUE_BITS || bits_ == FALSE_BITS; }
+
+	bool is_none() const
+	{ return bits_ == NONE_BITS; }
+
+	bool is_error() const
+	{ return bits_ == ERROR_BITS; }
+
+	bool is_heap() const
+	{ return (bits_ & (QNAN | SIGN_BIT)) == (QNAN | SIGN_BIT); }
+
+	bool is_empty() const
+	{ return bits_ == EMPTY_BITS; }
+
+	double as_num() const
+	{
+		double value;
+		std::memcpy(&value, &bits_, sizeof(double));
+		return value;
+	}
+
+	bool as_bool() const
+	{ return bits_ == TRUE_BITS; }
+
+	CIL::Value* as_heap() const
+	{ return (CIL::Value*)(uintptr_t)(bits_ & ~(SIGN_BIT | QNAN)); }
+
+	template <typename T>
+	T* as() const
+	{ return is_heap() ? dynamic_cast<T*>(as_heap()) : nullptr; }
+
+	uint64_t bits() const
+	{ return bits_; }
+
+	const Type type() const;
+
+	bool is_type(Type t) const
+	{ return type().is(t); }
+
+	value_t invert() const;
+	value_t negate() const;
+	value_t increment() const;
+	value_t decrement() const;
+
+	value_t add(const value_t&) const;
+	value_t subtract(const value_t&) const;
+	value_t multiply(const value_t&) const;
+	value_t divide(const value_t&) const;
+
+	value_t bitwise_not() const;
+	value_t bitwise_and(const value_t&) const;
+	value_t bitwise_or(const value_t&) const;
+	value_t bitwise_xor(const value_t&) const;
+
+	value_t left_bitshift(const value_t&) const;
+	value_t right_bitshift(const value_t&) const;
+
+	value_t equals(const value_t&) const;
+	value_t not_equals(const value_t&) const;
+	value_t greater(const value_t&) const;
+	value_t less(const value_t&) const;
+	value_t greater_equals(const value_t&) const;
+	value_t less_equals(const value_t&) const;
+	value_t logical_and(const value_t&) const;
+	value_t logical_or(const value_t&) const;
+
+	std::string to_string() const;
+	std::string to_debug_string() const;
+
+	const bool to_bool() const;
+
+	explicit operator bool() const
+	{ return !is_empty(); }
+
+	bool operator==(std::nullptr_t) const
+	{ return is_empty(); }
+
+	bool operator!=(std::nullptr_t) const
+	{ return !is_empty(); }
+private:
+	explicit value_t(uint64_t bits)
+		: bits_(bits) {}
+
+	void retain() const;
+	void release() const;
+
+	static constexpr uint64_t SIGN_BIT      = 0x8000000000000000;
+	static constexpr uint64_t QNAN          = 0x7ffc000000000000;
+	static constexpr uint64_t CANONICAL_NAN = 0x7ff8000000000000;
+
+	static constexpr uint64_t NONE_BITS  = QNAN | 1;
+	static constexpr uint64_t FALSE_BITS = QNAN | 2;
+	static constexpr uint64_t TRUE_BITS  = QNAN | 3;
+	static constexpr uint64_t ERROR_BITS = QNAN | 4;
+	static constexpr uint64_t EMPTY_BITS = QNAN | 5;
+
+	uint64_t bits_;
+};
 
 namespace CIL
 {
+	//Base of all heap allocated values. Only types that cannot be stored
+	//inline in a value_t (strings and objects) derive from this.
 	class Value
 	{
 	public:
+		virtual ~Value() {}
+
 		const Type type() const
 		{ return type_; }
 
 		const bool is_type(Type t) const
 		{ return type_.is(t); }
 
-		virtual value_ptr invert();
-		virtual value_ptr negate();
-		virtual value_ptr increment();
-		virtual value_ptr decrement();
-
-		virtual value_ptr add(value_ptr);
-		virtual value_ptr subtract(value_ptr);
-		virtual value_ptr multiply(value_ptr);
-		virtual value_ptr divide(value_ptr);
-
-		virtual value_ptr bitwise_not();
-		virtual value_ptr bitwise_and(value_ptr);
-		virtual value_ptr bitwise_or(value_ptr);
-		virtual value_ptr bitwise_xor(value_ptr);
-
-		virtual value_ptr left_bitshift(value_ptr);
-		virtual value_ptr right_bitshift(value_ptr);
-
-		virtual value_ptr equals(value_ptr);
-		virtual value_ptr not_equals(value_ptr);
-		virtual value_ptr greater(value_ptr);
-		virtual value_ptr less(value_ptr);
-		virtual value_ptr greater_equals(value_ptr);
-		virtual value_ptr less_equals(value_ptr);
-		virtual value_ptr logical_and(value_ptr);
-		virtual value_ptr logical_or(value_ptr);
+		virtual value_t invert(const value_t& self);
+		virtual value_t negate(const value_t& self);
+		virtual value_t increment(const value_t& self);
+		virtual value_t decrement(const value_t& self);
+
+		virtual value_t add(const value_t& self, const value_t&);
+		virtual value_t subtract(const value_t& self, const value_t&);
+		virtual value_t multiply(const value_t& self, const value_t&);
+		virtual value_t divide(const value_t& self, const value_t&);
+
+		virtual value_t bitwise_not(const value_t& self);
+		virtual value_t bitwise_and(const value_t& self, const value_t&);
+		virtual value_t bitwise_or(const value_t& self, const value_t&);
+		virtual value_t bitwise_xor(const value_t& self, const value_t&);
+
+		virtual value_t left_bitshift(const value_t& self, const value_t&);
+		virtual value_t right_bitshift(const value_t& self, const value_t&);
+
+		virtual value_t equals(const value_t& self, const value_t&);
+		virtual value_t not_equals(const value_t& self, const value_t&);
+		virtual value_t greater(const value_t& self, const value_t&);
+		virtual value_t less(const value_t& self, const value_t&);
+		virtual value_t greater_equals(const value_t& self, const value_t&);
+		virtual value_t less_equals(const value_t& self, const value_t&);
+		virtual value_t logical_and(const value_t& self, const value_t&);
+		virtual value_t logical_or(const value_t& self, const value_t&);
 
 		virtual std::string to_string() = 0;
 		virtual std::string to_debug_string() = 0;
 
 		virtual const bool to_bool() = 0;
+
+		static CILError unary_op_not_implemented(std::string op, const value_t& self);
+
+		static CILError binary_op_not_implemented(std::string op, const value_t& self, const value_t& val);
+
+		static CILError binary_op_invalid_type(std::string op, const value_t& self, const value_t& val);
 	protected:
 		Value(Type type)
-			: type_(type) {}
+			: type_(type), refs_(0) {}
 
 		const Type type_;
+	private:
+		friend class ::value_t;
+		//Reads the counts to tell references from outside from those between objects
+		friend class ::Heap;
 
-		CILError unary_op_not_implemented(std::string op);
+		mutable std::atomic<uint32_t> refs_;
+	};
+}
 
-		CILError binary_op_not_implemented(std::string op, value_ptr val);
+inline value_t::value_t(CIL::Value* heap)
+	: bits_(SIGN_BIT | QNAN | (uint64_t)(uintptr_t)heap)
+{
+	retain();
+}
 
-		CILError binary_op_invalid_type(std::string op, value_ptr val);
-	};
-}
\ No newline at end of file
+inline void value_t::retain() const
+{
+	if (is_heap())
+	{ as_heap()->refs_.fetch_add(1, std::memory_order_relaxed); }
+}
+
+inline void value_t::release() const
+{
+	if (is_heap() && as_heap()->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{ delete as_heap(); }
+}
@@ -0,0 +1,98 @@
+#include "FrontendBenchmark.h"
+#include "TraversalBenchmark.h"
+#include "Timing.h"
+#include "../../Lexing/Lexer.h"
+#include "../../Scanning/Scanner.h"
+#include "../../Scanning/SymbolTable.h"
+#include "../../Parsing/Parser.h"
+#include "../../Interpreting/Isolate.h"
+#include "../../Diagnostics/SourceFileManager.h"
+#include "../../Diagnostics/Diagnostics.h"
+#include <filesystem>
+
+FrontendBenchmark::FrontendBenchmark(ProgramGenerator::Shape shape, size_t runs)
+	: shape_(shape), runs_(runs == 0 ? 1 : runs)
+{
+}
+
+FrontendBenchmark::Sample FrontendBenchmark::run(size_t functions)
+{
+	Sample sample{};
+	sample.functions = functions;
+
+	std::string program = ProgramGenerator{ shape_ }.generate(functions);
+	sample.bytes = program.size();
+	sample.lines = std::count(program.begin(), program.end(), '\n');
+
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "cil-frontend-benchmark.cil";
+	{
+		std::ofstream file{ path, std::ios::binary };
+		file << program;
+	}
+
+	std::vector<double> lex_ms{}, scan_ms{}, parse_ms{};
+	for (size_t i = 0; i < runs_; i++)
+	{
+		Isolate isolate{};
+		Isolate::Scope scope{ isolate };
+
+		auto start = std::chrono::steady_clock::now();
+		SourceFileManager source{ path.string() };
+		Lexer lexer{ isolate, source };
+		token_list tokens = lexer.scan_file();
+		auto lexed = std::chrono::steady_clock::now();
+
+		Scanner scanner{ isolate, tokens };
+		token_list top_level_tokens = scanner.scan();
+		auto scanned = std::chrono::steady_clock::now();
+
+		Parser parser{ isolate, top_level_tokens };
+		stmt_list& stmts = parser.parse();
+		auto parsed = std::chrono::steady_clock::now();
+
+		if (ErrorManager::error_ocurred())
+		{
+			std::string error = ErrorManager::errors().front().what();
+			std::filesystem::remove(path);
+			throw CILError::error("Generated program does not parse: $", error);
+		}
+
+		lex_ms.push_back(std::chrono::duration<double, std::milli>(lexed - start).count());
+		scan_ms.push_back(std::chrono::duration<double, std::milli>(scanned - lexed).count());
+		parse_ms.push_back(std::chrono::duration<double, std::milli>(parsed - scanned).count());
+		sample.tokens = tokens.size();
+		sample.nodes = TraversalBenchmark{ stmts }.nodes();
+	}
+	std::filesystem::remove(path);
+
+	sample.lex_ms = median(lex_ms);
+	sample.scan_ms = median(scan_ms);
+	sample.parse_ms = median(parse_ms);
+	return sample;
+}
+
+void FrontendBenchmark::report(const std::vector<Sample>& samples, std::ostream& os)
+{
+	os << std::right << std::setw(10) << "functions" << std::setw(10) << "lines" << std::setw(10) << "tokens"
+	   << std::setw(10) << "nodes" << std::setw(8) << "phase" << std::setw(12) << "ms"
+	   << std::setw(14) << "tokens/s" << std::setw(10) << "MB/s" << std::setw(14) << "nodes/s" << "\n";
+	for (const Sample& sample : samples)
+	{
+		std::pair<const char*, double> phases[] =
+		{
+			{ "lex", sample.lex_ms },
+			{ "scan", sample.scan_ms },
+			{ "parse", sample.parse_ms }
+		};
+		for (const auto& [phase, ms] : phases)
+		{
+			double seconds = std::max(ms, 1e-6) / 1000.0;
+			os << std::setw(10) << sample.functions << std::setw(10) << sample.lines << std::setw(10) << sample.tokens
+			   << std::setw(10) << sample.nodes << std::setw(8) << phase
+			   << std::fixed << std::setprecision(3) << std::setw(12) << ms
+			   << std::setprecision(0) << std::setw(14) << sample.tokens / seconds
+			   << std::setprecision(2) << std::setw(10) << sample.bytes / seconds / (1024.0 * 1024.0)
+			   << std::setprecision(0) << std::setw(14) << sample.nodes / seconds << "\n";
+		}
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "../../cil-system.h"
+#include "ProgramGenerator.h"
+
+//Measures how lexing, scanning and parsing scale with the size of the input.
+//Programs of growing size are generated with ProgramGenerator, written to a
+//temporary file and run through the front end. Every phase is reported as
+//tokens/s, MB/s and AST nodes/s, so a phase whose work grows faster than its
+//input shows up as a rate that drops with the size.
+class FrontendBenchmark
+{
+public:
+	struct Sample
+	{
+		size_t functions = 0;
+		size_t lines = 0;
+		size_t bytes = 0;
+		size_t tokens = 0;
+		size_t nodes = 0;
+
+		//Median of all runs
+		double lex_ms = 0;
+		double scan_ms = 0;
+		double parse_ms = 0;
+	};
+
+	FrontendBenchmark(ProgramGenerator::Shape shape = {}, size_t runs = 3);
+
+	Sample run(size_t functions);
+
+	static void report(const std::vector<Sample>& samples, std::ostream& os);
+private:
+	ProgramGenerator::Shape shape_;
+	size_t runs_;
+};
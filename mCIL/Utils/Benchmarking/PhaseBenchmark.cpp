@@ -0,0 +1,152 @@
+#include "PhaseBenchmark.h"
+#include "Timing.h"
+#include "../../Lexing/Lexer.h"
+#include "../../Scanning/Scanner.h"
+#include "../../Scanning/SymbolTable.h"
+#include "../../Parsing/Parser.h"
+#include "../../Parsing/Optimizer.h"
+#include "../../Parsing/Resolver.h"
+#include "../../Interpreting/Interpreter.h"
+#include "../../Interpreting/VM.h"
+#include "../../Interpreting/Isolate.h"
+#include "../../Diagnostics/SourceFileManager.h"
+#include "../../Diagnostics/Diagnostics.h"
+
+//Swallows everything the benchmarked program prints
+class NullBuffer : public std::streambuf
+{
+protected:
+	int overflow(int c) override
+	{ return c; }
+
+	std::streamsize xsputn(const char*, std::streamsize n) override
+	{ return n; }
+};
+
+double PhaseBenchmark::Phase::median() const
+{
+	return ::median(ms);
+}
+
+double PhaseBenchmark::Phase::p95() const
+{
+	if (ms.empty())
+	{ return 0; }
+	std::vector<double> sorted = ms;
+	std::sort(sorted.begin(), sorted.end());
+	size_t rank = (95 * sorted.size() + 99) / 100;
+	return sorted[rank - 1];
+}
+
+PhaseBenchmark::PhaseBenchmark(std::string path, bool vm, bool optimize)
+	: path_(path), vm_(vm), optimize_(optimize)
+{
+}
+
+PhaseBenchmark::Result PhaseBenchmark::run(size_t runs)
+{
+	Result result{ path_, { { "lex", {} }, { "scan", {} }, { "parse", {} }, { "resolve", {} }, { "execute", {} }, { "total", {} } }, "" };
+	for (size_t i = 0; i < runs; i++)
+	{
+		if (!run_once(result))
+		{ break; }
+	}
+	return result;
+}
+
+bool PhaseBenchmark::run_once(Result& result)
+{
+	//Every run starts from the builtin types and no globals, as a fresh process would
+	Isolate isolate{};
+	Isolate::Scope scope{ isolate };
+
+	auto failed = [&result]()
+	{
+		if (!ErrorManager::error_ocurred())
+		{ return false; }
+		result.error = ErrorManager::errors().front().what();
+		return true;
+	};
+
+	double times[5]{};
+
+	auto start = std::chrono::steady_clock::now();
+	SourceFileManager source{ path_ };
+	Lexer lexer{ isolate, source };
+	token_list tokens = lexer.scan_file();
+	times[0] = elapsed_ms(start);
+	if (failed())
+	{ return false; }
+
+	start = std::chrono::steady_clock::now();
+	Scanner scanner{ isolate, tokens };
+	token_list top_level_tokens = scanner.scan();
+	times[1] = elapsed_ms(start);
+	if (failed())
+	{ return false; }
+
+	start = std::chrono::steady_clock::now();
+	Parser parser{ isolate, top_level_tokens };
+	stmt_list& stmts = parser.parse();
+	times[2] = elapsed_ms(start);
+	if (failed())
+	{ return false; }
+
+	start = std::chrono::steady_clock::now();
+	ConstantPool constants{};
+	Optimizer optimizer{ stmts, constants };
+	if (optimize_)
+	{ optimizer.optimize(); }
+	Resolver resolver{ stmts, constants };
+	resolver.resolve();
+	times[3] = elapsed_ms(start);
+	if (failed())
+	{ return false; }
+
+	NullBuffer null_buffer{};
+	std::streambuf* out = std::cout.rdbuf(&null_buffer);
+	start = std::chrono::steady_clock::now();
+	if (vm_)
+	{
+		VM vm{ stmts };
+		vm.define_global_symbols();
+		vm.run();
+	}
+	else
+	{
+		Interpreter interpreter{ isolate, stmts };
+		interpreter.define_global_symbols();
+		interpreter.run();
+	}
+	times[4] = elapsed_ms(start);
+	std::cout.rdbuf(out);
+	if (failed())
+	{ return false; }
+
+	double total = 0;
+	for (size_t i = 0; i < 5; i++)
+	{
+		result.phases[i].ms.push_back(times[i]);
+		total += times[i];
+	}
+	result.phases[5].ms.push_back(total);
+	return true;
+}
+
+void PhaseBenchmark::report(const std::vector<Result>& results, std::ostream& os)
+{
+	os << std::left << std::setw(24) << "program" << std::setw(10) << "phase" << std::right
+	   << std::setw(8) << "runs" << std::setw(14) << "median ms" << std::setw(14) << "p95 ms" << "\n";
+	os << std::fixed << std::setprecision(3);
+	for (const Result& result : results)
+	{
+		std::string name = result.path.substr(result.path.find_last_of("/\\") + 1);
+		for (const Phase& phase : result.phases)
+		{
+			os << std::left << std::setw(24) << name << std::setw(10) << phase.name << std::right
+			   << std::setw(8) << phase.ms.size() << std::setw(14) << phase.median() << std::setw(14) << phase.p95() << "\n";
+		}
+		if (!result.error.empty())
+		{ os << "  failed: " << result.error << "\n"; }
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "../../cil-system.h"
+
+//Runs one CIL program through the whole pipeline several times and times every
+//phase on its own: lexing, scanning, parsing, optimizing plus resolving, and
+//executing. Every run starts from an empty global symbol table, so each run
+//does the same work. Output the program prints while executing is discarded.
+class PhaseBenchmark
+{
+public:
+	struct Phase
+	{
+		std::string name;
+		std::vector<double> ms;
+
+		double median() const;
+		//Nearest-rank 95th percentile
+		double p95() const;
+	};
+
+	struct Result
+	{
+		std::string path;
+		std::vector<Phase> phases;
+		//First error the program reported, the phases only hold the runs before it
+		std::string error;
+	};
+
+	PhaseBenchmark(std::string path, bool vm = false, bool optimize = true);
+
+	Result run(size_t runs);
+
+	static void report(const std::vector<Result>& results, std::ostream& os);
+private:
+	//Returns false once an error was reported
+	bool run_once(Result& result);
+
+	std::string path_;
+	bool vm_;
+	bool optimize_;
+};
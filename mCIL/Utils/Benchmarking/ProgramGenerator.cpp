@@ -0,0 +1,207 @@
+#include "ProgramGenerator.h"
+
+static constexpr size_t CLASS_INTERVAL = 16;
+
+ProgramGenerator::ProgramGenerator(uint32_t seed)
+	: ProgramGenerator(Shape{}, seed)
+{
+}
+
+ProgramGenerator::ProgramGenerator(Shape shape, uint32_t seed)
+	: shape_(shape), rng_(seed), level_(0), counters_(0), locals_ready_(true)
+{
+	shape_.max_statements = std::max(shape_.max_statements, shape_.min_statements);
+}
+
+std::string ProgramGenerator::generate(size_t functions)
+{
+	std::stringstream ss{};
+	generate(functions, ss);
+	return ss.str();
+}
+
+void ProgramGenerator::generate(size_t functions, std::ostream& os)
+{
+	for (size_t i = 0; i < functions; i++)
+	{
+		gen_function(i, os);
+		if (i % CLASS_INTERVAL == 0)
+		{ gen_class(i, os); }
+	}
+	gen_main(functions, os);
+}
+
+void ProgramGenerator::gen_function(size_t index, std::ostream& os)
+{
+	os << "def f_" << index << "(num a, num b) -> num\n{\n";
+	level_ = 1;
+	//Initializers may only refer to the parameters
+	locals_ready_ = false;
+	os << indent() << "num x = " << gen_expression(0) << ";\n";
+	os << indent() << "num y = " << gen_expression(0) << ";\n";
+	os << indent() << "num[4] t = { " << pick(10) << ", " << pick(10) << ", a, b };\n";
+	locals_ready_ = true;
+
+	uint32_t statements = shape_.min_statements + pick(shape_.max_statements - shape_.min_statements + 1);
+	for (uint32_t i = 0; i < statements; i++)
+	{
+		gen_statement(1, os);
+	}
+
+	if (index > 0)
+	{ os << indent() << "return x + f_" << index / 2 << "(y, " << pick(10) << ");\n"; }
+	else
+	{ os << indent() << "return x - y;\n"; }
+	level_ = 0;
+	os << "}\n\n";
+}
+
+void ProgramGenerator::gen_class(size_t index, std::ostream& os)
+{
+	os << "class C_" << index << "\n{\n";
+	//Method names have to be unique across all classes
+	os << "\tdef get_" << index << "(num v) -> num\n\t{\n";
+	os << "\t\tm = m + v;\n";
+	os << "\t\treturn m * " << pick(10) << ";\n";
+	os << "\t}\n\n";
+	os << "\tnum m = " << index << ";\n";
+	os << "}\n\n";
+}
+
+void ProgramGenerator::gen_main(size_t functions, std::ostream& os)
+{
+	os << "num total = 0;\n";
+	for (size_t i = 0; i < functions; i++)
+	{
+		os << "total = total + f_" << i << "(" << i << ", " << pick(10) << ");\n";
+		if (i % CLASS_INTERVAL == 0)
+		{
+			os << "C_" << i << " o_" << i << " = new C_" << i << "();\n";
+			os << "total = total + o_" << i << ".get_" << i << "(" << pick(10) << ");\n";
+		}
+	}
+	os << "print total;\n";
+}
+
+void ProgramGenerator::gen_statement(int depth, std::ostream& os)
+{
+	//Compound statements only appear while there is nesting budget left
+	uint32_t kind = pick(depth < shape_.statement_depth ? 8 : 3);
+	switch (kind)
+	{
+	case 0:
+	case 1:
+		os << indent() << var() << " = " << gen_expression(0) << ";\n";
+		break;
+	case 2:
+		os << indent() << var() << " = t[" << pick(4) << "] + " << gen_expression(1) << ";\n";
+		break;
+	case 3:
+	case 4:
+	{
+		os << indent() << "if (" << gen_condition() << ")\n" << indent() << "{\n";
+		level_++;
+		gen_statement(depth + 1, os);
+		level_--;
+		os << indent() << "}\n";
+		if (pick(2))
+		{
+			os << indent() << "elif (" << gen_condition() << ")\n" << indent() << "{\n";
+			level_++;
+			gen_statement(depth + 1, os);
+			level_--;
+			os << indent() << "}\n";
+		}
+		os << indent() << "else\n" << indent() << "{\n";
+		level_++;
+		gen_statement(depth + 1, os);
+		level_--;
+		os << indent() << "}\n";
+		break;
+	}
+	case 5:
+	case 6:
+	{
+		//Loop counters are unique and never assigned in the body, so every loop terminates
+		std::string counter = "i" + std::to_string(counters_++);
+		os << indent() << "for (num " << counter << " = 0; " << counter << " < " << 2 + pick(3)
+			<< "; " << counter << "++)\n" << indent() << "{\n";
+		level_++;
+		os << indent() << var() << " = " << var() << " + " << counter << ";\n";
+		gen_statement(depth + 1, os);
+		level_--;
+		os << indent() << "}\n";
+		break;
+	}
+	case 7:
+	{
+		std::string counter = "w" + std::to_string(counters_++);
+		os << indent() << "num " << counter << " = 0;\n";
+		os << indent() << "while (" << counter << " < " << 2 + pick(3) << ")\n" << indent() << "{\n";
+		level_++;
+		os << indent() << counter << "++;\n";
+		gen_statement(depth + 1, os);
+		os << indent() << "if (" << gen_condition() << ")\n" << indent() << "{\n";
+		os << indent() << "\tbreak;\n";
+		os << indent() << "}\n";
+		level_--;
+		os << indent() << "}\n";
+		break;
+	}
+	}
+}
+
+std::string ProgramGenerator::gen_expression(int depth)
+{
+	uint32_t kind = pick(depth < shape_.expression_depth ? 9 : 3);
+	if (kind == 0)
+	{ return var(); }
+	if (kind == 2 && locals_ready_)
+	{ return "t[" + std::to_string(pick(4)) + "]"; }
+	if (kind == 1 || kind == 2)
+	{ return std::to_string(pick(100)); }
+
+	//Operands are generated in sequence, so the output does not depend on evaluation order
+	std::string cond = kind == 7 ? gen_condition() : "";
+	std::string left = gen_expression(depth + 1);
+	std::string right = kind == 6 || kind == 8 ? "" : gen_expression(depth + 1);
+	switch (kind)
+	{
+	case 3:
+		return left + " + " + right;
+	case 4:
+		return left + " - " + right;
+	case 5:
+		return "(" + left + ") * " + right;
+	case 6:
+		return "(0 - " + left + ")";
+	case 7:
+		return "((" + cond + ") ? " + left + " : " + right + ")";
+	default:
+		return "(" + left + ")";
+	}
+}
+
+std::string ProgramGenerator::gen_condition()
+{
+	static const char* comparisons[] = { "<", ">", "<=", ">=", "==", "!=" };
+	std::string left = var();
+	std::string op = comparisons[pick(6)];
+	return left + " " + op + " " + std::to_string(pick(100));
+}
+
+std::string ProgramGenerator::var()
+{
+	static const char* vars[] = { "a", "b", "x", "y" };
+	return vars[pick(locals_ready_ ? 4 : 2)];
+}
+
+std::string ProgramGenerator::indent() const
+{
+	return std::string(level_, '\t');
+}
+
+uint32_t ProgramGenerator::pick(uint32_t bound)
+{
+	return rng_() % bound;
+}
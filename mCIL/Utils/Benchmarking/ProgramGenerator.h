@@ -0,0 +1,47 @@
+#pragma once
+#include "../../cil-system.h"
+
+//Writes large, syntactically valid CIL programs for benchmarking the front end
+//and AST consumers. The output only depends on the seed, so runs are comparable.
+//Every function calls at most one function with half its index, so executing
+//the program terminates and recursion stays logarithmic in the function count.
+class ProgramGenerator
+{
+public:
+	//How large and how deeply nested the generated functions are
+	struct Shape
+	{
+		//Nesting of if/elif/else, for and while inside a function body. Every loop
+		//runs up to four times, so running deeply nested programs gets slow fast
+		int statement_depth = 3;
+		//Nesting of operators inside an expression
+		int expression_depth = 3;
+		//Top-level statements per function body, besides the declarations and return
+		uint32_t min_statements = 3;
+		uint32_t max_statements = 6;
+	};
+
+	ProgramGenerator(uint32_t seed = 42);
+	ProgramGenerator(Shape shape, uint32_t seed = 42);
+
+	std::string generate(size_t functions);
+	void generate(size_t functions, std::ostream& os);
+private:
+	void gen_function(size_t index, std::ostream& os);
+	void gen_class(size_t index, std::ostream& os);
+	void gen_main(size_t functions, std::ostream& os);
+
+	void gen_statement(int depth, std::ostream& os);
+	std::string gen_expression(int depth);
+	std::string gen_condition();
+
+	std::string var();
+	std::string indent() const;
+	uint32_t pick(uint32_t bound);
+
+	Shape shape_;
+	std::mt19937 rng_;
+	int level_;
+	size_t counters_;
+	bool locals_ready_;
+};
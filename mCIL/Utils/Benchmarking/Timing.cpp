@@ -0,0 +1,15 @@
+#include "Timing.h"
+
+double median(std::vector<double> times)
+{
+	if (times.empty())
+	{ return 0; }
+	std::sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "../../cil-system.h"
+
+//Helpers every benchmark runner times its runs with
+
+//Median of the given times, 0 if there are none
+double median(std::vector<double> times);
+
+//Milliseconds passed since 'start'
+double elapsed_ms(std::chrono::steady_clock::time_point start);
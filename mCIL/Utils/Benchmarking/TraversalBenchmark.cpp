@@ -0,0 +1,393 @@
+#include "TraversalBenchmark.h"
+#include "Timing.h"
+
+//Visits every node reachable from a root exactly once
+class NodeCounter : public ASTVisitor<NodeCounter>
+{
+	friend ASTVisitor<NodeCounter>;
+public:
+	size_t count = 0;
+
+	void count_expr(const expr_ptr& expr)
+	{
+		if (expr)
+		{ visit_expr(expr); }
+	}
+
+	void count_stmt(const stmt_ptr& stmt)
+	{
+		if (stmt)
+		{ visit_stmt(stmt); }
+	}
+private:
+	void visit_error_expr(ErrorExpression*)
+	{ count++; }
+
+	void visit_grouping_expr(GroupingExpression* expr)
+	{
+		count++;
+		count_expr(expr->expr());
+	}
+
+	void visit_primary_expr(PrimaryExpression*)
+	{ count++; }
+
+	void visit_call_expr(CallExpression* expr)
+	{
+		count++;
+		for (const expr_ptr& arg : expr->args())
+		{ count_expr(arg); }
+	}
+
+	void visit_access_expr(AccessExpression* expr)
+	{
+		count++;
+		count_expr(expr->inner());
+	}
+
+	void visit_new_expr(NewExpression* expr)
+	{
+		count++;
+		for (const expr_ptr& arg : expr->args())
+		{ count_expr(arg); }
+	}
+
+	void visit_array_access_expr(ArrayAccessExpression* expr)
+	{
+		count++;
+		count_expr(expr->index());
+	}
+
+	void visit_unary_expr(UnaryExpression* expr)
+	{
+		count++;
+		count_expr(expr->expr());
+	}
+
+	void visit_binary_expr(BinaryExpression* expr)
+	{
+		count++;
+		count_expr(expr->left());
+		count_expr(expr->right());
+	}
+
+	void visit_ternary_expr(TernaryExpression* expr)
+	{
+		count++;
+		count_expr(expr->cond());
+		count_expr(expr->left());
+		count_expr(expr->right());
+	}
+
+	void visit_assignment_expr(AssignmentExpression* expr)
+	{
+		count++;
+		count_expr(expr->target());
+		count_expr(expr->expr());
+	}
+
+	void visit_error_stmt(ErrorStatement*)
+	{ count++; }
+
+	void visit_block_stmt(BlockStatement* stmt)
+	{
+		count++;
+		for (const stmt_ptr& inner : stmt->inner())
+		{ count_stmt(inner); }
+	}
+
+	void visit_break_stmt(BreakStatement*)
+	{ count++; }
+
+	void visit_return_stmt(ReturnStatement* stmt)
+	{
+		count++;
+		count_expr(stmt->expr());
+	}
+
+	void visit_print_stmt(PrintStatement* stmt)
+	{
+		count++;
+		count_expr(stmt->expr());
+	}
+
+	void visit_if_stmt(IfStatement* stmt)
+	{
+		count++;
+		count_expr(stmt->cond());
+		count_stmt(stmt->if_branch());
+		count_stmt(stmt->top_elif());
+	}
+
+	void visit_elif_stmt(ElifStatement* stmt)
+	{
+		count++;
+		count_expr(stmt->cond());
+		count_stmt(stmt->inner());
+		count_stmt(stmt->next_elif());
+	}
+
+	void visit_while_stmt(WhileStatement* stmt)
+	{
+		count++;
+		count_expr(stmt->cond());
+		count_stmt(stmt->inner());
+	}
+
+	void visit_for_stmt(ForStatement* stmt)
+	{
+		count++;
+		count_stmt(stmt->init());
+		count_expr(stmt->cond());
+		count_expr(stmt->exec());
+		count_stmt(stmt->inner());
+	}
+
+	void visit_var_decl_stmt(VarDeclStatement* stmt)
+	{
+		count++;
+		count_expr(stmt->val());
+	}
+
+	void visit_arr_decl_stmt(ArrDeclStatement* stmt)
+	{
+		count++;
+		for (const expr_ptr& val : stmt->vals())
+		{ count_expr(val); }
+	}
+
+	void visit_func_decl_stmt(FuncDeclStatement* stmt)
+	{
+		count++;
+		count_stmt(stmt->body());
+	}
+
+	void visit_class_decl_stmt(ClassDeclStatement* stmt)
+	{
+		count++;
+		for (const stmt_ptr& member : stmt->members())
+		{ count_stmt(member); }
+		for (const stmt_ptr& method : stmt->methods())
+		{ count_stmt(method); }
+	}
+
+	void visit_expr_stmt(ExprStatement* stmt)
+	{
+		count++;
+		count_expr(stmt->expr());
+	}
+};
+
+//The dispatch the AST consumers used before ASTVisitor: every child is taken
+//by value and downcast with a checked cast
+static size_t dynamic_count_expr(expr_ptr expr);
+static size_t dynamic_count_stmt(stmt_ptr stmt);
+
+static size_t dynamic_count_expr(expr_ptr expr)
+{
+	if (!expr)
+	{ return 0; }
+
+	switch (expr->type())
+	{
+	case ExprType::EXPRESSION_GROUPING:
+		return 1 + dynamic_count_expr(std::dynamic_pointer_cast<GroupingExpression>(expr)->expr());
+	case ExprType::EXPRESSION_CALL:
+	{
+		size_t count = 1;
+		for (expr_ptr arg : std::dynamic_pointer_cast<CallExpression>(expr)->args())
+		{ count += dynamic_count_expr(arg); }
+		return count;
+	}
+	case ExprType::EXPRESSION_ACCESS:
+		return 1 + dynamic_count_expr(std::dynamic_pointer_cast<AccessExpression>(expr)->inner());
+	case ExprType::EXPRESSION_NEW:
+	{
+		size_t count = 1;
+		for (expr_ptr arg : std::dynamic_pointer_cast<NewExpression>(expr)->args())
+		{ count += dynamic_count_expr(arg); }
+		return count;
+	}
+	case ExprType::EXPRESSION_ARRAY_ACCESS:
+		return 1 + dynamic_count_expr(std::dynamic_pointer_cast<ArrayAccessExpression>(expr)->index());
+	case ExprType::EXPRESSION_UNARY:
+		return 1 + dynamic_count_expr(std::dynamic_pointer_cast<UnaryExpression>(expr)->expr());
+	case ExprType::EXPRESSION_BINARY:
+	{
+		std::shared_ptr<BinaryExpression> binary = std::dynamic_pointer_cast<BinaryExpression>(expr);
+		return 1 + dynamic_count_expr(binary->left()) + dynamic_count_expr(binary->right());
+	}
+	case ExprType::EXPRESSION_TERNARY:
+	{
+		std::shared_ptr<TernaryExpression> ternary = std::dynamic_pointer_cast<TernaryExpression>(expr);
+		return 1 + dynamic_count_expr(ternary->cond()) + dynamic_count_expr(ternary->left())
+			+ dynamic_count_expr(ternary->right());
+	}
+	case ExprType::EXPRESSION_ASSIGNMENT:
+	{
+		std::shared_ptr<AssignmentExpression> assignment = std::dynamic_pointer_cast<AssignmentExpression>(expr);
+		return 1 + dynamic_count_expr(assignment->target()) + dynamic_count_expr(assignment->expr());
+	}
+	default:
+		return 1;
+	}
+}
+
+static size_t dynamic_count_stmt(stmt_ptr stmt)
+{
+	if (!stmt)
+	{ return 0; }
+
+	switch (stmt->type())
+	{
+	case StmtType::STATEMENT_BLOCK:
+	{
+		size_t count = 1;
+		for (stmt_ptr inner : std::dynamic_pointer_cast<BlockStatement>(stmt)->inner())
+		{ count += dynamic_count_stmt(inner); }
+		return count;
+	}
+	case StmtType::STATEMENT_RETURN:
+		return 1 + dynamic_count_expr(std::dynamic_pointer_cast<ReturnStatement>(stmt)->expr());
+	case StmtType::STATEMENT_PRINT:
+		return 1 + dynamic_count_expr(std::dynamic_pointer_cast<PrintStatement>(stmt)->expr());
+	case StmtType::STATEMENT_IF:
+	{
+		std::shared_ptr<IfStatement> if_stmt = std::dynamic_pointer_cast<IfStatement>(stmt);
+		return 1 + dynamic_count_expr(if_stmt->cond()) + dynamic_count_stmt(if_stmt->if_branch())
+			+ dynamic_count_stmt(if_stmt->top_elif());
+	}
+	case StmtType::STATEMENT_ELIF:
+	{
+		std::shared_ptr<ElifStatement> elif_stmt = std::dynamic_pointer_cast<ElifStatement>(stmt);
+		return 1 + dynamic_count_expr(elif_stmt->cond()) + dynamic_count_stmt(elif_stmt->inner())
+			+ dynamic_count_stmt(elif_stmt->next_elif());
+	}
+	case StmtType::STATEMENT_WHILE:
+	{
+		std::shared_ptr<WhileStatement> while_stmt = std::dynamic_pointer_cast<WhileStatement>(stmt);
+		return 1 + dynamic_count_expr(while_stmt->cond()) + dynamic_count_stmt(while_stmt->inner());
+	}
+	case StmtType::STATEMENT_FOR:
+	{
+		std::shared_ptr<ForStatement> for_stmt = std::dynamic_pointer_cast<ForStatement>(stmt);
+		return 1 + dynamic_count_stmt(for_stmt->init()) + dynamic_count_expr(for_stmt->cond())
+			+ dynamic_count_expr(for_stmt->exec()) + dynamic_count_stmt(for_stmt->inner());
+	}
+	case StmtType::STATEMENT_VAR_DECL:
+		return 1 + dynamic_count_expr(std::dynamic_pointer_cast<VarDeclStatement>(stmt)->val());
+	case StmtType::STATEMENT_ARR_DECL:
+	{
+		size_t count = 1;
+		for (expr_ptr val : std::dynamic_pointer_cast<ArrDeclStatement>(stmt)->vals())
+		{ count += dynamic_count_expr(val); }
+		return count;
+	}
+	case StmtType::STATEMENT_FUNC_DECL:
+		return 1 + dynamic_count_stmt(std::dynamic_pointer_cast<FuncDeclStatement>(stmt)->body());
+	case StmtType::STATEMENT_CLASS_DECL:
+	{
+		std::shared_ptr<ClassDeclStatement> class_stmt = std::dynamic_pointer_cast<ClassDeclStatement>(stmt);
+		size_t count = 1;
+		for (stmt_ptr member : class_stmt->members())
+		{ count += dynamic_count_stmt(member); }
+		for (stmt_ptr method : class_stmt->methods())
+		{ count += dynamic_count_stmt(method); }
+		return count;
+	}
+	case StmtType::STATEMENT_EXPR:
+		return 1 + dynamic_count_expr(std::dynamic_pointer_cast<ExprStatement>(stmt)->expr());
+	default:
+		return 1;
+	}
+}
+
+TraversalBenchmark::TraversalBenchmark(const stmt_list& program)
+	: roots_(program.begin(), program.end()), expr_roots_()
+{
+	//Global declarations live in the symbol table instead of the program
+	for (auto& pair : SymbolTable::global_table()->vars_)
+	{
+		if (pair.second.init_expr)
+		{ expr_roots_.push_back(pair.second.init_expr); }
+	}
+	for (auto& pair : SymbolTable::global_table()->funcs_)
+	{
+		if (pair.second.body)
+		{ roots_.push_back(pair.second.body); }
+	}
+	for (auto& pair : SymbolTable::global_table()->classes_)
+	{
+		for (SymbolTable::Variable& member : pair.second.members)
+		{
+			if (member.init_expr)
+			{ expr_roots_.push_back(member.init_expr); }
+		}
+		for (SymbolTable::Function& method : pair.second.methods)
+		{
+			if (method.body)
+			{ roots_.push_back(method.body); }
+		}
+	}
+}
+
+TraversalBenchmark::Result TraversalBenchmark::run(size_t iterations)
+{
+	if (iterations == 0)
+	{ iterations = 1; }
+
+	auto median_ms = [iterations](auto traverse, size_t& nodes)
+	{
+		std::vector<double> times{};
+		for (size_t i = 0; i < iterations; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			nodes = traverse();
+			times.push_back(elapsed_ms(start));
+		}
+		return median(times);
+	};
+
+	Result result{};
+	size_t dynamic_nodes = 0;
+	result.visitor_ms = median_ms([this]() { return count_with_visitor(); }, result.nodes);
+	result.dynamic_cast_ms = median_ms([this]() { return count_with_dynamic_cast(); }, dynamic_nodes);
+
+	if (dynamic_nodes != result.nodes)
+	{ throw CILError::error("Traversals disagree on the node count"); }
+	return result;
+}
+
+void TraversalBenchmark::report(const Result& result, std::ostream& os) const
+{
+	auto nodes_per_s = [&result](double ms)
+	{ return ms > 0 ? result.nodes / (ms / 1000.0) : 0.0; };
+
+	os << "Traversal of " << result.nodes << " nodes, median of all runs:\n"
+		<< std::fixed << std::setprecision(3)
+		<< "  visitor       " << std::setw(10) << result.visitor_ms << "ms  "
+		<< std::setprecision(0) << nodes_per_s(result.visitor_ms) << " nodes/s\n"
+		<< std::setprecision(3)
+		<< "  dynamic cast  " << std::setw(10) << result.dynamic_cast_ms << "ms  "
+		<< std::setprecision(0) << nodes_per_s(result.dynamic_cast_ms) << " nodes/s\n";
+}
+
+size_t TraversalBenchmark::count_with_visitor() const
+{
+	NodeCounter counter{};
+	for (const stmt_ptr& root : roots_)
+	{ counter.count_stmt(root); }
+	for (const expr_ptr& root : expr_roots_)
+	{ counter.count_expr(root); }
+	return counter.count;
+}
+
+size_t TraversalBenchmark::count_with_dynamic_cast() const
+{
+	size_t count = 0;
+	for (const stmt_ptr& root : roots_)
+	{ count += dynamic_count_stmt(root); }
+	for (const expr_ptr& root : expr_roots_)
+	{ count += dynamic_count_expr(root); }
+	return count;
+}
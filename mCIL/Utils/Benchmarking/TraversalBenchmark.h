@@ -0,0 +1,37 @@
+#pragma once
+#include "../../cil-system.h"
+#include "../../Parsing/Expression.h"
+#include "../../Parsing/Statement.h"
+#include "../../Parsing/ASTVisitor.h"
+#include "../../Scanning/SymbolTable.h"
+
+//Measures how fast the whole program (top level, global functions and class
+//methods) can be walked. The same node count is taken once through ASTVisitor
+//and once through the switch plus dynamic_pointer_cast dispatch the consumers
+//used before, so the two numbers show what the static dispatch saves.
+class TraversalBenchmark
+{
+public:
+	struct Result
+	{
+		size_t nodes;
+		double visitor_ms;
+		double dynamic_cast_ms;
+	};
+
+	TraversalBenchmark(const stmt_list& program);
+
+	//Runs every traversal 'iterations' times and reports the median run
+	Result run(size_t iterations);
+	void report(const Result& result, std::ostream& os) const;
+
+	//Number of nodes in the program
+	size_t nodes() const
+	{ return count_with_visitor(); }
+private:
+	size_t count_with_visitor() const;
+	size_t count_with_dynamic_cast() const;
+
+	std::vector<stmt_ptr> roots_;
+	std::vector<expr_ptr> expr_roots_;
+};
@@ -2,7 +2,7 @@
 
 void ASTDebugPrinter::print_expression(expr_ptr expr)
 {
-	os_ << repr_expr(expr) << std::endl;
+	os_ << visit_expr(expr) << std::endl;
 }
 
 void ASTDebugPrinter::print_statement(stmt_ptr stmt)
@@ -12,15 +12,15 @@ void ASTDebugPrinter::print_statement(stmt_ptr stmt)
 
 void ASTDebugPrinter::print_expr_list(expr_list exprs)
 {
-	for (expr_ptr expr : exprs)
+	for (const expr_ptr& expr : exprs)
 	{
-		os_ << repr_expr(expr) << std::endl;
+		os_ << visit_expr(expr) << std::endl;
 	}
 }
 
 void ASTDebugPrinter::print_stmt_list(stmt_list stmts)
 {
-	for (stmt_ptr stmt : stmts)
+	for (const stmt_ptr& stmt : stmts)
 	{
 		os_ << repr_stmt(stmt) << std::endl;
 	}
@@ -35,46 +35,20 @@ std::string ASTDebugPrinter::repr_cil_type(Type type)
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_expr(expr_ptr expr)
+std::string ASTDebugPrinter::visit_error_expr(ErrorExpression*)
 {
-	switch (expr->type())
-	{
-	case ExprType::EXPRESSION_ERROR:
-		return "<ErrorExpression>";
-	case ExprType::EXPRESSION_GROUPING:
-		return repr_grouping_expr(std::dynamic_pointer_cast<GroupingExpression, Expression>(expr));
-	case ExprType::EXPRESSION_CALL:
-		return repr_call_expr(std::dynamic_pointer_cast<CallExpression, Expression>(expr));
-	case ExprType::EXPRESSION_ACCESS:
-		return repr_access_expr(std::dynamic_pointer_cast<AccessExpression, Expression>(expr));
-	case ExprType::EXPRESSION_NEW:
-		return repr_new_expr(std::dynamic_pointer_cast<NewExpression, Expression>(expr));
-	case ExprType::EXPRESSION_ARRAY_ACCESS:
-		return repr_array_access_expr(std::dynamic_pointer_cast<ArrayAccessExpression, Expression>(expr));
-	case ExprType::EXPRESSION_PRIMARY:
-		return repr_primary_expr(std::dynamic_pointer_cast<PrimaryExpression, Expression>(expr));
-	case ExprType::EXPRESSION_UNARY:
-		return repr_unary_expr(std::dynamic_pointer_cast<UnaryExpression, Expression>(expr));
-	case ExprType::EXPRESSION_BINARY:
-		return repr_binary_expr(std::dynamic_pointer_cast<BinaryExpression, Expression>(expr));
-	case ExprType::EXPRESSION_TERNARY:
-		return repr_ternary_expr(std::dynamic_pointer_cast<TernaryExpression, Expression>(expr));
-	case ExprType::EXPRESSION_ASSIGNMENT:
-		return repr_assignment_expr(std::dynamic_pointer_cast<AssignmentExpression, Expression>(expr));
-	default:
-		throw CILError::error(expr->pos(), "Incomplete handling of expressions");
-	}
+	return "<ErrorExpression>";
 }
 
-std::string ASTDebugPrinter::repr_grouping_expr(std::shared_ptr<GroupingExpression> expr)
+std::string ASTDebugPrinter::visit_grouping_expr(GroupingExpression* expr)
 {
 	InitRepr();
 	result += "<GroupingExpression>\n";
-	ReprChild(repr_expr(expr->expr()));
+	ReprChild(visit_expr(expr->expr()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_primary_expr(std::shared_ptr<PrimaryExpression> expr)
+std::string ASTDebugPrinter::visit_primary_expr(PrimaryExpression* expr)
 {
 	InitRepr();
 	result += "<PrimaryExpression";
@@ -101,172 +75,146 @@ std::string ASTDebugPrinter::repr_primary_expr(std::shared_ptr<PrimaryExpression
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_call_expr(std::shared_ptr<CallExpression> expr)
+std::string ASTDebugPrinter::visit_call_expr(CallExpression* expr)
 {
 	InitRepr();
 	result += "<CallExpression";
 	result += " name=" + expr->identifier();
+	if (expr->intrinsic() != Intrinsic::INTRINSIC_NONE)
+	{ result += " intrinsic"; }
 	result += ">\n";
-	for (expr_ptr arg : expr->args())
+	for (const expr_ptr& arg : expr->args())
 	{
-		ReprChild(repr_expr(arg));
+		ReprChild(visit_expr(arg));
 	}
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_access_expr(std::shared_ptr<AccessExpression> expr)
+std::string ASTDebugPrinter::visit_access_expr(AccessExpression* expr)
 {
 	InitRepr();
 	result += "<AccessExpression";
 	result += " identifier=" + expr->identifier();
 	result += ">\n";
-	ReprChild(repr_expr(expr->inner()));
+	ReprChild(visit_expr(expr->inner()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_new_expr(std::shared_ptr<NewExpression> expr)
+std::string ASTDebugPrinter::visit_new_expr(NewExpression* expr)
 {
 	InitRepr();
 	result += "<NewExpression";
 	result += " identifier=" + expr->identifier();
 	result += ">\n";
-	for (expr_ptr arg : expr->args())
+	for (const expr_ptr& arg : expr->args())
 	{
-		ReprChild(repr_expr(arg));
+		ReprChild(visit_expr(arg));
 	}
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_array_access_expr(std::shared_ptr<ArrayAccessExpression> expr)
+std::string ASTDebugPrinter::visit_array_access_expr(ArrayAccessExpression* expr)
 {
 	InitRepr();
 	result += "<ArrayAccessExpression";
 	result += " identifier=" + expr->identifier();
 	result += ">\n";
-	ReprChild(repr_expr(expr->index()));
+	ReprChild(visit_expr(expr->index()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_unary_expr(std::shared_ptr<UnaryExpression> expr)
+std::string ASTDebugPrinter::visit_unary_expr(UnaryExpression* expr)
 {
 	InitRepr();
 	result += "<UnaryExpression";
 	result += " operator=" + TokenPrinter::print_operator(expr->op());
 	result += ">\n";
-	ReprChild(repr_expr(expr->expr()));
+	ReprChild(visit_expr(expr->expr()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_binary_expr(std::shared_ptr<BinaryExpression> expr)
+std::string ASTDebugPrinter::visit_binary_expr(BinaryExpression* expr)
 {
 	InitRepr();
 	result += "<BinaryExpression";
 	result += " operator=" + TokenPrinter::print_operator(expr->op());
 	result += ">\n";
-	ReprChild(repr_expr(expr->left()));
-	ReprChild(repr_expr(expr->right()));
+	ReprChild(visit_expr(expr->left()));
+	ReprChild(visit_expr(expr->right()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_ternary_expr(std::shared_ptr<TernaryExpression> expr)
+std::string ASTDebugPrinter::visit_ternary_expr(TernaryExpression* expr)
 {
 	InitRepr();
 	result += "<TernaryExpression>\n";
-	ReprChild(repr_expr(expr->cond()));
-	ReprChild(repr_expr(expr->left()));
-	ReprChild(repr_expr(expr->right()));
+	ReprChild(visit_expr(expr->cond()));
+	ReprChild(visit_expr(expr->left()));
+	ReprChild(visit_expr(expr->right()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_assignment_expr(std::shared_ptr<AssignmentExpression> expr)
+std::string ASTDebugPrinter::visit_assignment_expr(AssignmentExpression* expr)
 {
 	InitRepr();
 	result += "<AssignmentExpression>\n";
-	ReprChild(repr_expr(expr->target()));
-	ReprChild(repr_expr(expr->expr()));
+	ReprChild(visit_expr(expr->target()));
+	ReprChild(visit_expr(expr->expr()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_stmt(stmt_ptr stmt)
+std::string ASTDebugPrinter::repr_stmt(const stmt_ptr& stmt)
 {
 	if (stmt == nullptr) { return ""; }
+	return visit_stmt(stmt);
+}
 
-	switch (stmt->type())
-	{
-	case StmtType::STATEMENT_ERROR:
-		return "<ErrorStatment>";
-	case StmtType::STATEMENT_BLOCK:
-		return repr_block_stmt(std::dynamic_pointer_cast<BlockStatement, Statement>(stmt));
-	case StmtType::STATEMENT_BREAK:
-		return repr_break_stmt(std::dynamic_pointer_cast<BreakStatement, Statement>(stmt));
-	case StmtType::STATEMENT_RETURN:
-		return repr_return_stmt(std::dynamic_pointer_cast<ReturnStatement, Statement>(stmt));
-	case StmtType::STATEMENT_PRINT:
-		return repr_print_stmt(std::dynamic_pointer_cast<PrintStatement, Statement>(stmt));
-	case StmtType::STATEMENT_ELIF:
-		return repr_elif_stmt(std::dynamic_pointer_cast<ElifStatement, Statement>(stmt));
-	case StmtType::STATEMENT_IF:
-		return repr_if_stmt(std::dynamic_pointer_cast<IfStatement, Statement>(stmt));
-	case StmtType::STATEMENT_WHILE:
-		return repr_while_stmt(std::dynamic_pointer_cast<WhileStatement, Statement>(stmt));
-	case StmtType::STATEMENT_FOR:
-		return repr_for_stmt(std::dynamic_pointer_cast<ForStatement, Statement>(stmt));
-	case StmtType::STATEMENT_VAR_DECL:
-		return repr_var_decl_stmt(std::dynamic_pointer_cast<VarDeclStatement, Statement>(stmt));
-	case StmtType::STATEMENT_ARR_DECL:
-		return repr_arr_decl_stmt(std::dynamic_pointer_cast<ArrDeclStatement, Statement>(stmt));
-	case StmtType::STATEMENT_FUNC_DECL:
-		return repr_func_decl_stmt(std::dynamic_pointer_cast<FuncDeclStatement, Statement>(stmt));
-	case StmtType::STATEMENT_CLASS_DECL:
-		return repr_class_decl_stmt(std::dynamic_pointer_cast<ClassDeclStatement, Statement>(stmt));
-	case StmtType::STATEMENT_EXPR:
-		return repr_expr_stmt(std::dynamic_pointer_cast<ExprStatement, Statement>(stmt));
-	default:
-		throw CILError::error(stmt->pos(), "Incomplete handling of statements");
-	}
+std::string ASTDebugPrinter::visit_error_stmt(ErrorStatement*)
+{
+	return "<ErrorStatment>";
 }
 
-std::string ASTDebugPrinter::repr_block_stmt(std::shared_ptr<BlockStatement> stmt)
+std::string ASTDebugPrinter::visit_block_stmt(BlockStatement* stmt)
 {
 	InitRepr();
 	result += "<BlockStatement>\n";
-	for (stmt_ptr child : stmt->inner())
+	for (const stmt_ptr& child : stmt->inner())
 	{
 		ReprChild(repr_stmt(child));
 	}
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_break_stmt(std::shared_ptr<BreakStatement> stmt)
+std::string ASTDebugPrinter::visit_break_stmt(BreakStatement*)
 {
 	InitRepr();
 	result += "<BreakStatement>\n";
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_return_stmt(std::shared_ptr<ReturnStatement> stmt)
+std::string ASTDebugPrinter::visit_return_stmt(ReturnStatement* stmt)
 {
 	InitRepr();
 	result += "<ReturnStatement>\n";
-	ReprChild(repr_expr(stmt->expr()));
+	ReprChild(visit_expr(stmt->expr()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_print_stmt(std::shared_ptr<PrintStatement> stmt)
+std::string ASTDebugPrinter::visit_print_stmt(PrintStatement* stmt)
 {
 	InitRepr();
 	result += "<PrintStatement>\n";
-	ReprChild(repr_expr(stmt->expr()));
+	ReprChild(visit_expr(stmt->expr()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_elif_stmt(std::shared_ptr<ElifStatement> stmt)
+std::string ASTDebugPrinter::visit_elif_stmt(ElifStatement* stmt)
 {
 	InitRepr();
 	if (stmt->cond())
 	{
 		result += "<ElifStatement>\n";
-		ReprChild(repr_expr(stmt->cond()));
+		ReprChild(visit_expr(stmt->cond()));
 		ReprChild(repr_stmt(stmt->inner()));
 		ReprEqual(repr_stmt(stmt->next_elif()));
 	}
@@ -278,48 +226,48 @@ std::string ASTDebugPrinter::repr_elif_stmt(std::shared_ptr<ElifStatement> stmt)
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_if_stmt(std::shared_ptr<IfStatement> stmt)
+std::string ASTDebugPrinter::visit_if_stmt(IfStatement* stmt)
 {
 	InitRepr();
 	result += "<IfStatement>\n";
-	ReprChild(repr_expr(stmt->cond()));
+	ReprChild(visit_expr(stmt->cond()));
 	ReprChild(repr_stmt(stmt->if_branch()));
 	ReprEqual(repr_stmt(stmt->top_elif()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_while_stmt(std::shared_ptr<WhileStatement> stmt)
+std::string ASTDebugPrinter::visit_while_stmt(WhileStatement* stmt)
 {
 	InitRepr();
 	result += "<WhileStatement>\n";
-	ReprChild(repr_expr(stmt->cond()));
+	ReprChild(visit_expr(stmt->cond()));
 	ReprChild(repr_stmt(stmt->inner()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_for_stmt(std::shared_ptr<ForStatement> stmt)
+std::string ASTDebugPrinter::visit_for_stmt(ForStatement* stmt)
 {
 	InitRepr();
-	result += "<ForStatement>\n";
+	result += stmt->parallel() ? "<ForStatement parallel>\n" : "<ForStatement>\n";
 	ReprChild(repr_stmt(stmt->init()));
-	ReprChild(repr_expr(stmt->cond()));
-	ReprChild(repr_expr(stmt->exec()));
+	ReprChild(visit_expr(stmt->cond()));
+	ReprChild(visit_expr(stmt->exec()));
 	ReprChild(repr_stmt(stmt->inner()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_var_decl_stmt(std::shared_ptr<VarDeclStatement> stmt)
+std::string ASTDebugPrinter::visit_var_decl_stmt(VarDeclStatement* stmt)
 {
 	InitRepr();
 	result += "<VarDeclStatement";
 	result += " name=" + stmt->info().name;
 	result += repr_cil_type(stmt->info().type);
 	result += ">\n";
-	ReprChild(repr_expr(stmt->val()));
+	ReprChild(visit_expr(stmt->val()));
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_arr_decl_stmt(std::shared_ptr<ArrDeclStatement> stmt)
+std::string ASTDebugPrinter::visit_arr_decl_stmt(ArrDeclStatement* stmt)
 {
 	InitRepr();
 	result += "<ArrDeclStatement";
@@ -330,7 +278,7 @@ std::string ASTDebugPrinter::repr_arr_decl_stmt(std::shared_ptr<ArrDeclStatement
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_func_decl_stmt(std::shared_ptr<FuncDeclStatement> stmt)
+std::string ASTDebugPrinter::visit_func_decl_stmt(FuncDeclStatement* stmt)
 {
 	InitRepr();
 	result += "<FuncDeclStatement";
@@ -345,27 +293,27 @@ std::string ASTDebugPrinter::repr_func_decl_stmt(std::shared_ptr<FuncDeclStateme
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_class_decl_stmt(std::shared_ptr<ClassDeclStatement> stmt)
+std::string ASTDebugPrinter::visit_class_decl_stmt(ClassDeclStatement* stmt)
 {
 	InitRepr();
 	result += "<ClassDeclStatement";
 	result += " name=" + stmt->info().name;
 	result += ">\n";
-	for (stmt_ptr method : stmt->methods())
+	for (const stmt_ptr& method : stmt->methods())
 	{
 		ReprChild(repr_stmt(method));
 	}
-	for (stmt_ptr member : stmt->members())
+	for (const stmt_ptr& member : stmt->members())
 	{
 		ReprChild(repr_stmt(member));
 	}
 	return result;
 }
 
-std::string ASTDebugPrinter::repr_expr_stmt(std::shared_ptr<ExprStatement> stmt)
+std::string ASTDebugPrinter::visit_expr_stmt(ExprStatement* stmt)
 {
 	InitRepr();
 	result += "<ExprStatement>\n";
-	ReprChild(repr_expr(stmt->expr()));
+	ReprChild(visit_expr(stmt->expr()));
 	return result;
 }
@@ -6,6 +6,7 @@
 #include "../../Diagnostics/CILError.h"
 #include "../../Parsing/Expression.h"
 #include "../../Parsing/Statement.h"
+#include "../../Parsing/ASTVisitor.h"
 
 #define InitRepr()						\
 	std::string result = "";			\
@@ -19,8 +20,9 @@
 	result += stmt;	\
 	level_--;
 
-class ASTDebugPrinter
+class ASTDebugPrinter : public ASTVisitor<ASTDebugPrinter, std::string, std::string>
 {
+	friend ASTVisitor<ASTDebugPrinter, std::string, std::string>;
 public:
 	ASTDebugPrinter(std::ostream& os = std::cout)
 		: os_(os), level_(0) {}
@@ -37,33 +39,34 @@ private:
 
 	std::string repr_cil_type(Type type);
 
-	std::string repr_expr(expr_ptr expr);
+	std::string visit_error_expr(ErrorExpression* expr);
+	std::string visit_grouping_expr(GroupingExpression* expr);
+	std::string visit_primary_expr(PrimaryExpression* expr);
+	std::string visit_call_expr(CallExpression* expr);
+	std::string visit_access_expr(AccessExpression* expr);
+	std::string visit_new_expr(NewExpression* expr);
+	std::string visit_array_access_expr(ArrayAccessExpression* expr);
+	std::string visit_unary_expr(UnaryExpression* expr);
+	std::string visit_binary_expr(BinaryExpression* expr);
+	std::string visit_ternary_expr(TernaryExpression* expr);
+	std::string visit_assignment_expr(AssignmentExpression* expr);
 
-	std::string repr_grouping_expr(std::shared_ptr<GroupingExpression> expr);
-	std::string repr_primary_expr(std::shared_ptr<PrimaryExpression> expr);
-	std::string repr_call_expr(std::shared_ptr<CallExpression> expr);
-	std::string repr_access_expr(std::shared_ptr<AccessExpression> expr);
-	std::string repr_new_expr(std::shared_ptr<NewExpression> expr);
-	std::string repr_array_access_expr(std::shared_ptr<ArrayAccessExpression> expr);
-	std::string repr_unary_expr(std::shared_ptr<UnaryExpression> expr);
-	std::string repr_binary_expr(std::shared_ptr<BinaryExpression> expr);
-	std::string repr_ternary_expr(std::shared_ptr<TernaryExpression> expr);
-	std::string repr_assignment_expr(std::shared_ptr<AssignmentExpression> expr);
+	//Optional children (else branches, initializers) may be missing
+	std::string repr_stmt(const stmt_ptr& stmt);
 
-	std::string repr_stmt(stmt_ptr stmt);
-
-	std::string repr_block_stmt(std::shared_ptr<BlockStatement> stmt);
-	std::string repr_break_stmt(std::shared_ptr<BreakStatement> stmt);
-	std::string repr_return_stmt(std::shared_ptr<ReturnStatement> stmt);
-	std::string repr_print_stmt(std::shared_ptr<PrintStatement> stmt);
-	std::string repr_elif_stmt(std::shared_ptr<ElifStatement> stmt);
-	std::string repr_if_stmt(std::shared_ptr<IfStatement> stmt);
-	std::string repr_while_stmt(std::shared_ptr<WhileStatement> stmt);
-	std::string repr_for_stmt(std::shared_ptr<ForStatement> stmt);
-	std::string repr_var_decl_stmt(std::shared_ptr<VarDeclStatement> stmt);
-	std::string repr_arr_decl_stmt(std::shared_ptr<ArrDeclStatement> stmt);
-	std::string repr_func_decl_stmt(std::shared_ptr<FuncDeclStatement> stmt);
-	std::string repr_class_decl_stmt(std::shared_ptr<ClassDeclStatement> stmt);
-	std::string repr_expr_stmt(std::shared_ptr<ExprStatement> stmt);
+	std::string visit_error_stmt(ErrorStatement* stmt);
+	std::string visit_block_stmt(BlockStatement* stmt);
+	std::string visit_break_stmt(BreakStatement* stmt);
+	std::string visit_return_stmt(ReturnStatement* stmt);
+	std::string visit_print_stmt(PrintStatement* stmt);
+	std::string visit_elif_stmt(ElifStatement* stmt);
+	std::string visit_if_stmt(IfStatement* stmt);
+	std::string visit_while_stmt(WhileStatement* stmt);
+	std::string visit_for_stmt(ForStatement* stmt);
+	std::string visit_var_decl_stmt(VarDeclStatement* stmt);
+	std::string visit_arr_decl_stmt(ArrDeclStatement* stmt);
+	std::string visit_func_decl_stmt(FuncDeclStatement* stmt);
+	std::string visit_class_decl_stmt(ClassDeclStatement* stmt);
+	std::string visit_expr_stmt(ExprStatement* stmt);
 };
 
@@ -0,0 +1,165 @@
+#include "HitCounters.h"
+
+//Calls 'found' for every statement below a root, including the root
+class StatementCollector : public ASTVisitor<StatementCollector>
+{
+	friend ASTVisitor<StatementCollector>;
+public:
+	StatementCollector(std::function<void(const Statement*)> found)
+		: found_(found) {}
+
+	void collect(const stmt_ptr& stmt)
+	{
+		if (stmt)
+		{
+			found_(stmt.get());
+			visit_stmt(stmt);
+		}
+	}
+private:
+	void visit_error_stmt(ErrorStatement*) {}
+	void visit_break_stmt(BreakStatement*) {}
+	void visit_return_stmt(ReturnStatement*) {}
+	void visit_print_stmt(PrintStatement*) {}
+	void visit_var_decl_stmt(VarDeclStatement*) {}
+	void visit_arr_decl_stmt(ArrDeclStatement*) {}
+	void visit_expr_stmt(ExprStatement*) {}
+
+	void visit_block_stmt(BlockStatement* stmt)
+	{
+		for (const stmt_ptr& inner : stmt->inner())
+		{ collect(inner); }
+	}
+
+	void visit_if_stmt(IfStatement* stmt)
+	{
+		collect(stmt->if_branch());
+		collect(stmt->top_elif());
+	}
+
+	void visit_elif_stmt(ElifStatement* stmt)
+	{
+		collect(stmt->inner());
+		collect(stmt->next_elif());
+	}
+
+	void visit_while_stmt(WhileStatement* stmt)
+	{ collect(stmt->inner()); }
+
+	void visit_for_stmt(ForStatement* stmt)
+	{
+		collect(stmt->init());
+		collect(stmt->inner());
+	}
+
+	void visit_func_decl_stmt(FuncDeclStatement* stmt)
+	{ collect(stmt->body()); }
+
+	void visit_class_decl_stmt(ClassDeclStatement* stmt)
+	{
+		for (const stmt_ptr& method : stmt->methods())
+		{ collect(method); }
+	}
+
+	std::function<void(const Statement*)> found_;
+};
+
+HitCounters::HitCounters(const stmt_list& program)
+	: statements_(), functions_(), frames_()
+{
+	for (const stmt_ptr& stmt : program)
+	{ add_statements(stmt); }
+
+	//Global declarations live in the symbol table instead of the program
+	for (auto& pair : SymbolTable::global_table()->funcs_)
+	{ add_statements(pair.second.body); }
+	for (auto& pair : SymbolTable::global_table()->classes_)
+	{
+		for (SymbolTable::Function& method : pair.second.methods)
+		{ add_statements(method.body); }
+	}
+}
+
+void HitCounters::add_statements(const stmt_ptr& root)
+{
+	StatementCollector collector{ [this](const Statement* stmt) { statements_.emplace(key(stmt->pos()), 0); } };
+	collector.collect(root);
+}
+
+void HitCounters::enter(const Environment::Function& func)
+{
+	FunctionCounter& counter = functions_[key(func.body->pos())];
+	if (counter.calls == 0)
+	{
+		counter.name = func.name;
+		counter.line_off = func.body->pos().start_pos().line_off;
+	}
+	counter.calls++;
+	if (counter.active++ == 0)
+	{ counter.start = std::chrono::steady_clock::now(); }
+	frames_.push_back(&counter);
+}
+
+void HitCounters::leave()
+{
+	FunctionCounter& counter = *frames_.back();
+	frames_.pop_back();
+	if (--counter.active == 0)
+	{ counter.inclusive += std::chrono::steady_clock::now() - counter.start; }
+}
+
+void HitCounters::unwind(size_t depth)
+{
+	while (frames_.size() > depth)
+	{ leave(); }
+}
+
+void HitCounters::report(SourceManager& source, std::ostream& os) const
+{
+	//Several statements can start on one line, the line shows the busiest
+	std::map<size_t, size_t> lines{};
+	size_t last_line = 0;
+	for (const auto& [pos, hits] : statements_)
+	{
+		size_t line_off = (size_t)(pos >> 32);
+		size_t& line_hits = lines[line_off];
+		line_hits = std::max(line_hits, hits);
+		last_line = std::max(last_line, line_off);
+	}
+	size_t width = std::to_string(last_line + 1).size();
+
+	os << "Execution counts:\n\n";
+	for (size_t line_off = 0;; line_off++)
+	{
+		size_t tabs = 0;
+		std::string source_line = ErrorManager::render_line(source, line_off, tabs);
+		if (source_line.empty())
+		{ break; }
+
+		auto it = lines.find(line_off);
+		if (it == lines.end())
+		{ os << std::string(10, ' '); }
+		else if (it->second == 0)
+		{ os << std::setw(10) << "#####"; }
+		else
+		{ os << std::setw(10) << it->second; }
+		os << "  " << ErrorManager::line_prefix(line_off, width) << source_line
+		   << (source_line.ends_with("\n") ? "" : "\n");
+	}
+
+	std::vector<const FunctionCounter*> functions{};
+	for (const auto& pair : functions_)
+	{ functions.push_back(&pair.second); }
+	std::sort(functions.begin(), functions.end(), [](const FunctionCounter* a, const FunctionCounter* b)
+		{ return a->inclusive > b->inclusive; });
+
+	os << "\nFunctions by inclusive time:\n";
+	for (const FunctionCounter* func : functions)
+	{
+		std::chrono::duration<double, std::milli> inclusive = func->inclusive;
+		os << "  " << std::left << std::setw(20) << func->name << std::right
+		   << std::setw(12) << func->calls << " calls"
+		   << std::setw(12) << std::fixed << std::setprecision(3) << inclusive.count() << "ms"
+		   << "  (line " << func->line_off + 1 << ")\n";
+	}
+}
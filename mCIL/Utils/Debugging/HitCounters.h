@@ -0,0 +1,67 @@
+#pragma once
+#include "../../cil-system.h"
+#include "../../Parsing/Expression.h"
+#include "../../Parsing/Statement.h"
+#include "../../Parsing/ASTVisitor.h"
+#include "../../Scanning/SymbolTable.h"
+#include "../../Interpreting/Environment.h"
+#include "../../Diagnostics/Diagnostics.h"
+#include "../../Diagnostics/SourceManager.h"
+
+//Exact execution counts for the tree-walking interpreter: how often every
+//statement ran, how often every function was called and how long its calls
+//took in total. Everything is keyed by the position the statement or function
+//body starts at.
+//The interpreter only calls into the counters when it is built with
+//CIL_COUNTERS defined, otherwise the hooks are not compiled at all.
+class HitCounters
+{
+public:
+	//Registers every statement of the program, global functions and class
+	//methods, so statements that never run show up in the listing. Functions
+	//no call refers to are never parsed and have no statements to register
+	HitCounters(const stmt_list& program);
+
+	void hit(const Statement* stmt)
+	{ statements_[key(stmt->pos())]++; }
+
+	void enter(const Environment::Function& func);
+	void leave();
+
+	//A tail call replaces the function that made it
+	void replace(const Environment::Function& func)
+	{
+		leave();
+		enter(func);
+	}
+
+	size_t depth() const
+	{ return frames_.size(); }
+
+	void unwind(size_t depth);
+
+	//Prints every source line with the hits of the statements on it, '#####'
+	//marks lines whose statements never ran, followed by the functions by time
+	void report(SourceManager& source, std::ostream& os) const;
+private:
+	struct FunctionCounter
+	{
+		std::string name;
+		size_t line_off = 0;
+		size_t calls = 0;
+		std::chrono::steady_clock::duration inclusive{};
+
+		//Only the outermost of several recursive calls is timed
+		size_t active = 0;
+		std::chrono::steady_clock::time_point start{};
+	};
+
+	static uint64_t key(const Position& pos)
+	{ return ((uint64_t)pos.start_pos().line_off << 32) | (uint64_t)pos.start_pos().char_off; }
+
+	void add_statements(const stmt_ptr& root);
+
+	std::unordered_map<uint64_t, size_t> statements_;
+	std::unordered_map<uint64_t, FunctionCounter> functions_;
+	std::vector<FunctionCounter*> frames_;
+};
@@ -0,0 +1,65 @@
+#include "Profiler.h"
+
+static const std::string top_level_name = "main";
+
+Profiler::Profiler(std::chrono::microseconds interval)
+	: frames_(), samples_(), samples_total_(0), interval_(interval),
+	  ticks_(0), timer_(), lock_(), stopped_(), running_(false)
+{
+	frames_.push_back({ &top_level_name, nullptr });
+}
+
+Profiler::~Profiler()
+{
+	stop();
+}
+
+void Profiler::start()
+{
+	if (running_)
+	{ return; }
+	running_ = true;
+	timer_ = std::thread([this]()
+	{
+		std::unique_lock<std::mutex> lock{ lock_ };
+		while (!stopped_.wait_for(lock, interval_, [this]() { return !running_; }))
+		{ ticks_.fetch_add(1, std::memory_order_relaxed); }
+	});
+}
+
+void Profiler::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock{ lock_ };
+		running_ = false;
+	}
+	stopped_.notify_all();
+	if (timer_.joinable())
+	{ timer_.join(); }
+}
+
+void Profiler::sample()
+{
+	//Ticks that passed since the stack last changed are all charged to it
+	size_t ticks = ticks_.exchange(0, std::memory_order_relaxed);
+
+	std::string stack{};
+	for (const Frame& frame : frames_)
+	{
+		if (!stack.empty())
+		{ stack += ';'; }
+		stack += *frame.function;
+		if (frame.stmt)
+		{ stack += ":" + std::to_string(frame.stmt->pos().start_pos().line_off + 1); }
+	}
+	samples_[stack] += ticks;
+	samples_total_ += ticks;
+}
+
+void Profiler::write_collapsed(std::ostream& os) const
+{
+	std::vector<std::pair<std::string, size_t>> sorted{ samples_.begin(), samples_.end() };
+	std::sort(sorted.begin(), sorted.end());
+	for (const auto& [stack, count] : sorted)
+	{ os << stack << " " << count << "\n"; }
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "../../cil-system.h"
+#include "../../Parsing/Statement.h"
+
+//Sampling profiler for the tree-walking interpreter. The interpreter keeps a
+//shadow stack of the CIL functions it is running and the statement each of them
+//is at. A timer thread only counts ticks, the interpreter checks for them
+//whenever the stack changes and charges them to the stack they passed in, so
+//the stack is never read from another thread.
+//The samples are written as collapsed stacks ("main:3;fib:7;fib:5 12"), which
+//flamegraph.pl, speedscope and similar tools read directly.
+class Profiler
+{
+public:
+	Profiler(std::chrono::microseconds interval = std::chrono::microseconds(1000));
+	~Profiler();
+
+	void start();
+	void stop();
+
+	void enter(const std::string& function)
+	{
+		flush();
+		frames_.push_back({ &function, nullptr });
+	}
+
+	//A tail call replaces the frame of the function that made it
+	void replace(const std::string& function)
+	{
+		flush();
+		frames_.back() = { &function, nullptr };
+	}
+
+	void leave()
+	{
+		flush();
+		frames_.pop_back();
+	}
+
+	size_t depth() const
+	{ return frames_.size(); }
+
+	void unwind(size_t depth)
+	{
+		flush();
+		frames_.resize(depth);
+	}
+
+	//Moves the innermost frame to 'stmt' and returns the statement it was at
+	const Statement* at(const Statement* stmt)
+	{
+		flush();
+		const Statement* previous = frames_.back().stmt;
+		frames_.back().stmt = stmt;
+		return previous;
+	}
+
+	void restore(const Statement* stmt)
+	{
+		flush();
+		frames_.back().stmt = stmt;
+	}
+
+	size_t samples() const
+	{ return samples_total_; }
+
+	void write_collapsed(std::ostream& os) const;
+private:
+	struct Frame
+	{
+		const std::string* function;
+		const Statement* stmt;
+	};
+
+	//Charges the ticks that passed to the stack as it is, before it changes
+	void flush()
+	{
+		if (ticks_.load(std::memory_order_relaxed) != 0)
+		{ sample(); }
+	}
+
+	void sample();
+
+	std::vector<Frame> frames_;
+	std::unordered_map<std::string, size_t> samples_;
+	size_t samples_total_;
+
+	std::chrono::microseconds interval_;
+	std::atomic<size_t> ticks_;
+	std::thread timer_;
+	std::mutex lock_;
+	std::condition_variable stopped_;
+	bool running_;
+};
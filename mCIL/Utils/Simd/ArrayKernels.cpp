@@ -0,0 +1,601 @@
+#include "ArrayKernels.h"
+#include <array>
+
+//SSE2 is part of every x86-64 CPU, AVX2 kernels are compiled for it and only run once the CPU reported it
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CIL_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CIL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CIL_TARGET_AVX2
+#endif
+
+using Isa = ArrayKernels::Isa;
+using Arith = ArrayKernels::Arith;
+using Compare = ArrayKernels::Compare;
+using Operand = ArrayKernels::Operand;
+
+//Partial results of a reduction, element i goes to lane i % LANES until the last full round
+static constexpr size_t LANES = 8;
+
+std::atomic<Isa> ArrayKernels::isa_{ ArrayKernels::detected_isa() };
+
+//The lanes are always folded in this order, whichever registers held them
+static double combine_sum(const double* lanes)
+{
+	return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+
+//What minpd and maxpd compute, including which operand wins when one is NaN
+template <bool MIN>
+static double pick(double value, double current)
+{
+	if constexpr (MIN)
+	{ return value < current ? value : current; }
+	else
+	{ return value > current ? value : current; }
+}
+
+template <bool MIN>
+static double combine_extreme(const double* lanes)
+{
+	double result = lanes[0];
+	for (size_t i = 1; i < LANES; i++)
+	{ result = pick<MIN>(lanes[i], result); }
+	return result;
+}
+
+template <Arith OP>
+static double apply(double left, double right)
+{
+	if constexpr (OP == Arith::ARITH_ADD)
+	{ return left + right; }
+	else if constexpr (OP == Arith::ARITH_SUBTRACT)
+	{ return left - right; }
+	else if constexpr (OP == Arith::ARITH_MULTIPLY)
+	{ return left * right; }
+	else
+	{ return left / right; }
+}
+
+//'!=' holds for NaN like it does in C++, every other comparison fails
+template <Compare OP>
+static bool holds(double left, double right)
+{
+	if constexpr (OP == Compare::COMPARE_LESS)
+	{ return left < right; }
+	else if constexpr (OP == Compare::COMPARE_GREATER)
+	{ return left > right; }
+	else if constexpr (OP == Compare::COMPARE_LESS_EQUAL)
+	{ return left <= right; }
+	else if constexpr (OP == Compare::COMPARE_GREATER_EQUAL)
+	{ return left >= right; }
+	else if constexpr (OP == Compare::COMPARE_EQUAL)
+	{ return left == right; }
+	else
+	{ return left != right; }
+}
+
+template <bool SCALAR>
+static double element(const Operand& operand, size_t index)
+{
+	if constexpr (SCALAR)
+	{ return operand.scalar; }
+	else
+	{ return operand.data[index]; }
+}
+
+//Scalar kernels, also finish the elements the vector kernels leave over from 'start' on
+
+static double sum_scalar(const double* values, size_t count)
+{
+	double lanes[LANES] = {};
+	size_t i = 0;
+	for (; i + LANES <= count; i += LANES)
+	{
+		for (size_t j = 0; j < LANES; j++)
+		{ lanes[j] += values[i + j]; }
+	}
+	double total = combine_sum(lanes);
+	for (; i < count; i++)
+	{ total += values[i]; }
+	return total;
+}
+
+static double dot_scalar(const double* left, const double* right, size_t count)
+{
+	double lanes[LANES] = {};
+	size_t i = 0;
+	for (; i + LANES <= count; i += LANES)
+	{
+		for (size_t j = 0; j < LANES; j++)
+		{ lanes[j] += left[i + j] * right[i + j]; }
+	}
+	double total = combine_sum(lanes);
+	for (; i < count; i++)
+	{ total += left[i] * right[i]; }
+	return total;
+}
+
+template <bool MIN>
+static double extreme_tail(const double* values, size_t start, size_t count, double result)
+{
+	for (size_t i = start; i < count; i++)
+	{ result = pick<MIN>(values[i], result); }
+	return result;
+}
+
+template <bool MIN>
+static double extreme_scalar(const double* values, size_t count)
+{
+	if (count < LANES)
+	{ return extreme_tail<MIN>(values, 1, count, values[0]); }
+	double lanes[LANES];
+	std::copy(values, values + LANES, lanes);
+	size_t i = LANES;
+	for (; i + LANES <= count; i += LANES)
+	{
+		for (size_t j = 0; j < LANES; j++)
+		{ lanes[j] = pick<MIN>(values[i + j], lanes[j]); }
+	}
+	return extreme_tail<MIN>(values, i, count, combine_extreme<MIN>(lanes));
+}
+
+template <Arith OP, bool LEFT_SCALAR, bool RIGHT_SCALAR>
+static void arith_scalar(double* dst, Operand left, Operand right, size_t start, size_t count)
+{
+	for (size_t i = start; i < count; i++)
+	{ dst[i] = apply<OP>(element<LEFT_SCALAR>(left, i), element<RIGHT_SCALAR>(right, i)); }
+}
+
+template <Compare OP, bool LEFT_SCALAR, bool RIGHT_SCALAR>
+static void compare_scalar(uint8_t* dst, Operand left, Operand right, size_t start, size_t count)
+{
+	for (size_t i = start; i < count; i++)
+	{ dst[i] = holds<OP>(element<LEFT_SCALAR>(left, i), element<RIGHT_SCALAR>(right, i)); }
+}
+
+#ifdef CIL_SIMD_X86
+//The bytes a comparison writes for each movemask result, element i in byte i
+static constexpr std::array<uint32_t, 16> MASK_BYTES = []()
+{
+	std::array<uint32_t, 16> bytes{};
+	for (uint32_t mask = 0; mask < 16; mask++)
+	{
+		for (uint32_t bit = 0; bit < 4; bit++)
+		{ bytes[mask] |= ((mask >> bit) & 1) << (bit * 8); }
+	}
+	return bytes;
+}();
+
+//SSE2 kernels, two elements per register
+
+static double sum_sse2(const double* values, size_t count)
+{
+	__m128d acc[LANES / 2] = { _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd() };
+	size_t i = 0;
+	for (; i + LANES <= count; i += LANES)
+	{
+		for (size_t j = 0; j < LANES / 2; j++)
+		{ acc[j] = _mm_add_pd(acc[j], _mm_loadu_pd(values + i + j * 2)); }
+	}
+	double lanes[LANES];
+	for (size_t j = 0; j < LANES / 2; j++)
+	{ _mm_storeu_pd(lanes + j * 2, acc[j]); }
+	double total = combine_sum(lanes);
+	for (; i < count; i++)
+	{ total += values[i]; }
+	return total;
+}
+
+static double dot_sse2(const double* left, const double* right, size_t count)
+{
+	__m128d acc[LANES / 2] = { _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd(), _mm_setzero_pd() };
+	size_t i = 0;
+	for (; i + LANES <= count; i += LANES)
+	{
+		for (size_t j = 0; j < LANES / 2; j++)
+		{
+			__m128d product = _mm_mul_pd(_mm_loadu_pd(left + i + j * 2), _mm_loadu_pd(right + i + j * 2));
+			acc[j] = _mm_add_pd(acc[j], product);
+		}
+	}
+	double lanes[LANES];
+	for (size_t j = 0; j < LANES / 2; j++)
+	{ _mm_storeu_pd(lanes + j * 2, acc[j]); }
+	double total = combine_sum(lanes);
+	for (; i < count; i++)
+	{ total += left[i] * right[i]; }
+	return total;
+}
+
+template <bool MIN>
+static double extreme_sse2(const double* values, size_t count)
+{
+	if (count < LANES)
+	{ return extreme_tail<MIN>(values, 1, count, values[0]); }
+	__m128d acc[LANES / 2];
+	for (size_t j = 0; j < LANES / 2; j++)
+	{ acc[j] = _mm_loadu_pd(values + j * 2); }
+	size_t i = LANES;
+	for (; i + LANES <= count; i += LANES)
+	{
+		for (size_t j = 0; j < LANES / 2; j++)
+		{
+			__m128d next = _mm_loadu_pd(values + i + j * 2);
+			acc[j] = MIN ? _mm_min_pd(next, acc[j]) : _mm_max_pd(next, acc[j]);
+		}
+	}
+	double lanes[LANES];
+	for (size_t j = 0; j < LANES / 2; j++)
+	{ _mm_storeu_pd(lanes + j * 2, acc[j]); }
+	return extreme_tail<MIN>(values, i, count, combine_extreme<MIN>(lanes));
+}
+
+template <bool SCALAR>
+static __m128d load_sse2(const Operand& operand, size_t index, __m128d broadcast)
+{
+	if constexpr (SCALAR)
+	{ return broadcast; }
+	else
+	{ return _mm_loadu_pd(operand.data + index); }
+}
+
+template <Arith OP, bool LEFT_SCALAR, bool RIGHT_SCALAR>
+static void arith_sse2(double* dst, Operand left, Operand right, size_t count)
+{
+	__m128d left_broadcast = _mm_set1_pd(left.scalar);
+	__m128d right_broadcast = _mm_set1_pd(right.scalar);
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128d l = load_sse2<LEFT_SCALAR>(left, i, left_broadcast);
+		__m128d r = load_sse2<RIGHT_SCALAR>(right, i, right_broadcast);
+		__m128d result;
+		if constexpr (OP == Arith::ARITH_ADD)
+		{ result = _mm_add_pd(l, r); }
+		else if constexpr (OP == Arith::ARITH_SUBTRACT)
+		{ result = _mm_sub_pd(l, r); }
+		else if constexpr (OP == Arith::ARITH_MULTIPLY)
+		{ result = _mm_mul_pd(l, r); }
+		else
+		{ result = _mm_div_pd(l, r); }
+		_mm_storeu_pd(dst + i, result);
+	}
+	arith_scalar<OP, LEFT_SCALAR, RIGHT_SCALAR>(dst, left, right, i, count);
+}
+
+template <Compare OP, bool LEFT_SCALAR, bool RIGHT_SCALAR>
+static void compare_sse2(uint8_t* dst, Operand left, Operand right, size_t count)
+{
+	__m128d left_broadcast = _mm_set1_pd(left.scalar);
+	__m128d right_broadcast = _mm_set1_pd(right.scalar);
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128d l = load_sse2<LEFT_SCALAR>(left, i, left_broadcast);
+		__m128d r = load_sse2<RIGHT_SCALAR>(right, i, right_broadcast);
+		__m128d result;
+		if constexpr (OP == Compare::COMPARE_LESS)
+		{ result = _mm_cmplt_pd(l, r); }
+		else if constexpr (OP == Compare::COMPARE_GREATER)
+		{ result = _mm_cmpgt_pd(l, r); }
+		else if constexpr (OP == Compare::COMPARE_LESS_EQUAL)
+		{ result = _mm_cmple_pd(l, r); }
+		else if constexpr (OP == Compare::COMPARE_GREATER_EQUAL)
+		{ result = _mm_cmpge_pd(l, r); }
+		else if constexpr (OP == Compare::COMPARE_EQUAL)
+		{ result = _mm_cmpeq_pd(l, r); }
+		else
+		{ result = _mm_cmpneq_pd(l, r); }
+		uint16_t bytes = (uint16_t)MASK_BYTES[_mm_movemask_pd(result)];
+		std::memcpy(dst + i, &bytes, sizeof(bytes));
+	}
+	compare_scalar<OP, LEFT_SCALAR, RIGHT_SCALAR>(dst, left, right, i, count);
+}
+
+//AVX2 kernels, four elements per register. Without FMA, a fused multiply-add
+//would round differently than the other kernels
+
+CIL_TARGET_AVX2 static double sum_avx2(const double* values, size_t count)
+{
+	__m256d low = _mm256_setzero_pd();
+	__m256d high = _mm256_setzero_pd();
+	size_t i = 0;
+	for (; i + LANES <= count; i += LANES)
+	{
+		low = _mm256_add_pd(low, _mm256_loadu_pd(values + i));
+		high = _mm256_add_pd(high, _mm256_loadu_pd(values + i + 4));
+	}
+	double lanes[LANES];
+	_mm256_storeu_pd(lanes, low);
+	_mm256_storeu_pd(lanes + 4, high);
+	double total = combine_sum(lanes);
+	for (; i < count; i++)
+	{ total += values[i]; }
+	return total;
+}
+
+CIL_TARGET_AVX2 static double dot_avx2(const double* left, const double* right, size_t count)
+{
+	__m256d low = _mm256_setzero_pd();
+	__m256d high = _mm256_setzero_pd();
+	size_t i = 0;
+	for (; i + LANES <= count; i += LANES)
+	{
+		low = _mm256_add_pd(low, _mm256_mul_pd(_mm256_loadu_pd(left + i), _mm256_loadu_pd(right + i)));
+		high = _mm256_add_pd(high, _mm256_mul_pd(_mm256_loadu_pd(left + i + 4), _mm256_loadu_pd(right + i + 4)));
+	}
+	double lanes[LANES];
+	_mm256_storeu_pd(lanes, low);
+	_mm256_storeu_pd(lanes + 4, high);
+	double total = combine_sum(lanes);
+	for (; i < count; i++)
+	{ total += left[i] * right[i]; }
+	return total;
+}
+
+template <bool MIN>
+CIL_TARGET_AVX2 static double extreme_avx2(const double* values, size_t count)
+{
+	if (count < LANES)
+	{ return extreme_tail<MIN>(values, 1, count, values[0]); }
+	__m256d low = _mm256_loadu_pd(values);
+	__m256d high = _mm256_loadu_pd(values + 4);
+	size_t i = LANES;
+	for (; i + LANES <= count; i += LANES)
+	{
+		__m256d next_low = _mm256_loadu_pd(values + i);
+		__m256d next_high = _mm256_loadu_pd(values + i + 4);
+		low = MIN ? _mm256_min_pd(next_low, low) : _mm256_max_pd(next_low, low);
+		high = MIN ? _mm256_min_pd(next_high, high) : _mm256_max_pd(next_high, high);
+	}
+	double lanes[LANES];
+	_mm256_storeu_pd(lanes, low);
+	_mm256_storeu_pd(lanes + 4, high);
+	return extreme_tail<MIN>(values, i, count, combine_extreme<MIN>(lanes));
+}
+
+template <bool SCALAR>
+CIL_TARGET_AVX2 static __m256d load_avx2(const Operand& operand, size_t index, __m256d broadcast)
+{
+	if constexpr (SCALAR)
+	{ return broadcast; }
+	else
+	{ return _mm256_loadu_pd(operand.data + index); }
+}
+
+template <Arith OP, bool LEFT_SCALAR, bool RIGHT_SCALAR>
+CIL_TARGET_AVX2 static void arith_avx2(double* dst, Operand left, Operand right, size_t count)
+{
+	__m256d left_broadcast = _mm256_set1_pd(left.scalar);
+	__m256d right_broadcast = _mm256_set1_pd(right.scalar);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m256d l = load_avx2<LEFT_SCALAR>(left, i, left_broadcast);
+		__m256d r = load_avx2<RIGHT_SCALAR>(right, i, right_broadcast);
+		__m256d result;
+		if constexpr (OP == Arith::ARITH_ADD)
+		{ result = _mm256_add_pd(l, r); }
+		else if constexpr (OP == Arith::ARITH_SUBTRACT)
+		{ result = _mm256_sub_pd(l, r); }
+		else if constexpr (OP == Arith::ARITH_MULTIPLY)
+		{ result = _mm256_mul_pd(l, r); }
+		else
+		{ result = _mm256_div_pd(l, r); }
+		_mm256_storeu_pd(dst + i, result);
+	}
+	arith_scalar<OP, LEFT_SCALAR, RIGHT_SCALAR>(dst, left, right, i, count);
+}
+
+template <Compare OP, bool LEFT_SCALAR, bool RIGHT_SCALAR>
+CIL_TARGET_AVX2 static void compare_avx2(uint8_t* dst, Operand left, Operand right, size_t count)
+{
+	__m256d left_broadcast = _mm256_set1_pd(left.scalar);
+	__m256d right_broadcast = _mm256_set1_pd(right.scalar);
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m256d l = load_avx2<LEFT_SCALAR>(left, i, left_broadcast);
+		__m256d r = load_avx2<RIGHT_SCALAR>(right, i, right_broadcast);
+		__m256d result;
+		if constexpr (OP == Compare::COMPARE_LESS)
+		{ result = _mm256_cmp_pd(l, r, _CMP_LT_OQ); }
+		else if constexpr (OP == Compare::COMPARE_GREATER)
+		{ result = _mm256_cmp_pd(l, r, _CMP_GT_OQ); }
+		else if constexpr (OP == Compare::COMPARE_LESS_EQUAL)
+		{ result = _mm256_cmp_pd(l, r, _CMP_LE_OQ); }
+		else if constexpr (OP == Compare::COMPARE_GREATER_EQUAL)
+		{ result = _mm256_cmp_pd(l, r, _CMP_GE_OQ); }
+		else if constexpr (OP == Compare::COMPARE_EQUAL)
+		{ result = _mm256_cmp_pd(l, r, _CMP_EQ_OQ); }
+		else
+		{ result = _mm256_cmp_pd(l, r, _CMP_NEQ_UQ); }
+		uint32_t bytes = MASK_BYTES[_mm256_movemask_pd(result)];
+		std::memcpy(dst + i, &bytes, sizeof(bytes));
+	}
+	compare_scalar<OP, LEFT_SCALAR, RIGHT_SCALAR>(dst, left, right, i, count);
+}
+#endif
+
+Isa ArrayKernels::detected_isa()
+{
+	static const Isa detected = []()
+	{
+#ifdef CIL_SIMD_X86
+#ifdef _MSC_VER
+		//AVX2 needs the CPU to support it and the OS to save the upper halves of the registers
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] >= 7)
+		{
+			__cpuid(info, 1);
+			bool os_saves_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+			__cpuidex(info, 7, 0);
+			if (os_saves_avx && (info[1] & (1 << 5)))
+			{ return Isa::ISA_AVX2; }
+		}
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+		{ return Isa::ISA_AVX2; }
+#endif
+		return Isa::ISA_SSE2;
+#else
+		return Isa::ISA_SCALAR;
+#endif
+	}();
+	return detected;
+}
+
+Isa ArrayKernels::isa()
+{
+	return isa_.load(std::memory_order_relaxed);
+}
+
+void ArrayKernels::set_isa(Isa isa)
+{
+	isa_.store(std::min(isa, detected_isa()), std::memory_order_relaxed);
+}
+
+const char* ArrayKernels::isa_name(Isa isa)
+{
+	switch (isa)
+	{
+	case Isa::ISA_SSE2: return "sse2";
+	case Isa::ISA_AVX2: return "avx2";
+	default:            return "scalar";
+	}
+}
+
+double ArrayKernels::sum(const double* values, size_t count)
+{
+	switch (isa())
+	{
+#ifdef CIL_SIMD_X86
+	case Isa::ISA_AVX2: return sum_avx2(values, count);
+	case Isa::ISA_SSE2: return sum_sse2(values, count);
+#endif
+	default:            return sum_scalar(values, count);
+	}
+}
+
+double ArrayKernels::min(const double* values, size_t count)
+{
+	switch (isa())
+	{
+#ifdef CIL_SIMD_X86
+	case Isa::ISA_AVX2: return extreme_avx2<true>(values, count);
+	case Isa::ISA_SSE2: return extreme_sse2<true>(values, count);
+#endif
+	default:            return extreme_scalar<true>(values, count);
+	}
+}
+
+double ArrayKernels::max(const double* values, size_t count)
+{
+	switch (isa())
+	{
+#ifdef CIL_SIMD_X86
+	case Isa::ISA_AVX2: return extreme_avx2<false>(values, count);
+	case Isa::ISA_SSE2: return extreme_sse2<false>(values, count);
+#endif
+	default:            return extreme_scalar<false>(values, count);
+	}
+}
+
+double ArrayKernels::dot(const double* left, const double* right, size_t count)
+{
+	switch (isa())
+	{
+#ifdef CIL_SIMD_X86
+	case Isa::ISA_AVX2: return dot_avx2(left, right, count);
+	case Isa::ISA_SSE2: return dot_sse2(left, right, count);
+#endif
+	default:            return dot_scalar(left, right, count);
+	}
+}
+
+template <Arith OP, bool LEFT_SCALAR, bool RIGHT_SCALAR>
+static void arith_on(Isa isa, double* dst, Operand left, Operand right, size_t count)
+{
+	switch (isa)
+	{
+#ifdef CIL_SIMD_X86
+	case Isa::ISA_AVX2: arith_avx2<OP, LEFT_SCALAR, RIGHT_SCALAR>(dst, left, right, count); break;
+	case Isa::ISA_SSE2: arith_sse2<OP, LEFT_SCALAR, RIGHT_SCALAR>(dst, left, right, count); break;
+#endif
+	default:            arith_scalar<OP, LEFT_SCALAR, RIGHT_SCALAR>(dst, left, right, 0, count); break;
+	}
+}
+
+//Instantiates a kernel for every pair of array and scalar operands
+template <Arith OP>
+static void arith_of(Isa isa, double* dst, Operand left, Operand right, size_t count)
+{
+	if (left.data && right.data)
+	{ arith_on<OP, false, false>(isa, dst, left, right, count); }
+	else if (left.data)
+	{ arith_on<OP, false, true>(isa, dst, left, right, count); }
+	else if (right.data)
+	{ arith_on<OP, true, false>(isa, dst, left, right, count); }
+	else
+	{ arith_on<OP, true, true>(isa, dst, left, right, count); }
+}
+
+void ArrayKernels::arith(Arith op, double* dst, Operand left, Operand right, size_t count)
+{
+	switch (op)
+	{
+	case Arith::ARITH_ADD:      arith_of<Arith::ARITH_ADD>(isa(), dst, left, right, count); break;
+	case Arith::ARITH_SUBTRACT: arith_of<Arith::ARITH_SUBTRACT>(isa(), dst, left, right, count); break;
+	case Arith::ARITH_MULTIPLY: arith_of<Arith::ARITH_MULTIPLY>(isa(), dst, left, right, count); break;
+	case Arith::ARITH_DIVIDE:   arith_of<Arith::ARITH_DIVIDE>(isa(), dst, left, right, count); break;
+	}
+}
+
+template <Compare OP, bool LEFT_SCALAR, bool RIGHT_SCALAR>
+static void compare_on(Isa isa, uint8_t* dst, Operand left, Operand right, size_t count)
+{
+	switch (isa)
+	{
+#ifdef CIL_SIMD_X86
+	case Isa::ISA_AVX2: compare_avx2<OP, LEFT_SCALAR, RIGHT_SCALAR>(dst, left, right, count); break;
+	case Isa::ISA_SSE2: compare_sse2<OP, LEFT_SCALAR, RIGHT_SCALAR>(dst, left, right, count); break;
+#endif
+	default:            compare_scalar<OP, LEFT_SCALAR, RIGHT_SCALAR>(dst, left, right, 0, count); break;
+	}
+}
+
+template <Compare OP>
+static void compare_of(Isa isa, uint8_t* dst, Operand left, Operand right, size_t count)
+{
+	if (left.data && right.data)
+	{ compare_on<OP, false, false>(isa, dst, left, right, count); }
+	else if (left.data)
+	{ compare_on<OP, false, true>(isa, dst, left, right, count); }
+	else if (right.data)
+	{ compare_on<OP, true, false>(isa, dst, left, right, count); }
+	else
+	{ compare_on<OP, true, true>(isa, dst, left, right, count); }
+}
+
+void ArrayKernels::compare(Compare op, uint8_t* dst, Operand left, Operand right, size_t count)
+{
+	switch (op)
+	{
+	case Compare::COMPARE_LESS:          compare_of<Compare::COMPARE_LESS>(isa(), dst, left, right, count); break;
+	case Compare::COMPARE_GREATER:       compare_of<Compare::COMPARE_GREATER>(isa(), dst, left, right, count); break;
+	case Compare::COMPARE_LESS_EQUAL:    compare_of<Compare::COMPARE_LESS_EQUAL>(isa(), dst, left, right, count); break;
+	case Compare::COMPARE_GREATER_EQUAL: compare_of<Compare::COMPARE_GREATER_EQUAL>(isa(), dst, left, right, count); break;
+	case Compare::COMPARE_EQUAL:         compare_of<Compare::COMPARE_EQUAL>(isa(), dst, left, right, count); break;
+	case Compare::COMPARE_NOT_EQUAL:     compare_of<Compare::COMPARE_NOT_EQUAL>(isa(), dst, left, right, count); break;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "../../cil-system.h"
+
+//Loops over whole buffers of doubles for the array operations of the language.
+//Every kernel exists as plain C++ and, on x86, for SSE2 and AVX2. The widest
+//instruction set the CPU supports is picked once at runtime, so one binary runs
+//everywhere. Reductions keep eight partial results in the same lanes whatever
+//the instruction set, which makes their results identical on every machine.
+class ArrayKernels
+{
+public:
+	enum class Isa { ISA_SCALAR, ISA_SSE2, ISA_AVX2 };
+	enum class Arith { ARITH_ADD, ARITH_SUBTRACT, ARITH_MULTIPLY, ARITH_DIVIDE };
+	enum class Compare { COMPARE_LESS, COMPARE_GREATER, COMPARE_LESS_EQUAL, COMPARE_GREATER_EQUAL, COMPARE_EQUAL, COMPARE_NOT_EQUAL };
+
+	//One side of an element-wise operation, without data the scalar stands in for every element
+	struct Operand
+	{
+		const double* data = nullptr;
+		double scalar = 0;
+	};
+
+	//The widest instruction set the CPU supports
+	static Isa detected_isa();
+	//The instruction set the kernels use, benchmarks can lower it to compare them
+	static Isa isa();
+	static void set_isa(Isa isa);
+	static const char* isa_name(Isa isa);
+
+	//'count' has to be at least 1 for min and max
+	static double sum(const double* values, size_t count);
+	static double min(const double* values, size_t count);
+	static double max(const double* values, size_t count);
+	static double dot(const double* left, const double* right, size_t count);
+
+	//'dst' may be one of the operands
+	static void arith(Arith op, double* dst, Operand left, Operand right, size_t count);
+	//Writes 1 where the comparison holds and 0 where it does not
+	static void compare(Compare op, uint8_t* dst, Operand left, Operand right, size_t count);
+private:
+	static std::atomic<Isa> isa_;
+};
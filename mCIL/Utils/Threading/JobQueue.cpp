@@ -6,48 +6,73 @@ bool JobQueueCmp::operator()(const JobQueueEntry& a, const JobQueueEntry& b)
 }
 
 JobQueue::JobQueue()
-	: std::priority_queue<JobQueueEntry, std::vector<JobQueueEntry>, JobQueueCmp>()
+	: std::priority_queue<JobQueueEntry, std::vector<JobQueueEntry>, JobQueueCmp>(),
+	  unfinished_(), finished_(), closed_(false)
 {}
 
 void JobQueue::push_job(ThreadJob* job)
 {
+	std::unique_lock lock{ lock_ };
 	//TODO: Add priority
 	this->emplace(
 		job,
 		0,
 		job->id
 	);
+	unfinished_.insert(job->id);
 	job_available_.notify_one();
 }
 
 ThreadJob* JobQueue::request_job()
 {
 	std::unique_lock lock{ lock_ };
-	while (empty())
-	{
-		job_available_.wait(lock, [this] {return !empty(); });
-	}
+	job_available_.wait(lock, [this] {return !empty() || closed_; });
+	if (empty())
+	{ return nullptr; }
 	JobQueueEntry entry = top();
 	pop();
-	job_assigned_.notify_all();
 	return entry.job;
 }
 
-const JobQueueEntry& JobQueue::get_job_entry(JobID id) const
+void JobQueue::finish_job(JobID id, std::exception_ptr error)
+{
+	std::unique_lock lock{ lock_ };
+	unfinished_.erase(id);
+	finished_.emplace(id, error);
+	jobs_finished_.notify_all();
+}
+
+std::exception_ptr JobQueue::wait_for_job(JobID id)
+{
+	std::unique_lock lock{ lock_ };
+	if (!unfinished_.contains(id) && !finished_.contains(id))
+	{ throw std::invalid_argument("No Job with given id found"); }
+	jobs_finished_.wait(lock, [this, id] {return finished_.contains(id); });
+	std::exception_ptr error = finished_[id];
+	finished_.erase(id);
+	return error;
+}
+
+std::exception_ptr JobQueue::wait_for_finish()
 {
-	for (const JobQueueEntry& entry : this->c)
+	std::unique_lock lock{ lock_ };
+	jobs_finished_.wait(lock, [this] {return unfinished_.empty(); });
+	std::exception_ptr error{};
+	for (auto& [id, job_error] : finished_)
 	{
-		if (entry.id == id)
+		if (job_error)
 		{
-			return entry;
+			error = job_error;
+			break;
 		}
 	}
-	throw std::invalid_argument("No Job with given id found");
+	finished_.clear();
+	return error;
 }
 
-void JobQueue::wait_for_assign()
+void JobQueue::close()
 {
-	size_t orig_size = size();
 	std::unique_lock lock{ lock_ };
-	job_assigned_.wait(lock, [this, orig_size] {return size() < orig_size; });
+	closed_ = true;
+	job_available_.notify_all();
 }
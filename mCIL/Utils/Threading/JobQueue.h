@@ -20,13 +20,28 @@ public:
 	JobQueue();
 
 	void push_job(ThreadJob* job);
+	//Blocks until a job is available, returns nullptr once the queue is closed and empty
 	ThreadJob* request_job();
+	//Called by a worker after the job it requested ran, workers delete their jobs
+	//so only the id and the exception it threw are kept until someone waits for it
+	void finish_job(JobID id, std::exception_ptr error);
 
-	const JobQueueEntry& get_job_entry(JobID id) const;
+	//Blocks until the job with the given id finished running, returns the exception it threw
+	std::exception_ptr wait_for_job(JobID id);
+	//Blocks until every pushed job finished running, they all count as waited for.
+	//Returns the exception of the earliest pushed job that threw one
+	std::exception_ptr wait_for_finish();
 
-	void wait_for_assign();
+	//Wakes up all workers waiting for a job, they stop once no job is left
+	void close();
 private:
 	std::mutex lock_;
 	std::condition_variable job_available_;
-	std::condition_variable job_assigned_;
+	std::condition_variable jobs_finished_;
+
+	//Jobs that were pushed but did not finish yet, queued or running
+	std::unordered_set<JobID> unfinished_;
+	//Jobs that finished but were not waited for yet
+	std::map<JobID, std::exception_ptr> finished_;
+	bool closed_;
 };
\ No newline at end of file
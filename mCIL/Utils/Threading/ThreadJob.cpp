@@ -1,7 +1,7 @@
 #include "ThreadJob.h"
 
 ThreadJob::ThreadJob(JobID id)
-	: id(id), status(JobStatus::PENDING), worker(nullptr)
+	: id(id), status(JobStatus::PENDING), worker(nullptr), error()
 {}
 
 void ThreadJob::execute()
@@ -9,10 +9,11 @@ void ThreadJob::execute()
 	status = JobStatus::RUNNING;
 	try
 	{ run_(); }
-	catch (const std::exception& e)
+	catch (...)
 	{
 		status = JobStatus::ERROR;
-		throw e;
+		error = std::current_exception();
+		return;
 	}
 	status = JobStatus::FINISHED;
 }
@@ -16,11 +16,16 @@ class ThreadJob
 {
 public:
 	ThreadJob(JobID id);
+	virtual ~ThreadJob() = default;
+
+	//Runs the job, an exception it throws is kept in 'error' since nothing
+	//on the worker's thread could handle it. ThreadManager rethrows it when waiting
 	void execute();
 
 	JobID id;
 	JobStatus status;
 	Worker* worker;
+	std::exception_ptr error;
 private:
 	virtual void run_() = 0;
 };
\ No newline at end of file
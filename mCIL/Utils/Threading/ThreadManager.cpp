@@ -21,6 +21,7 @@ ThreadManager::ThreadManager(size_t thread_count)
 
 ThreadManager::~ThreadManager()
 {
+    jobs_.close();
     for (Worker* worker : workers_)
     {
         delete worker;
@@ -29,23 +30,19 @@ ThreadManager::~ThreadManager()
 
 void ThreadManager::wait(JobID id)
 {
-    const JobQueueEntry& entry = jobs_.get_job_entry(id);
-    while (!entry.job->worker)
+    std::exception_ptr error = jobs_.wait_for_job(id);
+    if (error)
     {
-        jobs_.wait_for_assign();
+        std::rethrow_exception(error);
     }
-    entry.job->worker->wait();
 }
 
 void ThreadManager::wait_all()
 {
-    while (!jobs_.empty())
+    std::exception_ptr error = jobs_.wait_for_finish();
+    if (error)
     {
-        jobs_.wait_for_assign();
-    }
-    for (Worker* worker : workers_)
-    {
-        worker->wait();
+        std::rethrow_exception(error);
     }
 }
 
@@ -15,6 +15,7 @@ public:
 	template <typename Ret, typename... Ts>
 	const JobResult<Ret>* schedule_func(std::function<Ret(Ts...)>, Ts... Args);
 
+	//Both rethrow an exception a job they waited for threw
 	void wait(JobID id);
 	void wait_all();
 
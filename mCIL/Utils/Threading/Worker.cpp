@@ -2,13 +2,14 @@
 
 Worker::Worker(JobQueue* queue)
     : status(WorkerStatus::FREE), current_job_id(0), current_job(nullptr), lock_(), job_queue_(queue),
-      continue_(true), finished_(false)
+      continue_(true), finished_(true)
 {
     thread_ = new std::thread(&Worker::run, this);
 }
 
 Worker::~Worker()
 {
+    //The queue has to be closed first, otherwise the thread may never return from request_job
     continue_.store(false);
     thread_->join();
     delete thread_;
@@ -31,21 +32,32 @@ void Worker::run()
         thread_ready_.notify_all();
 
         get_job_();
+        if (!current_job)
+        { break; }
 
         finished_.store(false);
 
         status = WorkerStatus::BUSY;
 
+        current_job->worker = this;
         current_job->execute();
 
-        finished_.store(true);
+        JobID id = current_job->id;
+        std::exception_ptr error = current_job->error;
+        delete current_job;
+        current_job = nullptr;
+        {
+            std::unique_lock lock{ lock_ };
+            finished_.store(true);
+        }
         job_finished_.notify_all();
+        job_queue_->finish_job(id, error);
     }
 }
 
 void Worker::get_job_()
 {
     ThreadJob* job = job_queue_->request_job();
-    current_job_id = job->id;
+    current_job_id = job ? job->id : 0;
     current_job = job;
 }
\ No newline at end of file
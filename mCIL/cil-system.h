@@ -2,20 +2,35 @@
 #include <iostream>
 #include <string>
 #include <map>
+#include <memory_resource>
 #include <assert.h>
 #include <vector>
 #include <queue>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
 #include <fstream>
 #include <stdlib.h>
 
 #include <thread>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
 
 #include <exception>
+#include <atomic>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
 
 #include <sstream>
+#include <iomanip>
 #include <cstdarg>
+#include <algorithm>
+#include <random>
+#include <optional>
+#include <cmath>
 
 #include "LLVMHeaders.h"
\ No newline at end of file
@@ -4,61 +4,307 @@
 #include "Scanning/Scanner.h"
 #include "Parsing/Parser.h"
 #include "Parsing/Statement.h"
+#include "Parsing/Resolver.h"
+#include "Parsing/Optimizer.h"
 #include "Compiling/Compiler.h"
 #include "Compiling/LLVMBackend.h"
+#include "Compiling/BytecodeBackend.h"
 #include "Diagnostics/SourceFileManager.h"
 #include "Diagnostics/Diagnostics.h"
 #include "Utils/Debugging/ASTDebugPrinter.h"
+#include "Utils/Debugging/Profiler.h"
+#ifdef CIL_COUNTERS
+#include "Utils/Debugging/HitCounters.h"
+#endif
+#include "Utils/Benchmarking/ProgramGenerator.h"
+#include "Utils/Benchmarking/TraversalBenchmark.h"
 #include "Interpreting/Interpreter.h"
+#include "Interpreting/VM.h"
+#include "Interpreting/Isolate.h"
 #include "REPL/REPL.h"
 
-int main()
+enum class Engine
+{
+	ENGINE_AST,
+	ENGINE_VM
+};
+
+struct Options
+{
+	std::string path = "Samples/Functions.cil";
+	Engine engine = Engine::ENGINE_AST;
+	bool dump_ast = false;
+	bool dump_optimized_ast = false;
+	bool optimize = true;
+	bool report_loops = false;
+	bool dump_bytecode = false;
+	bool time = false;
+	bool stats = false;
+	std::string profile = "";
+	bool counters = false;
+	size_t threads = 0;
+	Heap::Limits heap{};
+	size_t generate = 0;
+	ProgramGenerator::Shape generate_shape{};
+	size_t bench_traversal = 0;
+};
+
+void print_usage(const char* program)
+{
+	std::cerr << "Usage: " << program << " [options] [file]\n"
+		<< "  --engine=ast|vm   Execute with the tree-walking interpreter (default) or the bytecode VM\n"
+		<< "  --vm              Same as --engine=vm\n"
+		<< "  --dump-ast        Print the parsed program before running it\n"
+		<< "  --dump-optimized-ast\n"
+		<< "                    Print the program after constant folding and branch elimination\n"
+		<< "  --no-optimize     Run the program exactly as it was parsed\n"
+		<< "  --report-loops    List hoisted loop invariants and induction variables on stderr\n"
+		<< "  --dump-bytecode   Print the compiled top-level bytecode before running it\n"
+		<< "  --time            Report how long execution took on stderr\n"
+		<< "  --stats           Dump runtime statistics on stderr after execution\n"
+		<< "  --profile[=FILE]  Sample the CIL call stack and write collapsed stacks for flamegraph\n"
+		<< "                    tools to FILE (default profile.folded), AST engine only\n"
+#ifdef CIL_COUNTERS
+		<< "  --counters        Print every source line with how often it ran and the time spent\n"
+		<< "                    in each function on stderr, AST engine only\n"
+#endif
+		<< "  --threads=N       Run parallel loops on N threads (default one per hardware thread),\n"
+		<< "                    AST engine only, the VM runs them sequentially. An error inside a\n"
+		<< "                    parallel loop stops the program like any other statement's error\n"
+		<< "  --gc-threshold=N  Collect garbage objects after N bytes of them were allocated (default 4MB)\n"
+		<< "  --heap-limit=N    Fail allocations that would grow the heap past N bytes (default no limit)\n"
+		<< "  --generate=N      Write a synthetic program with N functions to stdout and exit\n"
+		<< "  --generate-statement-depth=N\n"
+		<< "                    Nest statements up to N levels deep in generated functions (default 3)\n"
+		<< "  --generate-expression-depth=N\n"
+		<< "                    Nest operators up to N levels deep in generated expressions (default 3)\n"
+		<< "  --bench-traversal[=N]\n"
+		<< "                    Time N walks (default 20) over the parsed program instead of running it\n";
+}
+
+Options parse_options(int argc, char** argv)
+{
+	Options options{};
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--engine=ast")
+		{ options.engine = Engine::ENGINE_AST; }
+		else if (arg == "--engine=vm" || arg == "--vm")
+		{ options.engine = Engine::ENGINE_VM; }
+		else if (arg == "--dump-ast")
+		{ options.dump_ast = true; }
+		else if (arg == "--dump-optimized-ast")
+		{ options.dump_optimized_ast = true; }
+		else if (arg == "--no-optimize")
+		{ options.optimize = false; }
+		else if (arg == "--report-loops")
+		{ options.report_loops = true; }
+		else if (arg == "--dump-bytecode")
+		{ options.dump_bytecode = true; }
+		else if (arg == "--time")
+		{ options.time = true; }
+		else if (arg == "--stats")
+		{ options.stats = true; }
+		else if (arg == "--profile")
+		{ options.profile = "profile.folded"; }
+		else if (arg.starts_with("--profile="))
+		{ options.profile = arg.substr(std::strlen("--profile=")); }
+#ifdef CIL_COUNTERS
+		else if (arg == "--counters")
+		{ options.counters = true; }
+#endif
+		else if (arg.starts_with("--threads="))
+		{ options.threads = std::stoul(arg.substr(std::strlen("--threads="))); }
+		else if (arg.starts_with("--gc-threshold="))
+		{ options.heap.collect_after = std::stoul(arg.substr(std::strlen("--gc-threshold="))); }
+		else if (arg.starts_with("--heap-limit="))
+		{ options.heap.max_bytes = std::stoul(arg.substr(std::strlen("--heap-limit="))); }
+		else if (arg.starts_with("--generate="))
+		{ options.generate = std::stoul(arg.substr(std::strlen("--generate="))); }
+		else if (arg.starts_with("--generate-statement-depth="))
+		{ options.generate_shape.statement_depth = std::stoi(arg.substr(std::strlen("--generate-statement-depth="))); }
+		else if (arg.starts_with("--generate-expression-depth="))
+		{ options.generate_shape.expression_depth = std::stoi(arg.substr(std::strlen("--generate-expression-depth="))); }
+		else if (arg == "--bench-traversal")
+		{ options.bench_traversal = 20; }
+		else if (arg.starts_with("--bench-traversal="))
+		{ options.bench_traversal = std::stoul(arg.substr(std::strlen("--bench-traversal="))); }
+		else if (arg == "--help" || arg == "-h")
+		{
+			print_usage(argv[0]);
+			exit(EXIT_SUCCESS);
+		}
+		else if (arg.starts_with("-"))
+		{
+			std::cerr << "Unknown option '" << arg << "'\n";
+			print_usage(argv[0]);
+			exit(EXIT_FAILURE);
+		}
+		else
+		{ options.path = arg; }
+	}
+	return options;
+}
+
+int main(int argc, char** argv)
 {
 	/*REPL repl{};
 	repl.run();*/
 
-	TypeTable::add_builtin_types();
+	Options options = parse_options(argc, argv);
+
+	if (options.generate > 0)
+	{
+		ProgramGenerator generator{ options.generate_shape };
+		generator.generate(options.generate, std::cout);
+		return EXIT_SUCCESS;
+	}
+
+	//The optimizer, resolver and VM work in the isolate the thread is in
+	Isolate isolate{};
+	Isolate::Scope scope{ isolate };
 
-	SourceFileManager source{ "Samples/Functions.cil" };
-	Lexer lexer{ source };
+	SourceFileManager source{ options.path };
+	Lexer lexer{ isolate, source };
 	token_list tokens = lexer.scan_file();
-	if (ErrorManager::error_ocurred)
+	if (ErrorManager::error_ocurred())
 	{
 		ErrorManager::report_errors(source);
 		exit(EXIT_FAILURE);
 	}
 
-	Scanner scanner{ tokens };
+	Scanner scanner{ isolate, tokens };
 	token_list top_level_tokens = scanner.scan();
-	if (ErrorManager::error_ocurred)
+	if (ErrorManager::error_ocurred())
 	{
 		ErrorManager::report_errors(source);
 		exit(EXIT_FAILURE);
 	}
 
-	Parser parser{ top_level_tokens };
+	Parser parser{ isolate, top_level_tokens };
 	stmt_list& stmts = parser.parse();
-	if (ErrorManager::error_ocurred)
+	if (ErrorManager::error_ocurred())
 	{
 		ErrorManager::report_errors(source);
 		exit(EXIT_FAILURE);
 	}
 
-	ASTDebugPrinter dbg{};
-	dbg.print_stmt_list(stmts);
+	if (options.dump_ast)
+	{
+		ASTDebugPrinter dbg{};
+		dbg.print_stmt_list(stmts);
+	}
+
+	ConstantPool constants{};
+	Optimizer optimizer{ stmts, constants };
+	if (options.report_loops)
+	{ optimizer.report_loops(std::cerr); }
+	if (options.optimize)
+	{ optimizer.optimize(); }
+
+	if (options.dump_optimized_ast)
+	{
+		ASTDebugPrinter dbg{};
+		dbg.print_stmt_list(stmts);
+	}
+
+	Resolver resolver{ stmts, constants };
+	resolver.resolve();
+
+	if (options.bench_traversal > 0)
+	{
+		TraversalBenchmark benchmark{ stmts };
+		benchmark.report(benchmark.run(options.bench_traversal), std::cerr);
+		return EXIT_SUCCESS;
+	}
+
+	if (options.dump_bytecode)
+	{
+		Compiler compiler{ stmts, std::shared_ptr<Backend>(new BytecodeBackend()) };
+		compiler.compile();
+		if (ErrorManager::error_ocurred())
+		{
+			ErrorManager::report_errors(source);
+			exit(EXIT_FAILURE);
+		}
+	}
 
 	/*Compiler compiler{ stmts, std::shared_ptr<Backend>(new LLVMBackend())};
 	compiler.compile();
-	if (ErrorManager::error_ocurred)
+	if (ErrorManager::error_ocurred())
 	{
 		ErrorManager::report_errors(source);
 		exit(EXIT_FAILURE);
 	}*/
 	
-	Interpreter interpreter{ stmts };
-	interpreter.define_global_symbols();
-	interpreter.run();
-	if (ErrorManager::error_ocurred)
+	std::stringstream stats{};
+	if (options.stats && options.optimize)
+	{ optimizer.dump_stats(stats); }
+	//Limits apply to what the program allocates while it runs, the constants of compiling it never fail
+	isolate.heap().set_limits(options.heap);
+	auto start = std::chrono::steady_clock::now();
+	if (options.engine == Engine::ENGINE_VM)
+	{
+		if (!options.profile.empty())
+		{ std::cerr << "--profile is only supported by the AST engine, running without it\n"; }
+		if (options.counters)
+		{ std::cerr << "--counters is only supported by the AST engine, running without it\n"; }
+		VM vm{ stmts };
+		vm.define_global_symbols();
+		vm.run();
+		if (options.stats)
+		{ vm.dump_stats(stats); }
+	}
+	else
+	{
+		Interpreter interpreter{ isolate, stmts };
+		interpreter.define_global_symbols();
+		interpreter.set_threads(options.threads);
+		Profiler profiler{};
+		if (!options.profile.empty())
+		{
+			interpreter.set_profiler(&profiler);
+			profiler.start();
+		}
+#ifdef CIL_COUNTERS
+		HitCounters counters{ stmts };
+		if (options.counters)
+		{ interpreter.set_counters(&counters); }
+#endif
+		interpreter.run();
+		if (!options.profile.empty())
+		{
+			profiler.stop();
+			std::ofstream out{ options.profile };
+			if (!out)
+			{ std::cerr << "Could not write profile to '" << options.profile << "'\n"; }
+			else
+			{
+				profiler.write_collapsed(out);
+				std::cerr << "Wrote " << profiler.samples() << " samples to '" << options.profile << "'\n";
+			}
+		}
+#ifdef CIL_COUNTERS
+		if (options.counters)
+		{
+			std::cerr << "\n";
+			counters.report(source, std::cerr);
+		}
+#endif
+		if (options.stats)
+		{ interpreter.dump_stats(stats); }
+	}
+	if (options.stats)
+	{ isolate.heap().dump_stats(stats); }
+	if (options.time)
+	{
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		std::cerr << "\nExecuted in " << std::fixed << std::setprecision(3) << elapsed.count() << "ms\n";
+	}
+	if (options.stats)
+	{ std::cerr << "\n" << stats.str(); }
+	if (ErrorManager::error_ocurred())
 	{
 		ErrorManager::report_errors(source);
 		exit(EXIT_FAILURE);